@@ -6,25 +6,36 @@
 #include "Account-Functions.h"
 #include "SavingAccount.h"
 #include "CertificateAccount.h"
+#include "AccountVariant.h"
 #include "Exceptions.h"
 #include "Constants.h"
 #include "Conversion-Functions.h"
+#include "Numeric-Functions.h"
 #include "Program-Data-Functions.h"
 #include "Display-Functions.h"
+#include "Clock.h"
 
 /*
 Saves an account to the accounts vector and writes it to a CSV file.
-Parameters: Person object to retrieve personNationalID, initial balance, and account type.
+Parameters: Person object to retrieve personNationalID, initial balance, account type, and certificate product.
 */
-static void saveAccount(Person&, double, string);
+static void saveAccount(const Person&, double, const string&, CertificateProductID);
+
+/*
+Prompts the user to select a certificate product from the catalog.
+Returns the ID of the selected product.
+*/
+static CertificateProductID selectCertificateProduct();
 
 /*
 Prompts the user to select an account type and enter an initial balance,
 then creates a new account for the specified person.
 */
-void createAccount(Person& person)
+void createAccount(const Person& person)
 {
     string accountType = ""; // Stores the account type.
+    CertificateProductID productID = CertificateProductID::Classic; // Stores the certificate product.
+    double minimumDeposit = MIN_BALANCE; // Stores the minimum initial balance of the selected account.
     double balance; // Stores the initial balance of the account.
     int choice; // Stores the user's account type selection.
     displayPerson(person); // Displays the person's information and accounts in tabular format.
@@ -65,6 +76,8 @@ void createAccount(Person& person)
         break;
     case 2:
         accountType = "CertificateAccount";
+        productID = selectCertificateProduct(); // Asks for the certificate product.
+        minimumDeposit = getCertificateProduct(productID).minimumDeposit; // Uses the product's minimum deposit.
         break;
     }
 
@@ -84,12 +97,12 @@ void createAccount(Person& person)
         }
 
         // Creates the account with the specified type and balance.
-        saveAccount(person, balance, accountType);
+        saveAccount(person, balance, accountType, productID);
     }
     catch (InsufficientBalanceException)
     {
         // Handles cases where the initial balance is below the minimum required.
-        cout << "Error: The minimum initial balance is $" << MIN_BALANCE << "." << endl;
+        cout << "Error: The minimum initial balance is $" << minimumDeposit << "." << endl;
         cout << "Please enter a valid initial balance: ";
         clearInputBufferFunc(); // Ensures the input buffer is valid and empty for the next input.
         cin >> balance; // Reads the re-entered balance.
@@ -103,7 +116,7 @@ void createAccount(Person& person)
         }
 
         // Loops until a valid balance (above the minimum) is entered.
-        while (balance < MIN_BALANCE)
+        while (balance < minimumDeposit)
         {
             // Exits the program if the input is invalid (e.g., non-numeric input for a number).
             if (cin.fail())
@@ -112,22 +125,52 @@ void createAccount(Person& person)
                 clearInputBufferFunc(); // Ensures the input buffer is valid and empty for the next input.
                 exit(1);
             }
-            cout << "Error: The minimum initial balance is $" << MIN_BALANCE << "." << endl;
+            cout << "Error: The minimum initial balance is $" << minimumDeposit << "." << endl;
             cout << "Please enter a valid initial balance: ";
             clearInputBufferFunc(); // Ensures the input buffer is valid and empty for the next input.
             cin >> balance; // Reads the re-entered balance.
         }
 
         // Creates the account with the valid balance.
-        saveAccount(person, balance, accountType);
+        saveAccount(person, balance, accountType, productID);
     }
 }
 
+/*
+Prompts the user to select a certificate product from the catalog.
+Returns the ID of the selected product.
+*/
+CertificateProductID selectCertificateProduct()
+{
+    int choice; // Stores the user's product selection.
+    displayCertificateProducts(); // Shows the certificate products.
+    cout << "Please select a certificate product: "; // Prompts the user to choose a product.
+    clearInputBufferFunc(); // Ensures the input buffer is valid and empty for the next input.
+    cin >> choice; // Reads the user's choice.
+
+    // Validates that the choice is a product number, looping until a valid choice is entered.
+    while (cin.fail() || choice < 1 || choice > CERTIFICATE_PRODUCT_COUNT)
+    {
+        // Exits the program if the input is invalid (e.g., non-integer input for an integer).
+        if (cin.fail())
+        {
+            cout << "Error: Invalid input. Please enter a number." << endl;
+            clearInputBufferFunc(); // Ensures the input buffer is valid and empty for the next input.
+            exit(1);
+        }
+        cout << "Error: Invalid choice. Please select 1 to " << CERTIFICATE_PRODUCT_COUNT << "." << endl;
+        cout << "Please select a certificate product: ";
+        clearInputBufferFunc(); // Ensures the input buffer is valid and empty for the next input.
+        cin >> choice; // Reads the re-entered choice.
+    }
+    return CERTIFICATE_PRODUCTS[choice - 1].id; // Returns the product listed under the chosen number.
+}
+
 /*
 Saves an account to the accounts vector and writes it to a CSV file.
-Parameters: Person object to retrieve personNationalID, initial balance, and account type.
+Parameters: Person object to retrieve personNationalID, initial balance, account type, and certificate product.
 */
-void saveAccount(Person& person, double balance, string accountType)
+void saveAccount(const Person& person, double balance, const string& accountType, CertificateProductID productID)
 {
     // Creates and saves the account based on the specified type.
     if (accountType == "SavingAccount")
@@ -137,24 +180,24 @@ void saveAccount(Person& person, double balance, string accountType)
         // Converts the SavingAccount object to a vector for storage.
         vector<string> savingAccountVector = convertSavingAccountObjectToAccountVector(savingAccountObject);
         // Assigns a unique account ID based on the current size of the accounts vector.
-        savingAccountVector[0] = to_string(accounts.size() + 1);
+        savingAccountVector[0] = formatInteger(accounts.size() + 1);
         // Adds the account vector to the accounts vector.
-        accounts.push_back(savingAccountVector);
+        accounts.push_back(move(savingAccountVector));
     }
     else
     {
-        // Initializes a CertificateAccount object with the person, balance, current interest rate, and 0 withdrawn amount.
-        CertificateAccount certificateAccountObject(person, balance, INTEREST_RATE_PERCENT, 0);
+        // Initializes a CertificateAccount object with the person, balance, and product, which sets the rate of the deposit's tier.
+        CertificateAccount certificateAccountObject(person, balance, productID);
         // Converts the CertificateAccount object to a vector for storage.
         vector<string> certificateAccountVector = convertCertificateAccountObjectToAccountVector(certificateAccountObject);
         // Assigns a unique account ID based on the current size of the accounts vector.
-        certificateAccountVector[0] = to_string(accounts.size() + 1);
+        certificateAccountVector[0] = formatInteger(accounts.size() + 1);
         // Adds the account vector to the accounts vector.
-        accounts.push_back(certificateAccountVector);
+        accounts.push_back(move(certificateAccountVector));
     }
 
-    // Writes all accounts in the accounts vector to the CSV file.
-    writeAllSavedAccountToCSVFile();
+    // Adds the new account to the account store.
+    persistNewAccount();
 }
 
 /*
@@ -164,30 +207,16 @@ such as ID, type, national ID, balance, creation date, and additional fields for
 void listAllAccounts()
 {
     // Initializes a table with headers for displaying account information.
-    vector<vector<string>> accountsTable = { {"AccountID", "Account Type", "NationalID", "Balance", "Creation Date & Time", "Interest Rate", "Withdrawn Amount", "Saving Balance"} };
-    // Iterates through all accounts in the accounts vector.
-    for (vector<string> account : accounts)
-    {
-        // Determines the account type and adds relevant data to the table.
-        if (account.back() == "")
-        {
-            // For saving accounts, adds an empty string for the saving balance field.
-            account.push_back("");
-            account.insert(account.begin() + 1, "Saving Account"); // Inserts the account type.
-        }
-        else
-        {
-            // For certificate accounts, calculates and adds the saving balance.
-            CertificateAccount certificateAccountObject = convertAccountVectorToCertificateAccountObject(account);
-            account.push_back(to_string(certificateAccountObject.getSavingBalance()));
-            account.insert(account.begin() + 1, "Certificate Account"); // Inserts the account type.
-        }
-
-        // Formats the creation date and time for display.
-        vector<string> dateTimeVector = convertDateTimeStringToDateTimeVector(account[4]);
-        account[4] = convertDateTimeVectorToFormattedDateTimeString(dateTimeVector);
-        accountsTable.push_back(account); // Adds the modified account vector to the table.
-    }
+    vector<vector<string>> accountsTable = { {"AccountID", "Account Type", "Product", "NationalID", "Balance", "Creation Date & Time", "Interest Rate", "Withdrawn Amount", "Saving Balance"} };
+    // Reads the accounts from a snapshot of the account version table, so the listing never holds up a change.
+    prepareAccountVersions();
+    AccountVersionTable::Snapshot snapshot(accountVersions);
+    accountsTable.reserve(snapshot.size() + 1); // Allocates the table once.
+    // Evaluates every saving balance as of the time of the operation, so the table is consistent.
+    time_t asOf = getOperationTime();
+    // Iterates through all accounts of the snapshot, adding the type name and the saving balance of each account's type.
+    for (size_t accountIndex = 0; accountIndex < snapshot.size(); accountIndex++)
+        accountsTable.push_back(convertAccountVariantToTableRow(snapshot.getAccount(accountIndex), asOf));
 
     // Prints the accounts table.
     printTable(accountsTable);
@@ -256,10 +285,11 @@ void updateAccount()
         cin >> accountID; // Reads the re-entered account ID.
     }
 
-    // Retrieves the account vector for the specified account ID.
-    vector<string> accountVector = accounts[accountID - 1];
+    // Retrieves the account vector for the specified account ID from the account store, with the version it is read at.
+    unsigned long long accountVersion = readAccountVersion(accountID - 1);
+    vector<string> accountVector;
     // Loops until the account nationalID matches the person's national ID.
-    while (stoll(accountVector[1]) != nationalID)
+    while (!readAccountOfPerson(accountID, nationalID, accountVector))
     {
         // Exits the program if the input is invalid (e.g., non-integer input for an integer).
         if (cin.fail())
@@ -289,15 +319,16 @@ void updateAccount()
             cin >> accountID; // Reads the re-entered account ID.
         }
 
-        // Updates the account vector with the new account data related to account ID.
-        accountVector = accounts[accountID - 1];
+        // Reads the version of the newly selected account before the account itself.
+        accountVersion = readAccountVersion(accountID - 1);
     }
 
-    // Determines the account type based on the last element (interest rate).
-    if (accountVector.back() == "")
+    // Converts the account vector to an account of its type.
+    AccountVariant accountObject = convertAccountVectorToAccountVariant(accountVector);
+    if (holds_alternative<SavingAccount>(accountObject))
     {
-        // Converts the account vector to a SavingAccount object.
-        SavingAccount savingAccountObject = convertAccountVectorToSavingAccountObject(accountVector);
+        // Gets the SavingAccount object held by the account.
+        SavingAccount& savingAccountObject = get<SavingAccount>(accountObject);
         displayUpdateChoices(); // Displays options for deposit or withdrawal.
         cout << "Please select an option: "; // Prompts the user to choose an option.
         int option; // Stores the user's option.
@@ -409,14 +440,13 @@ void updateAccount()
             // Performs the withdrawal operation.
             savingAccountObject.withdraw(amount);
         }
-
-        // Updates the account vector with the modified SavingAccount data.
-        accountVector = convertSavingAccountObjectToAccountVector(savingAccountObject);
     }
     else
     {
-        // Converts the account vector to a CertificateAccount object.
-        CertificateAccount certificateAccountObject = convertAccountVectorToCertificateAccountObject(accountVector);
+        // Gets the CertificateAccount object held by the account.
+        CertificateAccount& certificateAccountObject = get<CertificateAccount>(accountObject);
+        accrualCache.restore(accountID - 1, certificateAccountObject); // Reuses the cached returns; the saving balance is read several times below.
+        time_t asOf = getOperationTime(); // Evaluates the saving balance as of the time of the operation, however long the prompts take.
         double amount; // Stores the withdrawal amount.
 
         cout << "Enter the withdrawal amount: "; // Prompts the user to enter the withdrawal amount.
@@ -439,7 +469,7 @@ void updateAccount()
             cin >> amount; // Reads the re-entered withdrawal amount.
 
             // Loops until the withdrawal amount is within the available saving balance.
-            while (amount > certificateAccountObject.getSavingBalance())
+            while (amount > certificateAccountObject.getSavingBalanceAsOf(asOf))
             {
                 // Exits the program if the input is invalid (e.g., non-numeric input for a number).
                 if (cin.fail())
@@ -449,7 +479,7 @@ void updateAccount()
                     exit(1);
                 }
                 cout << "Error: Insufficient funds. You are trying to withdraw $" << amount
-                    << ", but your current saving balance is $" << certificateAccountObject.getSavingBalance() << "." << endl;
+                    << ", but your current saving balance is $" << certificateAccountObject.getSavingBalanceAsOf(asOf) << "." << endl;
                 cout << "Enter the withdrawal amount: ";
                 clearInputBufferFunc(); // Ensures the input buffer is valid and empty for the next input.
                 cin >> amount; // Reads the re-entered withdrawal amount.
@@ -457,15 +487,19 @@ void updateAccount()
         }
 
         // Performs the withdrawal operation.
-        certificateAccountObject.withdraw(amount);
-        // Updates the account vector with the modified CertificateAccount data.
-        accountVector = convertCertificateAccountObjectToAccountVector(certificateAccountObject);
+        certificateAccountObject.withdraw(amount, asOf);
     }
 
-    // Updates the accounts vector with the modified account data.
-    accounts[accountID - 1] = accountVector;
-    // Saves the updated accounts to the CSV file.
-    writeAllSavedAccountToCSVFile();
+    // Commits the modified account data, using the converter of its type, only if no other change was committed since the account was read,
+    // then rewrites only the updated account's record in the account store.
+    try
+    {
+        commitAccountUpdate(accountID - 1, accountVersion, convertAccountVariantToAccountVector(accountObject));
+    }
+    catch (AccountVersionConflictException)
+    {
+        cout << "Error: The account was changed by another operation while it was being updated. No change was made; please try again." << endl;
+    }
 }
 
 /*
@@ -527,10 +561,10 @@ void deleteAccount()
         cin >> accountID; // Reads the re-entered account ID.
     }
 
-    // Retrieves the account vector for the specified account ID.
-    vector<string> accountVector = accounts[accountID - 1];
+    // Retrieves the account vector for the specified account ID from the account store.
+    vector<string> accountVector;
     // Loops until the account nationalID matches the person's national ID.
-    while (stoll(accountVector[1]) != nationalID)
+    while (!readAccountOfPerson(accountID, nationalID, accountVector))
     {
         cout << "Error: Invalid Account ID. Please select an account owned by this person." << endl;
         cout << "Enter the Account ID to delete: ";
@@ -560,13 +594,10 @@ void deleteAccount()
             clearInputBufferFunc(); // Ensures the input buffer is valid and empty for the next input.
             cin >> accountID; // Reads the re-entered account ID.
         }
-
-        // Updates the account vector with the new account ID.
-        accountVector = accounts[accountID - 1];
     }
 
     // Removes the account from the accounts vector.
     accounts.erase(accounts.begin() + (accountID - 1));
-    // Saves the updated accounts to the CSV file.
-    writeAllSavedAccountToCSVFile();
+    // Saves the updated accounts to the CSV file and removes the account's record from the account store.
+    persistAccountRemovals({ static_cast<size_t>(accountID - 1) });
 }
\ No newline at end of file
@@ -11,10 +11,11 @@
 This function receives a Person object by reference. It prompts the user to choose an account type,
 enter an initial balance, and then creates an account for that person.
 */
-void createAccount(Person&);
+void createAccount(const Person&);
 
 /*
 This function displays all accounts created in the system in a tabular format.
+The accounts are read from a snapshot of the account version table.
 */
 void listAllAccounts();
 
@@ -24,6 +25,8 @@ This function updates account data:
 - For certificate accounts: allows only withdrawal
 The user is prompted to enter the national ID of the person, choose one of their accounts,
 and provide the account ID of the selected account to update.
+The change is committed only if the account's version has not changed since it was read;
+otherwise it is discarded and the user is told to try again.
 */
 void updateAccount();
 
@@ -0,0 +1,100 @@
+#include <cstring>
+#include <cstddef>
+#include "AccountStore.h"
+#include "Checksum-Functions.h"
+#include "Numeric-Functions.h"
+#include "Conversion-Functions.h"
+#include "AccountVariant.h"
+
+using namespace std;
+
+// Fills a record from an account vector, keeping its sequence number, and recomputes its checksum.
+void fillAccountRecord(AccountRecord& record, const vector<string>& account)
+{
+    uint64_t sequence = record.sequence; // Keeps the sequence number across the reset below.
+    memset(&record, 0, sizeof(record)); // Clears every field, including the reserved bytes.
+    record.sequence = sequence; // Restores the sequence number.
+    record.accountID = parseInt(account[0]); // Stores the account ID.
+    record.nationalID = parseLongLong(account[1]); // Stores the owner's national ID.
+    record.balance = parseDouble(account[2]); // Stores the balance.
+    string dateTimeString = account[3]; // Copies the creation date-time so it can be split.
+    vector<string> dateTimeVector = convertDateTimeStringToDateTimeVector(dateTimeString); // Splits the creation date-time.
+    for (int part = 0; part < 6; part++)
+        record.creationDateTime[part] = static_cast<int16_t>(parseInt(dateTimeVector[part])); // Stores each date-time component.
+    if (isSavingAccountVector(account)) // Determines if the account is a Saving Account.
+    {
+        record.accountType = SAVING_ACCOUNT_RECORD; // Marks the record as a saving account.
+    }
+    else
+    {
+        record.accountType = CERTIFICATE_ACCOUNT_RECORD; // Marks the record as a certificate account.
+        record.interestRatePercent = parseDouble(account[4]); // Stores the interest rate.
+        record.withdrawnAmount = parseDouble(account[5]); // Stores the withdrawn amount.
+        record.productID = static_cast<uint8_t>(parseCertificateProductID(account[6])); // Stores the product.
+    }
+    record.checksum = computeCRC32C(&record, offsetof(AccountRecord, checksum)); // Checksums the record.
+}
+
+// Gives a record a new account ID, marks a new version and recomputes its checksum.
+void renumberAccountRecord(AccountRecord& record, int32_t accountID)
+{
+    record.accountID = accountID; // Stores the new account ID.
+    record.sequence++; // Marks a new version of the record.
+    record.checksum = computeCRC32C(&record, offsetof(AccountRecord, checksum)); // Checksums the record.
+}
+
+// Rewrites the record from the account if its fields differ, then marks a new version of it.
+bool refreshAccountRecord(AccountRecord& record, const vector<string>& account)
+{
+    AccountRecord refreshedRecord = record; // Copies the record, keeping its sequence number.
+    fillAccountRecord(refreshedRecord, account); // Converts the account over it.
+    if (memcmp(&refreshedRecord, &record, sizeof(record)) == 0)
+        return false; // Returns false if the record already holds the account.
+    refreshedRecord.sequence++; // Marks a new version of the record.
+    refreshedRecord.checksum = computeCRC32C(&refreshedRecord, offsetof(AccountRecord, checksum)); // Checksums the record.
+    record = refreshedRecord; // Stores the new version.
+    return true;
+}
+
+// Converts a record back to an account vector.
+vector<string> convertAccountRecordToVector(const AccountRecord& record)
+{
+    vector<string> account; // Stores the resulting account vector.
+    account.reserve(ACCOUNT_FIELD_COUNT); // Allocates room for every field.
+    account.push_back(formatInteger(record.accountID)); // Adds the account ID.
+    account.push_back(formatInteger(record.nationalID)); // Adds the owner's national ID.
+    account.push_back(formatDouble(record.balance)); // Adds the balance.
+    account.push_back(convertRecordDateTimeToString(record)); // Adds the creation date-time.
+    if (record.accountType == CERTIFICATE_ACCOUNT_RECORD)
+    {
+        account.push_back(formatDouble(record.interestRatePercent)); // Adds the interest rate.
+        account.push_back(formatDouble(record.withdrawnAmount)); // Adds the withdrawn amount.
+        account.push_back(formatInteger(record.productID)); // Adds the product.
+    }
+    else
+    {
+        account.push_back(""); // Adds an empty string for interest rate (certificate-specific).
+        account.push_back(""); // Adds an empty string for withdrawn amount (certificate-specific).
+        account.push_back(""); // Adds an empty string for the product (certificate-specific).
+    }
+    return account; // Returns the account vector.
+}
+
+// Formats the creation date-time of a record.
+string convertRecordDateTimeToString(const AccountRecord& record)
+{
+    string dateTimeString; // Stores the creation date-time in the "Y-M-D-h-m-s" format of the CSV file.
+    for (int part = 0; part < 6; part++)
+    {
+        if (part > 0)
+            dateTimeString += '-'; // Separates the components.
+        appendInteger(dateTimeString, record.creationDateTime[part]); // Adds the component.
+    }
+    return dateTimeString; // Returns the creation date-time.
+}
+
+// Returns true if the checksum of the record matches its content.
+bool hasValidChecksum(const AccountRecord& record)
+{
+    return record.checksum == computeCRC32C(&record, offsetof(AccountRecord, checksum));
+}
@@ -0,0 +1,165 @@
+// This is the specification file for the AccountStore class,
+// the interface shared by the persistent stores that receive every account change.
+// The accounts vector stays the working copy; the store keeps the latest state of each account
+// on disk so a change can be persisted without rewriting the whole Accounts.csv file,
+// and serves the lookups of an account or of a person's accounts once the queued changes are written.
+
+// These are the include guards
+#pragma once
+#ifndef ACCOUNTSTORE_H
+#define ACCOUNTSTORE_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+using namespace std;
+
+/*
+	Holds one account as a fixed-size record, the on-disk unit of every account store.
+	Certificate fields are zero for saving accounts.
+*/
+struct AccountRecord
+{
+	uint64_t sequence;           // Incremented every time the record is rewritten
+	int64_t nationalID;          // National ID of the account owner
+	double balance;
+	double interestRatePercent;
+	double withdrawnAmount;
+	int32_t accountID;
+	int16_t creationDateTime[6]; // Year since 1900, month from 0, day, hour, minute, second
+	uint8_t accountType;         // SAVING_ACCOUNT_RECORD or CERTIFICATE_ACCOUNT_RECORD
+	uint8_t productID;           // CertificateProductID of a certificate; zero (Classic) in records written before products existed
+	uint8_t reserved[2];         // Unused, always zero
+	uint32_t checksum;           // CRC32C of all the record bytes before this field
+};
+
+// The record size is part of every store's file format, so it must not change with the compiler.
+static_assert(sizeof(AccountRecord) == 64, "The account record must be 64 bytes");
+
+// The values stored in the accountType field of a record.
+const uint8_t SAVING_ACCOUNT_RECORD = 0;
+const uint8_t CERTIFICATE_ACCOUNT_RECORD = 1;
+
+/*
+	Fills a record from an account vector and recomputes its checksum.
+	The sequence number of the record is kept.
+*/
+void fillAccountRecord(AccountRecord&, const vector<string>&);
+
+/*
+	Gives a record a new account ID, after the accounts before it were removed,
+	marking a new version of the record and recomputing its checksum.
+*/
+void renumberAccountRecord(AccountRecord&, int32_t);
+
+/*
+	Rewrites a record from the given account vector if any of its fields differ, such as its ID after a renumbering
+	or its balance after a transaction, marking a new version of the record.
+	Returns true if the record changed.
+*/
+bool refreshAccountRecord(AccountRecord&, const vector<string>&);
+
+// Converts a record back to an account vector in the format of the accounts vector.
+vector<string> convertAccountRecordToVector(const AccountRecord&);
+
+// Formats the creation date-time of a record in the "Y-M-D-h-m-s" format of the accounts vector.
+string convertRecordDateTimeToString(const AccountRecord&);
+
+// Returns true if the checksum of the record matches its content.
+bool hasValidChecksum(const AccountRecord&);
+
+/*
+	Holds the counters reported by a store.
+	Counters that do not apply to a store stay zero.
+*/
+struct StorageStatistics
+{
+	const char* backendName;    // Readable name of the store
+	long long pageHits;         // Page requests served from the buffer pool
+	long long pageMisses;       // Page requests that had to read the page from disk
+	long long pageEvictions;    // Pages removed from the buffer pool to make room for another one
+	long long pageWrites;       // Pages written back to disk
+	long long residentPages;    // Pages currently held in memory
+	long long sortedRuns;       // Sorted runs currently on disk
+	long long memtableRecords;  // Records held in memtables, not yet written to a run
+	long long compactions;      // Merges of sorted runs
+	long long pointReads;       // Lookups of a single account
+	long long bloomFilterSkips; // Sorted runs skipped during lookups because their bloom filter ruled the account out
+};
+
+class AccountStore
+{
+public:
+	// Virtual destructor, so a store can be deleted through this interface
+	virtual ~AccountStore() {}
+
+	/*
+		Opens the store file, creating an empty store if the file does not exist
+		or does not hold a valid store.
+		Throws an InvalidFileException if the file cannot be opened.
+	*/
+	virtual void open(const string&) = 0;
+
+	// Closes the store; it can be opened again later
+	virtual void close() = 0;
+
+	// Returns true if the store is open
+	virtual bool isOpen() const = 0;
+
+	// Returns the number of records stored
+	virtual size_t getRecordCount() const = 0;
+
+	/*
+		Replaces the whole store with the given account vectors.
+		Used when the store does not hold every account, or when the accounts were reordered.
+	*/
+	virtual void rebuild(const vector<vector<string>>&) = 0;
+
+	/*
+		Removes the records of the accounts that were at the given positions, sorted in increasing order,
+		and renumbers the records after them, since account IDs follow the account positions.
+		Every kept record is also rewritten from the given account vectors, from which those accounts were removed,
+		if it differs from them, so the changes made to the remaining accounts since they were last persisted are kept;
+		the store then matches the given account vectors.
+	*/
+	virtual void removeRecords(const vector<size_t>&, const vector<vector<string>>&) = 0;
+
+	// Rewrites the record of the account at the given index in place
+	virtual void updateRecord(size_t, const vector<string>&) = 0;
+
+	// Adds the record of a new account, whose ID must follow the last stored one
+	virtual void appendRecord(const vector<string>&) = 0;
+
+	/*
+		Copies the records of the store over the given account vectors and appends
+		the accounts that were created after the vectors were last saved.
+		Only records whose checksum is valid and whose account ID and national ID match the account
+		at the same position are applied. Returns the number of records applied,
+		or -1 if the store holds fewer records than the vector or a damaged record follows them
+		(the store must then be rebuilt from the vector).
+	*/
+	virtual long long applyTo(vector<vector<string>>&) = 0;
+
+	/*
+		Finds the record of the account with the given national ID and account ID.
+		Returns false if the account is not stored or its record is damaged.
+	*/
+	virtual bool findRecord(int64_t, int32_t, AccountRecord&) = 0;
+
+	/*
+		Adds the valid records of the accounts owned by the person with the given national ID
+		to the given vector, in account ID order.
+	*/
+	virtual void findRecordsOfPerson(int64_t, vector<AccountRecord>&) = 0;
+
+	/*
+		Forces every change written so far to the disk, so it survives a power failure as well as a crash.
+		Throws an InvalidFileException if the store cannot be synchronized.
+	*/
+	virtual void sync() = 0;
+
+	// Returns the counters of the store
+	virtual StorageStatistics getStatistics() const = 0;
+};
+
+#endif
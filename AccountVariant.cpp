@@ -0,0 +1,79 @@
+#include "AccountVariant.h"
+#include "Conversion-Functions.h"
+#include "Numeric-Functions.h"
+#include "DateTime-Functions.h"
+#include "Program-Data-Functions.h"
+
+using namespace std;
+
+// The account vector tells the two types apart by their interest fields only; a third type needs its own marker in the vector.
+static_assert(variant_size_v<AccountVariant> == 2, "Every account type must be distinguishable in the account vector");
+
+// Returns true if the interest rate field is empty.
+bool isSavingAccountVector(const vector<string>& accountVector)
+{
+    return accountVector[4].empty();
+}
+
+// Converts an account vector to a SavingAccount or CertificateAccount, reading the type once.
+AccountVariant convertAccountVectorToAccountVariant(const vector<string>& accountVector)
+{
+    if (isSavingAccountVector(accountVector))
+        return convertAccountVectorToSavingAccountObject(accountVector); // Builds a saving account.
+    return convertAccountVectorToCertificateAccountObject(accountVector); // Builds a certificate account.
+}
+
+// Converts an account back to an account vector with the converter of its type.
+vector<string> convertAccountVariantToAccountVector(const AccountVariant& account)
+{
+    return visit(AccountVisitor{
+        [](const SavingAccount& savingAccountObject) { return convertSavingAccountObjectToAccountVector(savingAccountObject); },
+        [](const CertificateAccount& certificateAccountObject) { return convertCertificateAccountObjectToAccountVector(certificateAccountObject); } }, account);
+}
+
+// Converts a range of account vectors to accounts stored in one contiguous vector.
+vector<AccountVariant> convertAccountVectorsToAccountVariants(const vector<vector<string>>& accountVectors, size_t first, size_t last)
+{
+    vector<AccountVariant> typedAccounts; // Stores the converted accounts.
+    typedAccounts.reserve(last - first); // Allocates the vector once.
+    for (size_t i = first; i < last; i++)
+        typedAccounts.push_back(convertAccountVectorToAccountVariant(accountVectors[i])); // Converts the account.
+    return typedAccounts; // Returns the accounts.
+}
+
+// Builds the display row of an account from its vector and its typed object, which must describe the same account.
+static vector<string> buildAccountTableRow(const vector<string>& accountVector, const AccountVariant& account, time_t asOf)
+{
+    vector<string> row; // Stores the resulting row.
+    row.reserve(accountVector.size() + 2); // Allocates the row once.
+    row.push_back(accountVector[0]); // Adds the account ID.
+    row.push_back(getAccountTypeName(account)); // Adds the account type.
+    row.push_back(visit(AccountVisitor{
+        [](const SavingAccount&) { return string(); },
+        [](const CertificateAccount& certificateAccountObject) { return string(getCertificateProduct(certificateAccountObject.getProductID()).name); } }, account)); // Adds the product name.
+    row.push_back(accountVector[1]); // Adds the owner's national ID.
+    row.push_back(accountVector[2]); // Adds the balance.
+    row.push_back(formatStoredDateTimeForDisplay(accountVector[3])); // Formats the creation date-time for display.
+    row.push_back(accountVector[4]); // Adds the interest rate.
+    row.push_back(accountVector[5]); // Adds the withdrawn amount.
+    row.push_back(visit(AccountVisitor{
+        [](const SavingAccount&) { return string(); },
+        [asOf](const CertificateAccount& certificateAccountObject) { return formatDouble(certificateAccountObject.getSavingBalanceAsOf(asOf)); } }, account)); // Adds the saving balance.
+    return row; // Returns the row.
+}
+
+// Converts an account vector to a display row, adding the type name, the product name and the saving balance of its type.
+// A certificate takes the accrual state cached for its position, so its returns are not recomputed.
+vector<string> convertAccountVectorToTableRow(const vector<string>& accountVector, size_t accountIndex, time_t asOf)
+{
+    AccountVariant account = convertAccountVectorToAccountVariant(accountVector); // Reads the account type once.
+    if (CertificateAccount* certificateAccountObject = get_if<CertificateAccount>(&account))
+        accrualCache.restore(accountIndex, *certificateAccountObject); // Reuses the cached creation time and returns.
+    return buildAccountTableRow(accountVector, account, asOf);
+}
+
+// Converts an account to a display row through its account vector; a certificate keeps the accrual state it carries.
+vector<string> convertAccountVariantToTableRow(const AccountVariant& account, time_t asOf)
+{
+    return buildAccountTableRow(convertAccountVariantToAccountVector(account), account, asOf);
+}
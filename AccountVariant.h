@@ -0,0 +1,108 @@
+// This is the specification file for the AccountVariant type,
+// a closed set of account value types dispatched at compile time.
+// An account is held by value as exactly one of its types, so accounts can be stored
+// back to back in a vector and processed without virtual calls,
+// and an operation that forgets to handle a type fails to compile.
+
+// These are the include guards
+#pragma once
+#ifndef ACCOUNTVARIANT_H
+#define ACCOUNTVARIANT_H
+
+#include <vector>
+#include <string>
+#include <variant>
+#include <type_traits>
+#include <ctime>
+#include "SavingAccount.h"
+#include "CertificateAccount.h"
+using namespace std;
+
+/*
+	Holds one account of any type by value.
+	Adding a type here requires an AccountTypeTraits specialization and a case in every visitor,
+	which the compiler enforces.
+*/
+using AccountVariant = variant<SavingAccount, CertificateAccount>;
+
+/*
+	Holds the compile-time description of each account type, such as the name displayed in the account tables.
+	There is no generic definition, so a type without a specialization is rejected at compile time.
+*/
+template <class AccountType>
+struct AccountTypeTraits;
+
+template <>
+struct AccountTypeTraits<SavingAccount>
+{
+	static constexpr const char* displayName = "Saving Account";
+};
+
+template <>
+struct AccountTypeTraits<CertificateAccount>
+{
+	static constexpr const char* displayName = "Certificate Account";
+};
+
+/*
+	Combines several lambdas into one visitor, so each account type gets its own case:
+	visit(AccountVisitor{ [](SavingAccount&) {...}, [](CertificateAccount&) {...} }, account)
+	A visitor missing a case for one of the types does not compile.
+*/
+template <class... Cases>
+struct AccountVisitor : Cases...
+{
+	using Cases::operator()...;
+};
+template <class... Cases>
+AccountVisitor(Cases...) -> AccountVisitor<Cases...>;
+
+/*
+	Returns true if the account vector holds a saving account.
+	Saving accounts leave the interest rate, withdrawn amount and product fields empty;
+	this is the only place that reads the type from the fields.
+*/
+bool isSavingAccountVector(const vector<string>&);
+
+// Converts an account vector to the account of the type its fields describe
+AccountVariant convertAccountVectorToAccountVariant(const vector<string>&);
+
+// Converts an account of any type back to an account vector
+vector<string> convertAccountVariantToAccountVector(const AccountVariant&);
+
+// Converts the account vectors in [first, last) of the given vector to accounts, stored back to back
+vector<AccountVariant> convertAccountVectorsToAccountVariants(const vector<vector<string>>&, size_t, size_t);
+
+/*
+	Converts an account vector to a row of the account tables:
+	{accountID, account type, product, nationalID, balance, formatted date, interest rate, withdrawn amount, saving balance}
+	The product and saving balance are empty for account types without them.
+	The position of the account in the accounts vector selects its cached accrual state,
+	and the saving balance is evaluated as of the given time.
+*/
+vector<string> convertAccountVectorToTableRow(const vector<string>&, size_t, time_t);
+
+// Converts an account to a row of the account tables, like convertAccountVectorToTableRow, using the accrual state the account carries
+vector<string> convertAccountVariantToTableRow(const AccountVariant&, time_t);
+
+// Returns the name of the account's type, as displayed in the account tables
+inline const char* getAccountTypeName(const AccountVariant& account)
+{
+	return visit([](const auto& typedAccount) { return AccountTypeTraits<decay_t<decltype(typedAccount)>>::displayName; }, account);
+}
+
+// Returns the account's balance, which every account type has
+inline double getAccountBalance(const AccountVariant& account)
+{
+	return visit([](const auto& typedAccount) { return typedAccount.getBalance(); }, account);
+}
+
+// Withdraws from the account, using the rules of its type; certificates check their saving balance at the given time
+inline void withdrawFromAccount(AccountVariant& account, double amount, time_t asOf)
+{
+	visit(AccountVisitor{
+		[amount](SavingAccount& savingAccountObject) { savingAccountObject.withdraw(amount); },
+		[amount, asOf](CertificateAccount& certificateAccountObject) { certificateAccountObject.withdraw(amount, asOf); } }, account);
+}
+
+#endif
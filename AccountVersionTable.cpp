@@ -0,0 +1,195 @@
+#include <thread>
+#include <algorithm>
+#include "AccountVersionTable.h"
+
+using namespace std;
+
+// Default constructor, the table starts with an empty numbering at epoch 0.
+AccountVersionTable::AccountVersionTable() : currentGeneration(new Generation(0, 0, nullptr)), publishedEpoch(0), built(false),
+    retiredVersionCount(0), reclaimedVersionCount(0)
+{
+    for (SnapshotSlot& slot : snapshotSlots)
+        slot.pinnedEpoch = FREE_SLOT; // No snapshot is open yet.
+}
+
+// Frees the replaced versions and numberings, then the newest version of every account.
+AccountVersionTable::~AccountVersionTable()
+{
+    for (RetiredEntry& entry : retiredEntries)
+    {
+        delete entry.version; // Frees the replaced version, if any.
+        delete entry.generation; // Frees the replaced numbering, without the versions it shares.
+    }
+    Generation* generation = currentGeneration.load(); // Gets the newest numbering.
+    for (atomic<AccountVersion*>& head : generation->heads)
+        delete head.load(); // Frees the newest version; the versions it replaced were retired.
+    delete generation; // Frees the numbering.
+}
+
+// Pins the latest published epoch and finds the numbering current at that epoch.
+AccountVersionTable::Snapshot::Snapshot(AccountVersionTable& table) : table(table), slotIndex(0), epoch(0), generation(nullptr)
+{
+    // Takes a free slot, pinning epoch 0 at first so nothing is freed while the real epoch is read.
+    while (true)
+    {
+        unsigned long long expected = FREE_SLOT; // Stores the value of a free slot.
+        if (table.snapshotSlots[slotIndex].pinnedEpoch.compare_exchange_strong(expected, 0))
+            break; // Takes the slot.
+        slotIndex = (slotIndex + 1) % ACCOUNT_SNAPSHOT_SLOT_COUNT; // Tries the next slot.
+        if (slotIndex == 0)
+            this_thread::yield(); // Lets a snapshot be released once every slot was tried.
+    }
+
+    // A writer freeing versions either saw the slot taken, or published before the epoch is read here,
+    // so every version reachable at the pinned epoch stays allocated.
+    epoch = table.publishedEpoch.load(); // Reads the latest published epoch.
+    table.snapshotSlots[slotIndex].pinnedEpoch.store(epoch); // Pins it.
+    const Generation* candidate = table.currentGeneration.load(memory_order_acquire); // Gets the newest numbering.
+    while (candidate->epoch > epoch)
+        candidate = candidate->older.load(memory_order_acquire); // Skips the numberings published after the pinned epoch.
+    generation = candidate; // Keeps the numbering of the pinned epoch.
+}
+
+// Releases the slot.
+AccountVersionTable::Snapshot::~Snapshot()
+{
+    table.snapshotSlots[slotIndex].pinnedEpoch.store(FREE_SLOT); // Stops pinning the epoch.
+}
+
+// Follows the account's chain from its newest version back to the newest one published by the pinned epoch.
+AccountVariant AccountVersionTable::Snapshot::getAccount(size_t accountIndex) const
+{
+    const AccountVersion* version = generation->heads[accountIndex].load(memory_order_acquire); // Gets the newest version.
+    while (version->epoch > epoch)
+        version = version->older.load(memory_order_acquire); // Skips the versions published after the pinned epoch.
+    return version->account; // Copies the account, so the caller can advance a certificate's returns on its own copy.
+}
+
+// Publishes every account as new versions of a new numbering.
+void AccountVersionTable::publishAll(vector<AccountVariant>&& accounts)
+{
+    lock_guard<mutex> lock(writerMutex); // Locks out the other writers.
+    unsigned long long epoch = publishedEpoch.load() + 1; // Stores the epoch of the change.
+    Generation* generation = new Generation(accounts.size(), epoch, currentGeneration.load()); // Creates the numbering.
+    for (size_t i = 0; i < accounts.size(); i++)
+        generation->heads[i].store(new AccountVersion(move(accounts[i]), epoch, nullptr), memory_order_relaxed); // Adds the account's first version.
+    installGeneration(generation, epoch, true); // Replaces every account.
+    built = true; // Lets the other changes be published.
+    finishPublish(epoch); // Makes the numbering visible.
+}
+
+// Publishes a new version of each changed account, all at one epoch.
+void AccountVersionTable::publishChanges(vector<pair<size_t, AccountVariant>>&& changes)
+{
+    lock_guard<mutex> lock(writerMutex); // Locks out the other writers.
+    if (!built || changes.empty())
+        return; // Nothing is published before the table is built.
+    unsigned long long epoch = publishedEpoch.load() + 1; // Stores the epoch of the change.
+    Generation* generation = currentGeneration.load(); // Gets the numbering, which only writers replace.
+    for (pair<size_t, AccountVariant>& change : changes)
+    {
+        AccountVersion* replaced = generation->heads[change.first].load(); // Gets the version being replaced.
+        AccountVersion* version = new AccountVersion(move(change.second), epoch, replaced); // Links the new version to it.
+        generation->heads[change.first].store(version, memory_order_release); // Makes the new version the newest one.
+        retiredEntries.push_back({ epoch, replaced, version, nullptr, nullptr }); // Frees the replaced version once no snapshot can reach it.
+        retiredVersionCount++; // Counts the replaced version.
+    }
+    finishPublish(epoch); // Makes the versions visible.
+}
+
+// Publishes a numbering with one more account, sharing the versions of the others.
+void AccountVersionTable::publishAppended(AccountVariant&& account)
+{
+    lock_guard<mutex> lock(writerMutex); // Locks out the other writers.
+    if (!built)
+        return; // Nothing is published before the table is built.
+    unsigned long long epoch = publishedEpoch.load() + 1; // Stores the epoch of the change.
+    Generation* replaced = currentGeneration.load(); // Gets the numbering being replaced.
+    Generation* generation = new Generation(replaced->heads.size() + 1, epoch, replaced); // Creates the numbering.
+    for (size_t i = 0; i < replaced->heads.size(); i++)
+        generation->heads[i].store(replaced->heads[i].load(), memory_order_relaxed); // Shares the newest version of the account.
+    generation->heads.back().store(new AccountVersion(move(account), epoch, nullptr), memory_order_relaxed); // Adds the new account's first version.
+    installGeneration(generation, epoch, false); // Keeps the shared versions.
+    finishPublish(epoch); // Makes the numbering visible.
+}
+
+// Publishes an empty numbering, dropping every account.
+void AccountVersionTable::clear()
+{
+    lock_guard<mutex> lock(writerMutex); // Locks out the other writers.
+    unsigned long long epoch = publishedEpoch.load() + 1; // Stores the epoch of the change.
+    installGeneration(new Generation(0, epoch, currentGeneration.load()), epoch, true); // Replaces every account.
+    built = false; // Waits for the accounts to be published again.
+    finishPublish(epoch); // Makes the numbering visible.
+}
+
+// Makes the given numbering the newest one and retires the replaced one, with its versions if they are not shared.
+void AccountVersionTable::installGeneration(Generation* generation, unsigned long long epoch, bool retireVersions)
+{
+    Generation* replaced = currentGeneration.load(); // Gets the numbering being replaced.
+    if (retireVersions)
+    {
+        for (atomic<AccountVersion*>& head : replaced->heads)
+        {
+            retiredEntries.push_back({ epoch, head.load(), nullptr, nullptr, nullptr }); // Frees the version with its numbering; the older ones are already retired.
+            retiredVersionCount++; // Counts the replaced version.
+        }
+    }
+    currentGeneration.store(generation, memory_order_release); // Makes the numbering the newest one.
+    retiredEntries.push_back({ epoch, nullptr, nullptr, replaced, generation }); // Frees the replaced numbering after its versions.
+}
+
+// Publishes the epoch, then frees the retired entries in epoch order while no open snapshot is pinned before them.
+void AccountVersionTable::finishPublish(unsigned long long epoch)
+{
+    publishedEpoch.store(epoch); // Lets new snapshots see the change.
+    unsigned long long oldestPinnedEpoch = getOldestPinnedEpoch(); // Reads the pins after the publication, matching the snapshot constructor.
+    while (!retiredEntries.empty() && retiredEntries.front().epoch <= oldestPinnedEpoch)
+    {
+        RetiredEntry& entry = retiredEntries.front(); // Gets the oldest entry.
+        if (entry.version)
+        {
+            if (entry.newerVersion)
+                entry.newerVersion->older.store(nullptr, memory_order_relaxed); // Unlinks it; no snapshot follows the chain past the newer version.
+            delete entry.version; // Frees the version.
+            retiredVersionCount--; // Counts it as reclaimed.
+            reclaimedVersionCount++;
+        }
+        if (entry.generation)
+        {
+            entry.newerGeneration->older.store(nullptr, memory_order_relaxed); // Unlinks it; no snapshot looks past the newer numbering.
+            delete entry.generation; // Frees the numbering, without the versions it shares.
+        }
+        retiredEntries.pop_front(); // Drops the entry.
+    }
+}
+
+// Reads every slot and returns the oldest pinned epoch.
+unsigned long long AccountVersionTable::getOldestPinnedEpoch() const
+{
+    unsigned long long oldestPinnedEpoch = FREE_SLOT; // Stores the oldest epoch found.
+    for (const SnapshotSlot& slot : snapshotSlots)
+        oldestPinnedEpoch = min(oldestPinnedEpoch, slot.pinnedEpoch.load()); // Keeps the older epoch.
+    return oldestPinnedEpoch;
+}
+
+// Returns whether the accounts are published.
+bool AccountVersionTable::isBuilt()
+{
+    lock_guard<mutex> lock(writerMutex); // Locks out the writers.
+    return built;
+}
+
+// Returns the number of replaced versions not freed yet.
+long long AccountVersionTable::getRetiredVersionCount()
+{
+    lock_guard<mutex> lock(writerMutex); // Locks out the writers.
+    return retiredVersionCount;
+}
+
+// Returns the number of replaced versions freed.
+long long AccountVersionTable::getReclaimedVersionCount()
+{
+    lock_guard<mutex> lock(writerMutex); // Locks out the writers.
+    return reclaimedVersionCount;
+}
@@ -0,0 +1,169 @@
+// This is the specification file for the AccountVersionTable class,
+// which keeps every account as a chain of immutable versions so long scans read a consistent snapshot
+// while writers go on. A change never overwrites an account: it publishes a new version at a new epoch.
+// A reader pins the epoch it started at and follows each account's chain back to the newest version
+// published by then, so it takes no lock and never sees half of a change.
+// Versions are reclaimed by the writers once no pinned epoch can reach them, so writers never wait for readers.
+
+// These are the include guards
+#pragma once
+#ifndef ACCOUNTVERSIONTABLE_H
+#define ACCOUNTVERSIONTABLE_H
+
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <utility>
+#include "AccountVariant.h"
+#include "Constants.h"
+using namespace std;
+
+class AccountVersionTable
+{
+private:
+	// Holds one version of an account, never changed once published
+	struct AccountVersion
+	{
+		AccountVariant account;            // Holds the account, with the accrual state of a certificate if it was prepared
+		unsigned long long epoch;          // The epoch the version was published at
+		atomic<AccountVersion*> older;     // The version it replaced, kept while a pinned epoch may need it
+
+		// Constructor that creates a version replacing the given one
+		AccountVersion(AccountVariant&& account, unsigned long long epoch, AccountVersion* older) : account(move(account)), epoch(epoch), older(older)
+		{
+		}
+	};
+
+	// Holds the newest version of every account for one numbering of the accounts; adding or removing accounts publishes a new one
+	struct Generation
+	{
+		vector<atomic<AccountVersion*>> heads; // Holds the newest version of the account at each position
+		unsigned long long epoch;              // The epoch the numbering was published at
+		atomic<Generation*> older;             // The numbering it replaced, kept while a pinned epoch may need it
+
+		// Constructor that creates a numbering of the given number of accounts, replacing the given one
+		Generation(size_t accountCount, unsigned long long epoch, Generation* older) : heads(accountCount), epoch(epoch), older(older)
+		{
+		}
+	};
+
+	/*
+		Holds a version or numbering replaced at the given epoch. It is freed once every pinned epoch has reached that epoch,
+		since a reader pinned there stops at its replacement; the replacement's link to it is cleared first.
+	*/
+	struct RetiredEntry
+	{
+		unsigned long long epoch;          // The epoch of the replacement
+		AccountVersion* version;           // The replaced version, or null
+		AccountVersion* newerVersion;      // The version linking to it, or null if it was dropped with its numbering
+		Generation* generation;            // The replaced numbering, or null
+		Generation* newerGeneration;       // The numbering linking to it
+	};
+
+	// Holds the epoch pinned by one open snapshot, on a cache line of its own
+	struct alignas(64) SnapshotSlot
+	{
+		atomic<unsigned long long> pinnedEpoch; // The snapshot's epoch, or FREE_SLOT when no snapshot uses the slot
+	};
+
+	static const unsigned long long FREE_SLOT = ~0ull; // Marks a slot that pins nothing
+
+	atomic<Generation*> currentGeneration;                     // Holds the newest numbering
+	atomic<unsigned long long> publishedEpoch;                 // Holds the epoch of the last published change
+	SnapshotSlot snapshotSlots[ACCOUNT_SNAPSHOT_SLOT_COUNT];   // Holds the epochs pinned by the open snapshots
+	mutex writerMutex;                                         // Serializes the writers; readers never take it
+	deque<RetiredEntry> retiredEntries;                        // Holds the replaced versions and numberings in epoch order, guarded by writerMutex
+	bool built;                                                // Set once the accounts are published, guarded by writerMutex
+	long long retiredVersionCount;                             // Counts the replaced versions not freed yet, guarded by writerMutex
+	long long reclaimedVersionCount;                           // Counts the replaced versions freed, guarded by writerMutex
+
+	// Replaces the newest numbering with the given one, published at the given epoch, and retires the old one
+	void installGeneration(Generation*, unsigned long long, bool);
+
+	// Makes the given epoch visible to new snapshots, then frees what no pinned epoch can reach; called with writerMutex held
+	void finishPublish(unsigned long long);
+
+	// Returns the oldest epoch pinned by an open snapshot, or FREE_SLOT if none is open
+	unsigned long long getOldestPinnedEpoch() const;
+
+public:
+	/*
+		Holds a consistent view of the accounts as of the epoch it pinned when it was taken.
+		Can be read from several threads at once while writers publish changes, and releases its slot when destroyed.
+		The table must outlive it.
+	*/
+	class Snapshot
+	{
+	private:
+		AccountVersionTable& table;       // Holds the table the snapshot reads
+		size_t slotIndex;                 // Holds the index of the slot pinning the epoch
+		unsigned long long epoch;         // Holds the pinned epoch
+		const Generation* generation;     // Holds the numbering current at that epoch
+
+	public:
+		// Constructor that pins the latest published epoch, waiting if every slot is taken
+		explicit Snapshot(AccountVersionTable&);
+
+		// Destructor that releases the slot, letting the writers free the versions only this snapshot needed
+		~Snapshot();
+
+		// A snapshot owns its slot, so it can be neither copied nor moved
+		Snapshot(const Snapshot&) = delete;
+		Snapshot& operator=(const Snapshot&) = delete;
+
+		// Returns a copy of the account at the given position as of the pinned epoch
+		AccountVariant getAccount(size_t) const;
+
+		// Inline getter for the number of accounts as of the pinned epoch
+		size_t size() const
+		{
+			return generation->heads.size();
+		}
+
+		// Inline getter for the pinned epoch
+		unsigned long long getEpoch() const
+		{
+			return epoch;
+		}
+	};
+
+	// Default constructor, the table starts empty and not built
+	AccountVersionTable();
+
+	// Destructor that frees every version; no snapshot may be open
+	~AccountVersionTable();
+
+	// The table is shared by reference with its snapshots, so it can be neither copied nor moved
+	AccountVersionTable(const AccountVersionTable&) = delete;
+	AccountVersionTable& operator=(const AccountVersionTable&) = delete;
+
+	// Publishes the given accounts as a new numbering, replacing every account, and marks the table built
+	void publishAll(vector<AccountVariant>&&);
+
+	// Publishes new versions of the accounts at the given positions, all at the same epoch, so no snapshot sees only some of them
+	void publishChanges(vector<pair<size_t, AccountVariant>>&&);
+
+	// Publishes an account added at the end, as a new numbering sharing the versions of the others
+	void publishAppended(AccountVariant&&);
+
+	// Publishes an empty numbering and marks the table not built, for when the accounts are reloaded
+	void clear();
+
+	// Returns true once the accounts are published; only writers call it
+	bool isBuilt();
+
+	// Inline getter for the epoch of the last published change
+	unsigned long long getPublishedEpoch() const
+	{
+		return publishedEpoch.load();
+	}
+
+	// Returns the number of replaced versions kept for the open snapshots
+	long long getRetiredVersionCount();
+
+	// Returns the number of replaced versions freed since the table was created
+	long long getReclaimedVersionCount();
+};
+
+#endif
@@ -0,0 +1,127 @@
+#include <limits>
+#include <algorithm>
+#include "AccrualCache.h"
+#include "AccountVariant.h"
+#include "WorkStealingPool.h"
+#include "Conversion-Functions.h"
+#include "Numeric-Functions.h"
+#include "Constants.h"
+
+using namespace std;
+
+// Default constructor, the first sweep prepares every state.
+AccrualCache::AccrualCache() : nextBoundary(numeric_limits<time_t>::min()), sweepCount(0), advancedCount(0)
+{
+}
+
+// Drops every state and makes the next sweep prepare them all again.
+void AccrualCache::clear()
+{
+    states.clear(); // Drops the states.
+    prepared.clear(); // Drops the prepared flags.
+    pendingPositions.clear(); // Drops the changed positions, which the full sweep covers.
+    nextBoundary = numeric_limits<time_t>::min(); // Makes the next sweep visit every account.
+}
+
+// Drops the state of one account and queues its position for the next sweep.
+void AccrualCache::invalidate(size_t position)
+{
+    if (position < prepared.size())
+        prepared[position] = 0; // Stops readers from taking the old state.
+    pendingPositions.push_back(position); // Prepares the new state at the next sweep.
+}
+
+// Prepares the states of the new certificates of the range and advances the expired ones,
+// counting them and returning the earliest window end of the range.
+time_t AccrualCache::advanceRange(const vector<vector<string>>& accountVectors, size_t first, size_t last, time_t now, long long& advanced)
+{
+    time_t earliestBoundary = numeric_limits<time_t>::max(); // Stores the earliest window end of the range.
+    for (size_t i = first; i < last; i++)
+    {
+        const vector<string>& accountVector = accountVectors[i]; // Gets the account without copying it.
+        if (isSavingAccountVector(accountVector))
+        {
+            prepared[i] = 0; // Saving accounts do not accrue.
+            continue;
+        }
+        if (!prepared[i])
+        {
+            CertificateAccount certificateAccountObject = convertAccountVectorToCertificateAccountObject(accountVector); // Builds the account once.
+            certificateAccountObject.getTotalReturnsAsOf(now); // Parses the creation date-time and computes the returns.
+            states[i] = certificateAccountObject.getAccrualState(); // Keeps the prepared state.
+            prepared[i] = 1; // Lets readers take it.
+            advanced++; // Counts the prepared state.
+        }
+        else if (now < states[i].accruedFrom || now >= states[i].accruedUntil)
+        {
+            getAccruedReturns(states[i], parseDouble(accountVector[2]), now); // Moves the cached returns to the current window.
+            advanced++; // Counts the advanced state.
+        }
+        earliestBoundary = min(earliestBoundary, states[i].accruedUntil); // Tracks when the next state expires.
+    }
+    return earliestBoundary; // Returns the earliest window end.
+}
+
+// Sweeps only the changed positions while no window has ended; otherwise visits every account,
+// on a work-stealing pool when there is more than one partition.
+size_t AccrualCache::sweep(const vector<vector<string>>& accountVectors, time_t now)
+{
+    if (!isSweepDue(now))
+        return 0; // Nothing expired or changed.
+    states.resize(accountVectors.size()); // Makes room for the accounts added since the last sweep.
+    prepared.resize(accountVectors.size(), 0); // Marks the added positions as not prepared.
+    long long advanced = 0; // Counts the states prepared or advanced.
+
+    if (now < nextBoundary)
+    {
+        for (size_t position : pendingPositions)
+        {
+            if (position < accountVectors.size())
+                nextBoundary = min(nextBoundary, advanceRange(accountVectors, position, position + 1, now, advanced)); // Prepares the changed account.
+        }
+    }
+    else if (accountVectors.size() <= static_cast<size_t>(REPORT_PARTITION_SIZE))
+    {
+        nextBoundary = advanceRange(accountVectors, 0, accountVectors.size(), now, advanced); // Visits every account on this thread.
+    }
+    else
+    {
+        size_t partitionCount = (accountVectors.size() + REPORT_PARTITION_SIZE - 1) / REPORT_PARTITION_SIZE; // Counts the partitions.
+        vector<time_t> partitionBoundaries(partitionCount); // Stores the earliest window end of each partition.
+        vector<long long> partitionCounts(partitionCount, 0); // Stores the number of states each partition advanced.
+        {
+            WorkStealingPool pool; // Starts one worker per hardware thread.
+            for (size_t partition = 0; partition < partitionCount; partition++)
+            {
+                size_t first = partition * REPORT_PARTITION_SIZE; // Stores the start of the partition.
+                size_t last = min(accountVectors.size(), first + REPORT_PARTITION_SIZE); // Stores the end of the partition.
+                pool.submit([this, &accountVectors, first, last, now, partition, &partitionBoundaries, &partitionCounts](int)
+                    {
+                        partitionBoundaries[partition] = advanceRange(accountVectors, first, last, now, partitionCounts[partition]); // Advances the partition; partitions never share a position.
+                    });
+            }
+            pool.waitAll(); // Waits for every partition.
+        }
+        nextBoundary = numeric_limits<time_t>::max(); // Merges the partition results.
+        for (size_t partition = 0; partition < partitionCount; partition++)
+        {
+            nextBoundary = min(nextBoundary, partitionBoundaries[partition]); // Keeps the earliest window end.
+            advanced += partitionCounts[partition]; // Adds the partition's count.
+        }
+    }
+
+    pendingPositions.clear(); // Every changed position has been prepared.
+    if (advanced > 0)
+    {
+        sweepCount++; // Counts the sweep.
+        advancedCount += advanced; // Counts the states.
+    }
+    return static_cast<size_t>(advanced); // Returns the number of states prepared or advanced.
+}
+
+// Copies the kept state into the account if the position has one.
+void AccrualCache::restore(size_t position, CertificateAccount& certificateAccountObject) const
+{
+    if (position < prepared.size() && prepared[position])
+        certificateAccountObject.restoreAccrualState(states[position]); // Reuses the parsed creation time and the cached returns.
+}
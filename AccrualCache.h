@@ -0,0 +1,76 @@
+// This is the specification file for the AccrualCache class,
+// which keeps the accrual state of every certificate account between operations.
+// Account objects are rebuilt from the accounts vector for every operation, so without it each listing,
+// report or withdrawal would parse every creation date-time again and recompute returns that only change
+// at accrual boundaries. A sweep advances the states whose boundary has passed, in bulk,
+// so the readers find returns that are already up to date.
+
+// These are the include guards
+#pragma once
+#ifndef ACCRUALCACHE_H
+#define ACCRUALCACHE_H
+
+#include <vector>
+#include <string>
+#include <ctime>
+#include <cstdint>
+#include "CertificateAccount.h"
+using namespace std;
+
+class AccrualCache
+{
+private:
+	vector<CertificateAccrualState> states; // Holds the state of the certificate at each position of the accounts vector
+	vector<uint8_t> prepared;               // Holds 1 at the positions whose state is prepared for the account there
+	vector<size_t> pendingPositions;        // Holds the positions changed since the last sweep
+	time_t nextBoundary;                    // Holds the earliest end of a cached accrual window; no state expires before it
+	long long sweepCount;                   // Counts the sweeps that did any work
+	long long advancedCount;                // Counts the states prepared or advanced by the sweeps
+
+	// Prepares or advances the states of the certificates in [first, last) as of the given time, returning the earliest window end
+	time_t advanceRange(const vector<vector<string>>&, size_t, size_t, time_t, long long&);
+
+public:
+	// Default constructor, the cache starts empty
+	AccrualCache();
+
+	// Drops every state, for when the accounts are renumbered or reloaded
+	void clear();
+
+	// Drops the state of the account at the given position, which was added or changed
+	void invalidate(size_t);
+
+	// Returns true if a state expired or an account changed since the last sweep
+	bool isSweepDue(time_t now) const
+	{
+		return now >= nextBoundary || !pendingPositions.empty();
+	}
+
+	/*
+		Prepares the states of the new and changed certificates and advances the states whose window ended,
+		as of the given time. Splits the accounts vector into partitions of REPORT_PARTITION_SIZE accounts
+		on a work-stealing pool when every state must be prepared, such as after a load.
+		Returns the number of states prepared or advanced.
+	*/
+	size_t sweep(const vector<vector<string>>&, time_t);
+
+	/*
+		Gives the certificate at the given position the state kept for it, if any.
+		Only reads the cache, so partitions of the accounts vector can call it from several threads.
+	*/
+	void restore(size_t, CertificateAccount&) const;
+
+	// Returns the number of sweeps that did any work
+	long long getSweepCount() const
+	{
+		return sweepCount;
+	}
+
+	// Returns the number of states prepared or advanced by the sweeps
+	long long getAdvancedCount() const
+	{
+		return advancedCount;
+	}
+};
+
+#endif
@@ -3,6 +3,10 @@
 #include "BankAccount.h"
 #include "Exceptions.h"
 #include "Constants.h"
+#include "Numeric-Functions.h"
+#include "Program-Data-Functions.h"
+#include "Clock.h"
+#include "DateTime-Functions.h"
 
 // Constructor to initialize a BankAccount with a Person object and balance.
 // Throws an InsufficientBalanceException if the balance is below the minimum.
@@ -15,11 +19,11 @@ BankAccount::BankAccount(const Person& personArgument, double balanceArgument)
 }
 
 // Default constructor to initialize a BankAccount with default values.
-// Uses a default Person object and minimum balance.
+// Has no owner and the minimum balance.
 BankAccount::BankAccount()
 {
     setCreationDateTime(); // Sets the account creation date and time.
-    setPerson(Person()); // Initializes with a default Person object.
+    setOwnerNationalID(0); // Initializes without an owner.
     setBalance(MIN_BALANCE); // Sets the balance to the minimum allowed value.
     setAccountID(0); // Initializes the account ID to 0.
 }
@@ -44,34 +48,43 @@ void BankAccount::setAccountID(int accountIDArgument)
     accountID = accountIDArgument; // Assigns the provided account ID.
 }
 
-// Sets the Person object associated with the account.
+// Sets the owner of the account to the given Person object.
+// Only the national ID is kept; the Person object is looked up again when needed.
 void BankAccount::setPerson(const Person& personArgument)
 {
-    person = personArgument; // Assigns the provided Person object to the account.
+    ownerNationalID = personArgument.getNationalID(); // Keeps the national ID of the owner.
 }
 
-// Sets the creation date and time of the account using the current system time.
+// Sets the owner of the account by national ID.
+void BankAccount::setOwnerNationalID(long long int nationalIDArgument)
+{
+    ownerNationalID = nationalIDArgument; // Assigns the provided national ID to the account.
+}
+
+// Looks the owner up in the persons vector by national ID.
+Person BankAccount::getPerson() const
+{
+    return searchPerson(ownerNationalID); // Returns the owner, or a default Person if the owner is not registered.
+}
+
+// Sets the creation date and time of the account to the time of the current operation, read once from the program clock.
 // Formats the timestamp as a string in the format "year-month-day-hour-minute-second".
+// Uses the date-time functions, which share no buffers, so accounts can be constructed from several threads at once.
 void BankAccount::setCreationDateTime()
 {
-    time_t timestamp = time(NULL); // Gets the current timestamp.
-    struct tm datetime = *localtime(&timestamp); // Converts the timestamp to a local time structure.
+    setCreationDateTime(getOperationTime()); // Formats the operation's timestamp.
+}
+
+// Sets the creation date and time of the account to the given timestamp, such as the maturity of a renewed certificate.
+void BankAccount::setCreationDateTime(time_t timestamp)
+{
     dateTimeField = ""; // Initializes the date-time string.
-    dateTimeField.append(to_string(datetime.tm_year)); // Appends the year.
-    dateTimeField.push_back('-'); // Adds a separator.
-    dateTimeField.append(to_string(datetime.tm_mon)); // Appends the month.
-    dateTimeField.push_back('-'); // Adds a separator.
-    dateTimeField.append(to_string(datetime.tm_mday)); // Appends the day.
-    dateTimeField.push_back('-'); // Adds a separator.
-    dateTimeField.append(to_string(datetime.tm_hour)); // Appends the hour.
-    dateTimeField.push_back('-'); // Adds a separator.
-    dateTimeField.append(to_string(datetime.tm_min)); // Appends the minute.
-    dateTimeField.push_back('-'); // Adds a separator.
-    dateTimeField.append(to_string(datetime.tm_sec)); // Appends the second.
+    appendStoredDateTime(dateTimeField, convertTimeToLocalDateTime(timestamp)); // Converts the timestamp to local time and appends its components.
 }
 
 // Sets the creation date and time of the account using a provided string in the format "year-month-day-hour-minute-second".
+// The string is taken by value and moved in, so a temporary argument is never copied.
 void BankAccount::setTimeDate(string timeDate)
 {
-    dateTimeField = timeDate; // Assigns the provided date-time string to the account.
+    dateTimeField = move(timeDate); // Assigns the provided date-time string to the account.
 }
\ No newline at end of file
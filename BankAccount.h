@@ -1,4 +1,7 @@
-// This is the specification file for the BankAccount class (Abstract Class)
+// This is the specification file for the BankAccount class,
+// the base holding the fields every account type shares.
+// It has no virtual functions: each account type defines its own withdraw,
+// and accounts of any type are dispatched at compile time through AccountVariant.
 
 // These are the include guards
 #pragma once
@@ -6,27 +9,30 @@
 #define BANKACCOUNT_H
 
 #include <string>
+#include <ctime>
 #include "Person.h"
 using namespace std;
 
 class BankAccount
 {
 private:
-	Person person;          // Holds the associated Person object
+	long long int ownerNationalID; // Holds the national ID of the owner, which identifies its Person object in the persons vector
 	double balance;         // Holds the account balance
 	int accountID;          // Holds the unique ID of the account
 	string dateTimeField;   // Holds the formatted date string [(Years since 1900)-(Months starting from 0)-(Days starting from 1)-(Hours starting from 0)-(Minutes starting from 0)-(Seconds starting from 0)]
 
 protected:
 	void setAccountID(int);         // Sets the account ID
-	void setCreationDateTime();     // Sets the current local date in formatted form to dateTimeField
-	void setTimeDate(string);       // Sets a specific formatted date string to dateTimeField
+	void setCreationDateTime();     // Sets the local date of the current operation in formatted form to dateTimeField
+	void setCreationDateTime(time_t); // Sets the local date of the given timestamp in formatted form to dateTimeField
+	void setTimeDate(string);       // Sets a specific formatted date string to dateTimeField, taking it over without a copy
 
 public:
 	BankAccount();                                  // Default constructor
 	BankAccount(const Person&, double);             // Parameterized constructor
 	void setBalance(double);                        // Sets the balance (with validation)
-	void setPerson(const Person&);                  // Sets the Person object
+	void setPerson(const Person&);                  // Sets the owner to the given Person object
+	void setOwnerNationalID(long long int);         // Sets the owner by national ID, without looking the person up
 
 	// Inline getter for balance
 	double getBalance() const
@@ -40,21 +46,20 @@ public:
 		return accountID;
 	}
 
-	// Inline getter for the Person object
-	Person getPerson() const
+	// Inline getter for the national ID of the owner
+	long long int getOwnerNationalID() const
 	{
-		return person;
+		return ownerNationalID;
 	}
 
-	// Inline getter for the formatted date/time string
-	string getDateTime() const
+	// Looks the owner up in the persons vector; returns a default Person if the owner is not registered
+	Person getPerson() const;
+
+	// Inline getter for the formatted date/time string, returned without a copy
+	const string& getDateTime() const
 	{
 		return dateTimeField;
 	}
-
-	// Pure virtual function for withdrawing money, 
-	// behavior will differ depending on the specific type of account
-	virtual void withdraw(double) = 0;
 };
 
 #endif
@@ -0,0 +1,395 @@
+#include <cstring>
+#include <algorithm>
+#include "BatchFileWriter.h"
+#include "File-Functions.h"
+#include "Exceptions.h"
+#include "Constants.h"
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define BANK_HAS_IO_URING
+#include <atomic>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#endif
+#endif
+#endif
+
+using namespace std;
+
+#ifdef BANK_HAS_IO_URING
+// Marks the completion of the fdatasync that ends a batch; write completions carry their pending write index.
+static const uint64_t SYNC_USER_DATA = ~0ULL;
+
+// Holds an io_uring instance set up with the raw system calls, so no extra library is needed.
+struct IoRing
+{
+    int ringDescriptor = -1;             // The file descriptor of the ring
+    void* submissionRingMemory = nullptr; // The mapped submission ring
+    size_t submissionRingSize = 0;       // The size of the mapped submission ring
+    void* completionRingMemory = nullptr; // The mapped completion ring, which may share the submission ring mapping
+    size_t completionRingSize = 0;       // The size of the mapped completion ring
+    io_uring_sqe* submissionEntries = nullptr; // The mapped submission entries
+    size_t submissionEntriesSize = 0;    // The size of the mapped submission entries
+    unsigned* submissionTail = nullptr;  // The tail of the submission ring, advanced by this program
+    unsigned submissionMask = 0;         // The mask wrapping submission ring positions
+    unsigned* submissionArray = nullptr; // The ring of indexes into the submission entries
+    unsigned* completionHead = nullptr;  // The head of the completion ring, advanced by this program
+    unsigned* completionTail = nullptr;  // The tail of the completion ring, advanced by the kernel
+    unsigned completionMask = 0;         // The mask wrapping completion ring positions
+    io_uring_cqe* completionEntries = nullptr; // The completion entries
+    bool buffersRegistered = false;      // Whether the buffers are registered, allowing fixed-buffer writes
+
+    ~IoRing()
+    {
+        if (submissionEntries != nullptr)
+            munmap(submissionEntries, submissionEntriesSize); // Unmaps the submission entries.
+        if (completionRingMemory != nullptr && completionRingMemory != submissionRingMemory)
+            munmap(completionRingMemory, completionRingSize); // Unmaps the completion ring if it has its own mapping.
+        if (submissionRingMemory != nullptr)
+            munmap(submissionRingMemory, submissionRingSize); // Unmaps the submission ring.
+        if (ringDescriptor >= 0)
+            ::close(ringDescriptor); // Closes the ring, which also unregisters the buffers.
+    }
+};
+
+// Sets up a ring with room for the given number of entries and registers the buffers; returns nullptr if io_uring is unavailable.
+static unique_ptr<IoRing> createIoRing(unsigned entryCount, char* bufferMemory, size_t bufferSize, size_t bufferCount)
+{
+    io_uring_params parameters; // Stores the ring parameters filled in by the kernel.
+    memset(&parameters, 0, sizeof(parameters)); // Asks for the default behavior.
+    int ringDescriptor = static_cast<int>(syscall(__NR_io_uring_setup, entryCount, &parameters)); // Creates the ring.
+    if (ringDescriptor < 0)
+        return nullptr; // Returns nullptr if the kernel does not provide io_uring or forbids it.
+    unique_ptr<IoRing> ring(new IoRing()); // Stores the ring; its destructor cleans up if a later step fails.
+    ring->ringDescriptor = ringDescriptor; // Keeps the descriptor.
+
+    // Maps the submission and completion rings, which share one mapping on kernels that support it.
+    ring->submissionRingSize = parameters.sq_off.array + parameters.sq_entries * sizeof(unsigned); // Calculates the submission ring size.
+    ring->completionRingSize = parameters.cq_off.cqes + parameters.cq_entries * sizeof(io_uring_cqe); // Calculates the completion ring size.
+    bool singleMapping = (parameters.features & IORING_FEAT_SINGLE_MMAP) != 0; // Checks whether one mapping holds both rings.
+    if (singleMapping)
+        ring->submissionRingSize = ring->completionRingSize = max(ring->submissionRingSize, ring->completionRingSize); // Maps the larger size once.
+    void* submissionRing = mmap(nullptr, ring->submissionRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringDescriptor, IORING_OFF_SQ_RING); // Maps the submission ring.
+    if (submissionRing == MAP_FAILED)
+        return nullptr; // Returns nullptr if the ring cannot be mapped.
+    ring->submissionRingMemory = submissionRing; // Keeps the mapping.
+    void* completionRing = submissionRing; // Uses the same mapping for the completion ring if possible.
+    if (!singleMapping)
+    {
+        completionRing = mmap(nullptr, ring->completionRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringDescriptor, IORING_OFF_CQ_RING); // Maps the completion ring.
+        if (completionRing == MAP_FAILED)
+            return nullptr; // Returns nullptr if the ring cannot be mapped.
+    }
+    ring->completionRingMemory = completionRing; // Keeps the mapping.
+    ring->submissionEntriesSize = parameters.sq_entries * sizeof(io_uring_sqe); // Calculates the size of the submission entries.
+    void* submissionEntries = mmap(nullptr, ring->submissionEntriesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringDescriptor, IORING_OFF_SQES); // Maps the submission entries.
+    if (submissionEntries == MAP_FAILED)
+        return nullptr; // Returns nullptr if the entries cannot be mapped.
+    ring->submissionEntries = static_cast<io_uring_sqe*>(submissionEntries); // Keeps the mapping.
+
+    // Finds the ring fields inside the mappings.
+    char* submissionBase = static_cast<char*>(submissionRing); // Points to the submission ring.
+    char* completionBase = static_cast<char*>(completionRing); // Points to the completion ring.
+    ring->submissionTail = reinterpret_cast<unsigned*>(submissionBase + parameters.sq_off.tail); // Finds the submission tail.
+    ring->submissionMask = *reinterpret_cast<unsigned*>(submissionBase + parameters.sq_off.ring_mask); // Reads the submission mask.
+    ring->submissionArray = reinterpret_cast<unsigned*>(submissionBase + parameters.sq_off.array); // Finds the submission index array.
+    ring->completionHead = reinterpret_cast<unsigned*>(completionBase + parameters.cq_off.head); // Finds the completion head.
+    ring->completionTail = reinterpret_cast<unsigned*>(completionBase + parameters.cq_off.tail); // Finds the completion tail.
+    ring->completionMask = *reinterpret_cast<unsigned*>(completionBase + parameters.cq_off.ring_mask); // Reads the completion mask.
+    ring->completionEntries = reinterpret_cast<io_uring_cqe*>(completionBase + parameters.cq_off.cqes); // Finds the completion entries.
+
+    // Registers the buffers so the kernel does not have to map them for every write; plain writes are used if this is refused.
+    vector<iovec> bufferVectors(bufferCount); // Describes the buffers.
+    for (size_t i = 0; i < bufferCount; i++)
+        bufferVectors[i] = iovec{ bufferMemory + i * bufferSize, bufferSize }; // Describes one buffer.
+    ring->buffersRegistered = syscall(__NR_io_uring_register, ringDescriptor, IORING_REGISTER_BUFFERS, bufferVectors.data(), static_cast<unsigned>(bufferCount)) == 0; // Registers the buffers.
+    return ring;
+}
+#else
+// Stands in for the ring on systems without io_uring; it is never created.
+struct IoRing
+{
+};
+#endif
+
+#ifndef _WIN32
+// Writes the whole range with pwrite, continuing after short writes; returns false on an error.
+static bool writeAllAt(int fileDescriptor, const char* data, size_t length, uint64_t offset)
+{
+    while (length > 0)
+    {
+        ssize_t written = pwrite(fileDescriptor, data, length, static_cast<off_t>(offset)); // Writes as much as the kernel takes.
+        if (written < 0 && errno == EINTR)
+            continue; // Tries again after an interruption.
+        if (written <= 0)
+            return false; // Returns false on an error.
+        data += written; // Skips the written bytes.
+        length -= static_cast<size_t>(written);
+        offset += static_cast<uint64_t>(written);
+    }
+    return true;
+}
+#endif
+
+// Constructor that allocates the buffers of a closed writer.
+BatchFileWriter::BatchFileWriter(size_t count, size_t size)
+    : bufferSize(size), bufferCount(max<size_t>(count, 1)), bufferMemory(bufferCount * size), currentLength(0), currentOffset(0)
+{
+#ifndef _WIN32
+    fileDescriptor = -1; // Marks the writer closed.
+#endif
+    pendingWrites.reserve(bufferCount); // Allocates the pending write list once.
+}
+
+// Destructor that writes the buffered data and closes the file.
+BatchFileWriter::~BatchFileWriter()
+{
+    try
+    {
+        close(); // Writes the buffered data and closes the file.
+    }
+    catch (InvalidFileException)
+    {
+        // A destructor cannot report the failure; the data is lost as it would be in a crash.
+    }
+}
+
+// Opens the file for appending and sets up io_uring if possible.
+void BatchFileWriter::open(const string& path, bool truncate)
+{
+    close(); // Closes a file opened earlier.
+    filePath = path; // Remembers the path.
+#ifdef _WIN32
+    file.clear(); // Clears the stream flags so the stream can be opened again.
+    file.open(filePath, ios::out | ios::binary | (truncate ? ios::trunc : ios::app)); // Opens the file.
+    if (!file.is_open())
+        throw InvalidFileException(); // Throws an exception if the file failed to open.
+    file.seekp(0, ios::end); // Moves to the end of the file.
+    currentOffset = static_cast<uint64_t>(file.tellp()); // Appends after the existing content.
+#else
+    fileDescriptor = ::open(filePath.c_str(), O_WRONLY | O_CREAT | (truncate ? O_TRUNC : 0), 0644); // Opens the file.
+    if (fileDescriptor < 0)
+        throw InvalidFileException(); // Throws an exception if the file failed to open.
+    struct stat fileStatus; // Stores the file size.
+    if (fstat(fileDescriptor, &fileStatus) != 0)
+        throw InvalidFileException(); // Throws an exception if the size cannot be read.
+    currentOffset = static_cast<uint64_t>(fileStatus.st_size); // Appends after the existing content.
+#ifdef BANK_HAS_IO_URING
+    if (USE_IO_URING && !ring)
+        ring = createIoRing(static_cast<unsigned>(bufferCount + 1), bufferMemory.data(), bufferSize, bufferCount); // Sets up the ring once; it outlives reopening the file.
+#endif
+#endif
+    currentLength = 0; // Starts with an empty buffer.
+    pendingWrites.clear(); // Starts with no pending writes.
+}
+
+// Writes the buffered data and closes the file.
+void BatchFileWriter::close()
+{
+    if (!isOpen())
+        return; // Returns if the writer is already closed.
+    flush(false); // Writes the buffered data.
+#ifdef _WIN32
+    file.close(); // Closes the file.
+#else
+    ::close(fileDescriptor); // Closes the file.
+    fileDescriptor = -1; // Marks the writer closed.
+#endif
+}
+
+// Returns true if the writer is open.
+bool BatchFileWriter::isOpen() const
+{
+#ifdef _WIN32
+    return file.is_open();
+#else
+    return fileDescriptor >= 0;
+#endif
+}
+
+// Copies bytes into the buffers, sealing each buffer as it fills up.
+void BatchFileWriter::append(const char* data, size_t size)
+{
+    bool keepRunning = reserveBytesForFaultInjection(size); // Shortens the data if it reaches the fault injection offset.
+    while (size > 0)
+    {
+        size_t copyLength = min(size, bufferSize - currentLength); // Fills the rest of the current buffer at most.
+        memcpy(getBuffer(pendingWrites.size()) + currentLength, data, copyLength); // Copies the bytes.
+        currentLength += copyLength; // Counts them.
+        data += copyLength; // Skips the copied bytes.
+        size -= copyLength;
+        if (currentLength == bufferSize)
+            sealCurrentBuffer(); // Queues the full buffer.
+    }
+    if (!keepRunning)
+    {
+        flush(false); // Writes what was appended before the offset, as a crash would leave it.
+        stopForFaultInjection(); // Stops the program.
+    }
+}
+
+// Moves the buffer being filled to the pending writes.
+void BatchFileWriter::sealCurrentBuffer()
+{
+    if (currentLength == 0)
+        return; // Returns if the buffer is empty.
+    pendingWrites.push_back(PendingWrite{ currentOffset, currentLength, pendingWrites.size() }); // Queues the buffer.
+    currentOffset += currentLength; // Places the next buffer after it.
+    currentLength = 0; // Starts the next buffer empty.
+    if (pendingWrites.size() == bufferCount)
+        writePendingBuffers(false); // Writes the batch once every buffer is in use.
+}
+
+// Writes the buffered data, forcing it to the disk if asked.
+void BatchFileWriter::flush(bool synchronize)
+{
+    if (!isOpen())
+        return; // Returns if the writer is closed.
+    sealCurrentBuffer(); // Queues the partly filled buffer.
+    writePendingBuffers(synchronize); // Writes the batch.
+}
+
+// Writes every pending buffer and waits for the batch, ending it with an fdatasync if asked.
+void BatchFileWriter::writePendingBuffers(bool synchronize)
+{
+#ifdef _WIN32
+    for (const PendingWrite& write : pendingWrites)
+        file.write(getBuffer(write.bufferIndex), static_cast<streamsize>(write.length)); // Writes the buffer.
+    pendingWrites.clear(); // Frees the buffers.
+    file.flush(); // Hands the data to the operating system.
+    if (!file || (synchronize && !syncFileToDisk(filePath)))
+        throw InvalidFileException(); // Throws an exception if a write or the synchronization failed.
+#else
+    if (pendingWrites.empty() && !synchronize)
+        return; // Returns if there is nothing to do.
+    bool failed = false; // Stores whether a write or the synchronization failed.
+    bool synchronized = !synchronize; // Stores whether the data is on the disk as requested.
+#ifdef BANK_HAS_IO_URING
+    if (ring)
+    {
+        // Fills one submission entry per buffer, then one for the fdatasync.
+        unsigned tail = *ring->submissionTail; // Reads the tail; only this thread advances it.
+        unsigned entryCount = 0; // Counts the entries filled.
+        for (size_t i = 0; i < pendingWrites.size(); i++)
+        {
+            const PendingWrite& write = pendingWrites[i]; // Gets the write.
+            unsigned index = (tail + entryCount) & ring->submissionMask; // Finds a free entry.
+            io_uring_sqe& entry = ring->submissionEntries[index]; // Gets the entry.
+            memset(&entry, 0, sizeof(entry)); // Clears it.
+            entry.opcode = ring->buffersRegistered ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE; // Writes from a registered buffer when possible.
+            entry.fd = fileDescriptor; // Writes to the file.
+            entry.addr = reinterpret_cast<uint64_t>(getBuffer(write.bufferIndex)); // Writes from the buffer.
+            entry.len = static_cast<uint32_t>(write.length); // Writes its content.
+            entry.off = write.offset; // Writes at its position in the file.
+            entry.buf_index = static_cast<uint16_t>(write.bufferIndex); // Names the registered buffer.
+            entry.user_data = i; // Identifies the write in its completion.
+            if (synchronize && i + 1 == pendingWrites.size())
+                entry.flags = IOSQE_IO_DRAIN | IOSQE_IO_LINK; // Starts the last write after the others finish, and links the fdatasync behind it.
+            ring->submissionArray[index] = index; // Puts the entry in the ring.
+            entryCount++; // Counts it.
+        }
+        if (synchronize)
+        {
+            unsigned index = (tail + entryCount) & ring->submissionMask; // Finds a free entry.
+            io_uring_sqe& entry = ring->submissionEntries[index]; // Gets the entry.
+            memset(&entry, 0, sizeof(entry)); // Clears it.
+            entry.opcode = IORING_OP_FSYNC; // Synchronizes the file.
+            entry.fd = fileDescriptor; // Synchronizes this file.
+            entry.fsync_flags = IORING_FSYNC_DATASYNC; // Skips metadata the data does not need, like fdatasync.
+            entry.user_data = SYNC_USER_DATA; // Identifies the synchronization in its completion.
+            if (pendingWrites.empty())
+                entry.flags = IOSQE_IO_DRAIN; // Waits for earlier writes when there is nothing to link to.
+            ring->submissionArray[index] = index; // Puts the entry in the ring.
+            entryCount++; // Counts it.
+        }
+        __atomic_store_n(ring->submissionTail, tail + entryCount, __ATOMIC_RELEASE); // Publishes the entries to the kernel.
+
+        // Submits the whole batch and waits for every completion with one system call, repeating only if interrupted.
+        unsigned completedCount = 0; // Counts the completions read.
+        unsigned submittedCount = 0; // Counts the entries the kernel has taken.
+        while (completedCount < entryCount)
+        {
+            int result = static_cast<int>(syscall(__NR_io_uring_enter, ring->ringDescriptor, entryCount - submittedCount, entryCount - completedCount, IORING_ENTER_GETEVENTS, nullptr, 0)); // Submits and waits.
+            if (result < 0 && errno != EINTR)
+            {
+                failed = true; // Reports the failure.
+                break;
+            }
+            if (result > 0)
+                submittedCount += static_cast<unsigned>(result); // Counts the entries taken.
+            unsigned head = *ring->completionHead; // Reads the head; only this thread advances it.
+            unsigned completionTail = __atomic_load_n(ring->completionTail, __ATOMIC_ACQUIRE); // Reads the completions published by the kernel.
+            for (; head != completionTail; head++)
+            {
+                const io_uring_cqe& completion = ring->completionEntries[head & ring->completionMask]; // Gets the completion.
+                if (completion.user_data == SYNC_USER_DATA)
+                    synchronized = completion.res == 0; // Records the result of the fdatasync; it is cancelled if a write fell short.
+                else
+                {
+                    const PendingWrite& write = pendingWrites[static_cast<size_t>(completion.user_data)]; // Gets the write.
+                    if (completion.res < 0)
+                        failed = true; // Records the failure.
+                    else if (static_cast<size_t>(completion.res) < write.length)
+                        failed = failed || !writeAllAt(fileDescriptor, getBuffer(write.bufferIndex) + completion.res, write.length - completion.res, write.offset + completion.res); // Finishes a short write.
+                }
+                completedCount++; // Counts the completion.
+            }
+            __atomic_store_n(ring->completionHead, head, __ATOMIC_RELEASE); // Frees the completion entries.
+        }
+    }
+    else
+#endif
+    {
+        // Issues the writes with pwrite, in parallel when there are several.
+        if (pendingWrites.size() == 1)
+            failed = !writeAllAt(fileDescriptor, getBuffer(pendingWrites[0].bufferIndex), pendingWrites[0].length, pendingWrites[0].offset); // Writes a single buffer directly.
+        else if (!pendingWrites.empty())
+        {
+            if (!fallbackPool)
+                fallbackPool.reset(new WorkStealingPool(min<int>(IO_FALLBACK_THREAD_COUNT, static_cast<int>(bufferCount)))); // Starts the threads on first use.
+            for (const PendingWrite& write : pendingWrites)
+            {
+                fallbackPool->submit([this, write](int)
+                    {
+                        if (!writeAllAt(fileDescriptor, getBuffer(write.bufferIndex), write.length, write.offset))
+                            throw InvalidFileException(); // Reports the failure to waitAll.
+                    }); // Writes the buffer on a pool thread.
+            }
+            try
+            {
+                fallbackPool->waitAll(); // Waits for every write.
+            }
+            catch (InvalidFileException)
+            {
+                failed = true; // Records the failure.
+            }
+        }
+    }
+    if (!failed && !synchronized)
+    {
+        int result; // Stores the result of the synchronization.
+        do
+        {
+            result = fdatasync(fileDescriptor); // Forces the data to the disk.
+        } while (result != 0 && errno == EINTR);
+        synchronized = result == 0; // Records the result.
+    }
+    pendingWrites.clear(); // Frees the buffers.
+    if (failed || !synchronized)
+        throw InvalidFileException(); // Throws an exception if a write or the synchronization failed.
+#endif
+}
+
+// Names the way the batches are written.
+const char* BatchFileWriter::getBackendName() const
+{
+    return ring ? "io_uring" : "pwrite thread pool";
+}
@@ -0,0 +1,105 @@
+// This is the specification file for the BatchFileWriter class,
+// which appends data to a file through a few large buffers and writes them in batches.
+// On Linux the writes of a batch are submitted through io_uring with a single system call,
+// from buffers registered with the kernel, and a requested fdatasync is linked behind them.
+// When io_uring is unavailable (another system, an old kernel, or a sandbox forbidding it),
+// a small thread pool issues the writes with pwrite and the batch ends with fdatasync.
+
+// These are the include guards
+#pragma once
+#ifndef BATCHFILEWRITER_H
+#define BATCHFILEWRITER_H
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include "WorkStealingPool.h"
+using namespace std;
+
+// Holds an io_uring instance: its file descriptor, its mapped rings and its registered buffers
+struct IoRing;
+
+class BatchFileWriter
+{
+private:
+	// Holds a filled buffer waiting to be written
+	struct PendingWrite
+	{
+		uint64_t offset;    // Holds the position in the file where the buffer goes
+		size_t length;      // Holds the number of bytes in the buffer
+		size_t bufferIndex; // Holds the index of the buffer
+	};
+
+	string filePath;                       // Holds the path of the file
+#ifdef _WIN32
+	ofstream file;                         // Holds the file; Windows always uses the stream
+#else
+	int fileDescriptor;                    // Holds the POSIX file descriptor, or -1 when the writer is closed
+#endif
+	size_t bufferSize;                     // Holds the size of each buffer
+	size_t bufferCount;                    // Holds the number of buffers
+	vector<char> bufferMemory;             // Holds all the buffers back to back
+	vector<PendingWrite> pendingWrites;    // Holds the filled buffers, in file order; the next buffer to fill follows them
+	size_t currentLength;                  // Holds the number of bytes in the buffer being filled
+	uint64_t currentOffset;                // Holds the position in the file where the buffer being filled goes
+	unique_ptr<IoRing> ring;               // Holds the io_uring instance, or nullptr when the thread pool is used
+	unique_ptr<WorkStealingPool> fallbackPool; // Holds the threads issuing pwrite calls, created when first needed
+
+	// Returns the start of the buffer with the given index
+	char* getBuffer(size_t index)
+	{
+		return bufferMemory.data() + index * bufferSize;
+	}
+
+	// Moves the buffer being filled to the pending writes, writing the batch if every buffer is full
+	void sealCurrentBuffer();
+
+	// Writes every pending buffer, followed by an fdatasync if asked, and waits for the batch to finish
+	void writePendingBuffers(bool);
+
+public:
+	// Constructor that creates a closed writer using the given number of buffers of the given size
+	BatchFileWriter(size_t, size_t);
+
+	// Destructor that writes the buffered data and closes the file
+	~BatchFileWriter();
+
+	// The writer owns a file, buffers and possibly a ring, so it can be neither copied nor assigned
+	BatchFileWriter(const BatchFileWriter&) = delete;
+	BatchFileWriter& operator=(const BatchFileWriter&) = delete;
+
+	/*
+		Opens the file for appending, creating it if it does not exist, and emptying it if asked.
+		Sets up io_uring when USE_IO_URING is set and the kernel allows it.
+		Throws an InvalidFileException if the file cannot be opened.
+	*/
+	void open(const string&, bool);
+
+	// Writes the buffered data and closes the file
+	void close();
+
+	// Returns true if the writer is open
+	bool isOpen() const;
+
+	/*
+		Copies bytes to the end of the file's buffered data.
+		Full buffers are written in one batch once all of them are in use.
+		Stops the program part-way if the fault injection offset is reached.
+	*/
+	void append(const char*, size_t);
+
+	/*
+		Writes the buffered data and waits for it, so it survives the program crashing.
+		When asked to synchronize, the data is also forced to the disk before returning.
+		Throws an InvalidFileException if a write or the synchronization fails.
+	*/
+	void flush(bool);
+
+	// Returns "io_uring" or "pwrite thread pool", naming how the batches are written
+	const char* getBackendName() const;
+};
+
+#endif
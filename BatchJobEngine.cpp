@@ -0,0 +1,317 @@
+#include <cstring>
+#include <cstddef>
+#include <chrono>
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <filesystem>
+#include "BatchJobEngine.h"
+#include "WorkStealingPool.h"
+#include "Checksum-Functions.h"
+#include "Conversion-Functions.h"
+#include "Numeric-Functions.h"
+#include "Exceptions.h"
+#include "Constants.h"
+
+using namespace std;
+
+// The bytes every checkpoint file starts with.
+static const char CHECKPOINT_MAGIC[8] = { 'B', 'A', 'N', 'K', 'E', 'O', 'D', '1' };
+
+// The partition index of the record written when a job is finished.
+static const uint32_t JOB_FINISHED_PARTITION = UINT32_MAX;
+
+// Holds the header at the start of the checkpoint file, describing the run it belongs to.
+struct CheckpointHeader
+{
+    char magic[8];             // CHECKPOINT_MAGIC
+    int64_t businessDate;      // Business date of the run
+    uint64_t accountCount;     // Number of accounts when the run started
+    uint32_t partitionSize;    // Number of accounts in a partition
+    uint32_t jobCount;         // Number of jobs of the run
+    uint32_t jobNamesChecksum; // CRC32C of the job names, in order
+    uint32_t checksum;         // CRC32C of the header bytes before this field
+};
+
+// Holds the header written before the payload of every record.
+struct CheckpointRecordHeader
+{
+    uint32_t payloadLength;  // Number of payload bytes after the header
+    uint32_t checksum;       // CRC32C of the header bytes after this field and of the payload
+    uint32_t jobIndex;       // Index of the job in the run
+    uint32_t partitionIndex; // Index of the partition, or JOB_FINISHED_PARTITION for the job's record
+    int64_t processedCount;  // Number of accounts processed
+    int64_t affectedCount;   // Number of accounts affected
+    double amount;           // Amount posted or capitalized
+};
+
+// The header sizes are part of the file format, so they must not change with the compiler.
+static_assert(sizeof(CheckpointHeader) == 40, "The checkpoint header must be 40 bytes");
+static_assert(sizeof(CheckpointRecordHeader) == 40, "The checkpoint record header must be 40 bytes");
+
+// Holds the progress of a run: the partitions and jobs already finished, with their results.
+struct CheckpointProgress
+{
+    vector<vector<BatchPartitionResult>> partitionResults; // Holds the result of every partition of every job
+    vector<vector<uint8_t>> partitionFinished;             // Holds 1 for the partitions whose result is known
+    vector<uint8_t> jobFinished;                           // Holds 1 for the jobs whose changes are persisted
+    vector<BatchPartitionResult> jobTotals;                // Holds the totals recorded for the finished jobs
+};
+
+// Computes the checksum of a record from its header and payload.
+static uint32_t computeRecordChecksum(const CheckpointRecordHeader& header, const char* payload)
+{
+    size_t checkedStart = offsetof(CheckpointRecordHeader, jobIndex); // The checksum covers the header from the job index on.
+    uint32_t checksum = computeCRC32C(reinterpret_cast<const char*>(&header) + checkedStart, sizeof(header) - checkedStart); // Checksums the header.
+    checksum = computeCRC32C(&header.payloadLength, sizeof(header.payloadLength), checksum); // Adds the length, so a damaged length is caught too.
+    return computeCRC32C(payload, header.payloadLength, checksum); // Adds the payload.
+}
+
+// Encodes the changed accounts of a partition, one CSV line each, starting with the account position.
+static string encodeChangedAccounts(const BatchPartitionResult& result)
+{
+    string payload; // Stores the encoded accounts.
+    for (const pair<size_t, vector<string>>& change : result.changedAccounts)
+    {
+        appendInteger(payload, static_cast<long long>(change.first)); // Adds the position.
+        payload.push_back(','); // Separates it from the account fields.
+        payload.append(convertVectorToCSVString(change.second)); // Adds the account fields.
+        payload.push_back('\n'); // Ends the line.
+    }
+    return payload; // Returns the payload.
+}
+
+// Decodes the changed accounts of a partition, checking that every position is in the accounts vector.
+// Throws an InvalidNumberException or InvalidFileException if the payload cannot be decoded.
+static void decodeChangedAccounts(const char* payload, size_t payloadLength, size_t accountCount, BatchPartitionResult& result)
+{
+    size_t lineStart = 0; // Stores where the next line starts.
+    while (lineStart < payloadLength)
+    {
+        const char* lineEnd = static_cast<const char*>(memchr(payload + lineStart, '\n', payloadLength - lineStart)); // Finds the end of the line.
+        if (lineEnd == nullptr)
+            throw InvalidFileException(); // Every line ends with a newline.
+        size_t lineLength = lineEnd - (payload + lineStart); // Computes the length of the line.
+        vector<string> fields = convertCSVStringToVector(string(payload + lineStart, lineLength)); // Splits the line.
+        long long position = parseLongLong(fields[0]); // Reads the position.
+        if (position < 0 || static_cast<size_t>(position) >= accountCount)
+            throw InvalidFileException(); // Rejects a position outside the accounts vector.
+        fields.erase(fields.begin()); // Keeps only the account fields.
+        fields.resize(ACCOUNT_FIELD_COUNT); // Restores the empty fields of a saving account.
+        result.changedAccounts.emplace_back(static_cast<size_t>(position), move(fields)); // Adds the change.
+        lineStart += lineLength + 1; // Moves past the newline.
+    }
+}
+
+// Builds the header describing a run.
+static CheckpointHeader makeCheckpointHeader(time_t businessDate, size_t accountCount, size_t partitionSize, size_t jobCount, uint32_t jobNamesChecksum)
+{
+    CheckpointHeader header = {}; // Stores the header (zero-initialized).
+    memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic)); // Stores the magic bytes.
+    header.businessDate = static_cast<int64_t>(businessDate); // Stores the business date.
+    header.accountCount = accountCount; // Stores the number of accounts.
+    header.partitionSize = static_cast<uint32_t>(partitionSize); // Stores the partition size.
+    header.jobCount = static_cast<uint32_t>(jobCount); // Stores the number of jobs.
+    header.jobNamesChecksum = jobNamesChecksum; // Stores the checksum of the job names.
+    header.checksum = computeCRC32C(&header, offsetof(CheckpointHeader, checksum)); // Checksums the header.
+    return header;
+}
+
+/*
+	Reads the checkpoint of an interrupted run matching the expected header into the progress,
+	taking the business date of the interrupted run.
+	Returns the length of the valid part of the file, or 0 if there is no matching checkpoint.
+*/
+static size_t readCheckpoint(const string& path, const CheckpointHeader& expected, size_t accountCount, CheckpointProgress& progress, time_t& businessDate)
+{
+    ifstream checkpointFile(path, ios::in | ios::binary); // Opens the checkpoint for reading.
+    if (!checkpointFile)
+        return 0; // Returns if no run was interrupted.
+    string content((istreambuf_iterator<char>(checkpointFile)), istreambuf_iterator<char>()); // Reads the whole checkpoint.
+    checkpointFile.close(); // Closes the file.
+
+    CheckpointHeader header; // Stores a copy of the header.
+    if (content.size() < sizeof(header))
+        return 0; // Starts over if the header was never completely written.
+    memcpy(&header, content.data(), sizeof(header)); // Copies the header out of the file content.
+    if (memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic)) != 0 || header.checksum != computeCRC32C(&header, offsetof(CheckpointHeader, checksum)))
+        return 0; // Starts over if the header is damaged.
+    if (header.accountCount != expected.accountCount || header.partitionSize != expected.partitionSize
+        || header.jobCount != expected.jobCount || header.jobNamesChecksum != expected.jobNamesChecksum)
+        return 0; // Starts over if the accounts or jobs changed since the run was interrupted.
+
+    size_t position = sizeof(header); // Stores where the next record starts.
+    while (content.size() - position >= sizeof(CheckpointRecordHeader))
+    {
+        CheckpointRecordHeader recordHeader; // Stores a copy of the record header.
+        memcpy(&recordHeader, content.data() + position, sizeof(recordHeader)); // Copies the header out of the file content.
+        const char* payload = content.data() + position + sizeof(recordHeader); // Points to the payload.
+        if (recordHeader.payloadLength > content.size() - position - sizeof(recordHeader))
+            break; // Stops at a record cut short by a crash.
+        if (recordHeader.checksum != computeRecordChecksum(recordHeader, payload) || recordHeader.jobIndex >= header.jobCount)
+            break; // Stops at a damaged record.
+
+        BatchPartitionResult result; // Stores the result the record holds.
+        result.processedCount = recordHeader.processedCount; // Copies the totals.
+        result.affectedCount = recordHeader.affectedCount;
+        result.amount = recordHeader.amount;
+        if (recordHeader.partitionIndex == JOB_FINISHED_PARTITION)
+        {
+            progress.jobFinished[recordHeader.jobIndex] = 1; // Skips the job when resuming.
+            progress.jobTotals[recordHeader.jobIndex] = move(result); // Keeps its totals for the summary.
+        }
+        else
+        {
+            if (recordHeader.partitionIndex >= progress.partitionFinished[recordHeader.jobIndex].size())
+                break; // Stops at a partition that does not exist.
+            try
+            {
+                decodeChangedAccounts(payload, recordHeader.payloadLength, accountCount, result); // Decodes the changed accounts.
+            }
+            catch (...)
+            {
+                break; // Stops at a record whose checksum matches but whose payload cannot be decoded.
+            }
+            progress.partitionResults[recordHeader.jobIndex][recordHeader.partitionIndex] = move(result); // Keeps the partition's result.
+            progress.partitionFinished[recordHeader.jobIndex][recordHeader.partitionIndex] = 1; // Skips the partition when resuming.
+        }
+        position += sizeof(recordHeader) + recordHeader.payloadLength; // Moves to the next record.
+    }
+    businessDate = static_cast<time_t>(header.businessDate); // Continues the interrupted business date.
+    return position; // Returns the length of the valid part.
+}
+
+// Constructor that creates an engine with a closed checkpoint file.
+BatchJobEngine::BatchJobEngine(const string& checkpointPathArgument, size_t partitionSizeArgument, int threadCountArgument)
+    : checkpointPath(checkpointPathArgument), partitionSize(partitionSizeArgument), threadCount(threadCountArgument),
+    checkpointWriter(JOURNAL_IO_BUFFER_COUNT, JOURNAL_IO_BUFFER_SIZE)
+{
+}
+
+// Appends a record to the checkpoint and writes it, forcing it to the disk if asked.
+void BatchJobEngine::appendCheckpointRecord(uint32_t jobIndex, uint32_t partitionIndex, const BatchPartitionResult& result, bool synchronize)
+{
+    string payload = encodeChangedAccounts(result); // Encodes the changes outside the lock.
+    CheckpointRecordHeader header = {}; // Stores the header (zero-initialized).
+    header.payloadLength = static_cast<uint32_t>(payload.size()); // Stores the payload length.
+    header.jobIndex = jobIndex; // Stores the job.
+    header.partitionIndex = partitionIndex; // Stores the partition.
+    header.processedCount = result.processedCount; // Stores the totals.
+    header.affectedCount = result.affectedCount;
+    header.amount = result.amount;
+    header.checksum = computeRecordChecksum(header, payload.data()); // Checksums the record.
+
+    lock_guard<mutex> lock(checkpointMutex); // Keeps the records of different partitions apart.
+    checkpointWriter.append(reinterpret_cast<const char*>(&header), sizeof(header)); // Appends the header.
+    checkpointWriter.append(payload.data(), payload.size()); // Appends the payload.
+    checkpointWriter.flush(synchronize); // Writes the record, so it survives the program crashing.
+}
+
+// Runs the jobs over the accounts vector, resuming an interrupted run of the same jobs.
+BatchRunSummary BatchJobEngine::run(const vector<const BatchJob*>& jobs, vector<vector<string>>& accountVectors, const function<void(const vector<size_t>&)>& persistChanges, time_t businessDate)
+{
+    size_t partitionCount = (accountVectors.size() + partitionSize - 1) / partitionSize; // Counts the partitions of each job.
+    uint32_t jobNamesChecksum = 0; // Stores the checksum of the job names.
+    for (const BatchJob* job : jobs)
+        jobNamesChecksum = computeCRC32C(job->getName(), strlen(job->getName()) + 1, jobNamesChecksum); // Adds the name with its terminator, so names cannot run together.
+
+    CheckpointProgress progress; // Stores the finished partitions and jobs.
+    progress.partitionResults.assign(jobs.size(), vector<BatchPartitionResult>(partitionCount)); // Makes room for every partition.
+    progress.partitionFinished.assign(jobs.size(), vector<uint8_t>(partitionCount, 0)); // Marks every partition as not run.
+    progress.jobFinished.assign(jobs.size(), 0); // Marks every job as not run.
+    progress.jobTotals.resize(jobs.size()); // Makes room for the totals of the finished jobs.
+
+    BatchRunSummary summary; // Stores the results of the run.
+    CheckpointHeader expectedHeader = makeCheckpointHeader(businessDate, accountVectors.size(), partitionSize, jobs.size(), jobNamesChecksum); // Describes this run.
+    size_t validLength = readCheckpoint(checkpointPath, expectedHeader, accountVectors.size(), progress, businessDate); // Looks for an interrupted run.
+    summary.resumed = validLength > 0; // Records whether the run continues an interrupted one.
+    summary.businessDate = businessDate; // Records the business date, which is the interrupted run's when resuming.
+
+    checkpointWriter.close(); // Closes the file left by an earlier run, if any.
+    if (summary.resumed)
+    {
+        error_code resizeError; // Stores the result of the resize.
+        filesystem::resize_file(checkpointPath, validLength, resizeError); // Cuts off the torn or damaged records.
+        if (resizeError)
+            throw InvalidFileException(); // Throws an exception if the damaged end cannot be removed.
+        checkpointWriter.open(checkpointPath, false); // Appends after the last valid record.
+    }
+    else
+    {
+        CheckpointHeader header = makeCheckpointHeader(businessDate, accountVectors.size(), partitionSize, jobs.size(), jobNamesChecksum); // Describes the new run.
+        checkpointWriter.open(checkpointPath, true); // Starts an empty checkpoint.
+        checkpointWriter.append(reinterpret_cast<const char*>(&header), sizeof(header)); // Writes the header.
+        checkpointWriter.flush(true); // Forces it to the disk before any partition is recorded.
+    }
+
+    WorkStealingPool pool(threadCount); // Starts the worker threads, shared by every job.
+    summary.threadCount = pool.getThreadCount(); // Records the number of threads.
+    for (size_t jobIndex = 0; jobIndex < jobs.size(); jobIndex++)
+    {
+        auto startTime = chrono::steady_clock::now(); // Records when the job started.
+        const BatchJob* job = jobs[jobIndex]; // Gets the job.
+        BatchJobSummary jobSummary; // Stores the totals of the job.
+        jobSummary.jobName = job->getName(); // Names the job.
+        jobSummary.partitionCount = partitionCount; // Counts its partitions.
+
+        if (progress.jobFinished[jobIndex])
+        {
+            const BatchPartitionResult& totals = progress.jobTotals[jobIndex]; // Gets the recorded totals.
+            jobSummary.processedCount = totals.processedCount; // Reports them without running the job again.
+            jobSummary.affectedCount = totals.affectedCount;
+            jobSummary.amount = totals.amount;
+            jobSummary.resumedPartitionCount = partitionCount; // Every partition comes from the checkpoint.
+            summary.jobs.push_back(move(jobSummary)); // Adds the job's summary.
+            continue;
+        }
+
+        vector<BatchPartitionResult>& partitionResults = progress.partitionResults[jobIndex]; // Gets the results of the job's partitions.
+        const vector<vector<string>>& readOnlyAccounts = accountVectors; // Gives the partitions read-only access.
+        for (size_t partition = 0; partition < partitionCount; partition++)
+        {
+            if (progress.partitionFinished[jobIndex][partition])
+            {
+                jobSummary.resumedPartitionCount++; // Counts the partition taken from the checkpoint.
+                continue;
+            }
+            size_t first = partition * partitionSize; // Stores the start of the partition.
+            size_t last = min(accountVectors.size(), first + partitionSize); // Stores the end of the partition.
+            pool.submit([this, job, &readOnlyAccounts, &partitionResults, jobIndex, partition, first, last, businessDate](int)
+                {
+                    BatchPartitionResult& result = partitionResults[partition]; // Gets the partition's own result; partitions never share one.
+                    job->processPartition(readOnlyAccounts, first, last, businessDate, result); // Runs the job on the partition.
+                    appendCheckpointRecord(static_cast<uint32_t>(jobIndex), static_cast<uint32_t>(partition), result, false); // Records the finished partition.
+                });
+        }
+        pool.waitAll(); // Waits for every partition; rethrows the first failure.
+
+        BatchPartitionResult totals; // Stores the totals of the job.
+        vector<size_t> changedPositions; // Stores the positions of the changed accounts.
+        for (BatchPartitionResult& result : partitionResults)
+        {
+            totals.processedCount += result.processedCount; // Adds the partition's totals.
+            totals.affectedCount += result.affectedCount;
+            totals.amount += result.amount;
+            for (pair<size_t, vector<string>>& change : result.changedAccounts)
+            {
+                accountVectors[change.first] = move(change.second); // Applies the change.
+                changedPositions.push_back(change.first); // Remembers its position.
+            }
+            result = BatchPartitionResult(); // Frees the changes, which are now in the accounts vector.
+        }
+        if (!changedPositions.empty())
+            persistChanges(changedPositions); // Persists every change of the job in one call.
+        appendCheckpointRecord(static_cast<uint32_t>(jobIndex), JOB_FINISHED_PARTITION, totals, true); // Records the finished job once its changes are persisted.
+
+        jobSummary.processedCount = totals.processedCount; // Reports the totals.
+        jobSummary.affectedCount = totals.affectedCount;
+        jobSummary.amount = totals.amount;
+        jobSummary.elapsedMilliseconds = chrono::duration<double, milli>(chrono::steady_clock::now() - startTime).count(); // Measures the job.
+        summary.jobs.push_back(move(jobSummary)); // Adds the job's summary.
+    }
+
+    checkpointWriter.close(); // Closes the checkpoint.
+    error_code removeError; // Stores the result of the removal.
+    filesystem::remove(checkpointPath, removeError); // Removes the checkpoint, since the run is complete.
+    return summary;
+}
@@ -0,0 +1,115 @@
+// This is the specification file for the BatchJobEngine class,
+// which runs the end-of-day batch jobs over every account.
+// Each job splits the accounts vector into partitions that run on a work-stealing pool,
+// every finished partition is recorded in a checkpoint file so an interrupted run resumes where it stopped,
+// and the changes of a job reach the account store through a single bulk persistence call.
+
+/*
+	Checkpoint file layout (all numbers in the native byte order):
+	- A 40-byte header: magic, business date, account count, partition size, job count,
+	  a CRC32C of the job names, and a CRC32C of the rest of the header
+	- Records, one per finished partition and one per finished job, each made of a 40-byte header
+	  (payload length, CRC32C, job index, partition index, processed, affected and amount totals)
+	  followed by the payload: the changed accounts of the partition, one CSV line each, starting with the account position
+	- A record cut short by a crash, or a damaged one, ends the file; it and everything after it is cut off
+	A header that does not match the run (other accounts, partitions or jobs) starts the run over.
+*/
+
+// These are the include guards
+#pragma once
+#ifndef BATCHJOBENGINE_H
+#define BATCHJOBENGINE_H
+
+#include <vector>
+#include <string>
+#include <ctime>
+#include <mutex>
+#include <functional>
+#include <utility>
+#include "BatchFileWriter.h"
+using namespace std;
+
+// Holds what a job did in one partition
+struct BatchPartitionResult
+{
+	long long processedCount = 0; // Number of accounts the job looked at
+	long long affectedCount = 0;  // Number of accounts the job applied to
+	double amount = 0;            // Amount posted or capitalized by the job
+	vector<pair<size_t, vector<string>>> changedAccounts; // New versions of the accounts the job changed, with their positions
+};
+
+// Holds the totals of one job of a run
+struct BatchJobSummary
+{
+	string jobName;
+	long long processedCount = 0;
+	long long affectedCount = 0;
+	double amount = 0;
+	size_t partitionCount = 0;        // Number of partitions of the job
+	size_t resumedPartitionCount = 0; // Number of partitions taken from the checkpoint instead of being run again
+	double elapsedMilliseconds = 0;   // Wall-clock time taken by the job, including its persistence
+};
+
+// Holds the results of a run
+struct BatchRunSummary
+{
+	time_t businessDate = 0; // The business date the jobs ran for, kept from the interrupted run when resuming
+	bool resumed = false;    // Set if the run continued from a checkpoint
+	int threadCount = 0;     // Number of worker threads used by the jobs
+	vector<BatchJobSummary> jobs;
+};
+
+// A job of the end-of-day batch
+class BatchJob
+{
+public:
+	// Virtual destructor, jobs are used through base class pointers
+	virtual ~BatchJob() = default;
+
+	// Returns the name of the job, shown in the results and recorded in the checkpoint
+	virtual const char* getName() const = 0;
+
+	/*
+		Processes the accounts in [first, last) for the given business date, filling the partition result
+		with its totals and the new versions of the accounts it changes.
+		Called from several threads at once for different partitions, so it must only read the accounts vector.
+	*/
+	virtual void processPartition(const vector<vector<string>>&, size_t, size_t, time_t, BatchPartitionResult&) const = 0;
+};
+
+class BatchJobEngine
+{
+private:
+	string checkpointPath;          // Holds the path of the checkpoint file
+	size_t partitionSize;           // Holds the number of accounts in a partition
+	int threadCount;                // Holds the number of worker threads, 0 for one per hardware thread
+	BatchFileWriter checkpointWriter; // Holds the checkpoint file opened for appending
+	mutex checkpointMutex;          // Guards the checkpoint writer, shared by the partitions finishing on different threads
+
+	// Appends a record for a finished partition, or for a finished job when the partition index is UINT32_MAX, and writes it
+	void appendCheckpointRecord(uint32_t, uint32_t, const BatchPartitionResult&, bool);
+
+public:
+	/*
+		Constructor that creates an engine keeping its checkpoint in the given file,
+		running partitions of the given number of accounts on the given number of threads (0 for one per hardware thread).
+	*/
+	BatchJobEngine(const string&, size_t, int = 0);
+
+	// The engine owns an open file, so it can be neither copied nor assigned
+	BatchJobEngine(const BatchJobEngine&) = delete;
+	BatchJobEngine& operator=(const BatchJobEngine&) = delete;
+
+	/*
+		Runs the jobs one after another over the accounts vector for the given business date.
+		If the checkpoint file holds an interrupted run of the same jobs over the same accounts,
+		continues it with its business date: finished jobs are skipped, and the finished partitions
+		of the interrupted job are taken from the checkpoint instead of being run again.
+		After each job, applies its changes to the accounts vector and passes their positions
+		to the persistence function in one call. Removes the checkpoint file once every job is finished.
+		Throws an InvalidFileException if the checkpoint cannot be written.
+	*/
+	BatchRunSummary run(const vector<const BatchJob*>&, vector<vector<string>>&, const function<void(const vector<size_t>&)>&, time_t);
+};
+
+#endif
@@ -0,0 +1,174 @@
+// This is the specification and implementation file for the BoundedMpmcQueue class template,
+// a fixed-capacity first-in first-out queue that several threads can push to and pop from
+// without locks. Every slot carries a sequence number telling whether it is ready to be written or read,
+// so a producer and a consumer only contend when they reach the same slot.
+// A producer that must not drop its element can block in push until the consumers have freed half of the queue;
+// the consumers only take a lock to wake it when a producer is actually waiting, and the half-queue margin
+// lets a consumer sharing a core with the producer work through a batch instead of trading turns with it slot by slot.
+
+// These are the include guards
+#pragma once
+#ifndef BOUNDEDMPMCQUEUE_H
+#define BOUNDEDMPMCQUEUE_H
+
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <cstddef>
+#include <condition_variable>
+#include <utility>
+using namespace std;
+
+template <typename T>
+class BoundedMpmcQueue
+{
+private:
+	// Holds one element and the sequence number of the next operation allowed on it
+	struct Slot
+	{
+		atomic<size_t> sequence; // Equals the position when the slot is free, and the position + 1 when it holds an element
+		T value;                 // Holds the element
+	};
+
+	// Keeps the producer and consumer positions on separate cache lines, so they do not slow each other down
+	struct alignas(64) Position
+	{
+		atomic<size_t> value;
+	};
+
+	vector<Slot> slots;      // Holds the ring of slots
+	size_t mask;             // Holds the capacity minus one, used to wrap positions around the ring
+	Position enqueuePosition; // Holds the position of the next push
+	Position dequeuePosition; // Holds the position of the next pop
+	atomic<size_t> waitingProducerCount; // Counts the producers blocked in push
+	mutex roomMutex;                     // Guards the sleep and wake-up of the blocked producers
+	condition_variable roomAvailable;    // Signaled when pops free half of the queue while a producer is blocked
+
+	// Returns true if at least half of the slots are free, counting the pushes and pops in progress as done
+	bool hasRoom() const
+	{
+		size_t dequeued = dequeuePosition.value.load(memory_order_seq_cst); // Reads the pops first, so they never pass the pushes read next.
+		return enqueuePosition.value.load(memory_order_seq_cst) - dequeued <= (mask + 1) / 2; // Compares the number of elements with half of the capacity.
+	}
+
+	// Wakes the blocked producers, if any, once a pop has freed half of the queue
+	void notifyWaitingProducers()
+	{
+		atomic_thread_fence(memory_order_seq_cst); // Orders the freed slot before the check, matching the fence in push.
+		if (waitingProducerCount.load(memory_order_relaxed) > 0 && hasRoom())
+		{
+			{
+				lock_guard<mutex> lock(roomMutex); // Locks so the wake-up cannot arrive between a producer's check and its wait.
+			}
+			roomAvailable.notify_all(); // Wakes the producers to try again.
+		}
+	}
+
+public:
+	// Constructor that creates an empty queue; the capacity is rounded up to a power of two
+	explicit BoundedMpmcQueue(size_t capacity)
+	{
+		size_t roundedCapacity = 2; // Stores the capacity rounded up to a power of two.
+		while (roundedCapacity < capacity)
+			roundedCapacity *= 2; // Doubles the capacity until it is large enough.
+		slots = vector<Slot>(roundedCapacity); // Creates the slots.
+		for (size_t i = 0; i < roundedCapacity; i++)
+			slots[i].sequence.store(i, memory_order_relaxed); // Marks every slot free for the first lap.
+		mask = roundedCapacity - 1; // Stores the wrap mask.
+		enqueuePosition.value.store(0, memory_order_relaxed); // Starts pushing at the first slot.
+		dequeuePosition.value.store(0, memory_order_relaxed); // Starts popping at the first slot.
+		waitingProducerCount.store(0, memory_order_relaxed); // No producer is blocked yet.
+	}
+
+	// The queue is shared by reference between threads, so it can be neither copied nor assigned
+	BoundedMpmcQueue(const BoundedMpmcQueue&) = delete;
+	BoundedMpmcQueue& operator=(const BoundedMpmcQueue&) = delete;
+
+	// Returns the number of elements the queue can hold
+	size_t getCapacity() const
+	{
+		return mask + 1;
+	}
+
+	/*
+		Returns true if no element is ready to be popped.
+		An element whose push has not finished yet counts as absent.
+	*/
+	bool isEmpty() const
+	{
+		size_t position = dequeuePosition.value.load(memory_order_relaxed); // Gets the position of the next pop.
+		return slots[position & mask].sequence.load(memory_order_acquire) != position + 1; // Checks whether that slot holds an element.
+	}
+
+	/*
+		Moves the element into the queue; if the queue is full, blocks until pops have freed half of it.
+		The caller must make sure a consumer is draining the queue, or it waits forever.
+	*/
+	void push(T& element)
+	{
+		while (!tryPush(element))
+		{
+			waitingProducerCount.fetch_add(1); // Asks the consumers to wake this producer.
+			atomic_thread_fence(memory_order_seq_cst); // Orders the request before the check, matching the fence in notifyWaitingProducers.
+			{
+				unique_lock<mutex> lock(roomMutex); // Locks to wait.
+				roomAvailable.wait(lock, [this]() { return hasRoom(); }); // Waits for the pops to free half of the queue.
+			}
+			waitingProducerCount.fetch_sub(1); // Stops asking for wake-ups before trying again.
+		}
+	}
+
+	// Moves the element into the queue; returns false, leaving it untouched, if the queue is full
+	bool tryPush(T& element)
+	{
+		size_t position = enqueuePosition.value.load(memory_order_relaxed); // Gets the position to push at.
+		while (true)
+		{
+			Slot& slot = slots[position & mask]; // Gets the slot at the position.
+			size_t sequence = slot.sequence.load(memory_order_acquire); // Reads the slot state.
+			long long difference = static_cast<long long>(sequence) - static_cast<long long>(position); // Compares it with the position.
+			if (difference == 0)
+			{
+				if (enqueuePosition.value.compare_exchange_weak(position, position + 1, memory_order_relaxed))
+				{
+					slot.value = move(element); // Stores the element in the claimed slot.
+					slot.sequence.store(position + 1, memory_order_release); // Publishes it to the consumers.
+					return true;
+				}
+				// On failure, compare_exchange_weak has loaded the new position; tries again with it.
+			}
+			else if (difference < 0)
+				return false; // Returns false if the slot still holds an element from the previous lap: the queue is full.
+			else
+				position = enqueuePosition.value.load(memory_order_relaxed); // Another producer took the slot; reloads the position.
+		}
+	}
+
+	// Moves the oldest element out of the queue; returns false if the queue is empty
+	bool tryPop(T& element)
+	{
+		size_t position = dequeuePosition.value.load(memory_order_relaxed); // Gets the position to pop at.
+		while (true)
+		{
+			Slot& slot = slots[position & mask]; // Gets the slot at the position.
+			size_t sequence = slot.sequence.load(memory_order_acquire); // Reads the slot state.
+			long long difference = static_cast<long long>(sequence) - static_cast<long long>(position + 1); // Compares it with the position.
+			if (difference == 0)
+			{
+				if (dequeuePosition.value.compare_exchange_weak(position, position + 1, memory_order_relaxed))
+				{
+					element = move(slot.value); // Takes the element out of the claimed slot.
+					slot.sequence.store(position + mask + 1, memory_order_release); // Frees the slot for the next lap.
+					notifyWaitingProducers(); // Wakes a producer blocked on the full queue.
+					return true;
+				}
+			}
+			else if (difference < 0)
+				return false; // Returns false if the slot has not been written yet: the queue is empty.
+			else
+				position = dequeuePosition.value.load(memory_order_relaxed); // Another consumer took the slot; reloads the position.
+		}
+	}
+};
+
+#endif
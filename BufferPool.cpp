@@ -0,0 +1,134 @@
+#include <cstring>
+#include "BufferPool.h"
+#include "Exceptions.h"
+#include "Constants.h"
+
+using namespace std;
+
+// Constructor that creates the given number of empty frames.
+BufferPool::BufferPool(PageFile& file, size_t frameCount)
+    : pageFile(file), frameData(frameCount * frameSize()), frames(frameCount, Frame{ 0, 0, false, false, false }),
+      clockHand(0), hitCount(0), missCount(0), evictionCount(0), writeCount(0)
+{
+    pageTable.reserve(frameCount); // Allocates the page table once.
+}
+
+// Returns the size of one frame.
+size_t BufferPool::frameSize()
+{
+    return STORAGE_PAGE_SIZE;
+}
+
+// Finds a free frame, evicting a page chosen by the CLOCK algorithm if needed.
+size_t BufferPool::findFreeFrame()
+{
+    // Two full sweeps are enough: the first one may only clear reference bits.
+    for (size_t step = 0; step < 2 * frames.size(); step++)
+    {
+        size_t frameIndex = clockHand; // Gets the frame under the clock hand.
+        clockHand = (clockHand + 1) % frames.size(); // Advances the clock hand.
+        Frame& frame = frames[frameIndex]; // Gets the frame state.
+        if (!frame.occupied)
+            return frameIndex; // Returns an empty frame right away.
+        if (frame.pinCount > 0)
+            continue; // Skips pages that are in use.
+        if (frame.referenced)
+        {
+            frame.referenced = false; // Gives a recently used page a second chance.
+            continue;
+        }
+        if (frame.dirty)
+        {
+            pageFile.writePage(frame.pageNumber, getFrameData(frameIndex)); // Writes the changed page before dropping it.
+            writeCount++; // Counts the write.
+        }
+        pageTable.erase(frame.pageNumber); // Removes the evicted page from the page table.
+        frame.occupied = false; // Marks the frame as empty.
+        evictionCount++; // Counts the eviction.
+        return frameIndex; // Returns the freed frame.
+    }
+    throw BufferPoolExhaustedException(); // Throws an exception if every page is pinned.
+}
+
+// Returns a pinned page, reading it from the file on a miss.
+char* BufferPool::fetchPage(uint32_t pageNumber)
+{
+    unordered_map<uint32_t, size_t>::iterator entry = pageTable.find(pageNumber); // Looks the page up.
+    if (entry != pageTable.end())
+    {
+        Frame& frame = frames[entry->second]; // Gets the frame holding the page.
+        frame.pinCount++; // Pins the page.
+        frame.referenced = true; // Marks the page as recently used.
+        hitCount++; // Counts the hit.
+        return getFrameData(entry->second); // Returns the page content.
+    }
+
+    size_t frameIndex = findFreeFrame(); // Finds a frame for the page.
+    char* data = getFrameData(frameIndex); // Gets the frame content.
+    pageFile.readPage(pageNumber, data); // Reads the page; the frame stays empty if this throws.
+    frames[frameIndex] = Frame{ pageNumber, 1, true, false, true }; // Stores the pinned page.
+    pageTable[pageNumber] = frameIndex; // Adds the page to the page table.
+    missCount++; // Counts the miss.
+    return data; // Returns the page content.
+}
+
+// Allocates a new zero-filled page and returns it pinned.
+char* BufferPool::newPage(uint32_t& pageNumber)
+{
+    size_t frameIndex = findFreeFrame(); // Finds a frame for the page.
+    pageNumber = pageFile.allocatePage(); // Reserves the page number.
+    char* data = getFrameData(frameIndex); // Gets the frame content.
+    memset(data, 0, frameSize()); // Clears the page.
+    frames[frameIndex] = Frame{ pageNumber, 1, true, true, true }; // Stores the pinned page; it must be written at least once.
+    pageTable[pageNumber] = frameIndex; // Adds the page to the page table.
+    return data; // Returns the page content.
+}
+
+// Releases one pin on a page.
+void BufferPool::unpinPage(uint32_t pageNumber, bool changed)
+{
+    unordered_map<uint32_t, size_t>::iterator entry = pageTable.find(pageNumber); // Looks the page up.
+    if (entry == pageTable.end())
+        return; // Ignores pages that are not in the pool.
+    Frame& frame = frames[entry->second]; // Gets the frame holding the page.
+    if (frame.pinCount > 0)
+        frame.pinCount--; // Releases the pin.
+    if (changed)
+        frame.dirty = true; // Remembers that the page must be written.
+}
+
+// Writes a page to the file if it is dirty.
+void BufferPool::flushPage(uint32_t pageNumber)
+{
+    unordered_map<uint32_t, size_t>::iterator entry = pageTable.find(pageNumber); // Looks the page up.
+    if (entry == pageTable.end() || !frames[entry->second].dirty)
+        return; // Returns if the page is not in the pool or is unchanged.
+    pageFile.writePage(pageNumber, getFrameData(entry->second)); // Writes the page.
+    frames[entry->second].dirty = false; // Marks the page as clean.
+    writeCount++; // Counts the write.
+}
+
+// Writes every dirty page to the file.
+void BufferPool::flushAllPages()
+{
+    for (size_t frameIndex = 0; frameIndex < frames.size(); frameIndex++)
+    {
+        Frame& frame = frames[frameIndex]; // Gets the frame state.
+        if (frame.occupied && frame.dirty)
+        {
+            pageFile.writePage(frame.pageNumber, getFrameData(frameIndex)); // Writes the page.
+            frame.dirty = false; // Marks the page as clean.
+            writeCount++; // Counts the write.
+        }
+    }
+    pageFile.sync(); // Hands the written pages to the operating system.
+}
+
+// Drops every page without writing it.
+void BufferPool::discardAllPages()
+{
+    for (Frame& frame : frames)
+        frame = Frame{ 0, 0, false, false, false }; // Empties the frame.
+    pageTable.clear(); // Empties the page table.
+    clockHand = 0; // Restarts the clock hand.
+}
@@ -0,0 +1,120 @@
+// This is the specification file for the BufferPool class,
+// a fixed number of in-memory frames caching the pages of a PageFile.
+// A page is pinned while it is used and can only be evicted once it is unpinned.
+// Victims are chosen with the CLOCK algorithm: a hand sweeps the frames,
+// giving every recently used page a second chance before evicting it.
+
+// These are the include guards
+#pragma once
+#ifndef BUFFERPOOL_H
+#define BUFFERPOOL_H
+
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include "PageFile.h"
+using namespace std;
+
+class BufferPool
+{
+private:
+	// Holds the state of one frame
+	struct Frame
+	{
+		uint32_t pageNumber; // Number of the page held by the frame
+		int pinCount;        // Number of users currently holding the page
+		bool referenced;     // Set on every use, cleared by the clock hand
+		bool dirty;          // Set when the page was changed since it was last written
+		bool occupied;       // Set when the frame holds a page
+	};
+
+	PageFile& pageFile;                           // Holds the file the pages are read from and written to
+	vector<char> frameData;                       // Holds the content of every frame, one page after another
+	vector<Frame> frames;                         // Holds the state of every frame
+	unordered_map<uint32_t, size_t> pageTable;    // Maps page numbers to the frames holding them
+	size_t clockHand;                             // Holds the next frame the clock algorithm looks at
+	long long hitCount;                           // Counts requests served from a frame
+	long long missCount;                          // Counts requests that read the page from the file
+	long long evictionCount;                      // Counts pages removed to make room for another one
+	long long writeCount;                         // Counts pages written to the file
+
+	// Returns a pointer to the content of a frame
+	char* getFrameData(size_t frameIndex)
+	{
+		return frameData.data() + frameIndex * frameSize();
+	}
+
+	// Returns the size of one frame
+	static size_t frameSize();
+
+	/*
+		Finds a frame for a new page, evicting an unpinned page with the CLOCK algorithm if every frame is occupied.
+		Throws a BufferPoolExhaustedException if every frame is pinned.
+	*/
+	size_t findFreeFrame();
+
+public:
+	// Constructor that creates the given number of empty frames over a page file
+	BufferPool(PageFile&, size_t);
+
+	// The pool refers to its page file, so it can be neither copied nor assigned
+	BufferPool(const BufferPool&) = delete;
+	BufferPool& operator=(const BufferPool&) = delete;
+
+	/*
+		Returns the content of the page with the given number, reading it from the file on a miss,
+		and pins it until unpinPage is called.
+		Throws an InvalidPageException if the page cannot be read.
+	*/
+	char* fetchPage(uint32_t);
+
+	/*
+		Allocates a new zero-filled page at the end of the file, stores its number in the reference argument,
+		and returns its content pinned and marked dirty.
+	*/
+	char* newPage(uint32_t&);
+
+	// Releases one pin on a page, marking it dirty if the caller changed it
+	void unpinPage(uint32_t, bool);
+
+	// Writes a page to the file if it is dirty
+	void flushPage(uint32_t);
+
+	// Writes every dirty page to the file and hands them to the operating system
+	void flushAllPages();
+
+	// Drops every page without writing it, used before the file is truncated
+	void discardAllPages();
+
+	// Returns the number of requests served from a frame
+	long long getHitCount() const
+	{
+		return hitCount;
+	}
+
+	// Returns the number of requests that read the page from the file
+	long long getMissCount() const
+	{
+		return missCount;
+	}
+
+	// Returns the number of evicted pages
+	long long getEvictionCount() const
+	{
+		return evictionCount;
+	}
+
+	// Returns the number of pages written to the file
+	long long getWriteCount() const
+	{
+		return writeCount;
+	}
+
+	// Returns the number of frames holding a page
+	size_t getResidentPageCount() const
+	{
+		return pageTable.size();
+	}
+};
+
+#endif
@@ -5,9 +5,7 @@
 #include "Exceptions.h"
 #include "Constants.h"
 #include "Conversion-Functions.h"
-
-// Calculates the number of years since the account's creation based on the provided date-time string in the format "Year-Month-Day-Hour-Minute-Second".
-static int getYearsAfterCreation(string);
+#include "Numeric-Functions.h"
 
 // Default constructor for CertificateAccount, initializing with default BankAccount values.
 // Sets interest rate and withdrawn amount to 0.
@@ -15,6 +13,7 @@ CertificateAccount::CertificateAccount() : BankAccount()
 {
     setInterestRatePercent(0); // Initializes the interest rate to 0.
     setWithdrawnAmount(0); // Initializes the withdrawn amount to 0.
+    setProductID(CertificateProductID::Classic); // Initializes the product to the Classic certificate.
 }
 
 // Parameterized constructor for CertificateAccount, initializing with a Person, balance, interest rate, and withdrawn amount.
@@ -23,12 +22,27 @@ CertificateAccount::CertificateAccount(const Person& personArgument, double bala
 {
     setInterestRatePercent(interestRatePercentArgument); // Sets the specified interest rate.
     setWithdrawnAmount(withdrawnAmountArgument); // Sets the specified withdrawn amount.
+    setProductID(CertificateProductID::Classic); // Sets the product to the Classic certificate.
+}
+
+// Parameterized constructor for a new CertificateAccount of a catalog product.
+// Validates the deposit and picks the interest rate with the product's own policy.
+CertificateAccount::CertificateAccount(const Person& personArgument, double balanceArgument, CertificateProductID productIDArgument) : BankAccount(personArgument, balanceArgument)
+{
+    double ratePercent = visitCertificateProduct(productIDArgument, [balanceArgument](auto policy)
+        {
+            if (!policy.isValidDeposit(balanceArgument))
+                throw InsufficientBalanceException(); // Throws an exception if the deposit is below the product's minimum.
+            return policy.getRatePercent(balanceArgument); // Returns the rate of the tier the deposit reaches.
+        });
+    setInterestRatePercent(ratePercent); // Sets the tier's interest rate.
+    setWithdrawnAmount(0); // Nothing has been withdrawn from a new account.
+    setProductID(productIDArgument); // Sets the product.
 }
 
-// Withdraws the specified amount from the certificate account's saving balance.
+// Withdraws the specified amount from the certificate account's saving balance at the given time.
 // Throws exceptions for invalid amounts or insufficient balance.
-// Overriden the withdraw pure virtual declaration in the BankAccount base class.
-void CertificateAccount::withdraw(double amount)
+void CertificateAccount::withdraw(double amount, time_t asOf)
 {
     if (amount < 0)
     {
@@ -37,7 +51,7 @@ void CertificateAccount::withdraw(double amount)
     else
     {
         double balance = getBalance(); // Retrieves the base account balance.
-        double savingBalance = getSavingBalance(); // Calculates the available saving balance.
+        double savingBalance = getSavingBalanceAsOf(asOf); // Calculates the available saving balance.
         if (amount > savingBalance)
         {
             throw InsufficientBalanceException(); // Throws an exception if the withdrawal amount exceeds the saving balance.
@@ -50,10 +64,33 @@ void CertificateAccount::withdraw(double amount)
     }
 }
 
+// Renews the certificate at each maturity up to the given time, capitalizing the returns not yet withdrawn.
+double CertificateAccount::rollOver(time_t asOf)
+{
+    double capitalizedAmount = 0; // Stores the total amount added to the deposit.
+    const CertificateAccrualState* state = &prepareAccrualState(); // Gets the creation time and term of the current term.
+    while (state->termPeriods > 0)
+    {
+        time_t maturityTime = state->creationTime + static_cast<time_t>(state->termPeriods) * state->periodSeconds; // Computes when the current term ends.
+        if (asOf < maturityTime)
+            break; // Stops at a term that has not ended yet.
+        double payout = computeTotalReturns(*state, getBalance(), maturityTime) - withdrawnAmount; // Computes the returns left at maturity.
+        double newBalance = getBalance() + payout; // Adds them to the deposit.
+        setBalance(newBalance); // Sets the renewed deposit.
+        setInterestRatePercent(visitCertificateProduct(productID, [newBalance](auto policy) { return policy.getRatePercent(newBalance); })); // Sets the rate of the tier the renewed deposit reaches.
+        setWithdrawnAmount(0); // Nothing has been withdrawn from the new term.
+        setCreationDateTime(maturityTime); // Starts the new term at the maturity.
+        capitalizedAmount += payout; // Counts the capitalized returns.
+        state = &prepareAccrualState(); // Prepares the state of the new term from its creation date-time.
+    }
+    return capitalizedAmount; // Returns the total amount added to the deposit.
+}
+
 // Sets the interest rate percentage for the certificate account.
 void CertificateAccount::setInterestRatePercent(double interestRatePercentArgument)
 {
     interestRatePercent = interestRatePercentArgument; // Assigns the provided interest rate.
+    accrualStateReady = false; // Prepares the accrual state again with the new rate.
 }
 
 // Sets the total withdrawn amount for the certificate account.
@@ -62,37 +99,44 @@ void CertificateAccount::setWithdrawnAmount(double withdrawnAmountArgument)
     withdrawnAmount = withdrawnAmountArgument; // Assigns the provided withdrawn amount.
 }
 
-// Calculates the available saving balance by subtracting the withdrawn amount from the total returns.
-double CertificateAccount::getSavingBalance() const
+// Sets the catalog product of the certificate account.
+void CertificateAccount::setProductID(CertificateProductID productIDArgument)
 {
-    double totalProfit = getTotalReturns(); // Calculates the total returns based on interest.
+    productID = productIDArgument; // Assigns the provided product.
+    accrualStateReady = false; // Prepares the accrual state again with the new product's tables.
+}
+
+// Calculates the available saving balance at the given time by subtracting the withdrawn amount from the total returns.
+double CertificateAccount::getSavingBalanceAsOf(time_t asOf) const
+{
+    double totalProfit = getTotalReturnsAsOf(asOf); // Calculates the total returns based on interest.
     return totalProfit - withdrawnAmount; // Returns the remaining balance after withdrawals.
 }
 
-// Calculates the number of years since the account's creation based on the provided date-time string.
-int getYearsAfterCreation(string dateTimeString)
+// Prepares the accrual state once: the creation date-time is parsed and the product's growth factors are looked up
+// only on the first returns calculation of the account.
+CertificateAccrualState& CertificateAccount::prepareAccrualState() const
+{
+    if (!accrualStateReady)
+    {
+        time_t creationTime = convertDateTimeStringToTime(getDateTime()); // Parses the creation date-time without copying it.
+        double ratePercent = interestRatePercent; // Copies the rate so the policy does not capture the account.
+        accrualState = visitCertificateProduct(productID, [ratePercent, creationTime](auto policy) { return policy.getAccrualState(ratePercent, creationTime); }); // Prepares the state with the product's policy.
+        accrualStateReady = true; // Reuses the state until the rate or product changes.
+    }
+    return accrualState; // Returns the prepared state.
+}
+
+// Takes over an accrual state prepared earlier for the same account.
+void CertificateAccount::restoreAccrualState(const CertificateAccrualState& state)
 {
-    time_t now; // Stores the current time.
-    time_t creationYear; // Stores the account's creation timestamp.
-    struct tm datetime; // Structure to hold the broken-down time.
-    vector<string> dateTimeVector = convertDateTimeStringToDateTimeVector(dateTimeString); // Converts the date-time string to a vector of time components.
-    now = time(NULL); // Gets the current timestamp.
-    datetime.tm_year = stoi(dateTimeVector[0]); // Sets the year from the date-time vector.
-    datetime.tm_mon = stoi(dateTimeVector[1]); // Sets the month.
-    datetime.tm_mday = stoi(dateTimeVector[2]); // Sets the day.
-    datetime.tm_hour = stoi(dateTimeVector[3]); // Sets the hour.
-    datetime.tm_min = stoi(dateTimeVector[4]); // Sets the minute.
-    datetime.tm_sec = stoi(dateTimeVector[5]); // Sets the second.
-    creationYear = mktime(&datetime); // Converts the time structure to a timestamp.
-    int yearsAfterCreation = difftime(now, creationYear) / SECONDS_IN_A_YEAR; // Calculates the years since creation.
-    return yearsAfterCreation; // Returns the number of years.
+    accrualState = state; // Copies the state, including the cached returns.
+    accrualStateReady = true; // Uses it instead of preparing a new one.
 }
 
-// Calculates the total returns for the certificate account based on the base balance, years since creation, and interest rate.
-double CertificateAccount::getTotalReturns() const
+// Calculates the total returns for the certificate account as of the given time, from the base balance and the accrual state.
+// Reuses the returns cached by an earlier call until the next accrual boundary passes.
+double CertificateAccount::getTotalReturnsAsOf(time_t asOf) const
 {
-    double baseBalance = getBalance(); // Retrieves the initial account balance.
-    string dateTimeString = getDateTime(); // Gets the account's creation date-time string.
-    int yearsAfterCreation = getYearsAfterCreation(dateTimeString); // Calculates the years since creation.
-    return (baseBalance * yearsAfterCreation * (static_cast<double>(interestRatePercent) / 100)); // Returns the total returns using the interest formula.
+    return getAccruedReturns(prepareAccrualState(), getBalance(), asOf); // Looks the growth factor up and applies it to the base balance if a boundary passed.
 }
\ No newline at end of file
@@ -13,12 +13,19 @@
 #include <vector>
 #include "BankAccount.h"
 #include "Constants.h"
+#include "ProductCatalog.h"
 
 class CertificateAccount : public BankAccount
 {
 private:
 	double interestRatePercent;  // Stores the interest rate as a percentage (e.g., 50% is stored as 50.0)
 	double withdrawnAmount;      // Stores the total amount already withdrawn from the account's returns
+	CertificateProductID productID; // Stores the catalog product the account was opened as
+	mutable CertificateAccrualState accrualState; // Caches the creation time, growth factors and last returns, prepared on the first returns calculation
+	mutable bool accrualStateReady; // Set once the accrual state is prepared; cleared when the rate or product changes
+
+	// Returns the accrual state, preparing it from the product, rate and creation date-time on first use
+	CertificateAccrualState& prepareAccrualState() const;
 
 	// Sets the interest rate percentage
 	void setInterestRatePercent(double);
@@ -26,6 +33,9 @@ private:
 	// Sets the withdrawn amount (with validation)
 	void setWithdrawnAmount(double);
 
+	// Sets the catalog product of the account
+	void setProductID(CertificateProductID);
+
 public:
 	// Default constructor
 	CertificateAccount();
@@ -39,6 +49,14 @@ public:
 	*/
 	CertificateAccount(const Person&, double, double, double);
 
+	/*
+		Parameterized constructor for a new certificate of the given catalog product:
+		the interest rate is the rate of the product tier the initial deposit reaches,
+		and nothing has been withdrawn yet.
+		Throws an InsufficientBalanceException if the deposit is below the product's minimum.
+	*/
+	CertificateAccount(const Person&, double, CertificateProductID);
+
 	// Inline getter for the interest rate
 	double getInterestRate() const
 	{
@@ -51,30 +69,60 @@ public:
 		return withdrawnAmount;
 	}
 
+	// Inline getter for the catalog product
+	CertificateProductID getProductID() const
+	{
+		return productID;
+	}
+
 	/*
-		Calculates the total interest earned since the account was created.
-		Formula: (years since creation) * (initial deposit) * (interestRatePercent / 100)
+		Calculates the total interest earned since the account was created, as of the given time,
+		with a table lookup and a multiply.
+		Formula: (initial deposit) * (growth factor of the account's tier after the periods accrued, capped at the term) - (initial deposit)
+		For simple interest the growth factor is 1 + periods * (interestRatePercent / 100).
+		The result is cached until the next accrual boundary, so repeated calls in between only compare times.
 	*/
-	double getTotalReturns() const;
+	double getTotalReturnsAsOf(time_t) const;
+
+	// Returns the accrual state with the returns cached so far, preparing it if needed
+	const CertificateAccrualState& getAccrualState() const
+	{
+		return prepareAccrualState();
+	}
+
+	/*
+		Takes over an accrual state prepared earlier for this account, such as one kept by the accrual cache,
+		so the creation date-time is not parsed again and the cached returns are reused.
+	*/
+	void restoreAccrualState(const CertificateAccrualState&);
 
 	/*
-		Calculates the remaining available interest (savings) by subtracting
+		Calculates the remaining available interest (savings) as of the given time by subtracting
 		the withdrawn amount from the total interest returns.
 		Formula: totalReturns - withdrawnAmount
 	*/
-	double getSavingBalance() const;
+	double getSavingBalanceAsOf(time_t) const;
+
+	/*
+		Withdraws from the interest balance available at the given time (with validation).
+		Called directly or through AccountVariant, never virtually.
+	*/
+	void withdraw(double, time_t);
 
 	/*
-		Overrides the pure virtual withdraw function from BankAccount.
-		Withdraws from the available interest balance (with validation).
+		Renews the certificate for every term that ended by the given time:
+		the returns not yet withdrawn are added to the deposit, the rate becomes the rate of the tier
+		the new deposit reaches, and the next term starts at the maturity of the last one.
+		Classic certificates have no term and are never renewed.
+		Returns the amount added to the deposit, or 0 if no term ended.
 	*/
-	void withdraw(double) override;
+	double rollOver(time_t);
 
 	/*
 		Friend function declaration to allow access to the protected members of the base class
 		(setAccountID and setDateTime). Used to convert a vector of strings (data of the account) into a CertificateAccount object.
 	*/
-	friend CertificateAccount convertAccountVectorToCertificateAccountObject(vector<string>&);
+	friend CertificateAccount convertAccountVectorToCertificateAccountObject(const vector<string>&);
 };
 
 #endif
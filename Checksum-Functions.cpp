@@ -0,0 +1,103 @@
+#include <cstring>
+#include "Checksum-Functions.h"
+
+// Enables the hardware CRC32 instruction only on x86-64 processors, where SSE4.2 provides it.
+#if defined(__x86_64__) || defined(_M_X64)
+#define CRC32C_X86
+#include <nmmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// GCC and Clang need the hardware function marked so it can use SSE4.2 without compiling the whole file for it.
+#if defined(__GNUC__) || defined(__clang__)
+#define CRC32C_TARGET_SSE42 __attribute__((target("sse4.2")))
+#else
+#define CRC32C_TARGET_SSE42
+#endif
+
+using namespace std;
+
+// The CRC32C polynomial in reflected (least significant bit first) form.
+static const uint32_t CRC32C_POLYNOMIAL = 0x82F63B78;
+
+// Signature shared by the implementations: updates a raw (not inverted) checksum with a block of bytes.
+typedef uint32_t (*CRC32CUpdater)(uint32_t, const unsigned char*, size_t);
+
+// Holds the checksum of every possible byte value, built once at startup.
+struct CRC32CTable
+{
+    uint32_t entries[256];
+
+    CRC32CTable()
+    {
+        for (uint32_t byte = 0; byte < 256; byte++)
+        {
+            uint32_t crc = byte; // Starts with the byte value.
+            for (int bit = 0; bit < 8; bit++)
+                crc = (crc & 1) ? (crc >> 1) ^ CRC32C_POLYNOMIAL : crc >> 1; // Divides by the polynomial one bit at a time.
+            entries[byte] = crc; // Stores the checksum of the byte.
+        }
+    }
+};
+
+// Updates the checksum one byte at a time using the lookup table.
+static uint32_t updateCRC32CTable(uint32_t crc, const unsigned char* data, size_t size)
+{
+    static const CRC32CTable table; // Builds the lookup table on first use.
+    for (size_t i = 0; i < size; i++)
+        crc = table.entries[(crc ^ data[i]) & 0xFF] ^ (crc >> 8); // Folds the next byte into the checksum.
+    return crc;
+}
+
+#ifdef CRC32C_X86
+// Updates the checksum eight bytes at a time using the SSE4.2 CRC32 instruction.
+CRC32C_TARGET_SSE42 static uint32_t updateCRC32CHardware(uint32_t crc, const unsigned char* data, size_t size)
+{
+    uint64_t crc64 = crc; // Holds the checksum in the width used by the 64-bit instruction.
+    for (; size >= 8; size -= 8, data += 8)
+    {
+        uint64_t word; // Stores the next eight bytes.
+        memcpy(&word, data, sizeof(word)); // Loads them without assuming alignment.
+        crc64 = _mm_crc32_u64(crc64, word); // Folds the eight bytes into the checksum.
+    }
+    crc = static_cast<uint32_t>(crc64); // Returns to the 32-bit checksum.
+    for (; size > 0; size--, data++)
+        crc = _mm_crc32_u8(crc, *data); // Folds the remaining bytes one at a time.
+    return crc;
+}
+
+// Returns true if the processor supports SSE4.2.
+static bool cpuSupportsSSE42()
+{
+#ifdef _MSC_VER
+    int info[4]; // Stores the EAX, EBX, ECX and EDX registers returned by CPUID.
+    __cpuid(info, 1); // Reads the basic feature flags.
+    return (info[2] & (1 << 20)) != 0; // Checks the SSE4.2 bit.
+#else
+    return __builtin_cpu_supports("sse4.2"); // Asks the compiler runtime.
+#endif
+}
+#endif
+
+// Picks the hardware implementation when available and the table otherwise.
+static CRC32CUpdater selectUpdater()
+{
+#ifdef CRC32C_X86
+    if (cpuSupportsSSE42())
+        return updateCRC32CHardware;
+#endif
+    return updateCRC32CTable;
+}
+
+// Holds the implementation chosen once at startup.
+static const CRC32CUpdater updateCRC32C = selectUpdater();
+
+// Computes the CRC32C checksum of a block, continuing from a previous checksum if one is given.
+uint32_t computeCRC32C(const void* data, size_t size, uint32_t previousChecksum)
+{
+    uint32_t crc = ~previousChecksum; // Undoes the final inversion of the previous checksum (or starts from all ones).
+    crc = updateCRC32C(crc, static_cast<const unsigned char*>(data), size); // Folds the block into the checksum.
+    return ~crc; // Applies the final inversion.
+}
@@ -0,0 +1,22 @@
+// This file contains the declarations of the checksum functions
+// used to detect corrupted or partially written data files.
+
+// These are the include guards
+#pragma once
+#ifndef CHECKSUMFUNCTIONS_H
+#define CHECKSUMFUNCTIONS_H
+
+#include <cstdint>
+#include <cstddef>
+using namespace std;
+
+/*
+	Computes the CRC32C (Castagnoli) checksum of a block of bytes.
+	Uses the SSE4.2 CRC32 instruction when the processor supports it and a lookup table otherwise;
+	both produce the same value.
+	The optional third argument continues a checksum returned by a previous call,
+	so data can be checksummed in several pieces.
+*/
+uint32_t computeCRC32C(const void*, size_t, uint32_t = 0);
+
+#endif
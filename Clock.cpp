@@ -0,0 +1,86 @@
+#include <cstdlib>
+#include <atomic>
+#include "Clock.h"
+#include "Numeric-Functions.h"
+
+using namespace std;
+
+// Holds the clock injected with setProgramClock, or nullptr for the default clock.
+static atomic<const Clock*> injectedClock(nullptr);
+
+// Holds the instant of the current operation, or -1 before the first one is captured.
+static atomic<time_t> operationTime(-1);
+
+// Returns the system time.
+time_t SystemClock::now() const
+{
+    return time(NULL); // Reads the system time.
+}
+
+// Constructor that sets the fixed clock to the given instant.
+FixedClock::FixedClock(time_t instantArgument) : instant(instantArgument)
+{
+}
+
+// Moves the fixed clock to the given instant.
+void FixedClock::setInstant(time_t instantArgument)
+{
+    instant = instantArgument; // Assigns the provided instant.
+}
+
+// Returns the default clock: a fixed clock if BANK_FIXED_CLOCK holds a timestamp, otherwise the system clock.
+static const Clock& getDefaultClock()
+{
+    static SystemClock systemClock; // Holds the system clock.
+    static FixedClock fixedClock(0); // Holds the fixed clock, used if the environment variable is set.
+    static bool useFixedClock = []()
+        {
+            const char* setting = getenv("BANK_FIXED_CLOCK"); // Reads the environment variable.
+            if (setting == nullptr || *setting == '\0')
+                return false; // Uses the system clock.
+            try
+            {
+                fixedClock.setInstant(static_cast<time_t>(parseLongLong(setting))); // Sets the fixed clock to the timestamp.
+                return true;
+            }
+            catch (...)
+            {
+                return false; // Ignores a value that is not a number.
+            }
+        }(); // Reads the environment variable once.
+    if (useFixedClock)
+        return fixedClock;
+    return systemClock;
+}
+
+// Returns the injected clock, or the default clock if none is injected.
+const Clock& getProgramClock()
+{
+    const Clock* clock = injectedClock.load(memory_order_acquire); // Gets the injected clock.
+    if (clock != nullptr)
+        return *clock;
+    return getDefaultClock();
+}
+
+// Injects the clock the program reads the time from.
+void setProgramClock(const Clock* clock)
+{
+    injectedClock.store(clock, memory_order_release); // Replaces the clock; nullptr restores the default one.
+}
+
+// Reads the program clock once and keeps the instant for the current operation.
+time_t captureOperationTime()
+{
+    time_t instant = getProgramClock().now(); // Reads the clock.
+    operationTime.store(instant, memory_order_release); // Keeps the instant for the operation.
+    return instant;
+}
+
+// Returns the instant of the current operation.
+time_t getOperationTime()
+{
+    time_t instant = operationTime.load(memory_order_acquire); // Gets the captured instant.
+    if (instant == -1)
+        return captureOperationTime(); // Captures one if no operation has started yet.
+    return instant;
+}
@@ -0,0 +1,78 @@
+// This is the specification file for the Clock classes, which give the program the current time.
+// The time is read from the program clock once at the start of each menu operation, and every return,
+// report row and batch job of the operation is evaluated as of that instant,
+// so results are consistent across accounts and a fixed clock can replay a chosen date.
+
+// These are the include guards
+#pragma once
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <ctime>
+using namespace std;
+
+// A source of the current time
+class Clock
+{
+public:
+	// Virtual destructor, clocks are used through base class references
+	virtual ~Clock() = default;
+
+	// Returns the current time
+	virtual time_t now() const = 0;
+};
+
+// A clock that reads the system time
+class SystemClock : public Clock
+{
+public:
+	// Returns the system time
+	time_t now() const override;
+};
+
+// A clock that always returns the instant it was set to, for replaying a date or comparing runs
+class FixedClock : public Clock
+{
+private:
+	time_t instant; // Holds the instant the clock returns
+
+public:
+	// Constructor that sets the clock to the given instant
+	explicit FixedClock(time_t);
+
+	// Moves the clock to the given instant
+	void setInstant(time_t);
+
+	// Returns the instant the clock is set to
+	time_t now() const override
+	{
+		return instant;
+	}
+};
+
+/*
+	Returns the clock the program reads the time from.
+	This is the system clock, unless the BANK_FIXED_CLOCK environment variable holds a timestamp,
+	which gives a fixed clock at that instant, or another clock was injected with setProgramClock.
+*/
+const Clock& getProgramClock();
+
+/*
+	Injects the clock the program reads the time from, which must outlive its use.
+	nullptr restores the default clock.
+*/
+void setProgramClock(const Clock*);
+
+/*
+	Reads the program clock once and keeps the instant as the time of the current operation.
+	Called at the start of each menu operation; returns the captured instant.
+*/
+time_t captureOperationTime();
+
+/*
+	Returns the instant captured for the current operation, capturing it first if none was.
+	Cheap enough to call per account, and safe to call from the worker threads of the operation.
+*/
+time_t getOperationTime();
+
+#endif
@@ -21,13 +21,22 @@ const int MIN_AGE = 18, MAX_AGE = 100;
 	The minimum initial deposit required to create an account.
 	Accounts cannot be created with a balance lower than this value.
 */
-const double MIN_BALANCE = 1000;
+constexpr double MIN_BALANCE = 1000;
 
 /*
-	The fixed interest rate (as a percentage) applied to all new certificate accounts.
+	The fixed interest rate (as a percentage) of Classic certificate accounts.
+	The other certificate products take their rates from the catalog in ProductCatalog.h.
 	For example, a value of 50 means 50% interest rate.
 */
-const double INTEREST_RATE_PERCENT = 25;
+constexpr double INTEREST_RATE_PERCENT = 25;
+
+/*
+	The number of fields of an account vector and of a line of the Accounts.csv file:
+	{accountID, nationalID, balance, date-time, interest rate, withdrawn amount, product}
+	The last three are empty for saving accounts. Lines written before the product field existed
+	have one field less and are padded when they are read.
+*/
+const int ACCOUNT_FIELD_COUNT = 7;
 
 /*
 	The number of seconds in a year.
@@ -36,4 +45,162 @@ const double INTEREST_RATE_PERCENT = 25;
 */
 const int SECONDS_IN_A_YEAR = 31622400;
 
+// The number of seconds in a day, the length of the business day posted by the end-of-day batch.
+const int SECONDS_IN_A_DAY = 86400;
+
+/*
+	The lower bound (inclusive) of each age band used by the bank-wide report.
+	Each band ends one year before the next band starts; the last band ends at MAX_AGE.
+*/
+const int AGE_BAND_COUNT = 6;
+const int AGE_BAND_LOWER_BOUNDS[AGE_BAND_COUNT] = { 18, 25, 35, 45, 55, 65 };
+
+/*
+	The number of records handed to one task when the bank-wide report
+	splits the persons and accounts vectors across worker threads.
+*/
+const int REPORT_PARTITION_SIZE = 16384;
+
+/*
+	The number of snapshots of the account version table that can be open at once.
+	Each open snapshot pins one slot; a reader finding every slot taken waits for one to be released.
+*/
+const int ACCOUNT_SNAPSHOT_SLOT_COUNT = 64;
+
+/*
+	The number of accounts in one partition of an end-of-day batch job.
+	Each partition runs as one task and is checkpointed when it finishes,
+	so an interrupted run repeats at most one partition per worker thread.
+*/
+const int BATCH_PARTITION_SIZE = 65536;
+
+/*
+	The number of transactions the queue of each worker of the transaction processor holds.
+	Producers wait when the queue of the account's worker is full, so memory stays bounded if the workers fall behind.
+*/
+const int TRANSACTION_QUEUE_CAPACITY = 4096;
+
+/*
+	The number of years after which a saving account left at the minimum balance
+	is reported as dormant by the end-of-day batch.
+*/
+const int DORMANT_ACCOUNT_YEARS = 2;
+
+/*
+	The paths of the data files, relative to the working directory of the program.
+	The CSV files are the import/export format; the snapshot is the binary copy loaded at startup;
+	the account table holds the latest account balances, updated in place after every change;
+	the person journal holds the person changes made since Persons.csv was last written;
+	the end-of-day checkpoint holds the progress of an end-of-day batch run until it completes.
+*/
+const char* const PERSONS_CSV_FILE_PATH = "./CSVs/Persons.csv";
+const char* const ACCOUNTS_CSV_FILE_PATH = "./CSVs/Accounts.csv";
+const char* const SNAPSHOT_FILE_PATH = "./CSVs/Bank.snapshot";
+const char* const ACCOUNT_TABLE_FILE_PATH = "./CSVs/Accounts.table";
+const char* const ACCOUNT_PAGES_FILE_PATH = "./CSVs/Accounts.pages";
+const char* const ACCOUNT_LSM_DIRECTORY_PATH = "./CSVs/Accounts.lsm";
+const char* const PERSON_JOURNAL_FILE_PATH = "./CSVs/Persons.journal";
+const char* const END_OF_DAY_CHECKPOINT_FILE_PATH = "./CSVs/EndOfDay.checkpoint";
+
+/*
+	The number of payload bytes covered by each CRC32C checksum in the snapshot file.
+	A corrupted snapshot is detected by the first block whose checksum does not match.
+*/
+const int SNAPSHOT_BLOCK_SIZE = 1 << 20;
+
+/*
+	The number of changes to persons and accounts after which a snapshot is taken in the background,
+	so that a restart after a crash loads a recent snapshot instead of reimporting the CSV files.
+*/
+const int BACKGROUND_SNAPSHOT_CHANGE_INTERVAL = 1000;
+
+/*
+	The number of person changes the person journal holds before it is folded into Persons.csv.
+	Replaying a longer journal slows the start after a crash; folding it more often rewrites the file more often.
+*/
+const int PERSON_JOURNAL_CHECKPOINT_RECORD_COUNT = 10000;
+
+/*
+	The stores that can persist account changes between two saves:
+	- MappedTable: one fixed-size record per account in a memory-mapped file
+	- PagedBTree: a B+tree of fixed-size pages read through a bounded buffer pool,
+	  so only the pages in use need to be in memory
+	- LogStructured: an LSM tree that appends every change to a log and a memtable,
+	  for workloads dominated by deposits and withdrawals
+*/
+enum class AccountStoreBackend { MappedTable, PagedBTree, LogStructured };
+
+// The store used by the program.
+const AccountStoreBackend ACCOUNT_STORE_BACKEND = AccountStoreBackend::PagedBTree;
+
+// The size of one page of the paged account store, in bytes.
+const int STORAGE_PAGE_SIZE = 4096;
+
+/*
+	The number of pages the buffer pool of the paged account store keeps in memory.
+	When it is full, the CLOCK algorithm evicts a page that was not used since the last sweep.
+*/
+const int BUFFER_POOL_FRAME_COUNT = 256;
+
+// The number of accounts a memtable of the LSM account store holds before it is written as a sorted run.
+const int LSM_MEMTABLE_RECORD_LIMIT = 1 << 16;
+
+/*
+	The number of full memtables allowed to wait for the background thread.
+	Writers pause when it is reached, so memory stays bounded if the disk falls behind.
+*/
+const int LSM_MAX_IMMUTABLE_MEMTABLES = 2;
+
+/*
+	The number of sorted runs above which the background thread merges them into one.
+	A point read checks at most this many runs (plus one while a merge is running).
+*/
+const int LSM_MAX_RUN_COUNT = 4;
+
+// The number of bloom filter bits per account in a sorted run, giving about 1% false positives.
+const int LSM_BLOOM_BITS_PER_KEY = 10;
+
+// The number of records per block of a sorted run; a point read reads one block.
+const int LSM_RUN_BLOCK_RECORD_COUNT = 64;
+
+/*
+	When a person or account change is reported as saved:
+	- AcknowledgeOnEnqueue: as soon as it is queued for the persistence thread,
+	  so the menu never waits for the disk; a crash can lose the changes still in the queue
+	- AcknowledgeOnSync: once the persistence thread has written it and forced it to the disk,
+	  together with the other changes queued at the same time
+*/
+enum class DurabilityPolicy { AcknowledgeOnEnqueue, AcknowledgeOnSync };
+
+// The policy used by the program.
+const DurabilityPolicy PERSISTENCE_DURABILITY_POLICY = DurabilityPolicy::AcknowledgeOnEnqueue;
+
+/*
+	The number of changes the persistence queue holds (rounded up to a power of two).
+	When it is full, the menu waits for the persistence thread to make room.
+*/
+const int PERSISTENCE_QUEUE_CAPACITY = 1024;
+
+/*
+	Whether the journal and snapshot writers submit their writes through io_uring on Linux.
+	When it is false or the kernel refuses io_uring, a thread pool of IO_FALLBACK_THREAD_COUNT threads
+	issues the writes with pwrite instead.
+*/
+const bool USE_IO_URING = true;
+const int IO_FALLBACK_THREAD_COUNT = 4;
+
+// The size and number of the buffers through which the person journal is written
+const size_t JOURNAL_IO_BUFFER_SIZE = 1 << 16;
+const size_t JOURNAL_IO_BUFFER_COUNT = 4;
+
+// The size and number of the buffers through which snapshots are written, so a large snapshot goes out in batches of 8 MB
+const size_t SNAPSHOT_IO_BUFFER_SIZE = 1 << 20;
+const size_t SNAPSHOT_IO_BUFFER_COUNT = 8;
+
+/*
+	The size of the chunks the person text arena stores names and phone numbers in.
+	Loads reserve a single chunk for all the text they bring, so this only matters for persons added later.
+*/
+const size_t PERSON_TEXT_ARENA_CHUNK_SIZE = 1 << 16;
+
 #endif
@@ -7,52 +7,83 @@
 #include "CertificateAccount.h"
 #include "SavingAccount.h"
 #include "BankAccount.h"
+#include "Numeric-Functions.h"
+#include "DateTime-Functions.h"
+#include "Exceptions.h"
 
 // Converts a Person object to a CSV-formatted string.
 // Combines national ID, name, age, and phone number with commas.
 string convertPersonObjectToCSVString(const Person& personObjectArgument)
 {
     string csvString; // Stores the resulting CSV string.
-    csvString.append(to_string(personObjectArgument.getNationalID())); // Appends the national ID.
+    appendInteger(csvString, personObjectArgument.getNationalID()); // Appends the national ID.
     csvString.push_back(','); // Adds a comma separator.
     csvString.append(personObjectArgument.getName()); // Appends the name.
     csvString.push_back(','); // Adds a comma separator.
-    csvString.append(to_string(personObjectArgument.getAge())); // Appends the age.
+    appendInteger(csvString, personObjectArgument.getAge()); // Appends the age.
     csvString.push_back(','); // Adds a comma separator.
     csvString.append(personObjectArgument.getPhoneNumber()); // Appends the phone number.
     return csvString; // Returns the formatted CSV string.
 }
 
+// Converts a Person object to a table row holding its fields.
+vector<string> convertPersonObjectToTableRow(const Person& personObjectArgument)
+{
+    vector<string> row; // Stores the resulting row.
+    row.reserve(4); // Allocates the row once.
+    row.push_back(formatInteger(personObjectArgument.getNationalID())); // Adds the national ID.
+    row.emplace_back(personObjectArgument.getName()); // Adds the name.
+    row.push_back(formatInteger(personObjectArgument.getAge())); // Adds the age.
+    row.emplace_back(personObjectArgument.getPhoneNumber()); // Adds the phone number.
+    return row; // Returns the row.
+}
+
+// Returns the field buffer of the calling thread, reused between calls to avoid reallocating it for every line.
+static vector<CSVField>& getLineFieldsBuffer()
+{
+    thread_local vector<CSVField> fields; // Stores the fields of the last line split on this thread.
+    return fields;
+}
+
 // Converts a CSV string to a vector of strings.
-// Splits the string at commas to extract individual fields.
+// Splits the string at commas using the vectorized tokenizer, then copies each field into the vector.
 vector<string> convertCSVStringToVector(const string& csvString)
 {
-    vector<string> stringVector; // Stores the resulting vector of fields.
-    int startPosition = 0; // Tracks the start of the current substring.
-    size_t commaPosition = csvString.find(',', startPosition); // Finds the next comma.
-    while (commaPosition != string::npos)
-    {
-        string tempString = csvString.substr(startPosition, commaPosition - startPosition); // Extracts the substring from startPosition to one position before next comma.
-        stringVector.push_back(tempString); // Adds the substring to the vector.
-        startPosition = commaPosition + 1; // Updates the start position.
-        commaPosition = csvString.find(',', startPosition); // Finds the next comma.
-    }
+    vector<CSVField>& fields = getLineFieldsBuffer(); // Gets the reusable field buffer.
+    splitCSVLine(csvString, fields); // Finds the position of every field.
+    return convertCSVFieldsToVector(csvString, fields.data(), fields.size()); // Copies the fields into a vector.
+}
 
-    string tempString = csvString.substr(startPosition, commaPosition - startPosition); // Extracts the final substring.
-    stringVector.push_back(tempString); // Adds the final substring to the vector.
+// Converts the fields of one tokenized record to a vector of strings.
+vector<string> convertCSVFieldsToVector(string_view text, const CSVField* fields, size_t fieldCount)
+{
+    vector<string> stringVector; // Stores the resulting vector of fields.
+    stringVector.reserve(fieldCount); // Allocates the vector once for all fields.
+    for (size_t i = 0; i < fieldCount; i++)
+        stringVector.emplace_back(text.substr(fields[i].offset, fields[i].length)); // Copies the field into the vector.
     return stringVector; // Returns the vector of fields.
 }
 
 // Converts a CSV string representing a person to a Person object.
-// Parses the CSV string into a vector and sets the Person object's attributes.
+// Splits the CSV string into fields and sets the Person object's attributes.
 Person convertCSVPersonStringToPersonObject(const string& csvPersonString)
 {
+    vector<CSVField>& fields = getLineFieldsBuffer(); // Gets the reusable field buffer.
+    splitCSVLine(csvPersonString, fields); // Finds the position of every field.
+    return convertCSVFieldsToPersonObject(csvPersonString, fields.data(), fields.size()); // Builds the Person from the fields.
+}
+
+// Converts the fields of one tokenized record to a Person object.
+// Parses the numeric fields in place, so only the name and phone number are copied, into the person text arena.
+Person convertCSVFieldsToPersonObject(string_view text, const CSVField* fields, size_t fieldCount)
+{
+    if (fieldCount < 4)
+        throw IncompletePersonException(); // Throws if the record is missing any of the four person fields.
     Person person; // Creates a new Person object.
-    vector<string> personVector = convertCSVStringToVector(csvPersonString); // Converts the CSV string to a vector.
-    person.setNationalID(stoll(personVector[0])); // Sets the national ID.
-    person.setName(personVector[1]); // Sets the name.
-    person.setAge(stoi(personVector[2])); // Sets the age.
-    person.setPhoneNumber(personVector[3]); // Sets the phone number.
+    person.setNationalID(parseLongLong(text.substr(fields[0].offset, fields[0].length))); // Sets the national ID.
+    person.setName(text.substr(fields[1].offset, fields[1].length)); // Sets the name.
+    person.setAge(parseInt(text.substr(fields[2].offset, fields[2].length))); // Sets the age.
+    person.setPhoneNumber(text.substr(fields[3].offset, fields[3].length)); // Sets the phone number.
     return person; // Returns the initialized Person object.
 }
 
@@ -61,60 +92,61 @@ Person convertCSVPersonStringToPersonObject(const string& csvPersonString)
 vector<string> convertSavingAccountObjectToAccountVector(const SavingAccount& savingAccountObject)
 {
     vector<string> accountVector; // Stores the resulting vector of account data.
-    accountVector.push_back(to_string(savingAccountObject.getAccountID())); // Adds the account ID.
-    accountVector.push_back(to_string(savingAccountObject.getPerson().getNationalID())); // Adds the person's national ID.
-    accountVector.push_back(to_string(savingAccountObject.getBalance())); // Adds the balance.
+    accountVector.push_back(formatInteger(savingAccountObject.getAccountID())); // Adds the account ID.
+    accountVector.push_back(formatInteger(savingAccountObject.getOwnerNationalID())); // Adds the person's national ID.
+    accountVector.push_back(formatDouble(savingAccountObject.getBalance())); // Adds the balance.
     accountVector.push_back(savingAccountObject.getDateTime()); // Adds the creation date-time.
     accountVector.push_back(""); // Adds an empty string for interest rate (certificate-specific).
     accountVector.push_back(""); // Adds an empty string for withdrawn amount (certificate-specific).
+    accountVector.push_back(""); // Adds an empty string for the product (certificate-specific).
     return accountVector; // Returns the account vector.
 }
 
 // Converts a CertificateAccount object to a vector of strings for storage.
-// Includes account ID, national ID, balance, creation date, interest rate, and withdrawn amount.
+// Includes account ID, national ID, balance, creation date, interest rate, withdrawn amount, and product.
 vector<string> convertCertificateAccountObjectToAccountVector(const CertificateAccount& certificateAccountObject)
 {
     vector<string> accountVector; // Stores the resulting vector of account data.
-    accountVector.push_back(to_string(certificateAccountObject.getAccountID())); // Adds the account ID.
-    accountVector.push_back(to_string(certificateAccountObject.getPerson().getNationalID())); // Adds the person's national ID.
-    accountVector.push_back(to_string(certificateAccountObject.getBalance())); // Adds the balance.
+    accountVector.push_back(formatInteger(certificateAccountObject.getAccountID())); // Adds the account ID.
+    accountVector.push_back(formatInteger(certificateAccountObject.getOwnerNationalID())); // Adds the person's national ID.
+    accountVector.push_back(formatDouble(certificateAccountObject.getBalance())); // Adds the balance.
     accountVector.push_back(certificateAccountObject.getDateTime()); // Adds the creation date-time.
-    accountVector.push_back(to_string(certificateAccountObject.getInterestRate())); // Adds the interest rate.
-    accountVector.push_back(to_string(certificateAccountObject.getWithdrawnAmount())); // Adds the withdrawn amount.
+    accountVector.push_back(formatDouble(certificateAccountObject.getInterestRate())); // Adds the interest rate.
+    accountVector.push_back(formatDouble(certificateAccountObject.getWithdrawnAmount())); // Adds the withdrawn amount.
+    accountVector.push_back(formatInteger(static_cast<int>(certificateAccountObject.getProductID()))); // Adds the product.
     return accountVector; // Returns the account vector.
 }
 
 // Converts a vector of strings to a CertificateAccount object.
-// Retrieves the associated Person object and sets all account attributes.
-CertificateAccount convertAccountVectorToCertificateAccountObject(vector<string>& accountVector)
+// Sets all account attributes; the owner is kept by national ID, so the persons vector is not searched.
+CertificateAccount convertAccountVectorToCertificateAccountObject(const vector<string>& accountVector)
 {
     CertificateAccount certificateAccountObject; // Creates a new CertificateAccount object.
-    Person person = searchPerson(stoll(accountVector[1])); // Retrieves the Person object by national ID.
-    certificateAccountObject.setAccountID(stoi(accountVector[0])); // Sets the account ID.
-    certificateAccountObject.setPerson(person); // Sets the associated Person.
-    certificateAccountObject.setBalance(stod(accountVector[2])); // Sets the balance.
+    certificateAccountObject.setAccountID(parseInt(accountVector[0])); // Sets the account ID.
+    certificateAccountObject.setOwnerNationalID(parseLongLong(accountVector[1])); // Sets the owner.
+    certificateAccountObject.setBalance(parseDouble(accountVector[2])); // Sets the balance.
     certificateAccountObject.setTimeDate(accountVector[3]); // Sets the creation date-time.
-    certificateAccountObject.setInterestRatePercent(stod(accountVector[4])); // Sets the interest rate.
-    certificateAccountObject.setWithdrawnAmount(stod(accountVector[5])); // Sets the withdrawn amount.
+    certificateAccountObject.setInterestRatePercent(parseDouble(accountVector[4])); // Sets the interest rate.
+    certificateAccountObject.setWithdrawnAmount(parseDouble(accountVector[5])); // Sets the withdrawn amount.
+    certificateAccountObject.setProductID(parseCertificateProductID(accountVector[6])); // Sets the product.
     return certificateAccountObject; // Returns the initialized CertificateAccount object.
 }
 
 // Converts a vector of strings to a SavingAccount object.
-// Retrieves the associated Person object and sets all account attributes.
-SavingAccount convertAccountVectorToSavingAccountObject(vector<string>& accountVector)
+// Sets all account attributes; the owner is kept by national ID, so the persons vector is not searched.
+SavingAccount convertAccountVectorToSavingAccountObject(const vector<string>& accountVector)
 {
     SavingAccount savingAccountObject; // Creates a new SavingAccount object.
-    savingAccountObject.setAccountID(stoi(accountVector[0])); // Sets the account ID.
-    Person person = searchPerson(stoll(accountVector[1])); // Retrieves the Person object by national ID.
-    savingAccountObject.setPerson(person); // Sets the associated Person.
-    savingAccountObject.setBalance(stod(accountVector[2])); // Sets the balance.
+    savingAccountObject.setAccountID(parseInt(accountVector[0])); // Sets the account ID.
+    savingAccountObject.setOwnerNationalID(parseLongLong(accountVector[1])); // Sets the owner.
+    savingAccountObject.setBalance(parseDouble(accountVector[2])); // Sets the balance.
     savingAccountObject.setTimeDate(accountVector[3]); // Sets the creation date-time.
     return savingAccountObject; // Returns the initialized SavingAccount object.
 }
 
 // Converts a vector of strings to a CSV-formatted string.
 // Joins the vector elements with commas.
-string convertVectorToCSVString(vector<string>& vecObject)
+string convertVectorToCSVString(const vector<string>& vecObject)
 {
     string csvString = ""; // Stores the resulting CSV string.
     for (int i = 0; i < vecObject.size(); i++)
@@ -128,7 +160,7 @@ string convertVectorToCSVString(vector<string>& vecObject)
 
 // Converts a date-time string to a vector of its components.
 // Splits the string at dashes to extract year, month, day, hour, minute, and second.
-vector<string> convertDateTimeStringToDateTimeVector(string& dateTimeString)
+vector<string> convertDateTimeStringToDateTimeVector(const string& dateTimeString)
 {
     vector<string> dateTimeVector; // Stores the resulting vector of date-time components.
     int startPosition = 0; // Tracks the start of the current substring.
@@ -147,19 +179,23 @@ vector<string> convertDateTimeStringToDateTimeVector(string& dateTimeString)
 }
 
 // Converts a date-time vector to a formatted date-time string.
-// Converts the vector components to a time structure and formats it using ctime.
-string convertDateTimeVectorToFormattedDateTimeString(vector<string> dateTimeVector)
+// Formats the components with the calendar arithmetic of the date-time functions, in the format of ctime.
+string convertDateTimeVectorToFormattedDateTimeString(const vector<string>& dateTimeVector)
+{
+    LocalDateTime dateTime; // Structure to hold the broken-down time.
+    dateTime.year = parseInt(dateTimeVector[0]); // Sets the year.
+    dateTime.month = parseInt(dateTimeVector[1]); // Sets the month.
+    dateTime.day = parseInt(dateTimeVector[2]); // Sets the day.
+    dateTime.hour = parseInt(dateTimeVector[3]); // Sets the hour.
+    dateTime.minute = parseInt(dateTimeVector[4]); // Sets the minute.
+    dateTime.second = parseInt(dateTimeVector[5]); // Sets the second.
+    string formattedDateTime; // Stores the formatted date-time string.
+    appendDisplayDateTime(formattedDateTime, dateTime); // Formats the date-time.
+    return formattedDateTime; // Returns the formatted date-time string.
+}
+
+// Converts a date-time string to a timestamp, such as the creation time of an account.
+time_t convertDateTimeStringToTime(const string& dateTimeString)
 {
-    struct tm datetime; // Structure to hold the broken-down time.
-    datetime.tm_year = stoi(dateTimeVector[0]); // Sets the year.
-    datetime.tm_mon = stoi(dateTimeVector[1]); // Sets the month.
-    datetime.tm_mday = stoi(dateTimeVector[2]); // Sets the day.
-    datetime.tm_hour = stoi(dateTimeVector[3]); // Sets the hour.
-    datetime.tm_min = stoi(dateTimeVector[4]); // Sets the minute.
-    datetime.tm_sec = stoi(dateTimeVector[5]); // Sets the second.
-    datetime.tm_isdst = -1; // Indicates daylight saving time is unknown.
-    time_t timestamp = mktime(&datetime); // Converts the time structure to a timestamp.
-    string dateTime = ctime(&timestamp); // Formats the timestamp as a string.
-    dateTime.pop_back(); // Removes the trailing newline.
-    return dateTime; // Returns the formatted date-time string.
+    return convertLocalDateTimeToTime(parseStoredDateTime(dateTimeString)); // Parses the components in place and converts them with the cached timezone offset.
 }
\ No newline at end of file
@@ -8,16 +8,18 @@
 
 #include <vector>
 #include <string>
+#include <ctime>
 #include "Person.h"
 #include "SavingAccount.h"
 #include "CertificateAccount.h"
+#include "Tokenizer-Functions.h"
 using namespace std;
 
 /*
 	Converts a vector of strings into a single CSV-formatted string.
 	Useful for writing structured data to a CSV file.
 */
-string convertVectorToCSVString(vector<string>&);
+string convertVectorToCSVString(const vector<string>&);
 
 /*
 	Converts a Person object into a CSV-formatted string.
@@ -26,6 +28,13 @@ string convertVectorToCSVString(vector<string>&);
 */
 string convertPersonObjectToCSVString(const Person&);
 
+/*
+	Converts a Person object into a table row of its fields for display.
+	Format: nationalID, name, age, phoneNumber
+	Builds the row directly, instead of formatting a CSV string and splitting it again.
+*/
+vector<string> convertPersonObjectToTableRow(const Person&);
+
 /*
 	Converts a CSV-formatted string into a vector of strings,
 	where each vector element represents a field.
@@ -33,15 +42,28 @@ string convertPersonObjectToCSVString(const Person&);
 */
 vector<string> convertCSVStringToVector(const string&);
 
+/*
+	Converts the fields of one tokenized CSV record into a vector of strings.
+	Takes the tokenized text, a pointer to the first field of the record, and the number of fields.
+*/
+vector<string> convertCSVFieldsToVector(string_view, const CSVField*, size_t);
+
 /*
 	Converts a CSV-formatted string containing person data
 	into a Person object.
 */
 Person convertCSVPersonStringToPersonObject(const string&);
 
+/*
+	Converts the fields of one tokenized CSV record containing person data into a Person object.
+	Takes the tokenized text, a pointer to the first field of the record, and the number of fields.
+	Throws an IncompletePersonException if the record has fewer than four fields.
+*/
+Person convertCSVFieldsToPersonObject(string_view, const CSVField*, size_t);
+
 /*
 	Converts a SavingAccount object into a vector of strings.
-	Format: {accountID, nationalID, balance, formatted date, (Empty), (Empty)} 
+	Format: {accountID, nationalID, balance, formatted date, (Empty), (Empty), (Empty)}
 	Empty fields to make the account vector of saving account to be as the same size as the certificate accounts (simplify printing process).
 	Used for storing account data in a structured form.
 */
@@ -50,7 +72,7 @@ vector<string> convertSavingAccountObjectToAccountVector(const SavingAccount&);
 /*
 	Converts a CertificateAccount object into a vector of strings.
 	Format: {accountID, nationalID, balance, formatted date,
-			 interestRatePercent, withdrawnAmount}
+			 interestRatePercent, withdrawnAmount, productID}
 */
 vector<string> convertCertificateAccountObjectToAccountVector(const CertificateAccount&);
 
@@ -58,27 +80,34 @@ vector<string> convertCertificateAccountObjectToAccountVector(const CertificateA
 	Converts a vector of strings containing certificate account data
 	into a CertificateAccount object.
 	Also uses protected base class methods to set internal fields (setAccountID, setTimeDate).
+	Throws an InvalidProductException if the product field is not in the catalog.
 */
-CertificateAccount convertAccountVectorToCertificateAccountObject(vector<string>&);
+CertificateAccount convertAccountVectorToCertificateAccountObject(const vector<string>&);
 
 /*
 	Converts a formatted date-time string into a vector of strings.
 	Format: "Year-Month-Day-Hour-Minute-Second" becomes {Year, Month, Day, Hour, Minute, Second}
 	Note: Year is years since 1900; Month, Day, Hour, Minute, and Second start from 0.
 */
-vector<string> convertDateTimeStringToDateTimeVector(string&);
+vector<string> convertDateTimeStringToDateTimeVector(const string&);
 
 /*
 	Converts a date-time vector (as strings) back into a single formatted string.
 	Format: {Year, Month, Day, Hour, Minute, Second} becomes "Year-Month-Day-Hour-Minute-Second"
 */
-string convertDateTimeVectorToFormattedDateTimeString(vector<string>);
+string convertDateTimeVectorToFormattedDateTimeString(const vector<string>&);
+
+/*
+	Converts a date-time string in the format "Year-Month-Day-Hour-Minute-Second" to a timestamp,
+	reading it as local time.
+*/
+time_t convertDateTimeStringToTime(const string&);
 
 /*
 	Converts a vector of strings containing saving account data
 	into a SavingAccount object.
 	Also uses protected base class methods to set internal fields (setAccountID, setTimeDate).
 */
-SavingAccount convertAccountVectorToSavingAccountObject(vector<string>&);
+SavingAccount convertAccountVectorToSavingAccountObject(const vector<string>&);
 
 #endif
@@ -0,0 +1,267 @@
+#include <climits>
+#include <cstddef>
+#include "DateTime-Functions.h"
+#include "Numeric-Functions.h"
+#include "Exceptions.h"
+
+using namespace std;
+
+// The number of seconds in a calendar day, used to split local seconds into days and times of day.
+static const long long SECONDS_PER_DAY = 86400;
+
+/*
+	The length of the spans the timezone offset is cached for.
+	A span whose offset is the same at both ends is taken to have no daylight saving change;
+	a week is far shorter than the time between two changes.
+*/
+static const long long OFFSET_SPAN_SECONDS = 7 * SECONDS_PER_DAY;
+
+// The number of spans each thread keeps, about forty years of weeks, so the creation dates of every account fit; must be a power of two.
+static const size_t OFFSET_CACHE_SIZE = 2048;
+
+// The names printed by ctime, indexed by day of the week from Sunday and by month from January.
+static const char WEEKDAY_NAMES[7][4] = { "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat" };
+static const char MONTH_NAMES[12][4] = { "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+
+// Holds the timezone offset of one span of time.
+struct OffsetSpan
+{
+    long long spanIndex = LLONG_MIN; // Index of the span, or LLONG_MIN for an empty entry
+    long long offsetSeconds = 0;     // Local time minus UTC at the start of the span
+    bool uniform = false;            // Set if the offset is the same at the end of the span
+};
+
+// Holds the spans each thread has looked up, so threads never share an entry.
+static thread_local OffsetSpan offsetCache[OFFSET_CACHE_SIZE];
+
+// Divides, rounding towards negative infinity, so times before 1970 fall on the right day.
+static long long floorDivide(long long dividend, long long divisor)
+{
+    long long quotient = dividend / divisor; // Divides, rounding towards zero.
+    if ((dividend % divisor != 0) && ((dividend < 0) != (divisor < 0)))
+        quotient--; // Rounds down instead.
+    return quotient;
+}
+
+// Returns the number of days from 1970-01-01 to the given date of the proleptic Gregorian calendar (month from 1).
+static long long convertCivilDateToDays(long long year, int month, int day)
+{
+    year -= month <= 2; // Starts the year in March, so the leap day is the last day of the year.
+    long long era = floorDivide(year, 400); // Finds the 400-year cycle.
+    long long yearOfEra = year - era * 400; // [0, 399]
+    long long dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1; // [0, 365]
+    long long dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear; // [0, 146096]
+    return era * 146097 + dayOfEra - 719468; // Shifts the epoch from 0000-03-01 to 1970-01-01.
+}
+
+// Converts a number of days from 1970-01-01 to the date of the proleptic Gregorian calendar (month from 1).
+static void convertDaysToCivilDate(long long days, long long& year, int& month, int& day)
+{
+    days += 719468; // Shifts the epoch to 0000-03-01.
+    long long era = floorDivide(days, 146097); // Finds the 400-year cycle.
+    long long dayOfEra = days - era * 146097; // [0, 146096]
+    long long yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365; // [0, 399]
+    long long dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100); // [0, 365]
+    long long shiftedMonth = (5 * dayOfYear + 2) / 153; // [0, 11], from March
+    day = static_cast<int>(dayOfYear - (153 * shiftedMonth + 2) / 5 + 1); // [1, 31]
+    month = static_cast<int>(shiftedMonth < 10 ? shiftedMonth + 3 : shiftedMonth - 9); // [1, 12]
+    year = yearOfEra + era * 400 + (month <= 2); // Moves January and February back to their calendar year.
+}
+
+// Returns the seconds from 1970-01-01 00:00:00 to the date-time, read as if it were UTC, carrying over out-of-range components.
+static long long convertLocalDateTimeToLocalSeconds(const LocalDateTime& dateTime)
+{
+    long long year = 1900LL + dateTime.year + floorDivide(dateTime.month, 12); // Carries the months over to the year.
+    int month = static_cast<int>(dateTime.month - floorDivide(dateTime.month, 12) * 12) + 1; // [1, 12]
+    long long days = convertCivilDateToDays(year, month, 1) + dateTime.day - 1; // Carries the days over to the month.
+    return days * SECONDS_PER_DAY + dateTime.hour * 3600LL + dateTime.minute * 60LL + dateTime.second; // Carries the times over to the day.
+}
+
+// Breaks local seconds down into a date-time, also returning the day of the week (0 for Sunday).
+static LocalDateTime convertLocalSecondsToLocalDateTime(long long localSeconds, int& weekday)
+{
+    long long days = floorDivide(localSeconds, SECONDS_PER_DAY); // Finds the day.
+    long long secondOfDay = localSeconds - days * SECONDS_PER_DAY; // [0, 86399]
+    long long year; // Stores the calendar year.
+    int month, day; // Stores the month from 1 and the day of the month.
+    convertDaysToCivilDate(days, year, month, day); // Finds the date.
+    weekday = static_cast<int>(days + 4 - floorDivide(days + 4, 7) * 7); // 1970-01-01 was a Thursday.
+    LocalDateTime dateTime; // Stores the result.
+    dateTime.year = static_cast<int>(year - 1900); // Counts the years from 1900.
+    dateTime.month = month - 1; // Counts the months from January.
+    dateTime.day = day;
+    dateTime.hour = static_cast<int>(secondOfDay / 3600);
+    dateTime.minute = static_cast<int>(secondOfDay / 60 % 60);
+    dateTime.second = static_cast<int>(secondOfDay % 60);
+    return dateTime;
+}
+
+// Converts a timestamp to the local broken-down time with the C library.
+static struct tm convertTimeToLocalTm(time_t timestamp)
+{
+    struct tm datetime; // Stores the local time structure.
+#ifdef _WIN32
+    localtime_s(&datetime, &timestamp); // Converts the timestamp to local time without the shared static buffer of localtime.
+#else
+    localtime_r(&timestamp, &datetime); // Converts the timestamp to local time without the shared static buffer of localtime.
+#endif
+    return datetime;
+}
+
+// Returns local time minus UTC at the given timestamp, asking the C library.
+static long long computeTimezoneOffset(long long timestamp)
+{
+    struct tm datetime = convertTimeToLocalTm(static_cast<time_t>(timestamp)); // Gets the local time.
+    LocalDateTime dateTime = { datetime.tm_year, datetime.tm_mon, datetime.tm_mday, datetime.tm_hour, datetime.tm_min, datetime.tm_sec };
+    return convertLocalDateTimeToLocalSeconds(dateTime) - timestamp; // Compares it with UTC.
+}
+
+// Returns the cached offset of the span holding the timestamp, asking the C library only the first time this thread meets the span.
+static OffsetSpan getOffsetSpan(long long timestamp)
+{
+    long long spanIndex = floorDivide(timestamp, OFFSET_SPAN_SECONDS); // Finds the span.
+    OffsetSpan& span = offsetCache[static_cast<size_t>(spanIndex) & (OFFSET_CACHE_SIZE - 1)]; // Finds its entry.
+    if (span.spanIndex != spanIndex)
+    {
+        long long spanStart = spanIndex * OFFSET_SPAN_SECONDS; // Stores the first second of the span.
+        long long startOffset = computeTimezoneOffset(spanStart); // Gets the offset at its start.
+        long long endOffset = computeTimezoneOffset(spanStart + OFFSET_SPAN_SECONDS - 1); // Gets the offset at its end.
+        span.spanIndex = spanIndex; // Replaces the entry.
+        span.offsetSeconds = startOffset;
+        span.uniform = startOffset == endOffset; // A daylight saving change makes the span fall back to the C library.
+    }
+    return span; // Returns a copy, so a later lookup cannot change it.
+}
+
+/*
+	Converts local seconds to a timestamp, setting 'nearChange' if the time is less than a day from a daylight saving change.
+	Away from a change the cached offsets give the timestamp. Near one, the offsets before and after it are tried:
+	a time repeated by the change resolves to its first occurrence, and a time skipped by it moves forward by the change,
+	the same for every call, unlike mktime, whose choice depends on the times it converted before.
+*/
+static long long convertLocalSecondsToTime(long long localSeconds, bool& nearChange)
+{
+    OffsetSpan guess = getOffsetSpan(localSeconds); // Guesses the offset from the span of the local time, which is less than a day away.
+    if (guess.uniform)
+    {
+        long long timestamp = localSeconds - guess.offsetSeconds; // Applies the guessed offset.
+        OffsetSpan actual = getOffsetSpan(timestamp); // Gets the offset where the guess lands.
+        nearChange = !actual.uniform || actual.offsetSeconds != guess.offsetSeconds;
+        if (!nearChange)
+            return timestamp; // The offset holds at the timestamp, so it maps back to the local time.
+    }
+    nearChange = true;
+    long long offsetBefore = computeTimezoneOffset(localSeconds - SECONDS_PER_DAY); // Gets the offset before the change.
+    long long offsetAfter = computeTimezoneOffset(localSeconds + SECONDS_PER_DAY); // Gets the offset after it.
+    long long earlier = localSeconds - offsetBefore; // Reads the time with the offset before the change.
+    if (computeTimezoneOffset(earlier) == offsetBefore)
+        return earlier; // The time happened before the change.
+    long long later = localSeconds - offsetAfter; // Reads the time with the offset after the change.
+    if (computeTimezoneOffset(later) == offsetAfter)
+        return later; // The time happened after the change.
+    return earlier; // The change skipped the time, so it moves forward by the change.
+}
+
+// Parses a stored date-time, splitting it at the dashes without allocating.
+LocalDateTime parseStoredDateTime(string_view dateTimeString)
+{
+    int components[6]; // Stores the six components.
+    size_t start = 0; // Stores where the current component starts.
+    for (int part = 0; part < 6; part++)
+    {
+        size_t dash = part < 5 ? dateTimeString.find('-', start) : dateTimeString.size(); // Finds the end of the component.
+        if (dash == string_view::npos)
+            throw InvalidNumberException(); // Rejects a date-time with fewer than six components.
+        components[part] = parseInt(dateTimeString.substr(start, dash - start)); // Parses the component; rejects trailing dashes in the last one.
+        start = dash + 1; // Moves past the dash.
+    }
+    return LocalDateTime{ components[0], components[1], components[2], components[3], components[4], components[5] };
+}
+
+// Appends a date-time in the stored format.
+void appendStoredDateTime(string& target, const LocalDateTime& dateTime)
+{
+    appendInteger(target, dateTime.year); // Appends the year.
+    target.push_back('-'); // Adds a separator.
+    appendInteger(target, dateTime.month); // Appends the month.
+    target.push_back('-'); // Adds a separator.
+    appendInteger(target, dateTime.day); // Appends the day.
+    target.push_back('-'); // Adds a separator.
+    appendInteger(target, dateTime.hour); // Appends the hour.
+    target.push_back('-'); // Adds a separator.
+    appendInteger(target, dateTime.minute); // Appends the minute.
+    target.push_back('-'); // Adds a separator.
+    appendInteger(target, dateTime.second); // Appends the second.
+}
+
+// Appends two digits, with a leading zero below ten.
+static void appendTwoDigits(string& target, int value)
+{
+    target.push_back(static_cast<char>('0' + value / 10)); // Appends the tens.
+    target.push_back(static_cast<char>('0' + value % 10)); // Appends the units.
+}
+
+// Appends a date-time in the display format of ctime, carrying over out-of-range components.
+void appendDisplayDateTime(string& target, const LocalDateTime& dateTime)
+{
+    int weekday; // Stores the day of the week.
+    long long localSeconds = convertLocalDateTimeToLocalSeconds(dateTime); // Carries the components over.
+    bool nearChange; // Stores whether a daylight saving change is close.
+    long long timestamp = convertLocalSecondsToTime(localSeconds, nearChange); // Resolves the time.
+    if (nearChange)
+        localSeconds = timestamp + computeTimezoneOffset(timestamp); // Goes through the timestamp, so a time skipped by the change moves forward, as with ctime.
+    LocalDateTime normalized = convertLocalSecondsToLocalDateTime(localSeconds, weekday); // Breaks it down and finds the weekday.
+    target.append(WEEKDAY_NAMES[weekday], 3); // Appends the day of the week.
+    target.push_back(' '); // Adds a separator.
+    target.append(MONTH_NAMES[normalized.month], 3); // Appends the month.
+    target.push_back(' '); // Adds a separator.
+    if (normalized.day < 10)
+        target.push_back(' '); // Pads the day to two characters, as ctime does.
+    appendInteger(target, normalized.day); // Appends the day.
+    target.push_back(' '); // Adds a separator.
+    appendTwoDigits(target, normalized.hour); // Appends the hour.
+    target.push_back(':'); // Adds a separator.
+    appendTwoDigits(target, normalized.minute); // Appends the minute.
+    target.push_back(':'); // Adds a separator.
+    appendTwoDigits(target, normalized.second); // Appends the second.
+    target.push_back(' '); // Adds a separator.
+    appendInteger(target, 1900LL + normalized.year); // Appends the calendar year.
+}
+
+// Converts a timestamp to the local date-time with the cached offset of its span.
+LocalDateTime convertTimeToLocalDateTime(time_t timestamp)
+{
+    OffsetSpan span = getOffsetSpan(static_cast<long long>(timestamp)); // Gets the offset of the span.
+    if (!span.uniform)
+    {
+        struct tm datetime = convertTimeToLocalTm(timestamp); // Asks the C library around a daylight saving change.
+        return LocalDateTime{ datetime.tm_year, datetime.tm_mon, datetime.tm_mday, datetime.tm_hour, datetime.tm_min, datetime.tm_sec };
+    }
+    int weekday; // Stores the unused day of the week.
+    return convertLocalSecondsToLocalDateTime(static_cast<long long>(timestamp) + span.offsetSeconds, weekday); // Shifts to local time and breaks it down.
+}
+
+// Converts a local date-time to a timestamp with the cached offset, or with the offsets on either side of a daylight saving change.
+time_t convertLocalDateTimeToTime(const LocalDateTime& dateTime)
+{
+    bool nearChange; // Stores whether a daylight saving change is close, which needs no special handling here.
+    return static_cast<time_t>(convertLocalSecondsToTime(convertLocalDateTimeToLocalSeconds(dateTime), nearChange)); // Reads the date-time as if it were UTC and applies the offset.
+}
+
+// Formats a stored date-time for display.
+string formatStoredDateTimeForDisplay(string_view dateTimeString)
+{
+    string displayString; // Stores the formatted date-time.
+    displayString.reserve(24); // Allocates the string once.
+    appendDisplayDateTime(displayString, parseStoredDateTime(dateTimeString)); // Formats it.
+    return displayString;
+}
+
+// Formats a timestamp for display in local time.
+string formatTimeForDisplay(time_t timestamp)
+{
+    string displayString; // Stores the formatted date-time.
+    displayString.reserve(24); // Allocates the string once.
+    appendDisplayDateTime(displayString, convertTimeToLocalDateTime(timestamp)); // Formats it.
+    return displayString;
+}
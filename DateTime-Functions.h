@@ -0,0 +1,65 @@
+// This file contains the declarations of the date-time functions.
+// They convert between timestamps, the "Y-M-D-h-m-s" date-times stored in the accounts vector,
+// and the "Www Mmm dd hh:mm:ss yyyy" text displayed in the account tables,
+// with calendar arithmetic and a cached timezone offset instead of mktime, localtime and ctime.
+// Nothing is shared between calls except read-only tables and a per-thread cache,
+// so every function can be called from several threads at once.
+
+// These are the include guards
+#pragma once
+#ifndef DATETIMEFUNCTIONS_H
+#define DATETIMEFUNCTIONS_H
+
+#include <string>
+#include <string_view>
+#include <ctime>
+using namespace std;
+
+// Holds a local date and time broken down the way the accounts vector stores it
+struct LocalDateTime
+{
+	int year;   // Years since 1900
+	int month;  // Months since January (0-11)
+	int day;    // Day of the month (1-31)
+	int hour;   // Hours since midnight (0-23)
+	int minute; // Minutes after the hour (0-59)
+	int second; // Seconds after the minute (0-60)
+};
+
+/*
+	Parses a stored date-time in the format "Year-Month-Day-Hour-Minute-Second".
+	Throws an InvalidNumberException if it does not have six numeric components.
+*/
+LocalDateTime parseStoredDateTime(string_view);
+
+// Appends a date-time to the end of a string in the stored format "Year-Month-Day-Hour-Minute-Second"
+void appendStoredDateTime(string&, const LocalDateTime&);
+
+/*
+	Appends a date-time to the end of a string in the display format of ctime, without its newline:
+	"Www Mmm dd hh:mm:ss yyyy". Components out of their range are carried over, and a time skipped
+	by a daylight saving change is moved forward, as mktime does.
+*/
+void appendDisplayDateTime(string&, const LocalDateTime&);
+
+/*
+	Converts a timestamp to the local date-time.
+	The timezone offset is cached per week for each thread, so only a week containing
+	a daylight saving change asks the C library.
+*/
+LocalDateTime convertTimeToLocalDateTime(time_t);
+
+/*
+	Converts a local date-time to a timestamp, as mktime does with daylight saving time unknown,
+	except that a time repeated by a daylight saving change always resolves to its first occurrence.
+	Uses the cached timezone offset, and asks the C library only around a change.
+*/
+time_t convertLocalDateTimeToTime(const LocalDateTime&);
+
+// Formats a stored date-time for display, such as the creation date-time in the account tables
+string formatStoredDateTimeForDisplay(string_view);
+
+// Formats a timestamp for display in local time
+string formatTimeForDisplay(time_t);
+
+#endif
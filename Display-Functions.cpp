@@ -3,7 +3,9 @@
 #include <string>
 #include <algorithm>
 #include <iomanip>
+#include <sstream>
 #include "Display-Functions.h"
+#include "ProductCatalog.h"
 using namespace std;
 
 // Prints a 2D vector as a formatted table, requiring all inner vectors to have the same size.
@@ -58,6 +60,9 @@ void displayOptionsList()
         {"7.", "List all accounts"},
         {"8.", "Delete person"},
         {"9.", "Delete account"},
+        {"10.", "Bank-wide report"},
+        {"11.", "Run end-of-day batch"},
+        {"12.", "Process transaction file"},
     };
 
     // Prints the table of program options.
@@ -79,6 +84,37 @@ void displayAccountTypes()
     printTable(list);
 }
 
+// Creates and displays a table of the certificate products, numbered in catalog order.
+void displayCertificateProducts()
+{
+    vector<vector<string>> list = { {"No.", "Product", "Term", "Compounding", "Minimum Deposit", "Interest Rate"} };
+    const char* const compoundingNames[] = { "None", "Annual", "Monthly" }; // Stores the compounding names, indexed by InterestCompounding.
+    for (const CertificateProduct& product : CERTIFICATE_PRODUCTS)
+    {
+        ostringstream term; // Stores the term column.
+        ostringstream minimumDeposit; // Stores the minimum deposit column.
+        ostringstream rates; // Stores the rate tiers column.
+        if (product.termYears == 0)
+            term << "Open-ended"; // Shows a certificate that earns for as long as it is open.
+        else
+            term << product.termYears << (product.termYears == 1 ? " year" : " years"); // Shows the fixed term.
+        minimumDeposit << setprecision(10) << "$" << product.minimumDeposit; // Shows the minimum deposit without trailing zeros.
+        rates << setprecision(10);
+        for (int tier = 0; tier < product.tierCount; tier++)
+        {
+            if (tier > 0)
+                rates << ", "; // Separates the tiers.
+            rates << product.tiers[tier].ratePercent << "% from $" << product.tiers[tier].minimumBalance; // Shows the tier.
+        }
+        list.push_back({ to_string(static_cast<int>(product.id) + 1) + ".", product.name, term.str(), compoundingNames[static_cast<int>(product.compounding)], minimumDeposit.str(), rates.str() });
+    }
+
+    cout << "A certificate product sets the term the certificate earns interest for, whether the returns earn interest too (compounding), its minimum deposit, and its rate tiers." << endl;
+    cout << "The rate of the highest tier the initial deposit reaches is kept for the life of the certificate." << endl;
+    // Prints the table of certificate products.
+    printTable(list);
+}
+
 // Creates and displays a table of update options for accounts.
 void displayUpdateChoices()
 {
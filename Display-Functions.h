@@ -30,6 +30,12 @@ void displayOptionsList();
 */
 void displayAccountTypes();
 
+/*
+	Displays the certificate products of the catalog with their terms, minimum deposits and rate tiers.
+	Used during certificate account creation for product selection.
+*/
+void displayCertificateProducts();
+
 /*
 	Displays the update options available for a Saving Account.
 	Options include:
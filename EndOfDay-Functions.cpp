@@ -0,0 +1,145 @@
+#include <vector>
+#include <string>
+#include <iostream>
+#include "EndOfDay-Functions.h"
+#include "Program-Data-Functions.h"
+#include "Conversion-Functions.h"
+#include "Numeric-Functions.h"
+#include "Display-Functions.h"
+#include "AccountVariant.h"
+#include "Constants.h"
+#include "Clock.h"
+#include "DateTime-Functions.h"
+using namespace std;
+
+/*
+	Totals the returns the certificates earned during the business day.
+	A certificate's returns are derived from its deposit and age, so posting them only reports them;
+	the accounts are left unchanged.
+*/
+class InterestPostingJob : public BatchJob
+{
+public:
+    const char* getName() const override
+    {
+        return "Interest Posting";
+    }
+
+    void processPartition(const vector<vector<string>>& accountVectors, size_t first, size_t last, time_t businessDate, BatchPartitionResult& result) const override
+    {
+        for (size_t i = first; i < last; i++)
+        {
+            const vector<string>& accountVector = accountVectors[i]; // Gets the account without copying it.
+            result.processedCount++; // Counts the account.
+            if (isSavingAccountVector(accountVector))
+                continue; // Saving accounts earn no interest.
+            CertificateAccount certificateAccountObject = convertAccountVectorToCertificateAccountObject(accountVector); // Builds the account.
+            accrualCache.restore(i, certificateAccountObject); // Reuses the cached creation time and returns.
+            double dayReturns = certificateAccountObject.getTotalReturnsAsOf(businessDate) - certificateAccountObject.getTotalReturnsAsOf(businessDate - SECONDS_IN_A_DAY); // Computes the returns earned during the day.
+            if (dayReturns > 0)
+            {
+                result.affectedCount++; // Counts the certificate that earned interest.
+                result.amount += dayReturns; // Adds its returns.
+            }
+        }
+    }
+};
+
+/*
+	Renews the certificates whose term ended by the business date, adding the returns not yet withdrawn to the deposit.
+	The renewed accounts are the only changes of the batch.
+*/
+class MaturityRolloverJob : public BatchJob
+{
+public:
+    const char* getName() const override
+    {
+        return "Maturity Rollover";
+    }
+
+    void processPartition(const vector<vector<string>>& accountVectors, size_t first, size_t last, time_t businessDate, BatchPartitionResult& result) const override
+    {
+        for (size_t i = first; i < last; i++)
+        {
+            const vector<string>& accountVector = accountVectors[i]; // Gets the account without copying it.
+            result.processedCount++; // Counts the account.
+            if (isSavingAccountVector(accountVector))
+                continue; // Saving accounts have no term.
+            CertificateAccount certificateAccountObject = convertAccountVectorToCertificateAccountObject(accountVector); // Builds the account.
+            accrualCache.restore(i, certificateAccountObject); // Reuses the cached creation time.
+            double capitalizedAmount = certificateAccountObject.rollOver(businessDate); // Renews the certificate if its term ended.
+            if (certificateAccountObject.getDateTime() == accountVector[3])
+                continue; // The term has not ended.
+            result.affectedCount++; // Counts the renewed certificate.
+            result.amount += capitalizedAmount; // Adds the capitalized returns.
+            result.changedAccounts.emplace_back(i, convertCertificateAccountObjectToAccountVector(certificateAccountObject)); // Keeps the renewed account.
+        }
+    }
+};
+
+/*
+	Counts the dormant saving accounts: there is no record of the last deposit or withdrawal,
+	so an account older than DORMANT_ACCOUNT_YEARS whose balance never rose above the minimum is taken as dormant.
+	The accounts are left unchanged.
+*/
+class DormantAccountJob : public BatchJob
+{
+public:
+    const char* getName() const override
+    {
+        return "Dormant Accounts";
+    }
+
+    void processPartition(const vector<vector<string>>& accountVectors, size_t first, size_t last, time_t businessDate, BatchPartitionResult& result) const override
+    {
+        time_t dormancyCutoff = businessDate - static_cast<time_t>(DORMANT_ACCOUNT_YEARS) * SECONDS_IN_A_YEAR; // Computes the latest creation time of a dormant account.
+        for (size_t i = first; i < last; i++)
+        {
+            const vector<string>& accountVector = accountVectors[i]; // Gets the account without copying it.
+            result.processedCount++; // Counts the account.
+            if (!isSavingAccountVector(accountVector))
+                continue; // Only saving accounts are checked.
+            double balance = parseDouble(accountVector[2]); // Reads the balance.
+            if (balance > MIN_BALANCE)
+                continue; // Checks the balance first, so most accounts skip parsing the date-time.
+            if (convertDateTimeStringToTime(accountVector[3]) > dormancyCutoff)
+                continue; // The account is too recent to be dormant.
+            result.affectedCount++; // Counts the dormant account.
+            result.amount += balance; // Adds its balance.
+        }
+    }
+};
+
+// Runs the end-of-day jobs over the accounts vector, persisting the renewed certificates in one call.
+BatchRunSummary runEndOfDayBatch(time_t businessDate)
+{
+    InterestPostingJob interestPostingJob; // Creates the jobs, in the order they run.
+    MaturityRolloverJob maturityRolloverJob;
+    DormantAccountJob dormantAccountJob;
+    vector<const BatchJob*> jobs = { &interestPostingJob, &maturityRolloverJob, &dormantAccountJob };
+
+    BatchJobEngine engine(END_OF_DAY_CHECKPOINT_FILE_PATH, BATCH_PARTITION_SIZE); // Uses one worker per hardware thread.
+    return engine.run(jobs, accounts, persistAccountBatch, businessDate); // Runs or resumes the batch.
+}
+
+// Runs the end-of-day batch as of the time of the operation and displays the totals of each job.
+void displayEndOfDayBatch()
+{
+    BatchRunSummary summary = runEndOfDayBatch(getOperationTime()); // Runs the batch for the current date.
+
+    vector<vector<string>> resultsTable = { {"Job", "Accounts Processed", "Accounts Affected", "Amount", "Resumed Partitions"} }; // Initializes the results table with headers.
+    double elapsedMilliseconds = 0; // Stores the time taken by the jobs run now.
+    for (const BatchJobSummary& job : summary.jobs)
+    {
+        resultsTable.push_back({ job.jobName, formatInteger(job.processedCount), formatInteger(job.affectedCount), formatDouble(job.amount),
+            formatInteger(job.resumedPartitionCount) + "/" + formatInteger(job.partitionCount) }); // Adds the job's row.
+        elapsedMilliseconds += job.elapsedMilliseconds; // Adds the job's time.
+    }
+
+    string businessDate = formatTimeForDisplay(summary.businessDate); // Formats the business date.
+    if (summary.resumed)
+        cout << "Resumed the interrupted end-of-day batch." << endl; // Tells the user the run continued from its checkpoint.
+    cout << "End-of-Day Batch (" << businessDate << "):" << endl; // Displays a header for the results.
+    printTable(resultsTable); // Prints the results table.
+    cout << "Batch computed in " << elapsedMilliseconds << " ms using " << summary.threadCount << " threads." << endl; // Displays the timing.
+}
@@ -0,0 +1,30 @@
+// This file contains the declarations of the end-of-day batch functions.
+// The batch runs the interest posting, maturity rollover and dormant account jobs
+// over every account on the BatchJobEngine.
+
+// These are the include guards
+#pragma once
+#ifndef ENDOFDAYFUNCTIONS_H
+#define ENDOFDAYFUNCTIONS_H
+
+#include <ctime>
+#include "BatchJobEngine.h"
+
+/*
+	Runs the end-of-day jobs over the 'accounts' vector for the given business date, in this order:
+	- Interest posting: totals the returns the certificates earned during the business day
+	- Maturity rollover: renews the certificates whose term ended, capitalizing their returns
+	- Dormant accounts: counts the saving accounts older than DORMANT_ACCOUNT_YEARS left at the minimum balance
+	Splits the accounts into partitions of BATCH_PARTITION_SIZE accounts and checkpoints them to
+	END_OF_DAY_CHECKPOINT_FILE_PATH, so an interrupted run resumes where it stopped when it is started again.
+	The renewed certificates are persisted in one call.
+*/
+BatchRunSummary runEndOfDayBatch(time_t);
+
+/*
+	Runs the end-of-day batch for the date of the current operation and displays the results of each job in a tabular format.
+	Used by the main menu.
+*/
+void displayEndOfDayBatch();
+
+#endif
@@ -48,12 +48,55 @@ class IncompletePersonException {};
 */
 class InvalidFileException {};
 
+/*
+	Thrown when the binary snapshot file is truncated, has an unknown format version,
+	or fails one of its checksums.
+*/
+class InvalidSnapshotException {};
+
+/*
+	Thrown when a page read from the paged account store is truncated
+	or fails its checksum.
+*/
+class InvalidPageException {};
+
+/*
+	Thrown when the buffer pool needs a free frame
+	but every frame holds a page that is still in use.
+*/
+class BufferPoolExhaustedException {};
+
+/*
+	Thrown when the manifest or a sorted run of the LSM account store
+	is truncated, has an unknown format version, or fails its checksum.
+*/
+class InvalidRunException {};
+
 /*
 	Thrown when attempting to create a new user with a national ID
 	that already exists in the system.
 */
 class ExistPersonException {};
 
+/*
+	Thrown when a numeric field read from a file or an account vector
+	is empty, contains non-numeric characters, or is out of range.
+*/
+class InvalidNumberException {};
+
+/*
+	Thrown when a certificate account names a product
+	that is not in the certificate product catalog.
+*/
+class InvalidProductException {};
+
+/*
+	Thrown when an account update is committed with a version that is no longer the account's,
+	because another change was committed after the account was read.
+	The account is left unchanged; reading it again and repeating the update can succeed.
+*/
+class AccountVersionConflictException {};
+
 /*
 	Thrown when the name string is empty during a person update operation.
 */
@@ -0,0 +1,129 @@
+#include <string>
+#include <fstream>
+#include <cstdlib>
+#include <cstdint>
+#include <atomic>
+#include <filesystem>
+#include "File-Functions.h"
+#include "Numeric-Functions.h"
+#include "Exceptions.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+using namespace std;
+
+// Counts the bytes written since the program started, by every thread, while fault injection is on.
+static atomic<long long> faultInjectionBytesWritten(0);
+
+// Reads the number of bytes after which the program stops from the environment, or -1 if fault injection is off.
+static long long readFaultInjectionOffset()
+{
+    const char* setting = getenv("BANK_FAULT_INJECTION_OFFSET"); // Reads the environment variable.
+    if (setting == nullptr || *setting == '\0')
+        return -1; // Turns fault injection off if the variable is not set.
+    try
+    {
+        return max(0LL, parseLongLong(setting)); // Returns the offset.
+    }
+    catch (...)
+    {
+        return -1; // Ignores a value that is not a number.
+    }
+}
+
+// Returns the number of bytes after which the program stops, or -1 if fault injection is off.
+static long long getFaultInjectionOffset()
+{
+    static const long long faultOffset = readFaultInjectionOffset(); // Reads the environment variable once, even when several threads write first.
+    return faultOffset;
+}
+
+// Claims the range of bytes about to be written, shortening the write if it reaches the fault injection offset.
+bool reserveBytesForFaultInjection(size_t& size)
+{
+    long long faultOffset = getFaultInjectionOffset(); // Gets the offset at which to stop.
+    if (faultOffset < 0)
+        return true; // Counts nothing while fault injection is off.
+    long long firstByte = faultInjectionBytesWritten.fetch_add(static_cast<long long>(size)); // Claims the range, so concurrent writers never count the same bytes.
+    if (firstByte + static_cast<long long>(size) >= faultOffset)
+    {
+        size = firstByte < faultOffset ? static_cast<size_t>(faultOffset - firstByte) : 0; // Keeps only the part before the offset.
+        return false; // Asks the caller to stop once that part is written.
+    }
+    return true;
+}
+
+// Stops at once, without destructors or exit handlers, like a killed process.
+void stopForFaultInjection()
+{
+    _Exit(EXIT_FAILURE);
+}
+
+// Reads the whole content of an open file into a string with a single read.
+string readWholeFile(ifstream& file)
+{
+    string content; // Stores the file content.
+    file.seekg(0, ios::end); // Moves to the end of the file to find its size.
+    content.resize(static_cast<size_t>(file.tellg())); // Allocates the string once for the whole file.
+    file.seekg(0, ios::beg); // Moves back to the start of the file.
+    file.read(&content[0], content.size()); // Reads the file in one call.
+    return content; // Returns the file content.
+}
+
+// Writes bytes to a file, stopping the program once the fault injection offset is reached.
+void writeFileBytes(ostream& file, const char* data, size_t size)
+{
+    bool keepRunning = reserveBytesForFaultInjection(size); // Shortens the write if it reaches the offset.
+    file.write(data, static_cast<streamsize>(size)); // Writes the bytes.
+    if (!keepRunning)
+    {
+        file.flush(); // Hands the partial write to the operating system, as a crash would leave it.
+        stopForFaultInjection(); // Stops the program.
+    }
+}
+
+// Forces a written file to the disk.
+bool syncFileToDisk(const string& filePath)
+{
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filePath.c_str(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL); // Opens the file.
+    if (file == INVALID_HANDLE_VALUE)
+        return false; // Returns false if the file cannot be opened.
+    bool synced = FlushFileBuffers(file) != 0; // Writes the cached data of the file to the disk.
+    CloseHandle(file); // Closes the file.
+    return synced;
+#else
+    int file = ::open(filePath.c_str(), O_RDONLY); // Opens the file; a directory can only be opened for reading.
+    if (file < 0)
+        return false; // Returns false if the file cannot be opened.
+    bool synced = fsync(file) == 0; // Writes the cached data of the file to the disk.
+    ::close(file); // Closes the file.
+    return synced;
+#endif
+}
+
+// Writes the content to a temporary file, forces it to the disk, then renames it over the file.
+void writeFileAtomically(const string& filePath, const string& content)
+{
+    string temporaryPath = filePath + ".tmp"; // Stores the path of the temporary file.
+    ofstream temporaryFile(temporaryPath, ios::out | ios::trunc); // Opens the temporary file in text mode, like the file it replaces.
+    if (!temporaryFile)
+        throw InvalidFileException(); // Throws an exception if the file failed to open.
+    writeFileBytes(temporaryFile, content.data(), content.size()); // Writes the content.
+    temporaryFile.close(); // Flushes and closes the file.
+    if (!temporaryFile || !syncFileToDisk(temporaryPath))
+        throw InvalidFileException(); // Throws an exception if any write failed or the file could not be forced to the disk.
+
+    error_code renameError; // Stores the result of the rename.
+    filesystem::rename(temporaryPath, filePath, renameError); // Replaces the file in one step.
+    if (renameError)
+        throw InvalidFileException(); // Throws an exception if the file could not be replaced.
+#ifndef _WIN32
+    syncFileToDisk(filesystem::path(filePath).parent_path().string()); // Makes the rename itself durable.
+#endif
+}
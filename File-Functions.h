@@ -0,0 +1,59 @@
+// This file contains the declarations of the functions that write data files safely,
+// so that a crash part-way through a write never leaves a truncated file in place of a good one.
+// Every write also passes through the fault injection point used to test crash recovery.
+
+/*
+	Fault injection:
+	When the BANK_FAULT_INJECTION_OFFSET environment variable holds a number N,
+	the program stops at once, without saving anything, after N bytes have been written
+	through writeFileBytes, a BatchFileWriter or the mapping of the account table, by any thread;
+	the write that crosses the offset is cut short at it. This covers the CSV files, the snapshots,
+	the person journal and every account store, including the writes of the persistence thread.
+	Running the program repeatedly with random offsets reproduces a crash at any point of any write,
+	which Tests/FaultInjection-Test does.
+*/
+
+// These are the include guards
+#pragma once
+#ifndef FILEFUNCTIONS_H
+#define FILEFUNCTIONS_H
+
+#include <string>
+#include <fstream>
+#include <cstddef>
+using namespace std;
+
+// Reads the whole content of a file opened in binary mode into a string with a single read
+string readWholeFile(ifstream&);
+
+/*
+	Writes bytes to an open file, stopping the program part-way if the fault injection offset is reached.
+	The caller checks the state of the stream as after any other write.
+*/
+void writeFileBytes(ostream&, const char*, size_t);
+
+/*
+	Counts bytes about to be written for fault injection; safe to call from several threads.
+	Returns false, after shortening the size to the bytes before the fault injection offset,
+	if the caller must write only those and then call stopForFaultInjection.
+*/
+bool reserveBytesForFaultInjection(size_t&);
+
+// Stops the program at once, without destructors or exit handlers, as if it were killed
+[[noreturn]] void stopForFaultInjection();
+
+/*
+	Forces the written content of a file, or the entries of a directory, to the disk.
+	Returns false if the file cannot be opened or synchronized.
+*/
+bool syncFileToDisk(const string&);
+
+/*
+	Replaces the content of a file in one step.
+	The content is written to a temporary file next to it, forced to the disk, and renamed over the file,
+	so after a crash the file holds either the old or the new content, never a part of it.
+	Throws an InvalidFileException if the file cannot be written.
+*/
+void writeFileAtomically(const string&, const string&);
+
+#endif
@@ -0,0 +1,823 @@
+#include <cstring>
+#include <cstddef>
+#include <algorithm>
+#include <map>
+#include <filesystem>
+#include "LsmAccountStore.h"
+#include "Checksum-Functions.h"
+#include "File-Functions.h"
+#include "Numeric-Functions.h"
+#include "Exceptions.h"
+#include "Constants.h"
+
+using namespace std;
+
+// Identifies a manifest file.
+static const char MANIFEST_MAGIC[8] = { 'B', 'A', 'N', 'K', 'L', 'S', 'M', 'F' };
+
+// Identifies a sorted run file.
+static const char RUN_MAGIC[8] = { 'B', 'A', 'N', 'K', 'R', 'U', 'N', 'S' };
+
+// The format version written by this program; stores with any other version are recreated.
+static const uint32_t LSM_VERSION = 1;
+
+// The number of bloom filter bits set per account; about ln(2) times the bits per key.
+static const uint32_t BLOOM_HASH_COUNT = 7;
+
+// The number of records read at once when a whole run is scanned.
+static const size_t RUN_SCAN_RECORD_COUNT = 4096;
+
+// The names of the files of the store directory.
+static const char* const MANIFEST_FILE_NAME = "MANIFEST";
+static const char* const LOG_FILE_PREFIX = "wal-";
+static const char* const LOG_FILE_SUFFIX = ".log";
+static const char* const RUN_FILE_PREFIX = "run-";
+static const char* const RUN_FILE_SUFFIX = ".dat";
+
+// Holds the fixed-size start of the manifest, followed by the run numbers and a CRC32C of everything before it.
+struct ManifestHeader
+{
+    char magic[8];             // Always MANIFEST_MAGIC
+    uint32_t version;          // Format version of the store
+    uint32_t runCount;         // Number of run numbers that follow
+    uint64_t nextFileNumber;   // Number given to the next log or run file
+    uint64_t minimumLogNumber; // Oldest log whose records are not all in runs
+};
+
+// Holds the fixed-size start of a sorted run file.
+struct RunHeader
+{
+    char magic[8];             // Always RUN_MAGIC
+    uint32_t version;          // Format version of the store
+    uint32_t blockRecordCount; // Number of records per block
+    uint64_t recordCount;      // Number of records in the run
+    uint64_t maxSequence;      // Largest sequence number in the run
+    uint32_t bloomWordCount;   // Number of 64-bit words of the bloom filter
+    uint32_t bloomHashCount;   // Number of bits set per account in the bloom filter
+    int32_t minAccountID;      // Smallest account ID in the run
+    int32_t maxAccountID;      // Largest account ID in the run
+    uint32_t metadataChecksum; // CRC32C of the bloom filter and the block index
+    uint32_t headerChecksum;   // CRC32C of all the header bytes before this field
+};
+
+// Holds the records written since the last flush.
+struct LsmMemtable
+{
+    map<int32_t, AccountRecord> records; // Newest record of each account, ordered by account ID
+    uint64_t logNumber;                  // Number of the oldest log holding these records
+};
+
+// Holds an open sorted run.
+struct LsmSortedRun
+{
+    uint64_t fileNumber;          // Number of the run file
+    string filePath;              // Path of the run file
+    RunHeader header;             // Header read from the file
+    vector<uint64_t> bloomWords;  // Bloom filter of the account IDs
+    vector<int32_t> blockFirstIDs; // First account ID of every block
+    uint64_t recordsOffset;       // Position of the first record in the file
+    ifstream file;                // Open file used for reads
+    mutex fileMutex;              // Guards the position of the file
+    atomic<bool> obsolete;        // Set once a merge replaced the run; the file is deleted with the last reference
+
+    LsmSortedRun() : fileNumber(0), header(), recordsOffset(0), obsolete(false)
+    {
+    }
+
+    ~LsmSortedRun()
+    {
+        file.close(); // Closes the file so it can be deleted on every platform.
+        if (obsolete)
+        {
+            error_code removeError; // Ignores a failed removal; the file is only garbage.
+            filesystem::remove(filePath, removeError); // Deletes the replaced run.
+        }
+    }
+};
+
+// Builds the name of a numbered file of the store directory.
+static string makeFileName(const char* prefix, uint64_t number, const char* suffix)
+{
+    string name = prefix; // Starts with the prefix.
+    appendInteger(name, static_cast<long long>(number)); // Adds the number.
+    name += suffix; // Adds the suffix.
+    return name;
+}
+
+// Reads the number of a file name made by makeFileName, returning false if the name does not match.
+static bool parseFileNumber(const string& name, const char* prefix, const char* suffix, uint64_t& number)
+{
+    size_t prefixLength = strlen(prefix), suffixLength = strlen(suffix); // Stores the lengths of the fixed parts.
+    if (name.size() <= prefixLength + suffixLength || name.compare(0, prefixLength, prefix) != 0 ||
+        name.compare(name.size() - suffixLength, suffixLength, suffix) != 0)
+        return false; // Returns false if the fixed parts do not match.
+    try
+    {
+        number = static_cast<uint64_t>(parseLongLong(string_view(name).substr(prefixLength, name.size() - prefixLength - suffixLength))); // Parses the number.
+    }
+    catch (InvalidNumberException)
+    {
+        return false; // Returns false if the middle is not a number.
+    }
+    return true;
+}
+
+// Mixes the bits of an account ID (the SplitMix64 finalizer), so the bloom filter bits spread evenly.
+static uint64_t hashAccountID(int32_t accountID)
+{
+    uint64_t hash = static_cast<uint64_t>(static_cast<uint32_t>(accountID)) + 0x9E3779B97F4A7C15ULL; // Offsets the ID.
+    hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ULL; // Mixes the high bits into the low bits.
+    hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBULL; // Mixes again.
+    return hash ^ (hash >> 31); // Returns the final hash.
+}
+
+// Sets or tests the bloom filter bits of an account ID, deriving every bit position from two halves of one hash.
+static bool accessBloomFilter(vector<uint64_t>& words, uint32_t hashCount, int32_t accountID, bool set)
+{
+    uint64_t hash = hashAccountID(accountID); // Hashes the account ID once.
+    uint64_t bitCount = words.size() * 64; // Stores the number of bits of the filter.
+    uint64_t firstHash = static_cast<uint32_t>(hash); // Uses the low half as the first position.
+    uint64_t step = static_cast<uint32_t>(hash >> 32) | 1; // Uses the high half, made odd, as the step between positions.
+    for (uint32_t i = 0; i < hashCount; i++)
+    {
+        uint64_t bit = (firstHash + i * step) % bitCount; // Calculates the next position.
+        uint64_t mask = 1ULL << (bit % 64); // Selects the bit inside its word.
+        if (set)
+            words[bit / 64] |= mask; // Sets the bit.
+        else if ((words[bit / 64] & mask) == 0)
+            return false; // Returns false as soon as one bit is missing: the ID is not in the run.
+    }
+    return true; // Returns true if every bit is set: the ID may be in the run.
+}
+
+// Opens a run file and reads its header, bloom filter and block index.
+static shared_ptr<LsmSortedRun> loadSortedRun(const string& path, uint64_t fileNumber)
+{
+    shared_ptr<LsmSortedRun> run = make_shared<LsmSortedRun>(); // Creates the run.
+    run->fileNumber = fileNumber; // Stores the file number.
+    run->filePath = path; // Stores the path.
+    run->file.open(path, ios::in | ios::binary); // Opens the file.
+    if (!run->file.is_open())
+        throw InvalidRunException(); // Throws an exception if a run listed by the manifest is missing.
+
+    RunHeader& header = run->header; // Gets the header.
+    run->file.read(reinterpret_cast<char*>(&header), sizeof(header)); // Reads the header.
+    if (run->file.gcount() != sizeof(header) || memcmp(header.magic, RUN_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != LSM_VERSION || header.blockRecordCount == 0 || header.bloomWordCount == 0 ||
+        header.headerChecksum != computeCRC32C(&header, offsetof(RunHeader, headerChecksum)))
+        throw InvalidRunException(); // Throws an exception if the header is truncated or damaged.
+
+    run->bloomWords.resize(header.bloomWordCount); // Allocates the bloom filter.
+    run->file.read(reinterpret_cast<char*>(run->bloomWords.data()), run->bloomWords.size() * sizeof(uint64_t)); // Reads the bloom filter.
+    run->recordsOffset = sizeof(RunHeader) + run->bloomWords.size() * sizeof(uint64_t); // Records follow the bloom filter.
+    size_t blockCount = static_cast<size_t>((header.recordCount + header.blockRecordCount - 1) / header.blockRecordCount); // Counts the blocks.
+    run->blockFirstIDs.resize(blockCount); // Allocates the block index.
+    run->file.seekg(static_cast<streamoff>(run->recordsOffset + header.recordCount * sizeof(AccountRecord)), ios::beg); // Moves to the block index after the records.
+    run->file.read(reinterpret_cast<char*>(run->blockFirstIDs.data()), blockCount * sizeof(int32_t)); // Reads the block index.
+    if (!run->file)
+        throw InvalidRunException(); // Throws an exception if the file is truncated.
+    uint32_t checksum = computeCRC32C(run->bloomWords.data(), run->bloomWords.size() * sizeof(uint64_t)); // Checksums the bloom filter.
+    checksum = computeCRC32C(run->blockFirstIDs.data(), blockCount * sizeof(int32_t), checksum); // Continues with the block index.
+    if (checksum != header.metadataChecksum)
+        throw InvalidRunException(); // Throws an exception if the bloom filter or index is damaged.
+    return run;
+}
+
+// Writes records sorted by account ID as a run file and opens it.
+static shared_ptr<LsmSortedRun> writeSortedRun(const string& path, uint64_t fileNumber, const vector<AccountRecord>& records)
+{
+    RunHeader header = {}; // Stores the header (zero-initialized).
+    memcpy(header.magic, RUN_MAGIC, sizeof(header.magic)); // Stores the magic bytes.
+    header.version = LSM_VERSION; // Stores the format version.
+    header.blockRecordCount = LSM_RUN_BLOCK_RECORD_COUNT; // Stores the block size.
+    header.recordCount = records.size(); // Stores the record count.
+    header.bloomHashCount = BLOOM_HASH_COUNT; // Stores the number of bits per account.
+    vector<uint64_t> bloomWords(max<size_t>(1, (records.size() * LSM_BLOOM_BITS_PER_KEY + 63) / 64), 0); // Allocates the bloom filter.
+    header.bloomWordCount = static_cast<uint32_t>(bloomWords.size()); // Stores the bloom filter size.
+    vector<int32_t> blockFirstIDs; // Stores the first account ID of every block.
+    blockFirstIDs.reserve(records.size() / LSM_RUN_BLOCK_RECORD_COUNT + 1); // Allocates the block index once.
+    for (size_t i = 0; i < records.size(); i++)
+    {
+        accessBloomFilter(bloomWords, BLOOM_HASH_COUNT, records[i].accountID, true); // Adds the account to the bloom filter.
+        if (i % LSM_RUN_BLOCK_RECORD_COUNT == 0)
+            blockFirstIDs.push_back(records[i].accountID); // Starts a new block.
+        header.maxSequence = max(header.maxSequence, records[i].sequence); // Tracks the newest sequence number.
+    }
+    if (!records.empty())
+    {
+        header.minAccountID = records.front().accountID; // Stores the smallest account ID.
+        header.maxAccountID = records.back().accountID; // Stores the largest account ID.
+    }
+    header.metadataChecksum = computeCRC32C(bloomWords.data(), bloomWords.size() * sizeof(uint64_t)); // Checksums the bloom filter.
+    header.metadataChecksum = computeCRC32C(blockFirstIDs.data(), blockFirstIDs.size() * sizeof(int32_t), header.metadataChecksum); // Continues with the block index.
+    header.headerChecksum = computeCRC32C(&header, offsetof(RunHeader, headerChecksum)); // Checksums the header.
+
+    ofstream runFile(path, ios::out | ios::binary | ios::trunc); // Creates the run file.
+    writeFileBytes(runFile, reinterpret_cast<const char*>(&header), sizeof(header)); // Writes the header.
+    writeFileBytes(runFile, reinterpret_cast<const char*>(bloomWords.data()), bloomWords.size() * sizeof(uint64_t)); // Writes the bloom filter.
+    writeFileBytes(runFile, reinterpret_cast<const char*>(records.data()), records.size() * sizeof(AccountRecord)); // Writes the records.
+    writeFileBytes(runFile, reinterpret_cast<const char*>(blockFirstIDs.data()), blockFirstIDs.size() * sizeof(int32_t)); // Writes the block index.
+    runFile.close(); // Closes the file, writing its buffer.
+    if (!runFile)
+        throw InvalidFileException(); // Throws an exception if the file could not be written.
+    return loadSortedRun(path, fileNumber); // Opens the run for reads.
+}
+
+// Reads consecutive records of a run, appending them to a vector.
+static void readRunRecords(LsmSortedRun& run, size_t firstRecord, size_t count, vector<AccountRecord>& records)
+{
+    size_t oldSize = records.size(); // Stores where the new records start.
+    records.resize(oldSize + count); // Makes room for the records.
+    lock_guard<mutex> lock(run.fileMutex); // Keeps other readers from moving the file position.
+    run.file.seekg(static_cast<streamoff>(run.recordsOffset + firstRecord * sizeof(AccountRecord)), ios::beg); // Moves to the first record.
+    run.file.read(reinterpret_cast<char*>(&records[oldSize]), count * sizeof(AccountRecord)); // Reads the records.
+    size_t readCount = static_cast<size_t>(run.file.gcount()) / sizeof(AccountRecord); // Counts the complete records read.
+    run.file.clear(); // Clears the end-of-file flag of a truncated file so later reads still work.
+    records.resize(oldSize + readCount); // Drops the records that could not be read.
+}
+
+// Reads the manifest, returning false if it does not exist.
+static bool readManifest(const string& path, ManifestHeader& header, vector<uint64_t>& runNumbers)
+{
+    ifstream manifestFile(path, ios::in | ios::binary); // Opens the manifest.
+    if (!manifestFile.is_open())
+        return false; // Returns false for a new store.
+    manifestFile.read(reinterpret_cast<char*>(&header), sizeof(header)); // Reads the fixed part.
+    if (manifestFile.gcount() != sizeof(header) || memcmp(header.magic, MANIFEST_MAGIC, sizeof(header.magic)) != 0 || header.version != LSM_VERSION)
+        throw InvalidRunException(); // Throws an exception if the manifest is truncated or from another version.
+    runNumbers.resize(header.runCount); // Allocates the run numbers.
+    manifestFile.read(reinterpret_cast<char*>(runNumbers.data()), runNumbers.size() * sizeof(uint64_t)); // Reads the run numbers.
+    uint32_t storedChecksum = 0; // Stores the checksum written after the run numbers.
+    manifestFile.read(reinterpret_cast<char*>(&storedChecksum), sizeof(storedChecksum)); // Reads the checksum.
+    if (!manifestFile)
+        throw InvalidRunException(); // Throws an exception if the manifest is truncated.
+    uint32_t checksum = computeCRC32C(&header, sizeof(header)); // Checksums the fixed part.
+    checksum = computeCRC32C(runNumbers.data(), runNumbers.size() * sizeof(uint64_t), checksum); // Continues with the run numbers.
+    if (checksum != storedChecksum)
+        throw InvalidRunException(); // Throws an exception if the manifest is damaged.
+    return true;
+}
+
+// Default constructor, the store starts closed.
+LsmAccountStore::LsmAccountStore()
+    : opened(false), nextFileNumber(1), lastSequence(0), maxAccountID(0), stopRequested(false), backgroundBusy(false), backgroundFailed(false),
+      compactionCount(0), pointReadCount(0), bloomSkipCount(0)
+{
+}
+
+// Destructor that stops the background thread.
+LsmAccountStore::~LsmAccountStore()
+{
+    close(); // Stops the background thread and closes the files.
+}
+
+// Returns the path of a file of the store directory.
+string LsmAccountStore::getFilePath(const string& fileName) const
+{
+    return directoryPath + "/" + fileName;
+}
+
+// Starts a new log and an empty memtable writing to it.
+void LsmAccountStore::startNewMemtable()
+{
+    uint64_t logNumber = nextFileNumber++; // Numbers the new log.
+    logFile.close(); // Closes the previous log; its records stay on disk until their memtable is written as a run.
+    logFile.clear(); // Clears the stream flags so the stream can be opened again.
+    logFile.open(getFilePath(makeFileName(LOG_FILE_PREFIX, logNumber, LOG_FILE_SUFFIX)), ios::out | ios::binary | ios::trunc); // Creates the log.
+    if (!logFile.is_open())
+        throw InvalidFileException(); // Throws an exception if the log could not be created.
+    activeMemtable = make_shared<LsmMemtable>(); // Creates the empty memtable.
+    activeMemtable->logNumber = logNumber; // Links it to its log.
+}
+
+// Hands the full memtable to the background thread and starts a new one.
+void LsmAccountStore::freezeMemtable()
+{
+    unique_lock<mutex> lock(stateMutex); // Guards the memtable queue.
+    stateChanged.wait(lock, [this]() { return immutableMemtables.size() < static_cast<size_t>(LSM_MAX_IMMUTABLE_MEMTABLES) || backgroundFailed; }); // Waits while the background thread is behind.
+    if (backgroundFailed)
+        throw InvalidFileException(); // Throws an exception if the background thread can no longer write runs.
+    immutableMemtables.push_back(activeMemtable); // Queues the full memtable.
+    startNewMemtable(); // Starts a new memtable and log.
+    stateChanged.notify_all(); // Wakes the background thread.
+}
+
+// Appends a record to the log and the active memtable.
+void LsmAccountStore::writeRecord(const vector<string>& account)
+{
+    AccountRecord record = {}; // Stores the record (zero-initialized).
+    record.sequence = ++lastSequence; // Gives the record the next sequence number, so the newest version wins every merge.
+    fillAccountRecord(record, account); // Converts the account.
+    writeFileBytes(logFile, reinterpret_cast<const char*>(&record), sizeof(record)); // Appends the record to the log.
+    logFile.flush(); // Hands the record to the operating system before the write is acknowledged.
+    if (!logFile)
+        throw InvalidFileException(); // Throws an exception if the log could not be written.
+    activeMemtable->records[record.accountID] = record; // Replaces the previous version in the memtable.
+    maxAccountID = max(maxAccountID, record.accountID); // Tracks the largest account ID.
+    if (activeMemtable->records.size() >= static_cast<size_t>(LSM_MEMTABLE_RECORD_LIMIT))
+        freezeMemtable(); // Hands the memtable over once it is full.
+}
+
+// Writes the manifest through a temporary file and a rename.
+void LsmAccountStore::writeManifest()
+{
+    ManifestHeader header = {}; // Stores the fixed part (zero-initialized).
+    memcpy(header.magic, MANIFEST_MAGIC, sizeof(header.magic)); // Stores the magic bytes.
+    header.version = LSM_VERSION; // Stores the format version.
+    header.runCount = static_cast<uint32_t>(sortedRuns.size()); // Stores the number of runs.
+    header.nextFileNumber = nextFileNumber; // Stores the next file number.
+    header.minimumLogNumber = immutableMemtables.empty() ? activeMemtable->logNumber : immutableMemtables.front()->logNumber; // Stores the oldest log still needed.
+    vector<uint64_t> runNumbers; // Stores the run numbers, oldest first.
+    for (const shared_ptr<LsmSortedRun>& run : sortedRuns)
+        runNumbers.push_back(run->fileNumber); // Adds the run number.
+    uint32_t checksum = computeCRC32C(&header, sizeof(header)); // Checksums the fixed part.
+    checksum = computeCRC32C(runNumbers.data(), runNumbers.size() * sizeof(uint64_t), checksum); // Continues with the run numbers.
+
+    string manifestPath = getFilePath(MANIFEST_FILE_NAME); // Stores the path of the manifest.
+    string temporaryPath = manifestPath + ".tmp"; // Stores the path of the temporary file.
+    ofstream manifestFile(temporaryPath, ios::out | ios::binary | ios::trunc); // Creates the temporary file.
+    writeFileBytes(manifestFile, reinterpret_cast<const char*>(&header), sizeof(header)); // Writes the fixed part.
+    writeFileBytes(manifestFile, reinterpret_cast<const char*>(runNumbers.data()), runNumbers.size() * sizeof(uint64_t)); // Writes the run numbers.
+    writeFileBytes(manifestFile, reinterpret_cast<const char*>(&checksum), sizeof(checksum)); // Writes the checksum.
+    manifestFile.close(); // Closes the file, writing its buffer.
+    if (!manifestFile)
+        throw InvalidFileException(); // Throws an exception if the manifest could not be written.
+    error_code renameError; // Stores the result of the rename.
+    filesystem::rename(temporaryPath, manifestPath, renameError); // Replaces the previous manifest in one step.
+    if (renameError)
+        throw InvalidFileException(); // Throws an exception if the rename failed.
+}
+
+// Deletes the logs older than the given number.
+void LsmAccountStore::removeObsoleteLogs(uint64_t minimumLogNumber)
+{
+    error_code listError; // Stores the result of listing the directory.
+    for (const filesystem::directory_entry& entry : filesystem::directory_iterator(directoryPath, listError))
+    {
+        uint64_t logNumber; // Stores the number of the log.
+        if (parseFileNumber(entry.path().filename().string(), LOG_FILE_PREFIX, LOG_FILE_SUFFIX, logNumber) && logNumber < minimumLogNumber)
+        {
+            error_code removeError; // Ignores a failed removal; the log is skipped when the store is opened.
+            filesystem::remove(entry.path(), removeError); // Deletes the log.
+        }
+    }
+}
+
+// Deletes every file of the store and starts it empty.
+void LsmAccountStore::resetStore()
+{
+    sortedRuns.clear(); // Closes the runs.
+    immutableMemtables.clear(); // Drops the waiting memtables.
+    logFile.close(); // Closes the log.
+    error_code listError; // Stores the result of listing the directory.
+    vector<filesystem::path> storeFiles; // Stores the files to delete.
+    for (const filesystem::directory_entry& entry : filesystem::directory_iterator(directoryPath, listError))
+    {
+        string fileName = entry.path().filename().string(); // Gets the file name.
+        if (fileName.compare(0, strlen(MANIFEST_FILE_NAME), MANIFEST_FILE_NAME) == 0 || fileName.compare(0, strlen(LOG_FILE_PREFIX), LOG_FILE_PREFIX) == 0 ||
+            fileName.compare(0, strlen(RUN_FILE_PREFIX), RUN_FILE_PREFIX) == 0)
+            storeFiles.push_back(entry.path()); // Collects the files of the store.
+    }
+    for (const filesystem::path& storeFile : storeFiles)
+    {
+        error_code removeError; // Ignores a failed removal; the file is no longer referenced.
+        filesystem::remove(storeFile, removeError); // Deletes the file.
+    }
+    nextFileNumber = 1; // Restarts the file numbers.
+    lastSequence = 0; // Restarts the sequence numbers.
+    maxAccountID = 0; // Marks the store as empty.
+}
+
+// Opens the store directory, loads the runs, replays the logs and starts the background thread.
+void LsmAccountStore::open(const string& path)
+{
+    close(); // Closes any store opened before.
+    directoryPath = path; // Stores the directory path.
+    error_code directoryError; // Stores the result of creating the directory.
+    filesystem::create_directories(path, directoryError); // Creates the directory if it does not exist.
+    if (directoryError)
+        throw InvalidFileException(); // Throws an exception if the directory could not be created.
+    stopRequested = false; // Clears the flags of the background thread.
+    backgroundBusy = false;
+    backgroundFailed = false;
+    lastSequence = 0; // Restarts the counters of the previous store.
+    maxAccountID = 0;
+    nextFileNumber = 1;
+
+    lock_guard<mutex> lock(stateMutex); // Guards the state while it is loaded, as startNewMemtable and writeManifest expect.
+
+    // Loads the runs listed by the manifest.
+    ManifestHeader manifest = {}; // Stores the fixed part of the manifest.
+    vector<uint64_t> runNumbers; // Stores the live run numbers.
+    bool valid = false; // Stores whether the store could be loaded.
+    try
+    {
+        if (readManifest(getFilePath(MANIFEST_FILE_NAME), manifest, runNumbers))
+        {
+            for (uint64_t runNumber : runNumbers)
+            {
+                shared_ptr<LsmSortedRun> run = loadSortedRun(getFilePath(makeFileName(RUN_FILE_PREFIX, runNumber, RUN_FILE_SUFFIX)), runNumber); // Opens the run.
+                lastSequence = max(lastSequence, run->header.maxSequence); // Tracks the newest sequence number.
+                maxAccountID = max(maxAccountID, run->header.maxAccountID); // Tracks the largest account ID.
+                sortedRuns.push_back(run); // Adds the run.
+            }
+            nextFileNumber = manifest.nextFileNumber; // Continues the file numbers.
+            valid = true; // Marks the store as loaded.
+        }
+    }
+    catch (InvalidRunException)
+    {
+        valid = false; // Treats a damaged store like a missing one.
+    }
+    if (!valid)
+        resetStore(); // Starts an empty store; it is rebuilt from the loaded accounts.
+
+    // Finds the logs written since the last flush, and the largest file number in use.
+    vector<uint64_t> logNumbers; // Stores the numbers of the logs to replay.
+    error_code listError; // Stores the result of listing the directory.
+    for (const filesystem::directory_entry& entry : filesystem::directory_iterator(directoryPath, listError))
+    {
+        string fileName = entry.path().filename().string(); // Gets the file name.
+        uint64_t fileNumber; // Stores the number of the file.
+        if (parseFileNumber(fileName, LOG_FILE_PREFIX, LOG_FILE_SUFFIX, fileNumber))
+        {
+            if (valid && fileNumber >= manifest.minimumLogNumber)
+                logNumbers.push_back(fileNumber); // Replays the logs not yet in runs.
+            nextFileNumber = max(nextFileNumber, fileNumber + 1); // Never reuses a file number.
+        }
+        else if (parseFileNumber(fileName, RUN_FILE_PREFIX, RUN_FILE_SUFFIX, fileNumber))
+        {
+            nextFileNumber = max(nextFileNumber, fileNumber + 1); // Never reuses a file number.
+        }
+    }
+    sort(logNumbers.begin(), logNumbers.end()); // Replays the logs in the order they were written.
+
+    // Replays the logs into a memtable, stopping each log at its first torn record.
+    shared_ptr<LsmMemtable> recovered = make_shared<LsmMemtable>(); // Stores the replayed records.
+    recovered->logNumber = logNumbers.empty() ? 0 : logNumbers.front(); // Links it to the oldest replayed log.
+    for (uint64_t logNumber : logNumbers)
+    {
+        ifstream replayFile(getFilePath(makeFileName(LOG_FILE_PREFIX, logNumber, LOG_FILE_SUFFIX)), ios::in | ios::binary); // Opens the log.
+        AccountRecord record; // Stores the record being read.
+        while (replayFile.read(reinterpret_cast<char*>(&record), sizeof(record)) && hasValidChecksum(record))
+        {
+            AccountRecord& current = recovered->records[record.accountID]; // Gets the replayed version of the account.
+            if (record.sequence >= current.sequence)
+                current = record; // Keeps the newest version.
+            lastSequence = max(lastSequence, record.sequence); // Tracks the newest sequence number.
+            maxAccountID = max(maxAccountID, record.accountID); // Tracks the largest account ID.
+        }
+    }
+
+    startNewMemtable(); // Starts the memtable and log for new writes.
+    if (!recovered->records.empty())
+        immutableMemtables.push_back(recovered); // Has the replayed records written as a run, which also retires their logs.
+    writeManifest(); // Records the state of the opened store.
+    if (recovered->records.empty())
+        removeObsoleteLogs(activeMemtable->logNumber); // Deletes the empty logs left by the previous run of the program.
+    opened = true; // Marks the store as open.
+    backgroundThread = thread(&LsmAccountStore::backgroundLoop, this); // Starts the background thread.
+}
+
+// Stops the background thread and closes the files.
+void LsmAccountStore::close()
+{
+    if (!opened)
+        return; // Returns if the store is closed.
+    {
+        lock_guard<mutex> lock(stateMutex); // Guards the stop flag.
+        stopRequested = true; // Asks the background thread to finish.
+    }
+    stateChanged.notify_all(); // Wakes the background thread.
+    backgroundThread.join(); // Waits until the waiting memtables are written.
+    logFile.close(); // Closes the log; its records are replayed when the store is opened again.
+    sortedRuns.clear(); // Closes the runs.
+    immutableMemtables.clear(); // Drops the memtables; their logs are still on disk if they could not be written.
+    activeMemtable.reset(); // Drops the active memtable; its log is still on disk.
+    opened = false; // Marks the store as closed.
+}
+
+// Flushes memtables and compacts runs until the store is closed.
+void LsmAccountStore::backgroundLoop()
+{
+    unique_lock<mutex> lock(stateMutex); // Guards the state between tasks.
+    while (true)
+    {
+        stateChanged.wait(lock, [this]() { return stopRequested || !immutableMemtables.empty() || sortedRuns.size() > static_cast<size_t>(LSM_MAX_RUN_COUNT); }); // Waits for work.
+        bool flush = !immutableMemtables.empty(); // Writes memtables before merging runs, so writers are not held up.
+        if (!flush && stopRequested)
+            break; // Finishes once every waiting memtable is written.
+        backgroundBusy = true; // Tells rebuild to wait for this task.
+        lock.unlock(); // Lets writers and readers continue during the slow part.
+        bool failed = false; // Stores whether the task failed.
+        try
+        {
+            if (flush)
+                flushOldestMemtable(); // Writes the oldest waiting memtable.
+            else
+                compactRuns(); // Merges the runs.
+        }
+        catch (InvalidFileException)
+        {
+            failed = true; // The logs still hold the records, so nothing is lost.
+        }
+        catch (InvalidRunException)
+        {
+            failed = true;
+        }
+        lock.lock(); // Takes the lock back.
+        backgroundBusy = false; // Marks the task as finished.
+        backgroundFailed = failed; // Reports a failure to the writers.
+        stateChanged.notify_all(); // Wakes writers waiting for room or for the task to finish.
+        if (failed)
+            break; // Stops background work; new writes fail once the memtable queue is full.
+    }
+}
+
+// Writes the oldest waiting memtable as a run and retires its log.
+void LsmAccountStore::flushOldestMemtable()
+{
+    shared_ptr<LsmMemtable> memtable; // Stores the memtable to write.
+    uint64_t runNumber; // Stores the number of the new run.
+    {
+        lock_guard<mutex> lock(stateMutex); // Guards the memtable queue.
+        memtable = immutableMemtables.front(); // Takes the oldest memtable; readers still see it until the run replaces it.
+        runNumber = nextFileNumber++; // Numbers the run.
+    }
+    vector<AccountRecord> records; // Stores the records in account ID order.
+    records.reserve(memtable->records.size()); // Allocates the records once.
+    for (const pair<const int32_t, AccountRecord>& entry : memtable->records)
+        records.push_back(entry.second); // Copies the records; the map is already sorted.
+    shared_ptr<LsmSortedRun> run = writeSortedRun(getFilePath(makeFileName(RUN_FILE_PREFIX, runNumber, RUN_FILE_SUFFIX)), runNumber, records); // Writes the run.
+    uint64_t minimumLogNumber; // Stores the oldest log still needed.
+    {
+        lock_guard<mutex> lock(stateMutex); // Guards the runs and the memtable queue.
+        sortedRuns.push_back(run); // Adds the run as the newest.
+        immutableMemtables.pop_front(); // Drops the written memtable.
+        writeManifest(); // Records the new run.
+        minimumLogNumber = immutableMemtables.empty() ? activeMemtable->logNumber : immutableMemtables.front()->logNumber; // Finds the oldest log still needed.
+    }
+    removeObsoleteLogs(minimumLogNumber); // Deletes the logs now held by runs.
+}
+
+// Merges every current run into one.
+void LsmAccountStore::compactRuns()
+{
+    vector<shared_ptr<LsmSortedRun>> inputs; // Stores the runs to merge.
+    uint64_t runNumber; // Stores the number of the merged run.
+    {
+        lock_guard<mutex> lock(stateMutex); // Guards the runs.
+        inputs = sortedRuns; // Takes every current run.
+        runNumber = nextFileNumber++; // Numbers the merged run.
+    }
+    vector<AccountRecord> records; // Stores the records of every run.
+    for (const shared_ptr<LsmSortedRun>& run : inputs)
+        readRunRecords(*run, 0, static_cast<size_t>(run->header.recordCount), records); // Reads the whole run.
+    records.erase(remove_if(records.begin(), records.end(), [](const AccountRecord& record) { return !hasValidChecksum(record); }), records.end()); // Drops damaged records.
+    sort(records.begin(), records.end(), [](const AccountRecord& left, const AccountRecord& right)
+        { return left.accountID != right.accountID ? left.accountID < right.accountID : left.sequence > right.sequence; }); // Orders by account, newest version first.
+    records.erase(unique(records.begin(), records.end(), [](const AccountRecord& left, const AccountRecord& right) { return left.accountID == right.accountID; }), records.end()); // Keeps the newest version of each account.
+    shared_ptr<LsmSortedRun> merged = writeSortedRun(getFilePath(makeFileName(RUN_FILE_PREFIX, runNumber, RUN_FILE_SUFFIX)), runNumber, records); // Writes the merged run.
+    {
+        lock_guard<mutex> lock(stateMutex); // Guards the runs.
+        sortedRuns.erase(sortedRuns.begin(), sortedRuns.begin() + inputs.size()); // Removes the inputs; only newer runs were added meanwhile.
+        sortedRuns.insert(sortedRuns.begin(), merged); // Adds the merged run as the oldest.
+        writeManifest(); // Records the merge.
+    }
+    for (const shared_ptr<LsmSortedRun>& run : inputs)
+        run->obsolete = true; // Deletes each input file once its last reader releases it.
+    compactionCount++; // Counts the merge.
+}
+
+// Replaces the store with the given account vectors, written as a single run.
+void LsmAccountStore::rebuild(const vector<vector<string>>& accountVectors)
+{
+    vector<AccountRecord> records(accountVectors.size()); // Stores the records (zero-initialized).
+    for (size_t i = 0; i < accountVectors.size(); i++)
+    {
+        records[i].sequence = ++lastSequence; // Gives every record a sequence number newer than any stored one.
+        fillAccountRecord(records[i], accountVectors[i]); // Converts the account.
+    }
+    sort(records.begin(), records.end(), [](const AccountRecord& left, const AccountRecord& right) { return left.accountID < right.accountID; }); // Sorts the records by account ID.
+
+    unique_lock<mutex> lock(stateMutex); // Guards the runs and the memtables.
+    stateChanged.wait(lock, [this]() { return !backgroundBusy && (immutableMemtables.empty() || backgroundFailed); }); // Waits until the background thread is idle.
+    for (const shared_ptr<LsmSortedRun>& run : sortedRuns)
+        run->obsolete = true; // Deletes every old run.
+    sortedRuns.clear(); // Drops the old runs.
+    immutableMemtables.clear(); // Drops the old memtables.
+    uint64_t runNumber = nextFileNumber++; // Numbers the new run.
+    sortedRuns.push_back(writeSortedRun(getFilePath(makeFileName(RUN_FILE_PREFIX, runNumber, RUN_FILE_SUFFIX)), runNumber, records)); // Writes the accounts as one run.
+    startNewMemtable(); // Starts an empty memtable and log.
+    writeManifest(); // Records the new run.
+    uint64_t minimumLogNumber = activeMemtable->logNumber; // Every older log is replaced by the new run.
+    lock.unlock(); // Releases the lock before deleting files.
+    removeObsoleteLogs(minimumLogNumber); // Deletes the old logs.
+    maxAccountID = static_cast<int32_t>(accountVectors.size()); // Stores the new record count.
+}
+
+// Rebuilds the store from the remaining accounts, since a run cannot drop or renumber its records.
+void LsmAccountStore::removeRecords(const vector<size_t>&, const vector<vector<string>>& remainingAccounts)
+{
+    rebuild(remainingAccounts); // Writes the renumbered accounts as a single run.
+}
+
+// Appends the new version of the account to the log and the memtable.
+void LsmAccountStore::updateRecord(size_t, const vector<string>& account)
+{
+    writeRecord(account); // Writes the record; older versions are dropped by later merges.
+}
+
+// Appends the new account to the log and the memtable.
+void LsmAccountStore::appendRecord(const vector<string>& account)
+{
+    writeRecord(account); // Writes the record.
+}
+
+// Merges the runs and memtables, keeping the version with the largest sequence number of every account.
+void LsmAccountStore::mergeNewestRecords(vector<AccountRecord>& newest, vector<char>& present)
+{
+    size_t recordCount = getRecordCount(); // Stores the number of accounts stored.
+    newest.assign(recordCount, AccountRecord()); // Stores the newest version of each account, by position.
+    present.assign(recordCount, 0); // Stores whether a version was found for each position.
+    vector<shared_ptr<LsmSortedRun>> runs; // Stores the runs to read.
+    vector<shared_ptr<LsmMemtable>> memtables; // Stores the memtables to read, oldest first.
+    {
+        lock_guard<mutex> lock(stateMutex); // Guards the runs and the memtable queue.
+        runs = sortedRuns; // Copies the run list.
+        memtables.assign(immutableMemtables.begin(), immutableMemtables.end()); // Copies the waiting memtables.
+    }
+    memtables.push_back(activeMemtable); // Adds the active memtable as the newest.
+
+    auto keepNewest = [&](const AccountRecord& record)
+    {
+        if (!hasValidChecksum(record) || record.accountID < 1 || static_cast<size_t>(record.accountID) > recordCount)
+            return; // Skips damaged records.
+        size_t position = record.accountID - 1; // Gets the position of the account.
+        if (!present[position] || record.sequence > newest[position].sequence)
+        {
+            newest[position] = record; // Keeps the newer version.
+            present[position] = 1; // Marks the account as found.
+        }
+    };
+    vector<AccountRecord> runRecords; // Stores a chunk of run records.
+    for (const shared_ptr<LsmSortedRun>& run : runs)
+    {
+        for (size_t first = 0; first < run->header.recordCount; first += RUN_SCAN_RECORD_COUNT)
+        {
+            runRecords.clear(); // Reuses the chunk buffer.
+            readRunRecords(*run, first, min<size_t>(RUN_SCAN_RECORD_COUNT, static_cast<size_t>(run->header.recordCount) - first), runRecords); // Reads the next chunk.
+            for (const AccountRecord& record : runRecords)
+                keepNewest(record); // Merges the record.
+        }
+    }
+    for (const shared_ptr<LsmMemtable>& memtable : memtables)
+        for (const pair<const int32_t, AccountRecord>& entry : memtable->records)
+            keepNewest(entry.second); // Merges the memtable records.
+}
+
+// Merges the runs and memtables and applies the newest version of each account.
+long long LsmAccountStore::applyTo(vector<vector<string>>& accountVectors)
+{
+    size_t recordCount = getRecordCount(); // Stores the number of accounts stored.
+    if (!opened || recordCount < accountVectors.size())
+        return -1; // Reports that the store does not describe the same accounts.
+    vector<AccountRecord> newest; // Stores the newest version of each account, by position.
+    vector<char> present; // Stores whether a version was found for each position.
+    mergeNewestRecords(newest, present); // Merges every run and memtable.
+
+    // Applies the loaded accounts, then appends the accounts created after the last save.
+    size_t loadedCount = accountVectors.size(); // Stores the number of accounts loaded from the snapshot or the CSV file.
+    long long appliedCount = 0; // Counts the applied records.
+    for (size_t i = 0; i < loadedCount; i++)
+    {
+        if (!present[i] || newest[i].nationalID != parseLongLong(accountVectors[i][1]))
+            continue; // Skips accounts that are missing or describe a different owner.
+        vector<string>& account = accountVectors[i]; // Gets the account.
+        account[2] = formatDouble(newest[i].balance); // Applies the balance.
+        account[3] = convertRecordDateTimeToString(newest[i]); // Applies the creation date-time, which changes when a certificate is renewed.
+        if (newest[i].accountType == CERTIFICATE_ACCOUNT_RECORD)
+        {
+            account[4] = formatDouble(newest[i].interestRatePercent); // Applies the interest rate.
+            account[5] = formatDouble(newest[i].withdrawnAmount); // Applies the withdrawn amount.
+        }
+        appliedCount++; // Counts the applied record.
+    }
+    for (size_t i = loadedCount; i < recordCount && present[i]; i++)
+    {
+        accountVectors.push_back(convertAccountRecordToVector(newest[i])); // Adds the account.
+        appliedCount++; // Counts the applied record.
+    }
+    if (accountVectors.size() < recordCount)
+        return -1; // Has the store rebuilt without the records that could not be placed.
+    return appliedCount; // Returns the number of applied records.
+}
+
+// Finds the newest version of an account, checking the memtables and then the runs from newest to oldest.
+bool LsmAccountStore::findRecord(int32_t accountID, AccountRecord& record)
+{
+    pointReadCount++; // Counts the lookup.
+    map<int32_t, AccountRecord>::const_iterator entry = activeMemtable->records.find(accountID); // Looks in the active memtable.
+    if (entry != activeMemtable->records.end())
+    {
+        record = entry->second; // Returns the newest version.
+        return true;
+    }
+    vector<shared_ptr<LsmSortedRun>> runs; // Stores the runs to search.
+    vector<shared_ptr<LsmMemtable>> memtables; // Stores the waiting memtables.
+    {
+        lock_guard<mutex> lock(stateMutex); // Guards the runs and the memtable queue.
+        runs = sortedRuns; // Copies the run list.
+        memtables.assign(immutableMemtables.begin(), immutableMemtables.end()); // Copies the waiting memtables.
+    }
+    for (size_t i = memtables.size(); i-- > 0;)
+    {
+        entry = memtables[i]->records.find(accountID); // Looks in the waiting memtables, newest first.
+        if (entry != memtables[i]->records.end())
+        {
+            record = entry->second; // Returns the newest version.
+            return true;
+        }
+    }
+    for (size_t i = runs.size(); i-- > 0;)
+    {
+        LsmSortedRun& run = *runs[i]; // Gets the run, newest first.
+        if (run.header.recordCount == 0 || accountID < run.header.minAccountID || accountID > run.header.maxAccountID)
+            continue; // Skips runs whose range does not cover the ID.
+        if (!accessBloomFilter(run.bloomWords, run.header.bloomHashCount, accountID, false))
+        {
+            bloomSkipCount++; // Counts the run skipped without a read.
+            continue;
+        }
+        size_t block = static_cast<size_t>(upper_bound(run.blockFirstIDs.begin(), run.blockFirstIDs.end(), accountID) - run.blockFirstIDs.begin()) - 1; // Finds the block covering the ID.
+        size_t firstRecord = block * run.header.blockRecordCount; // Gets the first record of the block.
+        vector<AccountRecord> blockRecords; // Stores the block.
+        readRunRecords(run, firstRecord, min<size_t>(run.header.blockRecordCount, static_cast<size_t>(run.header.recordCount) - firstRecord), blockRecords); // Reads the block.
+        vector<AccountRecord>::const_iterator found = lower_bound(blockRecords.begin(), blockRecords.end(), accountID,
+            [](const AccountRecord& blockRecord, int32_t searchedID) { return blockRecord.accountID < searchedID; }); // Binary searches the block.
+        if (found != blockRecords.end() && found->accountID == accountID && hasValidChecksum(*found))
+        {
+            record = *found; // Returns the newest version.
+            return true;
+        }
+    }
+    return false; // Returns false if no version was found.
+}
+
+// Finds the newest version of the account with the given ID and checks that it belongs to the person.
+bool LsmAccountStore::findRecord(int64_t nationalID, int32_t accountID, AccountRecord& record)
+{
+    AccountRecord newest; // Stores the newest version of the account.
+    if (!opened || !findRecord(accountID, newest) || newest.nationalID != nationalID || !hasValidChecksum(newest))
+        return false; // Returns false if the account is missing, damaged or owned by someone else.
+    record = newest; // Copies the record.
+    return true;
+}
+
+// Merges every run and memtable, since the store is ordered by account ID only, and keeps the person's accounts.
+void LsmAccountStore::findRecordsOfPerson(int64_t nationalID, vector<AccountRecord>& records)
+{
+    if (!opened)
+        return; // Returns if the store is closed.
+    vector<AccountRecord> newest; // Stores the newest version of each account, by position.
+    vector<char> present; // Stores whether a version was found for each position.
+    mergeNewestRecords(newest, present); // Merges every run and memtable.
+    for (size_t i = 0; i < newest.size(); i++)
+        if (present[i] && newest[i].nationalID == nationalID)
+            records.push_back(newest[i]); // Keeps the person's account.
+}
+
+// Forces the logs still holding records that are not in runs to the disk.
+void LsmAccountStore::sync()
+{
+    logFile.flush(); // Hands the buffered records of the active log to the operating system.
+    vector<uint64_t> logNumbers; // Stores the numbers of the logs to synchronize.
+    {
+        lock_guard<mutex> lock(stateMutex); // Guards the memtable queue.
+        for (const shared_ptr<LsmMemtable>& memtable : immutableMemtables)
+            logNumbers.push_back(memtable->logNumber); // Adds the logs of the memtables waiting to be written.
+    }
+    logNumbers.push_back(activeMemtable->logNumber); // Adds the active log.
+    for (uint64_t logNumber : logNumbers)
+    {
+        string logPath = getFilePath(makeFileName(LOG_FILE_PREFIX, logNumber, LOG_FILE_SUFFIX)); // Gets the path of the log.
+        if (!syncFileToDisk(logPath) && filesystem::exists(logPath))
+            throw InvalidFileException(); // Throws an exception if a log could not be synchronized; a log written as a run meanwhile is gone.
+    }
+}
+
+// Returns the run, memtable, compaction and bloom filter counters.
+StorageStatistics LsmAccountStore::getStatistics() const
+{
+    StorageStatistics statistics = {}; // Stores the counters (zero-initialized).
+    statistics.backendName = "LSM tree"; // Names the store.
+    lock_guard<mutex> lock(stateMutex); // Guards the runs and the memtable queue.
+    statistics.sortedRuns = static_cast<long long>(sortedRuns.size()); // Counts the runs.
+    statistics.memtableRecords = activeMemtable ? static_cast<long long>(activeMemtable->records.size()) : 0; // Counts the active memtable records.
+    for (const shared_ptr<LsmMemtable>& memtable : immutableMemtables)
+        statistics.memtableRecords += static_cast<long long>(memtable->records.size()); // Adds the waiting memtable records.
+    statistics.compactions = compactionCount; // Copies the merge count.
+    statistics.pointReads = pointReadCount; // Copies the lookup count.
+    statistics.bloomFilterSkips = bloomSkipCount; // Copies the bloom filter skip count.
+    return statistics;
+}
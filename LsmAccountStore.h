@@ -0,0 +1,180 @@
+// This is the specification file for the LsmAccountStore class,
+// a log-structured merge account store built for streams of deposits and withdrawals.
+// A change is appended to a write-ahead log and kept in an in-memory table (the memtable);
+// full memtables are written as sorted, immutable runs by a background thread,
+// which also merges the runs when there are too many of them.
+// A write never reads or rewrites existing data, so writes stay cheap however large the book is.
+
+/*
+	Store directory layout:
+	- MANIFEST: the live run numbers, the next file number, and the oldest log still needed,
+	  followed by a CRC32C; rewritten through a temporary file and a rename
+	- wal-<number>.log: account records in the order they were written, each with its own checksum,
+	  replayed into the memtable when the store is opened
+	- run-<number>.dat: a header, a bloom filter of the account IDs, the records sorted by account ID,
+	  and the first account ID of every block of records
+*/
+
+// These are the include guards
+#pragma once
+#ifndef LSMACCOUNTSTORE_H
+#define LSMACCOUNTSTORE_H
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+#include "AccountStore.h"
+using namespace std;
+
+// Holds the records written since the last flush and the number of the oldest log holding them
+struct LsmMemtable;
+
+// Holds an open run file with its bloom filter and block index
+struct LsmSortedRun;
+
+class LsmAccountStore : public AccountStore
+{
+private:
+	string directoryPath;                             // Holds the path of the store directory
+	bool opened;                                      // Holds whether the store is open
+	shared_ptr<LsmMemtable> activeMemtable;           // Holds the memtable receiving the writes
+	ofstream logFile;                                 // Holds the log of the active memtable
+	deque<shared_ptr<LsmMemtable>> immutableMemtables; // Holds the full memtables waiting to be written, oldest first
+	vector<shared_ptr<LsmSortedRun>> sortedRuns;      // Holds the live runs, oldest first
+	uint64_t nextFileNumber;                          // Holds the number given to the next log or run file
+	uint64_t lastSequence;                            // Holds the sequence number of the newest record
+	int32_t maxAccountID;                             // Holds the largest account ID stored
+	mutable mutex stateMutex;                         // Guards the immutable memtables, the runs and the manifest
+	condition_variable stateChanged;                  // Wakes the background thread and the writers waiting for it
+	thread backgroundThread;                          // Holds the thread that flushes memtables and compacts runs
+	bool stopRequested;                               // Asks the background thread to finish
+	bool backgroundBusy;                              // Set while the background thread works outside the lock
+	bool backgroundFailed;                            // Set when the background thread failed to write a file
+	atomic<long long> compactionCount;                // Counts the run merges
+	atomic<long long> pointReadCount;                 // Counts the calls to findRecord
+	atomic<long long> bloomSkipCount;                 // Counts the runs skipped by their bloom filter during point reads
+
+	// Returns the path of a file of the store directory
+	string getFilePath(const string&) const;
+
+	// Starts a new log and an empty memtable writing to it; called with the state mutex held
+	void startNewMemtable();
+
+	// Hands the active memtable to the background thread, waiting if too many are already waiting
+	void freezeMemtable();
+
+	// Appends a record to the log and the active memtable
+	void writeRecord(const vector<string>&);
+
+	// Writes the manifest describing the current runs; called with the state mutex held
+	void writeManifest();
+
+	// Deletes the logs older than the given number, whose records are all in runs
+	void removeObsoleteLogs(uint64_t);
+
+	// Deletes every file of the store and starts it empty; called with the state mutex held
+	void resetStore();
+
+	// Runs on the background thread, flushing memtables and compacting runs until the store is closed
+	void backgroundLoop();
+
+	// Writes the oldest immutable memtable as a run
+	void flushOldestMemtable();
+
+	// Merges every current run into one, keeping the newest version of each account
+	void compactRuns();
+
+	/*
+		Merges the runs and memtables into the newest valid version of every account, stored at the position of its ID.
+		Positions without a valid version are marked zero in the second vector.
+	*/
+	void mergeNewestRecords(vector<AccountRecord>&, vector<char>&);
+
+public:
+	// Default constructor, the store starts closed
+	LsmAccountStore();
+
+	// Destructor that stops the background thread
+	~LsmAccountStore() override;
+
+	// The store owns a thread and open files, so it can be neither copied nor assigned
+	LsmAccountStore(const LsmAccountStore&) = delete;
+	LsmAccountStore& operator=(const LsmAccountStore&) = delete;
+
+	/*
+		Opens the store directory, creating it if needed, loads the runs listed by the manifest,
+		replays the logs into the memtable and starts the background thread.
+		A damaged manifest or run empties the store, which is then rebuilt from the loaded accounts.
+		Throws an InvalidFileException if the directory or a log cannot be created.
+	*/
+	void open(const string&) override;
+
+	// Stops the background thread after it writes the waiting memtables, and closes the files
+	void close() override;
+
+	// Returns true if the store is open
+	bool isOpen() const override
+	{
+		return opened;
+	}
+
+	// Returns the number of records, which is the largest account ID since IDs follow the account positions
+	size_t getRecordCount() const override
+	{
+		return static_cast<size_t>(maxAccountID);
+	}
+
+	/*
+		Replaces the store with the given account vectors, written as a single run,
+		after the background thread has finished its current work.
+	*/
+	void rebuild(const vector<vector<string>>&) override;
+
+	/*
+		Rebuilds the store from the remaining accounts: the runs have no deletions,
+		and every record after the first removed one would be rewritten with its new ID anyway.
+	*/
+	void removeRecords(const vector<size_t>&, const vector<vector<string>>&) override;
+
+	// Appends the new version of the account to the log and the memtable
+	void updateRecord(size_t, const vector<string>&) override;
+
+	// Appends the new account to the log and the memtable
+	void appendRecord(const vector<string>&) override;
+
+	/*
+		Merges the runs and memtables, keeping the newest version of each account,
+		copies each record over the account with its ID, then appends the accounts
+		created after the vector was last saved.
+	*/
+	long long applyTo(vector<vector<string>>&) override;
+
+	/*
+		Finds the newest version of the account with the given ID.
+		Looks in the memtables first, then in the runs from newest to oldest,
+		skipping the runs whose bloom filter rules the ID out and reading a single block of the others.
+		Returns false if the account is not stored.
+	*/
+	bool findRecord(int32_t, AccountRecord&);
+
+	// Finds the newest version of the account with findRecord and checks that it belongs to the person with the given national ID
+	bool findRecord(int64_t, int32_t, AccountRecord&) override;
+
+	// Merges every run and memtable like applyTo, since the runs are ordered by account ID only
+	void findRecordsOfPerson(int64_t, vector<AccountRecord>&) override;
+
+	// Forces the logs of the memtables not yet written as runs to the disk
+	void sync() override;
+
+	// Returns the run, memtable, compaction and bloom filter counters
+	StorageStatistics getStatistics() const override;
+};
+
+#endif
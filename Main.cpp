@@ -2,20 +2,20 @@
 #include <iostream>
 #include <ctime>
 #include "Program-Data-Functions.h"
+#include "Clock.h"
+#include "DateTime-Functions.h"
 using namespace std;
 
 // Entry point of the program, orchestrating the main application loop.
 int main(void)
 {
-    // Loads all persons from the Persons.csv file into the persons vector.
-    readAllSavedPersonsToThePersonsVector();
-    // Loads all accounts from the Accounts.csv file into the accounts vector.
-    readAllSavedAccountsToTheAccountsVector();
+    // Loads all persons and accounts, from the binary snapshot if it is up to date or from the CSV files otherwise.
+    loadProgramData();
     char choice = 'Y'; // Stores the user's choice to continue or exit the program.
     // Displays a welcome message and the current local date and time.
     cout << "Welcome to the Banking System!" << endl;
-    time_t timestamp = time(NULL);
-    cout << ctime(&timestamp) << endl;
+    time_t timestamp = getProgramClock().now();
+    cout << formatTimeForDisplay(timestamp) << endl << endl;
     cin.putback('\n'); // Inserts a newline into the input buffer to prevent issues with empty buffer checks.
 
     // Continues the program loop as long as the user chooses to proceed.
@@ -36,9 +36,7 @@ int main(void)
         cin >> choice; // Reads the user's choice to continue or exit.
     }
 
-    // Saves all accounts in the accounts vector to the Accounts.csv file to persist changes.
-    writeAllSavedAccountToCSVFile();
-    // Saves all persons in the persons vector to the Persons.csv file to persist changes.
-    writeAllSavedPersonsToTheCSVFile();
+    // Exports all persons and accounts to the CSV files and writes the binary snapshot to persist changes.
+    saveProgramData();
     return 0; // Exits the program successfully.
 }
\ No newline at end of file
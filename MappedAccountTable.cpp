@@ -0,0 +1,364 @@
+#include <cstring>
+#include <cstddef>
+#include "MappedAccountTable.h"
+#include "Checksum-Functions.h"
+#include "File-Functions.h"
+#include "Numeric-Functions.h"
+#include "Exceptions.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+using namespace std;
+
+// Identifies a table file.
+static const char TABLE_MAGIC[8] = { 'B', 'A', 'N', 'K', 'T', 'A', 'B', 'L' };
+
+// The format version written by this program; files with any other version are recreated.
+static const uint32_t TABLE_VERSION = 1;
+
+// The size of the header page; records start right after it.
+static const size_t TABLE_HEADER_SIZE = 4096;
+
+// The number of records the table grows by at least when it runs out of room.
+static const size_t TABLE_MINIMUM_CAPACITY = 1024;
+
+// Holds the fields stored at the start of the header page.
+struct AccountTableHeader
+{
+    char magic[8];           // Always TABLE_MAGIC
+    uint32_t version;        // Format version of the file
+    uint32_t recordSize;     // Size of one record, checked when the table is opened
+    uint64_t recordCount;    // Number of records in use
+    uint64_t capacity;       // Number of records the file has room for
+    uint32_t headerChecksum; // CRC32C of all the header bytes before this field
+    uint32_t reserved;       // Unused, always zero
+};
+
+// The header size is part of the file format, so it must not change with the compiler.
+static_assert(sizeof(AccountTableHeader) == 40, "The table header must be 40 bytes");
+
+// Default constructor, the table starts closed.
+MappedAccountTable::MappedAccountTable() : mappedData(nullptr), mappedSize(0)
+{
+#ifdef _WIN32
+    fileHandle = INVALID_HANDLE_VALUE; // Marks the file as closed.
+    mappingHandle = nullptr; // Marks the mapping as closed.
+#else
+    fileDescriptor = -1; // Marks the file as closed.
+#endif
+}
+
+// Destructor that unmaps the file.
+MappedAccountTable::~MappedAccountTable()
+{
+    close(); // Unmaps the file and closes its handles.
+}
+
+// Opens and maps the table file, starting an empty table if the file has no valid header.
+void MappedAccountTable::open(const string& path)
+{
+    close(); // Closes any table opened before.
+    filePath = path; // Stores the path for later remapping.
+#ifdef _WIN32
+    fileHandle = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr); // Opens or creates the file.
+    if (fileHandle == INVALID_HANDLE_VALUE)
+        throw InvalidFileException(); // Throws an exception if the file failed to open.
+    LARGE_INTEGER fileSize; // Stores the current size of the file.
+    GetFileSizeEx(fileHandle, &fileSize); // Reads the size of the file.
+    size_t existingSize = static_cast<size_t>(fileSize.QuadPart); // Converts the size.
+#else
+    fileDescriptor = ::open(path.c_str(), O_RDWR | O_CREAT, 0644); // Opens or creates the file.
+    if (fileDescriptor < 0)
+        throw InvalidFileException(); // Throws an exception if the file failed to open.
+    struct stat fileStatus; // Stores the file information.
+    fstat(fileDescriptor, &fileStatus); // Reads the size of the file.
+    size_t existingSize = static_cast<size_t>(fileStatus.st_size); // Converts the size.
+#endif
+
+    // Maps the existing file and checks its header.
+    if (existingSize >= TABLE_HEADER_SIZE)
+    {
+        mapFile((existingSize - TABLE_HEADER_SIZE) / sizeof(AccountRecord)); // Maps the whole existing file.
+        AccountTableHeader header; // Stores a copy of the header.
+        memcpy(&header, mappedData, sizeof(header)); // Copies the header out of the mapping.
+        if (memcmp(header.magic, TABLE_MAGIC, sizeof(header.magic)) == 0 && header.version == TABLE_VERSION &&
+            header.recordSize == sizeof(AccountRecord) && header.recordCount <= header.capacity && header.capacity <= getCapacity() &&
+            header.headerChecksum == computeCRC32C(&header, offsetof(AccountTableHeader, headerChecksum)))
+            return; // Keeps the existing table.
+    }
+
+    // Starts an empty table if the file is new or its header is not valid.
+    if (mappedData == nullptr)
+        mapFile(TABLE_MINIMUM_CAPACITY); // Creates room for the first records.
+    writeHeader(0, getCapacity()); // Writes an empty header.
+    flushRange(0, TABLE_HEADER_SIZE); // Makes the empty header durable.
+}
+
+// Unmaps the file and closes its handles.
+void MappedAccountTable::close()
+{
+    unmapFile(); // Unmaps the file.
+#ifdef _WIN32
+    if (fileHandle != INVALID_HANDLE_VALUE)
+        CloseHandle(fileHandle); // Closes the file.
+    fileHandle = INVALID_HANDLE_VALUE; // Marks the file as closed.
+#else
+    if (fileDescriptor >= 0)
+        ::close(fileDescriptor); // Closes the file.
+    fileDescriptor = -1; // Marks the file as closed.
+#endif
+}
+
+// Maps the file with room for the given number of records, growing the file if it is smaller.
+void MappedAccountTable::mapFile(size_t recordCapacity)
+{
+    unmapFile(); // Drops the previous mapping, if any.
+    size_t requiredSize = TABLE_HEADER_SIZE + recordCapacity * sizeof(AccountRecord); // Calculates the size of the file.
+#ifdef _WIN32
+    LARGE_INTEGER mappingSize; // Stores the size to map.
+    mappingSize.QuadPart = static_cast<LONGLONG>(requiredSize); // Converts the size.
+    mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READWRITE, mappingSize.HighPart, mappingSize.LowPart, nullptr); // Grows the file if needed and creates the mapping.
+    if (mappingHandle == nullptr)
+        throw InvalidFileException(); // Throws an exception if the mapping failed.
+    mappedData = static_cast<char*>(MapViewOfFile(mappingHandle, FILE_MAP_ALL_ACCESS, 0, 0, requiredSize)); // Maps the file.
+    if (mappedData == nullptr)
+        throw InvalidFileException(); // Throws an exception if the mapping failed.
+#else
+    struct stat fileStatus; // Stores the file information.
+    fstat(fileDescriptor, &fileStatus); // Reads the size of the file.
+    if (static_cast<size_t>(fileStatus.st_size) < requiredSize && ftruncate(fileDescriptor, static_cast<off_t>(requiredSize)) != 0)
+        throw InvalidFileException(); // Throws an exception if the file could not be grown.
+    void* mapping = mmap(nullptr, requiredSize, PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, 0); // Maps the file.
+    if (mapping == MAP_FAILED)
+        throw InvalidFileException(); // Throws an exception if the mapping failed.
+    mappedData = static_cast<char*>(mapping); // Stores the mapping.
+#endif
+    mappedSize = requiredSize; // Stores the mapped size.
+}
+
+// Unmaps the file.
+void MappedAccountTable::unmapFile()
+{
+    if (mappedData == nullptr)
+        return; // Returns if nothing is mapped.
+#ifdef _WIN32
+    UnmapViewOfFile(mappedData); // Unmaps the file.
+    CloseHandle(mappingHandle); // Closes the mapping.
+    mappingHandle = nullptr; // Marks the mapping as closed.
+#else
+    munmap(mappedData, mappedSize); // Unmaps the file.
+#endif
+    mappedData = nullptr; // Marks the table as unmapped.
+    mappedSize = 0; // Clears the mapped size.
+}
+
+// Flushes the given byte range of the mapping to disk, waiting until it is written.
+void MappedAccountTable::flushRange(size_t offset, size_t length)
+{
+#ifdef _WIN32
+    FlushViewOfFile(mappedData + offset, length); // Writes the dirty pages of the range.
+    FlushFileBuffers(fileHandle); // Waits until the file data reaches the disk.
+#else
+    size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE)); // Reads the page size.
+    size_t pageStart = offset - offset % pageSize; // Aligns the start down to a page, as msync requires.
+    msync(mappedData + pageStart, offset + length - pageStart, MS_SYNC); // Writes the dirty pages of the range and waits for them.
+#endif
+}
+
+// Copies bytes into the mapping, stopping the program part-way if the fault injection offset is reached.
+void MappedAccountTable::writeMappedBytes(size_t offset, const void* data, size_t size)
+{
+    bool keepRunning = reserveBytesForFaultInjection(size); // Shortens the copy if it reaches the offset.
+    memcpy(mappedData + offset, data, size); // Copies the bytes.
+    if (!keepRunning)
+    {
+        flushRange(offset, size); // Hands the partial copy to the file, as a crash would leave it.
+        stopForFaultInjection(); // Stops the program.
+    }
+}
+
+// Writes a fresh header for the given record count and capacity.
+void MappedAccountTable::writeHeader(size_t recordCount, size_t capacity)
+{
+    AccountTableHeader header = {}; // Stores the header (zero-initialized).
+    memcpy(header.magic, TABLE_MAGIC, sizeof(header.magic)); // Stores the magic bytes.
+    header.version = TABLE_VERSION; // Stores the format version.
+    header.recordSize = sizeof(AccountRecord); // Stores the record size.
+    header.recordCount = recordCount; // Stores the number of records.
+    header.capacity = capacity; // Stores the capacity.
+    header.headerChecksum = computeCRC32C(&header, offsetof(AccountTableHeader, headerChecksum)); // Checksums the header.
+    writeMappedBytes(0, &header, sizeof(header)); // Copies the header into the mapping.
+}
+
+// Returns the number of records the mapped file can hold.
+size_t MappedAccountTable::getCapacity() const
+{
+    return (mappedSize - TABLE_HEADER_SIZE) / sizeof(AccountRecord);
+}
+
+// Returns the number of records stored in the table.
+size_t MappedAccountTable::getRecordCount() const
+{
+    if (mappedData == nullptr)
+        return 0; // Returns 0 if the table is closed.
+    AccountTableHeader header; // Stores a copy of the header.
+    memcpy(&header, mappedData, sizeof(header)); // Copies the header out of the mapping.
+    return static_cast<size_t>(header.recordCount);
+}
+
+// Replaces the whole table with the given account vectors and flushes it.
+void MappedAccountTable::rebuild(const vector<vector<string>>& accountVectors)
+{
+    if (accountVectors.size() > getCapacity())
+        mapFile(max(accountVectors.size() * 2, TABLE_MINIMUM_CAPACITY)); // Grows the file, leaving room for new accounts.
+    for (size_t i = 0; i < accountVectors.size(); i++)
+    {
+        AccountRecord record = {}; // Stores the record, whose sequence restarts since it may now hold a different account.
+        fillAccountRecord(record, accountVectors[i]); // Converts the account.
+        writeMappedBytes(TABLE_HEADER_SIZE + i * sizeof(AccountRecord), &record, sizeof(record)); // Writes the record.
+    }
+    writeHeader(accountVectors.size(), getCapacity()); // Writes the new record count.
+    flushRange(0, TABLE_HEADER_SIZE + accountVectors.size() * sizeof(AccountRecord)); // Makes the whole table durable.
+}
+
+// Moves the kept records down over the removed ones, rewriting those that differ from the remaining accounts, and flushes the changed range.
+void MappedAccountTable::removeRecords(const vector<size_t>& removedIndexes, const vector<vector<string>>& remainingAccounts)
+{
+    if (mappedData == nullptr || removedIndexes.empty())
+        return; // Returns if there is nothing to remove.
+    size_t recordCount = getRecordCount(); // Stores the number of records before the removal.
+    const AccountRecord* records = reinterpret_cast<const AccountRecord*>(mappedData + TABLE_HEADER_SIZE); // Points to the first record.
+    size_t targetIndex = 0; // Stores the position the next kept record moves to.
+    size_t firstChangedIndex = recordCount; // Stores the first position written, where the flush starts.
+    size_t removedPosition = 0; // Stores the position of the next removed index.
+    for (size_t sourceIndex = 0; sourceIndex < recordCount; sourceIndex++)
+    {
+        if (removedPosition < removedIndexes.size() && removedIndexes[removedPosition] == sourceIndex)
+        {
+            removedPosition++; // Skips the removed record.
+            continue;
+        }
+        AccountRecord record = records[sourceIndex]; // Copies the kept record.
+        bool changed = targetIndex < remainingAccounts.size() ? refreshAccountRecord(record, remainingAccounts[targetIndex]) : false; // Renumbers it and applies the account's changes, or repairs a torn record.
+        if (changed || targetIndex != sourceIndex)
+        {
+            writeMappedBytes(TABLE_HEADER_SIZE + targetIndex * sizeof(AccountRecord), &record, sizeof(record)); // Writes it at its new position.
+            firstChangedIndex = min(firstChangedIndex, targetIndex); // Extends the range to flush.
+        }
+        targetIndex++; // Moves to the next position.
+    }
+    if (firstChangedIndex < targetIndex)
+        flushRange(TABLE_HEADER_SIZE + firstChangedIndex * sizeof(AccountRecord), (targetIndex - firstChangedIndex) * sizeof(AccountRecord)); // Makes the written records durable first.
+    writeHeader(targetIndex, getCapacity()); // Stores the new record count.
+    flushRange(0, TABLE_HEADER_SIZE); // Makes the header durable.
+}
+
+// Rewrites one record in place and flushes only the page(s) holding it.
+void MappedAccountTable::updateRecord(size_t index, const vector<string>& account)
+{
+    if (index >= getRecordCount())
+        return; // Ignores indexes outside the table; new accounts are added with appendRecord.
+    AccountRecord record = reinterpret_cast<const AccountRecord*>(mappedData + TABLE_HEADER_SIZE)[index]; // Copies the record.
+    record.sequence++; // Marks a new version of the record.
+    fillAccountRecord(record, account); // Rewrites the record and its checksum.
+    writeMappedBytes(TABLE_HEADER_SIZE + index * sizeof(AccountRecord), &record, sizeof(record)); // Writes the record back.
+    flushRange(TABLE_HEADER_SIZE + index * sizeof(AccountRecord), sizeof(AccountRecord)); // Flushes only this record's page.
+}
+
+// Writes a record after the last one and flushes it before the header that counts it.
+void MappedAccountTable::appendRecord(const vector<string>& account)
+{
+    size_t recordCount = getRecordCount(); // Stores the position of the new record.
+    if (recordCount == getCapacity())
+        mapFile(max(getCapacity() * 2, TABLE_MINIMUM_CAPACITY)); // Doubles the file when it is full.
+    AccountRecord record = {}; // Stores the new record, whose sequence starts at 0.
+    fillAccountRecord(record, account); // Converts the account and checksums the record.
+    writeMappedBytes(TABLE_HEADER_SIZE + recordCount * sizeof(AccountRecord), &record, sizeof(record)); // Writes the record.
+    flushRange(TABLE_HEADER_SIZE + recordCount * sizeof(AccountRecord), sizeof(AccountRecord)); // Makes the record durable first.
+    writeHeader(recordCount + 1, getCapacity()); // Counts the new record.
+    flushRange(0, TABLE_HEADER_SIZE); // Makes the header durable.
+}
+
+// Copies the valid records of the table over the matching account vectors and appends the newer accounts.
+long long MappedAccountTable::applyTo(vector<vector<string>>& accountVectors)
+{
+    size_t recordCount = getRecordCount(); // Stores the number of records in the table.
+    if (mappedData == nullptr || recordCount < accountVectors.size())
+        return -1; // Reports that the table does not describe the same accounts.
+    long long appliedCount = 0; // Counts the applied records.
+    const AccountRecord* records = reinterpret_cast<const AccountRecord*>(mappedData + TABLE_HEADER_SIZE); // Points to the first record.
+    size_t loadedCount = accountVectors.size(); // Stores the number of accounts loaded from the snapshot or the CSV file.
+    for (size_t i = 0; i < loadedCount; i++)
+    {
+        const AccountRecord& record = records[i]; // Gets the record.
+        vector<string>& account = accountVectors[i]; // Gets the account at the same position.
+        if (!hasValidChecksum(record))
+            continue; // Skips a record that was torn by a crash; the loaded value is kept.
+        if (record.accountID != parseInt(account[0]) || record.nationalID != parseLongLong(account[1]))
+            continue; // Skips a record that describes a different account.
+        account[2] = formatDouble(record.balance); // Applies the balance.
+        account[3] = convertRecordDateTimeToString(record); // Applies the creation date-time, which changes when a certificate is renewed.
+        if (record.accountType == CERTIFICATE_ACCOUNT_RECORD)
+        {
+            account[4] = formatDouble(record.interestRatePercent); // Applies the interest rate.
+            account[5] = formatDouble(record.withdrawnAmount); // Applies the withdrawn amount.
+        }
+        appliedCount++; // Counts the applied record.
+    }
+    for (size_t i = loadedCount; i < recordCount; i++)
+    {
+        const AccountRecord& record = records[i]; // Gets the record of an account created after the last save.
+        if (!hasValidChecksum(record) || record.accountID != static_cast<int32_t>(i + 1))
+            break; // Stops at the first record that is not the next account.
+        accountVectors.push_back(convertAccountRecordToVector(record)); // Adds the account.
+        appliedCount++; // Counts the applied record.
+    }
+    if (accountVectors.size() < recordCount)
+        return -1; // Has the table rebuilt without the torn records that follow the added accounts.
+    return appliedCount; // Returns the number of applied records.
+}
+
+// Returns the record at the position given by the account ID, if it holds the account.
+bool MappedAccountTable::findRecord(int64_t nationalID, int32_t accountID, AccountRecord& record)
+{
+    if (mappedData == nullptr || accountID < 1 || static_cast<size_t>(accountID) > getRecordCount())
+        return false; // Returns false if the table does not reach the account.
+    const AccountRecord& storedRecord = reinterpret_cast<const AccountRecord*>(mappedData + TABLE_HEADER_SIZE)[accountID - 1]; // Gets the record at the account's position.
+    if (!hasValidChecksum(storedRecord) || storedRecord.accountID != accountID || storedRecord.nationalID != nationalID)
+        return false; // Returns false if the record is damaged or describes a different account.
+    record = storedRecord; // Copies the record.
+    return true;
+}
+
+// Scans every record for the accounts of the person; the records are in account ID order.
+void MappedAccountTable::findRecordsOfPerson(int64_t nationalID, vector<AccountRecord>& records)
+{
+    if (mappedData == nullptr)
+        return; // Returns if the table is closed.
+    const AccountRecord* storedRecords = reinterpret_cast<const AccountRecord*>(mappedData + TABLE_HEADER_SIZE); // Points to the first record.
+    size_t recordCount = getRecordCount(); // Stores the number of records in the table.
+    for (size_t i = 0; i < recordCount; i++)
+        if (storedRecords[i].nationalID == nationalID && hasValidChecksum(storedRecords[i]))
+            records.push_back(storedRecords[i]); // Keeps the person's record unless it is damaged.
+}
+
+// Every write is already flushed to the disk, so there is nothing left to synchronize.
+void MappedAccountTable::sync()
+{
+}
+
+// Returns the name of the table and zero page counters.
+StorageStatistics MappedAccountTable::getStatistics() const
+{
+    StorageStatistics statistics = {}; // Stores the counters (zero-initialized).
+    statistics.backendName = "Memory-mapped table"; // Names the store.
+    return statistics;
+}
@@ -0,0 +1,126 @@
+// This is the specification file for the MappedAccountTable class,
+// an account store that keeps fixed-size account records in a memory-mapped file.
+// Changing one account rewrites only its record, so a deposit or withdrawal
+// dirties a single page instead of rewriting the whole account book.
+
+/*
+	Table file layout (all numbers in the native byte order):
+	- Header page (4096 bytes): magic "BANKTABL", format version, record count, record capacity,
+	  and a CRC32C of the header fields
+	- Records (64 bytes each): the account fields, a sequence number incremented on every update,
+	  and a CRC32C of the record, so a torn record write is detected when the table is opened
+*/
+
+// These are the include guards
+#pragma once
+#ifndef MAPPEDACCOUNTTABLE_H
+#define MAPPEDACCOUNTTABLE_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "AccountStore.h"
+using namespace std;
+
+class MappedAccountTable : public AccountStore
+{
+private:
+	string filePath;       // Holds the path of the table file
+	char* mappedData;      // Points to the start of the mapped file, or nullptr when the table is closed
+	size_t mappedSize;     // Holds the number of mapped bytes
+#ifdef _WIN32
+	void* fileHandle;      // Holds the Windows file handle
+	void* mappingHandle;   // Holds the Windows file mapping handle
+#else
+	int fileDescriptor;    // Holds the POSIX file descriptor
+#endif
+
+	// Maps the file with room for the given number of records, growing the file if needed
+	void mapFile(size_t);
+
+	// Unmaps the file and closes its handles
+	void unmapFile();
+
+	// Flushes the given byte range of the mapping to disk
+	void flushRange(size_t, size_t);
+
+	// Copies bytes to the given offset of the mapping, stopping the program part-way if the fault injection offset is reached
+	void writeMappedBytes(size_t, const void*, size_t);
+
+	// Writes a fresh header for the given record count and capacity
+	void writeHeader(size_t, size_t);
+
+	// Returns the number of records the mapped file can hold
+	size_t getCapacity() const;
+
+public:
+	// Default constructor, the table starts closed
+	MappedAccountTable();
+
+	// Destructor that unmaps the file
+	~MappedAccountTable() override;
+
+	// The table owns a mapping, so it can be neither copied nor moved
+	MappedAccountTable(const MappedAccountTable&) = delete;
+	MappedAccountTable& operator=(const MappedAccountTable&) = delete;
+
+	/*
+		Opens and maps the table file, creating an empty table if the file does not exist
+		or does not hold a valid table header.
+		Throws an InvalidFileException if the file cannot be opened or mapped.
+	*/
+	void open(const string&) override;
+
+	// Unmaps the file; the table can be opened again later
+	void close() override;
+
+	// Returns true if the table is open
+	bool isOpen() const override
+	{
+		return mappedData != nullptr;
+	}
+
+	// Returns the number of records stored in the table
+	size_t getRecordCount() const override;
+
+	// Replaces the whole table with the given account vectors and flushes it
+	void rebuild(const vector<vector<string>>&) override;
+
+	/*
+		Moves the records after the first removed one down over the removed ones, renumbering them,
+		then writes the new record count and flushes the moved records.
+	*/
+	void removeRecords(const vector<size_t>&, const vector<vector<string>>&) override;
+
+	/*
+		Rewrites the record at the given index in place from an account vector,
+		increments its sequence number, updates its checksum, and flushes only the page(s) holding it.
+	*/
+	void updateRecord(size_t, const vector<string>&) override;
+
+	/*
+		Writes the record after the last one, growing the file if it is full,
+		then flushes the record before the header that counts it.
+	*/
+	void appendRecord(const vector<string>&) override;
+
+	/*
+		Copies the records of the table over the given account vectors, by position,
+		then appends the valid records that follow the last account of the vector.
+	*/
+	long long applyTo(vector<vector<string>>&) override;
+
+	// Returns the record at the position of the account ID if it holds the account with the given national ID
+	bool findRecord(int64_t, int32_t, AccountRecord&) override;
+
+	// Scans every record, since the table is ordered by account ID only
+	void findRecordsOfPerson(int64_t, vector<AccountRecord>&) override;
+
+	// Does nothing, since every record and header is flushed to the disk when it is written
+	void sync() override;
+
+	// Returns the name of the table; it has no buffer pool, so the page counters are zero
+	StorageStatistics getStatistics() const override;
+};
+
+#endif
@@ -0,0 +1,124 @@
+#include <cmath>
+#include <charconv>
+#include "Numeric-Functions.h"
+#include "Exceptions.h"
+using namespace std;
+
+/*
+	Large enough for any double in fixed notation with six decimals:
+	a sign, up to 309 integer digits, the decimal point, and six decimals.
+*/
+static const int DOUBLE_BUFFER_SIZE = 320;
+
+// Large enough for any long long in decimal notation, including the sign.
+static const int INTEGER_BUFFER_SIZE = 24;
+
+// Number of decimals written by formatDouble, matching the "%f" format used by to_string.
+static const int DOUBLE_DECIMALS = 6;
+
+// The value of one unit of the last decimal written, as a scale factor.
+static const double DOUBLE_DECIMAL_SCALE = 1e6;
+
+/*
+	The largest magnitude formatted from an integer count of millionths. Below it, the scaled value is under 1e15
+	and exact to within 0.0625, so rounding it gives the same six decimals as formatting the exact double.
+*/
+static const double FAST_DOUBLE_LIMIT = 1e9;
+
+// Writes a double in fixed notation with six decimal places into the buffer, and returns the end of the text.
+static char* writeFixedDouble(char* buffer, double value)
+{
+    double scaled = value * DOUBLE_DECIMAL_SCALE; // Counts the value in millionths.
+    double rounded = nearbyint(scaled); // Rounds it to a whole number of millionths.
+    if (fabs(value) < FAST_DOUBLE_LIMIT && fabs(scaled - rounded) < 0.4)
+    {
+        // The value is not close to halfway between two millionths, so the rounding is the one "%f" makes:
+        // the digits are written as two integers, which is several times faster than a general fixed conversion.
+        char* position = buffer; // Points to the next character to write.
+        if (signbit(value))
+            *position++ = '-'; // Keeps the sign, including that of a negative value rounded to zero, as "%f" does.
+        long long millionths = llabs(static_cast<long long>(rounded)); // Stores the magnitude in millionths.
+        long long scale = static_cast<long long>(DOUBLE_DECIMAL_SCALE); // Stores the number of millionths in a unit.
+        position = to_chars(position, buffer + DOUBLE_BUFFER_SIZE, millionths / scale).ptr; // Writes the integer part.
+        *position++ = '.'; // Writes the decimal point.
+        long long fraction = millionths % scale; // Stores the decimals as an integer.
+        for (int digit = DOUBLE_DECIMALS - 1; digit >= 0; digit--)
+        {
+            position[digit] = static_cast<char>('0' + fraction % 10); // Writes the decimals from the last one, keeping the leading zeros.
+            fraction /= 10;
+        }
+        return position + DOUBLE_DECIMALS;
+    }
+    return to_chars(buffer, buffer + DOUBLE_BUFFER_SIZE, value, chars_format::fixed, DOUBLE_DECIMALS).ptr; // Formats large, halfway and non-finite values exactly.
+}
+
+// Returns true for the whitespace allowed around a field, such as the carriage return left by a CRLF line ending.
+static bool isFieldWhitespace(char character)
+{
+    return character == ' ' || character == '\t' || character == '\r' || character == '\n';
+}
+
+// Parses the whole field into the given arithmetic type, throwing InvalidNumberException on any failure.
+template <typename NumberType>
+static NumberType parseField(string_view field)
+{
+    while (!field.empty() && isFieldWhitespace(field.front()))
+        field.remove_prefix(1); // Skips the leading whitespace, which stoll and stod skipped too.
+    while (!field.empty() && isFieldWhitespace(field.back()))
+        field.remove_suffix(1); // Drops the trailing whitespace, so the last field of a CRLF line parses.
+    NumberType value{}; // Stores the parsed value.
+    const char* first = field.data(); // Points to the first character of the field.
+    const char* last = field.data() + field.size(); // Points one past the last character of the field.
+    from_chars_result result = from_chars(first, last, value); // Parses the field without allocating or using the locale.
+    if (result.ec != errc() || result.ptr != last)
+        throw InvalidNumberException(); // Throws if nothing was parsed, the value is out of range, or characters were left over.
+    return value; // Returns the parsed value.
+}
+
+// Parses a whole field as a long long integer.
+long long parseLongLong(string_view field)
+{
+    return parseField<long long>(field);
+}
+
+// Parses a whole field as an int.
+int parseInt(string_view field)
+{
+    return parseField<int>(field);
+}
+
+// Parses a whole field as a double.
+double parseDouble(string_view field)
+{
+    return parseField<double>(field);
+}
+
+// Appends an integer in decimal notation to the end of a string.
+void appendInteger(string& target, long long value)
+{
+    char buffer[INTEGER_BUFFER_SIZE]; // Stores the formatted digits on the stack.
+    to_chars_result result = to_chars(buffer, buffer + INTEGER_BUFFER_SIZE, value); // Formats the value.
+    target.append(buffer, result.ptr); // Appends the formatted digits.
+}
+
+// Appends a double in fixed notation with six decimal places to the end of a string.
+void appendDouble(string& target, double value)
+{
+    char buffer[DOUBLE_BUFFER_SIZE]; // Stores the formatted number on the stack.
+    target.append(buffer, writeFixedDouble(buffer, value)); // Formats the value and appends it.
+}
+
+// Formats an integer in decimal notation.
+string formatInteger(long long value)
+{
+    char buffer[INTEGER_BUFFER_SIZE]; // Stores the formatted digits on the stack.
+    to_chars_result result = to_chars(buffer, buffer + INTEGER_BUFFER_SIZE, value); // Formats the value.
+    return string(buffer, result.ptr); // Builds the string at its final size, without growing it.
+}
+
+// Formats a double in fixed notation with six decimal places.
+string formatDouble(double value)
+{
+    char buffer[DOUBLE_BUFFER_SIZE]; // Stores the formatted number on the stack.
+    return string(buffer, writeFixedDouble(buffer, value)); // Builds the string at its final size, without growing it.
+}
@@ -0,0 +1,50 @@
+// This file contains the declarations of the numeric codec functions.
+// They parse and format the numeric fields stored in the CSV files and account vectors
+// using from_chars/to_chars, which never allocate during parsing and never consult the locale.
+
+// These are the include guards
+#pragma once
+#ifndef NUMERICFUNCTIONS_H
+#define NUMERICFUNCTIONS_H
+
+#include <string>
+#include <string_view>
+using namespace std;
+
+/*
+	Parses a whole field as a long long integer (e.g., a national ID), ignoring the whitespace and line ending characters around it.
+	Throws an InvalidNumberException if the field is empty, has trailing characters, or is out of range.
+*/
+long long parseLongLong(string_view);
+
+/*
+	Parses a whole field as an int (e.g., an account ID, an age, or a date-time component), ignoring the whitespace and line ending characters around it.
+	Throws an InvalidNumberException if the field is empty, has trailing characters, or is out of range.
+*/
+int parseInt(string_view);
+
+/*
+	Parses a whole field as a double (e.g., a balance or an interest rate), ignoring the whitespace and line ending characters around it.
+	Throws an InvalidNumberException if the field is empty, has trailing characters, or is out of range.
+*/
+double parseDouble(string_view);
+
+/*
+	Formats an integer in decimal notation.
+	Produces the same text as to_string.
+*/
+string formatInteger(long long);
+
+/*
+	Formats a double in fixed notation with six decimal places.
+	Produces the same text as to_string, so existing CSV files keep their format.
+*/
+string formatDouble(double);
+
+// Appends an integer in decimal notation to the end of a string without a temporary string
+void appendInteger(string&, long long);
+
+// Appends a double in fixed notation with six decimal places to the end of a string without a temporary string
+void appendDouble(string&, double);
+
+#endif
@@ -0,0 +1,107 @@
+#include <cstring>
+#include "PageFile.h"
+#include "Checksum-Functions.h"
+#include "File-Functions.h"
+#include "Exceptions.h"
+#include "Constants.h"
+
+using namespace std;
+
+// The number of bytes at the start of every page that hold its checksum.
+static const size_t PAGE_CHECKSUM_SIZE = sizeof(uint32_t);
+
+// Default constructor, the file starts closed.
+PageFile::PageFile() : pageCount(0)
+{
+}
+
+// Opens the file, creating it if it does not exist.
+void PageFile::open(const string& path)
+{
+    close(); // Closes any file opened before.
+    filePath = path; // Stores the path for truncate.
+    file.open(path, ios::in | ios::out | ios::binary); // Opens the existing file for reading and writing.
+    if (!file.is_open())
+    {
+        ofstream newFile(path, ios::out | ios::binary); // Creates the file if it does not exist.
+        newFile.close(); // Closes the newly created file.
+        file.open(path, ios::in | ios::out | ios::binary); // Opens the new file for reading and writing.
+    }
+    if (!file.is_open())
+        throw InvalidFileException(); // Throws an exception if the file failed to open.
+    file.seekg(0, ios::end); // Moves to the end of the file to find its size.
+    pageCount = static_cast<uint32_t>(static_cast<long long>(file.tellg()) / STORAGE_PAGE_SIZE); // Counts the complete pages.
+}
+
+// Closes the file.
+void PageFile::close()
+{
+    if (file.is_open())
+        file.close(); // Closes the file.
+    file.clear(); // Clears the stream flags so the stream can be opened again.
+    pageCount = 0; // Resets the page count.
+}
+
+// Reads a page and verifies its checksum.
+void PageFile::readPage(uint32_t pageNumber, char* buffer)
+{
+    readPageWithoutChecksum(pageNumber, buffer); // Reads the whole page.
+    uint32_t storedChecksum; // Stores the checksum written with the page.
+    memcpy(&storedChecksum, buffer, PAGE_CHECKSUM_SIZE); // Reads the checksum from the start of the page.
+    if (storedChecksum != computeCRC32C(buffer + PAGE_CHECKSUM_SIZE, STORAGE_PAGE_SIZE - PAGE_CHECKSUM_SIZE))
+        throw InvalidPageException(); // Throws an exception if the page is damaged.
+}
+
+// Reads a page without verifying its checksum.
+void PageFile::readPageWithoutChecksum(uint32_t pageNumber, char* buffer)
+{
+    if (pageNumber >= pageCount)
+        throw InvalidPageException(); // Throws an exception if the page does not exist.
+    file.seekg(static_cast<streamoff>(pageNumber) * STORAGE_PAGE_SIZE, ios::beg); // Moves to the page.
+    file.read(buffer, STORAGE_PAGE_SIZE); // Reads the whole page.
+    if (file.gcount() != STORAGE_PAGE_SIZE)
+    {
+        file.clear(); // Clears the end-of-file flag so the stream stays usable.
+        throw InvalidPageException(); // Throws an exception if the page was never completely written.
+    }
+}
+
+// Stamps the checksum of a page and writes it.
+void PageFile::writePage(uint32_t pageNumber, char* buffer)
+{
+    uint32_t checksum = computeCRC32C(buffer + PAGE_CHECKSUM_SIZE, STORAGE_PAGE_SIZE - PAGE_CHECKSUM_SIZE); // Checksums the page content.
+    memcpy(buffer, &checksum, PAGE_CHECKSUM_SIZE); // Stores the checksum at the start of the page.
+    file.seekp(static_cast<streamoff>(pageNumber) * STORAGE_PAGE_SIZE, ios::beg); // Moves to the page.
+    writeFileBytes(file, buffer, STORAGE_PAGE_SIZE); // Writes the whole page, or the part before the fault injection offset.
+    if (!file)
+        throw InvalidFileException(); // Throws an exception if the write failed.
+}
+
+// Reserves the next page number.
+uint32_t PageFile::allocatePage()
+{
+    return pageCount++; // Returns the next page number and counts it.
+}
+
+// Removes every page from the file by recreating it empty.
+void PageFile::truncate()
+{
+    file.close(); // Closes the file so it can be recreated.
+    ofstream emptyFile(filePath, ios::out | ios::trunc | ios::binary); // Recreates the file empty.
+    emptyFile.close(); // Closes the empty file.
+    open(filePath); // Opens the empty file for reading and writing.
+}
+
+// Hands the written pages to the operating system.
+void PageFile::sync()
+{
+    file.flush(); // Writes the stream buffer to the file.
+}
+
+// Hands the written pages to the operating system and forces them to the disk.
+void PageFile::syncToDisk()
+{
+    file.flush(); // Writes the stream buffer to the file.
+    if (!file || !syncFileToDisk(filePath))
+        throw InvalidFileException(); // Throws an exception if the pages could not be forced to the disk.
+}
@@ -0,0 +1,83 @@
+// This is the specification file for the PageFile class,
+// a file made of fixed-size pages addressed by their page number.
+// Every page starts with a CRC32C of the rest of the page, stamped when the page is written
+// and verified when it is read, so a torn or damaged page is never used.
+
+// These are the include guards
+#pragma once
+#ifndef PAGEFILE_H
+#define PAGEFILE_H
+
+#include <string>
+#include <fstream>
+#include <cstdint>
+using namespace std;
+
+class PageFile
+{
+private:
+	fstream file;       // Holds the open file
+	string filePath;    // Holds the path of the file
+	uint32_t pageCount; // Holds the number of pages in the file, including pages allocated but not yet written
+
+public:
+	// Default constructor, the file starts closed
+	PageFile();
+
+	/*
+		Opens the file, creating it if it does not exist.
+		Throws an InvalidFileException if the file cannot be opened.
+	*/
+	void open(const string&);
+
+	// Closes the file
+	void close();
+
+	// Returns true if the file is open
+	bool isOpen() const
+	{
+		return file.is_open();
+	}
+
+	// Returns the number of pages in the file
+	uint32_t getPageCount() const
+	{
+		return pageCount;
+	}
+
+	/*
+		Reads the page with the given number into a buffer of STORAGE_PAGE_SIZE bytes.
+		Throws an InvalidPageException if the page is missing or fails its checksum.
+	*/
+	void readPage(uint32_t, char*);
+
+	/*
+		Reads the page with the given number into a buffer of STORAGE_PAGE_SIZE bytes without verifying its checksum,
+		so the records of a page torn by a crash can be checked one by one.
+		Throws an InvalidPageException if the page is missing.
+	*/
+	void readPageWithoutChecksum(uint32_t, char*);
+
+	/*
+		Stamps the checksum of the page held in the buffer and writes it at the given page number.
+		Throws an InvalidFileException if the write fails.
+	*/
+	void writePage(uint32_t, char*);
+
+	// Reserves the next page number; the page is created on disk when it is first written
+	uint32_t allocatePage();
+
+	// Removes every page from the file
+	void truncate();
+
+	// Hands the written pages to the operating system
+	void sync();
+
+	/*
+		Hands the written pages to the operating system and waits until they are on the disk.
+		Throws an InvalidFileException if the file cannot be synchronized.
+	*/
+	void syncToDisk();
+};
+
+#endif
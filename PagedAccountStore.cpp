@@ -0,0 +1,634 @@
+#include <cstring>
+#include <algorithm>
+#include "PagedAccountStore.h"
+#include "Numeric-Functions.h"
+#include "Exceptions.h"
+#include "Constants.h"
+
+using namespace std;
+
+// Identifies a page file.
+static const char PAGES_MAGIC[8] = { 'B', 'A', 'N', 'K', 'P', 'A', 'G', 'E' };
+
+// The format version written by this program; files with any other version are recreated.
+static const uint32_t PAGES_VERSION = 1;
+
+// The values stored in the pageType field of a page header.
+static const uint16_t META_PAGE = 1;
+static const uint16_t LEAF_PAGE = 2;
+static const uint16_t INTERNAL_PAGE = 3;
+
+// The page number of the meta page; no leaf links to it, so it also marks the end of the leaf chain.
+static const uint32_t META_PAGE_NUMBER = 0;
+
+// Holds the fields at the start of every page; the checksum is stamped by the PageFile.
+struct PageHeader
+{
+    uint32_t checksum;     // CRC32C of the rest of the page
+    uint16_t pageType;     // META_PAGE, LEAF_PAGE or INTERNAL_PAGE
+    uint16_t entryCount;   // Number of records in a leaf, or of keys in an internal page
+    uint32_t nextLeafPage; // Page number of the next leaf, or META_PAGE_NUMBER for the last one
+    uint32_t reserved;     // Unused, always zero
+};
+
+// Holds the location and size of the tree.
+struct MetaPage
+{
+    PageHeader header;
+    char magic[8];       // Always PAGES_MAGIC
+    uint32_t version;    // Format version of the file
+    uint32_t pageSize;   // Page size the file was written with
+    uint32_t rootPage;   // Page number of the root of the tree
+    uint32_t treeHeight; // Number of levels of the tree
+    uint64_t recordCount; // Number of records in the tree
+};
+
+// The number of records that fit in a leaf page.
+static const size_t LEAF_CAPACITY = (STORAGE_PAGE_SIZE - sizeof(PageHeader)) / sizeof(AccountRecord);
+
+// Holds account records sorted by key.
+struct LeafPage
+{
+    PageHeader header;
+    AccountRecord records[LEAF_CAPACITY];
+};
+
+// The number of keys that fit in an internal page next to one more child page number.
+static const size_t INTERNAL_CAPACITY = (STORAGE_PAGE_SIZE - sizeof(PageHeader) - sizeof(uint32_t)) / (sizeof(AccountTreeKey) + sizeof(uint32_t));
+
+// Holds the separator keys of an internal page; the keys of children[i] are at least keys[i - 1] and below keys[i].
+struct InternalPage
+{
+    PageHeader header;
+    uint32_t children[INTERNAL_CAPACITY + 1];
+    AccountTreeKey keys[INTERNAL_CAPACITY];
+};
+
+static_assert(sizeof(MetaPage) <= STORAGE_PAGE_SIZE, "The meta page must fit in a page");
+static_assert(sizeof(LeafPage) <= STORAGE_PAGE_SIZE, "A leaf page must fit in a page");
+static_assert(sizeof(InternalPage) <= STORAGE_PAGE_SIZE, "An internal page must fit in a page");
+
+// Orders keys by national ID, then by account ID.
+static bool operator<(const AccountTreeKey& left, const AccountTreeKey& right)
+{
+    if (left.nationalID != right.nationalID)
+        return left.nationalID < right.nationalID;
+    return left.accountID < right.accountID;
+}
+
+// Returns the key of a record.
+static AccountTreeKey getRecordKey(const AccountRecord& record)
+{
+    return AccountTreeKey{ record.nationalID, record.accountID };
+}
+
+// Returns the key of an account vector.
+static AccountTreeKey getAccountKey(const vector<string>& account)
+{
+    return AccountTreeKey{ parseLongLong(account[1]), parseLongLong(account[0]) };
+}
+
+// Returns the position of the first record of a leaf whose key is not below the given key.
+static size_t findRecordPosition(const LeafPage* leaf, const AccountTreeKey& key)
+{
+    const AccountRecord* position = lower_bound(leaf->records, leaf->records + leaf->header.entryCount, key,
+        [](const AccountRecord& record, const AccountTreeKey& searchedKey) { return getRecordKey(record) < searchedKey; }); // Binary searches the leaf.
+    return position - leaf->records;
+}
+
+// Constructor that creates a closed store with a buffer pool of the given number of pages.
+PagedAccountStore::PagedAccountStore(size_t frameCount)
+    : bufferPool(pageFile, frameCount), rootPage(0), treeHeight(0), recordCount(0)
+{
+}
+
+// Destructor that writes the dirty pages.
+PagedAccountStore::~PagedAccountStore()
+{
+    try
+    {
+        close(); // Writes the dirty pages and closes the file.
+    }
+    catch (InvalidFileException)
+    {
+        // The pages were written when they were changed, so nothing is lost if the final write fails.
+    }
+}
+
+// Writes the root, height and record count to the meta page.
+void PagedAccountStore::writeMetaPage()
+{
+    MetaPage* meta = reinterpret_cast<MetaPage*>(bufferPool.fetchPage(META_PAGE_NUMBER)); // Gets the meta page.
+    meta->header.pageType = META_PAGE; // Marks the page as the meta page.
+    memcpy(meta->magic, PAGES_MAGIC, sizeof(meta->magic)); // Stores the magic bytes.
+    meta->version = PAGES_VERSION; // Stores the format version.
+    meta->pageSize = STORAGE_PAGE_SIZE; // Stores the page size.
+    meta->rootPage = rootPage; // Stores the root page number.
+    meta->treeHeight = treeHeight; // Stores the tree height.
+    meta->recordCount = recordCount; // Stores the record count.
+    bufferPool.unpinPage(META_PAGE_NUMBER, true); // Releases the changed meta page.
+}
+
+// Replaces the file with a meta page and one empty leaf.
+void PagedAccountStore::initializeEmptyTree()
+{
+    rebuild(vector<vector<string>>()); // Bulk-loads an empty tree.
+}
+
+// Returns the leaf that holds or would hold the key, recording the path to it if requested.
+uint32_t PagedAccountStore::findLeaf(const AccountTreeKey& key, vector<pair<uint32_t, int>>* path)
+{
+    uint32_t pageNumber = rootPage; // Starts at the root.
+    for (uint32_t level = 1; level < treeHeight; level++)
+    {
+        const InternalPage* node = reinterpret_cast<const InternalPage*>(bufferPool.fetchPage(pageNumber)); // Gets the internal page.
+        int childIndex = static_cast<int>(upper_bound(node->keys, node->keys + node->header.entryCount, key) - node->keys); // Finds the child covering the key.
+        uint32_t childPage = node->children[childIndex]; // Gets the child page number.
+        bufferPool.unpinPage(pageNumber, false); // Releases the internal page.
+        if (path != nullptr)
+            path->push_back(make_pair(pageNumber, childIndex)); // Records the step.
+        pageNumber = childPage; // Moves down one level.
+    }
+    return pageNumber; // Returns the leaf page number.
+}
+
+// Adds a separator key and its right page to the parent at the given depth, splitting it if full.
+void PagedAccountStore::insertIntoParent(vector<pair<uint32_t, int>>& path, int depth, const AccountTreeKey& key, uint32_t rightPage)
+{
+    // Grows the tree by one level when the root itself was split.
+    if (depth < 0)
+    {
+        uint32_t newRootPage; // Stores the page number of the new root.
+        InternalPage* root = reinterpret_cast<InternalPage*>(bufferPool.newPage(newRootPage)); // Creates the new root.
+        root->header.pageType = INTERNAL_PAGE; // Marks the page as internal.
+        root->header.entryCount = 1; // Stores the single separator.
+        root->children[0] = rootPage; // Links the old root on the left.
+        root->children[1] = rightPage; // Links the new page on the right.
+        root->keys[0] = key; // Stores the separator.
+        bufferPool.unpinPage(newRootPage, true); // Releases the new root.
+        rootPage = newRootPage; // Switches to the new root.
+        treeHeight++; // Counts the new level.
+        return;
+    }
+
+    uint32_t pageNumber = path[depth].first; // Gets the parent page number.
+    int childIndex = path[depth].second; // Gets the position of the split child in the parent.
+    InternalPage* node = reinterpret_cast<InternalPage*>(bufferPool.fetchPage(pageNumber)); // Gets the parent.
+    size_t keyCount = node->header.entryCount; // Stores the number of keys in the parent.
+
+    // Inserts the separator in place when the parent has room.
+    if (keyCount < INTERNAL_CAPACITY)
+    {
+        memmove(&node->keys[childIndex + 1], &node->keys[childIndex], (keyCount - childIndex) * sizeof(AccountTreeKey)); // Shifts the keys right.
+        memmove(&node->children[childIndex + 2], &node->children[childIndex + 1], (keyCount - childIndex) * sizeof(uint32_t)); // Shifts the children right.
+        node->keys[childIndex] = key; // Stores the separator.
+        node->children[childIndex + 1] = rightPage; // Links the new page after the split child.
+        node->header.entryCount++; // Counts the separator.
+        bufferPool.unpinPage(pageNumber, true); // Releases the changed parent.
+        return;
+    }
+
+    // Splits the full parent around its middle key, which moves up to the next level.
+    vector<AccountTreeKey> keys(node->keys, node->keys + keyCount); // Copies the keys.
+    vector<uint32_t> children(node->children, node->children + keyCount + 1); // Copies the children.
+    keys.insert(keys.begin() + childIndex, key); // Adds the separator.
+    children.insert(children.begin() + childIndex + 1, rightPage); // Adds the new page.
+    size_t middle = keys.size() / 2; // Stores the position of the key that moves up.
+    uint32_t siblingPage; // Stores the page number of the new right half.
+    InternalPage* sibling = reinterpret_cast<InternalPage*>(bufferPool.newPage(siblingPage)); // Creates the right half.
+    sibling->header.pageType = INTERNAL_PAGE; // Marks the page as internal.
+    sibling->header.entryCount = static_cast<uint16_t>(keys.size() - middle - 1); // Counts the keys of the right half.
+    copy(keys.begin() + middle + 1, keys.end(), sibling->keys); // Moves the upper keys to the right half.
+    copy(children.begin() + middle + 1, children.end(), sibling->children); // Moves the upper children to the right half.
+    node->header.entryCount = static_cast<uint16_t>(middle); // Counts the keys of the left half.
+    copy(keys.begin(), keys.begin() + middle, node->keys); // Keeps the lower keys in the left half.
+    copy(children.begin(), children.begin() + middle + 1, node->children); // Keeps the lower children in the left half.
+    bufferPool.unpinPage(siblingPage, true); // Releases the right half.
+    bufferPool.unpinPage(pageNumber, true); // Releases the left half.
+    insertIntoParent(path, depth - 1, keys[middle], siblingPage); // Adds the middle key to the grandparent.
+}
+
+// Adds a record to its leaf, splitting the leaf if full.
+void PagedAccountStore::insertRecord(const AccountRecord& record)
+{
+    AccountTreeKey key = getRecordKey(record); // Gets the key of the record.
+    vector<pair<uint32_t, int>> path; // Stores the internal pages on the way to the leaf.
+    uint32_t leafPage = findLeaf(key, &path); // Finds the leaf.
+    LeafPage* leaf = reinterpret_cast<LeafPage*>(bufferPool.fetchPage(leafPage)); // Gets the leaf.
+    size_t recordCountInLeaf = leaf->header.entryCount; // Stores the number of records in the leaf.
+    size_t position = findRecordPosition(leaf, key); // Finds where the record belongs.
+
+    // Inserts the record in place when the leaf has room.
+    if (recordCountInLeaf < LEAF_CAPACITY)
+    {
+        memmove(&leaf->records[position + 1], &leaf->records[position], (recordCountInLeaf - position) * sizeof(AccountRecord)); // Shifts the records right.
+        leaf->records[position] = record; // Stores the record.
+        leaf->header.entryCount++; // Counts the record.
+        bufferPool.unpinPage(leafPage, true); // Releases the changed leaf.
+        return;
+    }
+
+    // Splits the full leaf in two halves and links the new one after it.
+    vector<AccountRecord> records(leaf->records, leaf->records + recordCountInLeaf); // Copies the records.
+    records.insert(records.begin() + position, record); // Adds the new record.
+    size_t leftCount = records.size() / 2; // Stores the number of records kept in the left half.
+    uint32_t siblingPage; // Stores the page number of the new right half.
+    LeafPage* sibling = reinterpret_cast<LeafPage*>(bufferPool.newPage(siblingPage)); // Creates the right half.
+    sibling->header.pageType = LEAF_PAGE; // Marks the page as a leaf.
+    sibling->header.entryCount = static_cast<uint16_t>(records.size() - leftCount); // Counts the records of the right half.
+    sibling->header.nextLeafPage = leaf->header.nextLeafPage; // Links the right half to the old next leaf.
+    copy(records.begin() + leftCount, records.end(), sibling->records); // Moves the upper records to the right half.
+    leaf->header.entryCount = static_cast<uint16_t>(leftCount); // Counts the records of the left half.
+    leaf->header.nextLeafPage = siblingPage; // Links the left half to the right half.
+    copy(records.begin(), records.begin() + leftCount, leaf->records); // Keeps the lower records in the left half.
+    AccountTreeKey separator = getRecordKey(sibling->records[0]); // Gets the first key of the right half.
+    bufferPool.unpinPage(siblingPage, true); // Releases the right half.
+    bufferPool.unpinPage(leafPage, true); // Releases the left half.
+    insertIntoParent(path, static_cast<int>(path.size()) - 1, separator, siblingPage); // Adds the separator to the parent.
+}
+
+// Walks down the leftmost children to the first leaf.
+uint32_t PagedAccountStore::findFirstLeaf()
+{
+    uint32_t pageNumber = rootPage; // Starts at the root.
+    for (uint32_t level = 1; level < treeHeight; level++)
+    {
+        const InternalPage* node = reinterpret_cast<const InternalPage*>(bufferPool.fetchPage(pageNumber)); // Gets the internal page.
+        uint32_t childPage = node->children[0]; // Gets the leftmost child.
+        bufferPool.unpinPage(pageNumber, false); // Releases the internal page.
+        pageNumber = childPage; // Moves down one level.
+    }
+    return pageNumber; // Returns the first leaf.
+}
+
+// Sets each separator key to the first key of the child on its right, bottom-up, and returns the first key of the subtree.
+// An empty child takes the key of the next child, so no key is routed to it; a last empty child keeps its key,
+// which is still above every key of the children before it, since renumbering only lowers the keys.
+bool PagedAccountStore::refreshSeparatorKeys(uint32_t pageNumber, uint32_t level, AccountTreeKey& firstKey)
+{
+    if (level == treeHeight)
+    {
+        const LeafPage* leaf = reinterpret_cast<const LeafPage*>(bufferPool.fetchPage(pageNumber)); // Gets the leaf.
+        bool hasRecords = leaf->header.entryCount > 0; // Checks whether the leaf kept any record.
+        if (hasRecords)
+            firstKey = getRecordKey(leaf->records[0]); // Stores its first key.
+        bufferPool.unpinPage(pageNumber, false); // Releases the leaf.
+        return hasRecords;
+    }
+
+    const InternalPage* node = reinterpret_cast<const InternalPage*>(bufferPool.fetchPage(pageNumber)); // Gets the internal page.
+    size_t keyCount = node->header.entryCount; // Stores the number of keys.
+    vector<uint32_t> children(node->children, node->children + keyCount + 1); // Copies the children, so the page is not pinned while they are read.
+    vector<AccountTreeKey> keys(node->keys, node->keys + keyCount); // Copies the keys.
+    bufferPool.unpinPage(pageNumber, false); // Releases the internal page.
+
+    vector<AccountTreeKey> childFirstKeys(children.size()); // Stores the first key of each child.
+    vector<char> childHasRecords(children.size()); // Stores whether each child holds a record.
+    for (size_t i = 0; i < children.size(); i++)
+        childHasRecords[i] = refreshSeparatorKeys(children[i], level + 1, childFirstKeys[i]); // Refreshes the child first.
+    for (size_t i = keyCount; i >= 1; i--)
+    {
+        if (childHasRecords[i])
+            keys[i - 1] = childFirstKeys[i]; // Separates the child from the ones before it by its first key.
+        else if (i < keyCount)
+            keys[i - 1] = keys[i]; // Routes nothing to the empty child.
+    }
+
+    InternalPage* changedNode = reinterpret_cast<InternalPage*>(bufferPool.fetchPage(pageNumber)); // Gets the internal page again.
+    bool changed = !equal(keys.begin(), keys.end(), changedNode->keys, [](const AccountTreeKey& left, const AccountTreeKey& right) {
+        return left.nationalID == right.nationalID && left.accountID == right.accountID; }); // Checks whether any key moved.
+    if (changed)
+        copy(keys.begin(), keys.end(), changedNode->keys); // Stores the new keys.
+    bufferPool.unpinPage(pageNumber, changed); // Releases the page, written only if a key moved.
+    for (size_t i = 0; i < children.size(); i++)
+    {
+        if (childHasRecords[i])
+        {
+            firstKey = childFirstKeys[i]; // Stores the first key of the first child holding a record.
+            return true;
+        }
+    }
+    return false;
+}
+
+// Opens the page file and reads its meta page, creating an empty tree if it is missing or damaged.
+void PagedAccountStore::open(const string& path)
+{
+    close(); // Closes any file opened before.
+    pageFile.open(path); // Opens or creates the page file.
+    bool valid = false; // Stores whether the file holds a usable tree.
+    if (pageFile.getPageCount() > 0)
+    {
+        try
+        {
+            const MetaPage* meta = reinterpret_cast<const MetaPage*>(bufferPool.fetchPage(META_PAGE_NUMBER)); // Reads the meta page.
+            valid = meta->header.pageType == META_PAGE && memcmp(meta->magic, PAGES_MAGIC, sizeof(meta->magic)) == 0 &&
+                meta->version == PAGES_VERSION && meta->pageSize == STORAGE_PAGE_SIZE &&
+                meta->rootPage < pageFile.getPageCount() && meta->treeHeight > 0; // Checks the meta page.
+            rootPage = meta->rootPage; // Stores the root page number.
+            treeHeight = meta->treeHeight; // Stores the tree height.
+            recordCount = meta->recordCount; // Stores the record count.
+            bufferPool.unpinPage(META_PAGE_NUMBER, false); // Releases the meta page.
+        }
+        catch (InvalidPageException)
+        {
+            valid = false; // Treats a damaged meta page like a missing file.
+        }
+    }
+    if (!valid)
+        initializeEmptyTree(); // Starts an empty tree.
+}
+
+// Writes the dirty pages and closes the file.
+void PagedAccountStore::close()
+{
+    if (!pageFile.isOpen())
+        return; // Returns if the store is closed.
+    bufferPool.flushAllPages(); // Writes the dirty pages.
+    bufferPool.discardAllPages(); // Empties the buffer pool for the next file.
+    pageFile.close(); // Closes the file.
+}
+
+// Replaces the tree by bulk-loading the sorted records into full leaves and building the levels above them.
+void PagedAccountStore::rebuild(const vector<vector<string>>& accountVectors)
+{
+    vector<AccountRecord> records(accountVectors.size()); // Stores the records (zero-initialized, so every sequence starts at 0).
+    for (size_t i = 0; i < accountVectors.size(); i++)
+        fillAccountRecord(records[i], accountVectors[i]); // Converts each account.
+    sort(records.begin(), records.end(), [](const AccountRecord& left, const AccountRecord& right) { return getRecordKey(left) < getRecordKey(right); }); // Sorts the records by key.
+
+    bufferPool.discardAllPages(); // Drops the pages of the old tree.
+    pageFile.truncate(); // Empties the file.
+    uint32_t metaPage; // Stores the page number of the meta page, always 0 in an empty file.
+    bufferPool.newPage(metaPage); // Reserves the meta page; it is filled once the tree is built.
+    bufferPool.unpinPage(metaPage, true); // Releases the meta page.
+
+    // Fills the leaves; nothing else allocates pages meanwhile, so every leaf is followed by the next page number.
+    vector<pair<AccountTreeKey, uint32_t>> level; // Stores the first key and page number of every page of the level being built.
+    size_t position = 0; // Stores the index of the first record of the next leaf.
+    do
+    {
+        size_t count = min(LEAF_CAPACITY, records.size() - position); // Counts the records of this leaf.
+        uint32_t leafPage; // Stores the page number of the leaf.
+        LeafPage* leaf = reinterpret_cast<LeafPage*>(bufferPool.newPage(leafPage)); // Creates the leaf.
+        leaf->header.pageType = LEAF_PAGE; // Marks the page as a leaf.
+        leaf->header.entryCount = static_cast<uint16_t>(count); // Counts the records.
+        leaf->header.nextLeafPage = position + count < records.size() ? leafPage + 1 : META_PAGE_NUMBER; // Links the next leaf, if any.
+        if (count > 0)
+            memcpy(leaf->records, &records[position], count * sizeof(AccountRecord)); // Copies the records.
+        level.push_back(make_pair(count > 0 ? getRecordKey(records[position]) : AccountTreeKey{ 0, 0 }, leafPage)); // Remembers the leaf for the level above.
+        bufferPool.unpinPage(leafPage, true); // Releases the leaf.
+        position += count; // Moves to the next records.
+    } while (position < records.size());
+
+    // Builds internal levels until a single page, the root, covers every leaf.
+    uint32_t height = 1; // Counts the levels built.
+    while (level.size() > 1)
+    {
+        vector<pair<AccountTreeKey, uint32_t>> parentLevel; // Stores the pages of the level above.
+        for (size_t first = 0; first < level.size(); first += INTERNAL_CAPACITY + 1)
+        {
+            size_t childCount = min(INTERNAL_CAPACITY + 1, level.size() - first); // Counts the children of this page.
+            uint32_t nodePage; // Stores the page number of the internal page.
+            InternalPage* node = reinterpret_cast<InternalPage*>(bufferPool.newPage(nodePage)); // Creates the internal page.
+            node->header.pageType = INTERNAL_PAGE; // Marks the page as internal.
+            node->header.entryCount = static_cast<uint16_t>(childCount - 1); // Counts the separators.
+            for (size_t child = 0; child < childCount; child++)
+            {
+                node->children[child] = level[first + child].second; // Links the child.
+                if (child > 0)
+                    node->keys[child - 1] = level[first + child].first; // Separates it from the previous child by its first key.
+            }
+            parentLevel.push_back(make_pair(level[first].first, nodePage)); // Remembers the page for the level above.
+            bufferPool.unpinPage(nodePage, true); // Releases the internal page.
+        }
+        level.swap(parentLevel); // Moves up one level.
+        height++; // Counts the level.
+    }
+
+    rootPage = level[0].second; // Stores the root page number.
+    treeHeight = height; // Stores the tree height.
+    recordCount = records.size(); // Stores the record count.
+    writeMetaPage(); // Writes the meta page.
+    bufferPool.flushAllPages(); // Writes the whole tree.
+}
+
+// Rewrites the record of an account in its leaf and writes only that leaf.
+void PagedAccountStore::updateRecord(size_t, const vector<string>& account)
+{
+    AccountTreeKey key = getAccountKey(account); // Gets the key of the account.
+    uint32_t leafPage = findLeaf(key, nullptr); // Finds the leaf holding the account.
+    LeafPage* leaf = reinterpret_cast<LeafPage*>(bufferPool.fetchPage(leafPage)); // Gets the leaf.
+    size_t position = findRecordPosition(leaf, key); // Finds the record.
+    bool found = position < leaf->header.entryCount && !(key < getRecordKey(leaf->records[position])); // Checks that the record holds this account.
+    if (found)
+    {
+        leaf->records[position].sequence++; // Marks a new version of the record.
+        fillAccountRecord(leaf->records[position], account); // Rewrites the record and its checksum.
+    }
+    bufferPool.unpinPage(leafPage, found); // Releases the leaf.
+    if (found)
+    {
+        bufferPool.flushPage(leafPage); // Writes the changed leaf.
+        pageFile.sync(); // Hands it to the operating system.
+    }
+}
+
+// Inserts the record of a new account and writes the changed pages.
+void PagedAccountStore::appendRecord(const vector<string>& account)
+{
+    AccountRecord record = {}; // Stores the new record (zero-initialized, so its sequence starts at 0).
+    fillAccountRecord(record, account); // Converts the account.
+    insertRecord(record); // Inserts it into the tree.
+    recordCount++; // Counts the record.
+    writeMetaPage(); // Stores the new count and, after a root split, the new root.
+    bufferPool.flushAllPages(); // Writes the changed pages.
+}
+
+// Drops the removed records and rewrites the others from the remaining accounts leaf by leaf,
+// then refreshes the separator keys and writes the changed pages.
+void PagedAccountStore::removeRecords(const vector<size_t>& removedIndexes, const vector<vector<string>>& remainingAccounts)
+{
+    if (removedIndexes.empty())
+        return; // Returns if there is nothing to remove.
+    uint32_t pageNumber = findFirstLeaf(); // Starts at the first leaf.
+    while (pageNumber != META_PAGE_NUMBER)
+    {
+        LeafPage* leaf = reinterpret_cast<LeafPage*>(bufferPool.fetchPage(pageNumber)); // Gets the leaf.
+        size_t keptCount = 0; // Counts the records kept in the leaf.
+        bool changed = false; // Stores whether the leaf must be written.
+        for (size_t i = 0; i < leaf->header.entryCount; i++)
+        {
+            AccountRecord record = leaf->records[i]; // Copies the record.
+            if (hasValidChecksum(record) && record.accountID >= 1)
+            {
+                size_t accountIndex = static_cast<size_t>(record.accountID - 1); // Gets the old position of the account.
+                vector<size_t>::const_iterator removed = lower_bound(removedIndexes.begin(), removedIndexes.end(), accountIndex); // Finds the removals before it.
+                if (removed != removedIndexes.end() && *removed == accountIndex)
+                {
+                    changed = true; // Drops the removed account.
+                    continue;
+                }
+                size_t newIndex = accountIndex - static_cast<size_t>(removed - removedIndexes.begin()); // Gets its position once the removed accounts before it are gone.
+                if (newIndex < remainingAccounts.size() && parseLongLong(remainingAccounts[newIndex][1]) == record.nationalID)
+                    changed |= refreshAccountRecord(record, remainingAccounts[newIndex]); // Renumbers it and applies the changes made to the account, keeping its key.
+                else if (newIndex != accountIndex)
+                {
+                    renumberAccountRecord(record, static_cast<int32_t>(newIndex + 1)); // Gives it the ID of its new position.
+                    changed = true;
+                }
+            }
+            leaf->records[keptCount++] = record; // Keeps the record, moved over the dropped ones; a damaged record is kept as it is.
+        }
+        leaf->header.entryCount = static_cast<uint16_t>(keptCount); // Counts the kept records.
+        uint32_t nextPage = leaf->header.nextLeafPage; // Gets the next leaf.
+        bufferPool.unpinPage(pageNumber, changed); // Releases the leaf.
+        pageNumber = nextPage; // Moves to the next leaf.
+    }
+    AccountTreeKey firstKey; // Stores the first key of the tree, unused.
+    refreshSeparatorKeys(rootPage, 1, firstKey); // Lowers the separator keys with the renumbered records.
+    recordCount -= min<uint64_t>(recordCount, removedIndexes.size()); // Stores the new record count.
+    writeMetaPage(); // Writes the new count.
+    bufferPool.flushAllPages(); // Writes the changed pages.
+}
+
+// Scans the leaves and applies every record to the account with its ID, then appends the newer accounts.
+long long PagedAccountStore::applyTo(vector<vector<string>>& accountVectors)
+{
+    if (!isOpen() || recordCount < accountVectors.size())
+        return -1; // Reports that the tree does not describe the same accounts.
+    size_t loadedCount = accountVectors.size(); // Stores the number of accounts loaded from the snapshot or the CSV file.
+    long long appliedCount = 0; // Counts the applied records.
+    vector<AccountRecord> newerRecords; // Stores the records of accounts created after the last save.
+
+    // Follows the leaf chain.
+    uint32_t pageNumber = findFirstLeaf(); // Starts at the first leaf.
+    vector<char> tornLeaf; // Stores a leaf that failed its page checksum, read without it.
+    bool tornLeafFound = false; // Stores whether a leaf was torn, so the tree is rebuilt.
+    while (pageNumber != META_PAGE_NUMBER)
+    {
+        const LeafPage* leaf; // Points to the leaf, in the buffer pool or in the torn leaf buffer.
+        bool pinned = true; // Stores whether the leaf is pinned in the buffer pool.
+        try
+        {
+            leaf = reinterpret_cast<const LeafPage*>(bufferPool.fetchPage(pageNumber)); // Gets the leaf.
+        }
+        catch (InvalidPageException)
+        {
+            tornLeaf.resize(STORAGE_PAGE_SIZE); // Makes room for the page.
+            pageFile.readPageWithoutChecksum(pageNumber, tornLeaf.data()); // Reads the torn leaf; each record still has its own checksum.
+            leaf = reinterpret_cast<const LeafPage*>(tornLeaf.data()); // Uses the torn leaf.
+            if (leaf->header.pageType != LEAF_PAGE || leaf->header.entryCount > LEAF_CAPACITY ||
+                leaf->header.nextLeafPage >= pageFile.getPageCount())
+                throw InvalidPageException(); // Gives up if the header itself was torn.
+            pinned = false; // The torn leaf is not in the buffer pool.
+            tornLeafFound = true; // Has the tree rebuilt.
+        }
+        for (size_t i = 0; i < leaf->header.entryCount; i++)
+        {
+            const AccountRecord& record = leaf->records[i]; // Gets the record.
+            if (!hasValidChecksum(record) || record.accountID < 1)
+                continue; // Skips a damaged record; the loaded value is kept.
+            if (static_cast<size_t>(record.accountID) > loadedCount)
+            {
+                newerRecords.push_back(record); // Keeps an account created after the last save.
+                continue;
+            }
+            vector<string>& account = accountVectors[record.accountID - 1]; // Gets the account with the same ID.
+            if (record.nationalID != parseLongLong(account[1]))
+                continue; // Skips a record that describes a different account.
+            account[2] = formatDouble(record.balance); // Applies the balance.
+            account[3] = convertRecordDateTimeToString(record); // Applies the creation date-time, which changes when a certificate is renewed.
+            if (record.accountType == CERTIFICATE_ACCOUNT_RECORD)
+            {
+                account[4] = formatDouble(record.interestRatePercent); // Applies the interest rate.
+                account[5] = formatDouble(record.withdrawnAmount); // Applies the withdrawn amount.
+            }
+            appliedCount++; // Counts the applied record.
+        }
+        uint32_t nextPage = leaf->header.nextLeafPage; // Gets the next leaf.
+        if (pinned)
+            bufferPool.unpinPage(pageNumber, false); // Releases the leaf.
+        pageNumber = nextPage; // Moves to the next leaf.
+    }
+
+    // Appends the newer accounts in ID order, stopping at the first gap.
+    sort(newerRecords.begin(), newerRecords.end(), [](const AccountRecord& left, const AccountRecord& right) { return left.accountID < right.accountID; }); // Sorts the newer accounts by ID.
+    for (const AccountRecord& record : newerRecords)
+    {
+        if (static_cast<size_t>(record.accountID) != accountVectors.size() + 1)
+            break; // Stops at the first account that does not follow the previous one.
+        accountVectors.push_back(convertAccountRecordToVector(record)); // Adds the account.
+        appliedCount++; // Counts the applied record.
+    }
+    if (tornLeafFound || accountVectors.size() < recordCount)
+        return -1; // Has the tree rebuilt without the torn leaf or the records that could not be placed.
+    return appliedCount; // Returns the number of applied records.
+}
+
+// Descends the tree to the leaf holding the key of the account and copies its record.
+bool PagedAccountStore::findRecord(int64_t nationalID, int32_t accountID, AccountRecord& record)
+{
+    AccountTreeKey key = AccountTreeKey{ nationalID, accountID }; // Builds the key of the account.
+    uint32_t leafPage = findLeaf(key, nullptr); // Finds the leaf holding the account.
+    const LeafPage* leaf = reinterpret_cast<const LeafPage*>(bufferPool.fetchPage(leafPage)); // Gets the leaf.
+    size_t position = findRecordPosition(leaf, key); // Finds the record.
+    bool found = position < leaf->header.entryCount && !(key < getRecordKey(leaf->records[position])) &&
+        hasValidChecksum(leaf->records[position]); // Checks that the record holds this account and is not damaged.
+    if (found)
+        record = leaf->records[position]; // Copies the record before the page is released.
+    bufferPool.unpinPage(leafPage, false); // Releases the leaf.
+    return found;
+}
+
+// Descends the tree to the first key of the person, then follows the leaf chain while the records are theirs.
+void PagedAccountStore::findRecordsOfPerson(int64_t nationalID, vector<AccountRecord>& records)
+{
+    AccountTreeKey key = AccountTreeKey{ nationalID, 0 }; // Builds a key below every account ID of the person.
+    uint32_t pageNumber = findLeaf(key, nullptr); // Finds the leaf holding the first account of the person.
+    bool passedPerson = false; // Set once a record of another person is reached.
+    size_t position = 0; // Stores the position of the first record to read in the leaf.
+    bool firstLeaf = true; // Set while reading the leaf found through the tree.
+    while (pageNumber != META_PAGE_NUMBER && !passedPerson)
+    {
+        const LeafPage* leaf = reinterpret_cast<const LeafPage*>(bufferPool.fetchPage(pageNumber)); // Gets the leaf.
+        if (firstLeaf)
+            position = findRecordPosition(leaf, key); // Skips the records of the persons before.
+        for (size_t i = position; i < leaf->header.entryCount; i++)
+        {
+            const AccountRecord& record = leaf->records[i]; // Gets the record.
+            if (record.nationalID != nationalID)
+            {
+                passedPerson = true; // Stops at the first record of the next person.
+                break;
+            }
+            if (hasValidChecksum(record))
+                records.push_back(record); // Keeps the record unless it is damaged.
+        }
+        uint32_t nextPage = leaf->header.nextLeafPage; // Gets the next leaf.
+        bufferPool.unpinPage(pageNumber, false); // Releases the leaf.
+        pageNumber = nextPage; // Moves to the next leaf, which the person's accounts may continue into.
+        position = 0; // Reads the next leaf from its start.
+        firstLeaf = false;
+    }
+}
+
+// Writes the dirty pages and forces the page file to the disk.
+void PagedAccountStore::sync()
+{
+    bufferPool.flushAllPages(); // Writes the pages changed since the last flush.
+    pageFile.syncToDisk(); // Forces the file to the disk.
+}
+
+// Returns the buffer pool counters.
+StorageStatistics PagedAccountStore::getStatistics() const
+{
+    StorageStatistics statistics = {}; // Stores the counters (zero-initialized).
+    statistics.backendName = "Paged B+tree"; // Names the store.
+    statistics.pageHits = bufferPool.getHitCount(); // Copies the hit count.
+    statistics.pageMisses = bufferPool.getMissCount(); // Copies the miss count.
+    statistics.pageEvictions = bufferPool.getEvictionCount(); // Copies the eviction count.
+    statistics.pageWrites = bufferPool.getWriteCount(); // Copies the write count.
+    statistics.residentPages = static_cast<long long>(bufferPool.getResidentPageCount()); // Copies the number of pages in memory.
+    return statistics;
+}
@@ -0,0 +1,147 @@
+// This is the specification file for the PagedAccountStore class,
+// an account store that keeps the account records in the leaves of a B+tree of fixed-size pages.
+// Pages are read through a buffer pool holding only BUFFER_POOL_FRAME_COUNT pages,
+// so updating or looking up an account touches the few pages on its root-to-leaf path
+// no matter how large the account book is.
+
+/*
+	Page file layout (every page is STORAGE_PAGE_SIZE bytes and starts with its CRC32C):
+	- Page 0: the meta page, holding the magic "BANKPAGE", format version, page size,
+	  root page number, tree height and record count
+	- Leaf pages: account records sorted by (national ID, account ID), linked to the next leaf,
+	  so the accounts of one person are stored next to each other
+	- Internal pages: separator keys and child page numbers
+*/
+
+// These are the include guards
+#pragma once
+#ifndef PAGEDACCOUNTSTORE_H
+#define PAGEDACCOUNTSTORE_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "AccountStore.h"
+#include "PageFile.h"
+#include "BufferPool.h"
+using namespace std;
+
+// Holds the key the B+tree is ordered by
+struct AccountTreeKey
+{
+	int64_t nationalID;
+	int64_t accountID;
+};
+
+class PagedAccountStore : public AccountStore
+{
+private:
+	PageFile pageFile;     // Holds the file of pages
+	BufferPool bufferPool; // Holds the pages currently in memory
+	uint32_t rootPage;     // Holds the page number of the root of the tree
+	uint32_t treeHeight;   // Holds the number of levels of the tree, 1 when the root is a leaf
+	uint64_t recordCount;  // Holds the number of records in the tree
+
+	// Writes the root, height and record count to the meta page
+	void writeMetaPage();
+
+	// Replaces the file with an empty tree
+	void initializeEmptyTree();
+
+	/*
+		Returns the leaf page that holds or would hold the given key.
+		Stores the internal pages visited and the child index taken in each of them if a path is given.
+	*/
+	uint32_t findLeaf(const AccountTreeKey&, vector<pair<uint32_t, int>>*);
+
+	// Adds a separator key and the page to its right to the parent at the given depth of the path, splitting it if full
+	void insertIntoParent(vector<pair<uint32_t, int>>&, int, const AccountTreeKey&, uint32_t);
+
+	// Adds a record to the tree, splitting the leaf if full
+	void insertRecord(const AccountRecord&);
+
+	// Returns the page number of the first leaf, down the leftmost children
+	uint32_t findFirstLeaf();
+
+	/*
+		Sets the separator keys of the subtree at the given page and level to the first keys of its children.
+		Stores the first key of the subtree and returns true, or returns false if the subtree holds no record.
+	*/
+	bool refreshSeparatorKeys(uint32_t, uint32_t, AccountTreeKey&);
+
+public:
+	// Constructor that creates a closed store with a buffer pool of the given number of pages
+	explicit PagedAccountStore(size_t);
+
+	// Destructor that writes the dirty pages
+	~PagedAccountStore() override;
+
+	/*
+		Opens the page file, creating an empty tree if the file does not exist
+		or its meta page is damaged or from another format version.
+		Throws an InvalidFileException if the file cannot be opened.
+	*/
+	void open(const string&) override;
+
+	// Writes the dirty pages and closes the file
+	void close() override;
+
+	// Returns true if the store is open
+	bool isOpen() const override
+	{
+		return pageFile.isOpen();
+	}
+
+	// Returns the number of records in the tree
+	size_t getRecordCount() const override
+	{
+		return static_cast<size_t>(recordCount);
+	}
+
+	/*
+		Replaces the tree with the given account vectors, bulk-loading full leaves
+		from the records sorted by key and building the internal levels above them.
+	*/
+	void rebuild(const vector<vector<string>>&) override;
+
+	/*
+		Drops the removed records from their leaves and renumbers the others in place in one pass over the leaf chain,
+		then refreshes the separator keys; renumbering keeps the key order, so no record moves to another leaf.
+	*/
+	void removeRecords(const vector<size_t>&, const vector<vector<string>>&) override;
+
+	/*
+		Finds the record of the account through the tree, rewrites it in its leaf,
+		and writes only that leaf page.
+	*/
+	void updateRecord(size_t, const vector<string>&) override;
+
+	// Inserts the record of a new account, splitting pages up to the root as needed
+	void appendRecord(const vector<string>&) override;
+
+	/*
+		Scans the leaves in key order and copies each record over the account with its ID,
+		then appends the records of accounts created after the vector was last saved.
+		A leaf torn by a crash is read without its page checksum and only its records with a valid checksum are applied;
+		-1 is then returned so the tree is rebuilt.
+		Throws an InvalidPageException if an internal page or the header of a leaf is damaged.
+	*/
+	long long applyTo(vector<vector<string>>&) override;
+
+	// Finds the record through the tree, reading only the pages on the root-to-leaf path of its key
+	bool findRecord(int64_t, int32_t, AccountRecord&) override;
+
+	/*
+		Finds the leaf holding the first key of the person and follows the leaf chain while the keys are theirs,
+		so a person's accounts cost one root-to-leaf path and rarely a second leaf.
+	*/
+	void findRecordsOfPerson(int64_t, vector<AccountRecord>&) override;
+
+	// Writes the dirty pages and forces the page file to the disk
+	void sync() override;
+
+	// Returns the buffer pool hit, miss, eviction and write counters
+	StorageStatistics getStatistics() const override;
+};
+
+#endif
@@ -0,0 +1,170 @@
+#include "PersistenceWorker.h"
+
+using namespace std;
+
+// Constructor that starts the persistence thread.
+PersistenceWorker::PersistenceWorker(AccountStore& store, PersonJournal& journal, size_t capacity, DurabilityPolicy policy)
+    : accountStore(store), personJournal(journal), durabilityPolicy(policy), queue(capacity),
+      stopping(false), workerSleeping(false), submittedCount(0), completedCount(0)
+{
+    workerThread = thread(&PersistenceWorker::workerLoop, this); // Starts the persistence thread.
+}
+
+// Destructor that lets the persistence thread write the queued changes, then joins it.
+PersistenceWorker::~PersistenceWorker()
+{
+    {
+        lock_guard<mutex> lock(stateMutex); // Locks so the thread cannot miss the stop signal.
+        stopping = true; // Asks the thread to finish once the queue is empty.
+    }
+    workAvailable.notify_one(); // Wakes the thread if it is waiting.
+    if (workerThread.joinable())
+        workerThread.join(); // Waits for the thread to finish.
+}
+
+// Wakes the persistence thread if it announced that it is going to sleep.
+void PersistenceWorker::wakeWorker()
+{
+    atomic_thread_fence(memory_order_seq_cst); // Orders the queued change before the check, matching the fence in workerLoop.
+    if (workerSleeping.exchange(false))
+    {
+        lock_guard<mutex> lock(stateMutex); // Locks so the wake-up cannot arrive between the thread's check and its wait.
+        workAvailable.notify_one(); // Wakes the thread.
+    }
+}
+
+// Queues a change and waits for the disk if the durability policy asks for it.
+void PersistenceWorker::submit(PersistenceRecord& record)
+{
+    rethrowError(); // Reports an earlier failure before accepting more changes.
+    atomic<bool> acknowledged(false); // Set by the persistence thread once the change is on the disk.
+    record.acknowledgement = durabilityPolicy == DurabilityPolicy::AcknowledgeOnSync ? &acknowledged : nullptr; // Asks for an acknowledgement if needed.
+    queue.push(record); // Applies backpressure: waits while the queue is full until the persistence thread takes a change.
+    submittedCount++; // Counts the change.
+    wakeWorker(); // Wakes the thread if it is waiting.
+
+    if (record.acknowledgement != nullptr)
+    {
+        unique_lock<mutex> lock(stateMutex); // Locks to wait for the acknowledgement.
+        progressMade.wait(lock, [&acknowledged]() { return acknowledged.load(memory_order_acquire); }); // Waits until the change is on the disk.
+    }
+    rethrowError(); // Reports a failure to write this change, if the caller waited for it.
+}
+
+// Waits until the persistence thread has written every queued change.
+void PersistenceWorker::waitUntilIdle()
+{
+    {
+        unique_lock<mutex> lock(stateMutex); // Locks to wait for progress.
+        progressMade.wait(lock, [this]() { return completedCount.load() >= submittedCount.load(); }); // Waits for the queue to drain.
+    }
+    rethrowError(); // Reports a failure to write one of the changes.
+}
+
+// Rethrows the first exception thrown by the persistence thread and forgets it.
+void PersistenceWorker::rethrowError()
+{
+    exception_ptr error; // Stores the exception to rethrow.
+    {
+        lock_guard<mutex> lock(stateMutex); // Locks to read the error.
+        error = firstError; // Takes the error.
+        firstError = nullptr; // Reports it only once.
+    }
+    if (error)
+        rethrow_exception(error); // Rethrows it to the caller.
+}
+
+// Writes one change to the journal or the store.
+void PersistenceWorker::applyRecord(PersistenceRecord& record)
+{
+    try
+    {
+        if (record.type == PersistenceRecordType::SavedPerson)
+            personJournal.appendSavedPerson(record.person); // Records the new details of the person.
+        else if (record.type == PersistenceRecordType::DeletedPerson)
+            personJournal.appendDeletedPerson(record.nationalID); // Records the removal of the person.
+        else if (record.type == PersistenceRecordType::UpdatedAccount)
+            accountStore.updateRecord(record.accountIndex, record.account); // Rewrites the account's record.
+        else
+            accountStore.appendRecord(record.account); // Adds the new account's record.
+    }
+    catch (...)
+    {
+        lock_guard<mutex> lock(stateMutex); // Locks to store the error.
+        if (!firstError)
+            firstError = current_exception(); // Keeps the first error for the caller.
+    }
+}
+
+// Takes every queued change, writes it, forces the batch to the disk if someone waits for it, then sleeps until more arrive.
+void PersistenceWorker::workerLoop()
+{
+    vector<atomic<bool>*> acknowledgements; // Stores the acknowledgements of the current batch.
+    PersistenceRecord record; // Stores the change being written.
+    while (true)
+    {
+        long long batchSize = 0; // Counts the changes of the batch.
+        while (queue.tryPop(record))
+        {
+            applyRecord(record); // Writes the change.
+            if (record.acknowledgement != nullptr)
+                acknowledgements.push_back(record.acknowledgement); // Acknowledges it after the sync below.
+            batchSize++; // Counts it.
+        }
+
+        if (batchSize > 0)
+        {
+            if (!acknowledgements.empty())
+            {
+                try
+                {
+                    personJournal.sync(); // Forces the journal to the disk.
+                    accountStore.sync(); // Forces the store to the disk.
+                }
+                catch (...)
+                {
+                    lock_guard<mutex> lock(stateMutex); // Locks to store the error.
+                    if (!firstError)
+                        firstError = current_exception(); // Keeps the first error for the caller.
+                }
+                for (atomic<bool>* acknowledgement : acknowledgements)
+                    acknowledgement->store(true, memory_order_release); // Acknowledges the whole batch with one sync.
+                acknowledgements.clear(); // Starts the next batch.
+            }
+            else
+            {
+                try
+                {
+                    personJournal.flush(); // Writes the batch's journal records with one submission.
+                }
+                catch (...)
+                {
+                    lock_guard<mutex> lock(stateMutex); // Locks to store the error.
+                    if (!firstError)
+                        firstError = current_exception(); // Keeps the first error for the caller.
+                }
+            }
+            {
+                lock_guard<mutex> lock(stateMutex); // Locks so a waiting caller cannot miss the progress.
+                completedCount += batchSize; // Counts the written changes.
+            }
+            progressMade.notify_all(); // Wakes the callers waiting for acknowledgements or an empty queue.
+            continue;
+        }
+
+        if (stopping)
+            return; // Finishes once the queue is empty and the worker is being destroyed.
+
+        // Announces the sleep, then looks at the queue once more, so a change queued meanwhile is not missed.
+        workerSleeping = true; // Asks the next caller to wake this thread.
+        atomic_thread_fence(memory_order_seq_cst); // Orders the announcement before the check, matching the fence in wakeWorker.
+        if (!queue.isEmpty())
+        {
+            workerSleeping = false; // Cancels the sleep to write the change that arrived meanwhile.
+            continue;
+        }
+        unique_lock<mutex> lock(stateMutex); // Locks to wait.
+        workAvailable.wait(lock, [this]() { return !workerSleeping || stopping; }); // Waits for a change or the stop signal.
+        workerSleeping = false; // Marks the thread awake.
+    }
+}
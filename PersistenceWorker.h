@@ -0,0 +1,97 @@
+// This is the specification file for the PersistenceWorker class,
+// a thread that writes person and account changes to the person journal and the account store
+// while the menu carries on. Changes reach it through a bounded lock-free queue;
+// the durability policy decides whether the caller waits for the change to reach the disk.
+
+// These are the include guards
+#pragma once
+#ifndef PERSISTENCEWORKER_H
+#define PERSISTENCEWORKER_H
+
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <exception>
+#include <condition_variable>
+#include "Person.h"
+#include "AccountStore.h"
+#include "PersonJournal.h"
+#include "BoundedMpmcQueue.h"
+#include "Constants.h"
+using namespace std;
+
+// The kinds of change the persistence thread writes
+enum class PersistenceRecordType { SavedPerson, DeletedPerson, UpdatedAccount, NewAccount };
+
+// Holds one change, copied when it is submitted so the caller can keep changing its data
+struct PersistenceRecord
+{
+	PersistenceRecordType type;     // The kind of change
+	Person person;                  // The new details of the person, for SavedPerson
+	long long nationalID;           // The national ID of the removed person, for DeletedPerson
+	size_t accountIndex;            // The position of the changed account, for UpdatedAccount
+	vector<string> account;         // The account fields, for UpdatedAccount and NewAccount
+	atomic<bool>* acknowledgement;  // Set once the change is on the disk, or nullptr if nobody waits for it
+};
+
+class PersistenceWorker
+{
+private:
+	AccountStore& accountStore;               // Holds the store receiving the account changes
+	PersonJournal& personJournal;             // Holds the journal receiving the person changes
+	DurabilityPolicy durabilityPolicy;        // Holds when a change is acknowledged
+	BoundedMpmcQueue<PersistenceRecord> queue; // Holds the changes waiting to be written
+	thread workerThread;                      // Holds the persistence thread
+	atomic<bool> stopping;                    // Set when the worker is being destroyed
+	atomic<bool> workerSleeping;              // Set while the persistence thread waits for changes
+	atomic<long long> submittedCount;         // Counts the changes queued
+	atomic<long long> completedCount;         // Counts the changes written
+	mutex stateMutex;                         // Guards sleeping and waking, and the first error
+	condition_variable workAvailable;         // Signaled when a change is queued or the worker stops
+	condition_variable progressMade;          // Signaled when the persistence thread finishes a batch of changes
+	exception_ptr firstError;                 // Holds the first exception thrown while writing, rethrown to the caller
+
+	// Wakes the persistence thread if it is waiting for changes
+	void wakeWorker();
+
+	// Writes one change, keeping the exception it throws for the caller
+	void applyRecord(PersistenceRecord&);
+
+	// Rethrows the first exception thrown by the persistence thread, if any
+	void rethrowError();
+
+	// The loop run by the persistence thread
+	void workerLoop();
+
+public:
+	/*
+		Constructor that starts the persistence thread, writing to the given store and journal
+		through a queue of the given capacity, with the given durability policy.
+	*/
+	PersistenceWorker(AccountStore&, PersonJournal&, size_t, DurabilityPolicy);
+
+	// Destructor that writes the queued changes and joins the persistence thread
+	~PersistenceWorker();
+
+	// The worker owns a running thread, so it can be neither copied nor moved
+	PersistenceWorker(const PersistenceWorker&) = delete;
+	PersistenceWorker& operator=(const PersistenceWorker&) = delete;
+
+	/*
+		Queues a change, waiting while the queue is full.
+		With AcknowledgeOnSync, also waits until the change has been written and forced to the disk.
+		Rethrows an exception thrown while writing an earlier change.
+	*/
+	void submit(PersistenceRecord&);
+
+	/*
+		Waits until every queued change has been written.
+		Called before the store or the journal is used directly, and before the program exits.
+		Rethrows an exception thrown while writing a change.
+	*/
+	void waitUntilIdle();
+};
+
+#endif
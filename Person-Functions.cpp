@@ -5,6 +5,9 @@
 #include "Constants.h"
 #include "Display-Functions.h"
 #include "Conversion-Functions.h"
+#include "AccountVariant.h"
+#include "Numeric-Functions.h"
+#include "Clock.h"
 
 using namespace std;
 
@@ -20,8 +23,9 @@ void createPerson(long long nationalID)
         else
         {
             personObject = fillPerson(nationalID); // Prompts the user to fill in the new person's details.
-            persons.push_back(personObject); // Adds the new person to the persons vector.
-            writeAllSavedPersonsToTheCSVFile(); // Saves all persons to the CSV file to persist the new person.
+            auto position = lower_bound(persons.begin(), persons.end(), personObject, [](Person& left, const Person& right) { return left.getNationalID() < right.getNationalID(); }); // Finds where the new person belongs in national ID order.
+            persons.insert(position, personObject); // Inserts the new person, keeping the persons vector sorted.
+            persistSavedPerson(personObject); // Records the new person in the person journal.
         }
     }
     else
@@ -182,42 +186,24 @@ Person fillPerson(long long personNationalID)
 void listAllPersons()
 {
     vector<vector<string>> personsTable = { {"NationalID", "Name", "Age", "Phone Number"} }; // Initializes the table with headers.
-    for (Person& person : persons) // Iterates through each person in the persons vector.
-    {
-        string personCSV = convertPersonObjectToCSVString(person); // Converts the Person object to a CSV string.
-        vector<string> personVector = convertCSVStringToVector(personCSV); // Converts the CSV string to a vector.
-        personsTable.push_back(personVector); // Adds the person's data to the table.
-    }
+    personsTable.reserve(persons.size() + 1); // Allocates the table once.
+    for (const Person& person : persons) // Iterates through each person in the persons vector.
+        personsTable.push_back(convertPersonObjectToTableRow(person)); // Adds the person's data to the table.
     printTable(personsTable); // Prints the persons' data in a tabular format.
 }
 
 // Displays a person's information and their associated accounts in two separate tables.
-// Takes a Person object and retrieves their national ID for account matching.
-void displayPerson(Person& personObject)
+// Takes a Person object and looks up their accounts by national ID in the account store.
+void displayPerson(const Person& personObject)
 {
-    string personCSV = convertPersonObjectToCSVString(personObject); // Converts the Person object to a CSV string.
-    vector<string> personVector = convertCSVStringToVector(personCSV); // Converts the CSV string to a vector.
+    vector<string> personVector = convertPersonObjectToTableRow(personObject); // Converts the Person object to a table row.
     vector<vector<string>> personTable = { {"NationalID", "Name", "Age", "Phone Number"}, personVector }; // Creates a table for the person's information.
-    vector<vector<string>> accountsTable = { {"AccountID", "Account Type", "NationalID", "Balance", "Creation Date & Time", "Interest Rate", "Withdrawn Amount", "Saving Balance"} }; // Initializes the accounts table with headers.
-    for (vector<string> account : accounts) // Iterates through all accounts.
+    vector<vector<string>> accountsTable = { {"AccountID", "Account Type", "Product", "NationalID", "Balance", "Creation Date & Time", "Interest Rate", "Withdrawn Amount", "Saving Balance"} }; // Initializes the accounts table with headers.
+    time_t asOf = getOperationTime(); // Evaluates the saving balances as of the time of the operation.
+    for (const vector<string>& personAccount : findAccountsOfPerson(personObject.getNationalID())) // Iterates through the person's accounts only.
     {
-        if (account[1] == personVector[0]) // Checks if the account's national ID matches the person's national ID.
-        {
-            if (account.back() == "") // Determines if the account is a Saving Account (empty interest rate field).
-            {
-                account.push_back(""); // Adds an empty field for certificate-specific data.
-                account.insert(account.begin() + 1, "Saving Account"); // Inserts the account type.
-            }
-            else // Handles Certificate Account.
-            {
-                CertificateAccount certificateAccountObject = convertAccountVectorToCertificateAccountObject(account); // Converts the account vector to a CertificateAccount object.
-                account.push_back(to_string(certificateAccountObject.getSavingBalance())); // Calculates and adds the saving balance.
-                account.insert(account.begin() + 1, "Certificate Account"); // Inserts the account type.
-            }
-            vector<string> dateTimeVector = convertDateTimeStringToDateTimeVector(account[4]); // Converts the account's date-time string to a vector.
-            account[4] = convertDateTimeVectorToFormattedDateTimeString(dateTimeVector); // Formats the date-time for display.
-            accountsTable.push_back(account); // Adds the modified account to the accounts table.
-        }
+        size_t accountIndex = static_cast<size_t>(parseInt(personAccount[0]) - 1); // Gets the account's position from its ID.
+        accountsTable.push_back(convertAccountVectorToTableRow(personAccount, accountIndex, asOf)); // Adds the account with its type name and saving balance.
     }
     cout << "Client Information:" << endl; // Displays a header for the person's information.
     printTable(personTable); // Prints the person's information table.
@@ -318,7 +304,7 @@ void updatePerson()
         if (newAge != 0) personObject.setAge(newAge); // Updates the age if changed.
         if (newPhoneNumber != "0") personObject.setPhoneNumber(newPhoneNumber); // Updates the phone number if changed.
         persons[personObjectIndex] = personObject; // Updates the person in the persons vector.
-        writeAllSavedPersonsToTheCSVFile(); // Saves all persons to the CSV file to persist changes.
+        persistSavedPerson(personObject); // Records the new details in the person journal.
     }
     catch (EmptyName)
     {
@@ -351,7 +337,7 @@ void updatePerson()
         if (newAge != 0) personObject.setAge(newAge); // Updates the age if changed.
         if (newPhoneNumber != "0") personObject.setPhoneNumber(newPhoneNumber); // Updates the phone number if changed.
         persons[personObjectIndex] = personObject; // Updates the person in the persons vector.
-        writeAllSavedPersonsToTheCSVFile(); // Saves all persons to the CSV file to persist changes.
+        persistSavedPerson(personObject); // Records the new details in the person journal.
     }
     catch (InvalidAgeException)
     {
@@ -382,7 +368,7 @@ void updatePerson()
         if (newAge != 0) personObject.setAge(newAge); // Updates the age if changed.
         if (newPhoneNumber != "0") personObject.setPhoneNumber(newPhoneNumber); // Updates the phone number if changed.
         persons[personObjectIndex] = personObject; // Updates the person in the persons vector.
-        writeAllSavedPersonsToTheCSVFile(); // Saves all persons to the CSV file to persist changes.
+        persistSavedPerson(personObject); // Records the new details in the person journal.
     }
 }
 
@@ -424,10 +410,10 @@ void deletePerson()
         {
             int first_account = -1; // Stores the index of the person's first account.
             int accounts_number = 0; // Counts the number of accounts associated with the person.
-            sort(accounts.begin(), accounts.end(), [&](vector<string>& acc1, vector<string>& acc2) { return stoll(acc1[1]) < stoll(acc2[1]); }); // Sorts accounts by national ID for contiguous grouping.
+            sort(accounts.begin(), accounts.end(), [&](const vector<string>& acc1, const vector<string>& acc2) { return parseLongLong(acc1[1]) < parseLongLong(acc2[1]); }); // Sorts accounts by national ID for contiguous grouping.
             for (int i = 0; i < accounts.size(); i++) // Iterates through all accounts.
             {
-                if (stoll(accounts[i][1]) == personObject.getNationalID()) // Checks if the account belongs to the person.
+                if (parseLongLong(accounts[i][1]) == personObject.getNationalID()) // Checks if the account belongs to the person.
                 {
                     if (first_account == -1) first_account = i; // Sets the first account index if not yet set.
                     accounts_number++; // Increments the count of the person's accounts.
@@ -435,12 +421,12 @@ void deletePerson()
             }
             accounts.erase(accounts.begin() + first_account, accounts.begin() + first_account + accounts_number); // Removes the person's accounts.
             persons.erase(persons.begin() + personObjectIndex); // Removes the person from the persons vector.
-            sort(accounts.begin(), accounts.end(), [&](vector<string>& acc1, vector<string>& acc2) { return stoi(acc1[0]) < stoi(acc2[0]); }); // Re-sorts accounts by accountID.
+            sort(accounts.begin(), accounts.end(), [&](const vector<string>& acc1, const vector<string>& acc2) { return parseInt(acc1[0]) < parseInt(acc2[0]); }); // Re-sorts accounts by accountID.
             cout << "The person and their accounts have been successfully deleted." << endl; // Confirms successful deletion.
-            writeAllSavedAccountToCSVFile(); // Saves all accounts to the CSV file.
-            writeAllSavedPersonsToTheCSVFile(); // Saves all persons to the CSV file.
+            persistAllAccounts(); // Saves all accounts to the CSV file and the account store.
+            persistDeletedPerson(nationalID); // Records the removal in the person journal.
         }
         else
             cout << "Deletion canceled. The person and their accounts remain in the system." << endl; // Informs the user if deletion was canceled.
     }
-}
\ No newline at end of file
+}
\ No newline at end of file
@@ -38,7 +38,7 @@ void listAllPersons();
 	- Shows one table for the person's data
 	- Shows another table for the persons accounts (retrieved by national ID)
 */
-void displayPerson(Person&);
+void displayPerson(const Person&);
 
 /*
 	Reads and displays a specific person's information.
@@ -8,15 +8,15 @@ using namespace std;
 // Default constructor to initialize a Person object with empty or zeroed data members.
 Person::Person()
 {
-    name = ""; // Initializes name as an empty string.
+    name = string_view(); // Initializes name as an empty string.
     age = 0; // Initializes age to 0.
-    phoneNumber = ""; // Initializes phone number as an empty string.
+    phoneNumber = string_view(); // Initializes phone number as an empty string.
     nationalID = 0; // Initializes national ID to 0.
 }
 
 // Parameterized constructor to initialize a Person object with specific data.
 // Uses setters to validate and set the provided arguments.
-Person::Person(string nameArgument, int ageArgument, long long int nationalIDArgument, string phoneNumberArgument)
+Person::Person(string_view nameArgument, int ageArgument, long long int nationalIDArgument, string_view phoneNumberArgument)
 {
     setName(nameArgument); // Sets and validates the name.
     setAge(ageArgument); // Sets and validates the age.
@@ -25,13 +25,14 @@ Person::Person(string nameArgument, int ageArgument, long long int nationalIDArg
 }
 
 // Sets the person's name with validation to ensure it is not empty and does not contain commas.
+// Copies the name into the person text arena, so copies of the Person object share it.
 // Throws an EmptyName exception if the name is invalid.
-void Person::setName(string nameArgument)
+void Person::setName(string_view nameArgument)
 {
-    if (nameArgument == "" || nameArgument.find(',') != string::npos)
+    if (nameArgument.empty() || nameArgument.find(',') != string_view::npos)
         throw EmptyName(); // Throws an exception if the name is empty or contains a comma.
     else
-        name = nameArgument; // Assigns the valid name to the object.
+        name = personTextArena.store(nameArgument); // Assigns the valid name to the object.
 }
 
 // Sets the person's age with validation to ensure it is within the allowed range.
@@ -64,25 +65,26 @@ void Person::setNationalID(long long int nationalIDArgument)
 }
 
 // Sets the person's phone number with validation to ensure it is not empty.
+// Copies the phone number into the person text arena, so copies of the Person object share it.
 // Throws an EmptyPhoneNumber exception if the phone number is empty.
-void Person::setPhoneNumber(string phoneNumberArgument)
+void Person::setPhoneNumber(string_view phoneNumberArgument)
 {
-    if (phoneNumberArgument == "" || phoneNumberArgument.find(',') != string::npos)
+    if (phoneNumberArgument.empty() || phoneNumberArgument.find(',') != string_view::npos)
         throw EmptyPhoneNumber(); // Throws an exception if the phone number is empty.
     else
-        phoneNumber = phoneNumberArgument; // Assigns the valid phone number to the object.
+        phoneNumber = personTextArena.store(phoneNumberArgument); // Assigns the valid phone number to the object.
 }
 
 // Overloads the less-than operator to compare two Person objects based on their national IDs.
 // Useful for sorting and searching operations.
-bool Person::operator<(Person& personObj)
+bool Person::operator<(const Person& personObj) const
 {
     return nationalID < personObj.nationalID; // Returns true if this object's national ID is less than the other's.
 }
 
 // Overloads the equality operator to check if two Person objects are identical.
 // Compares name, age, national ID, and phone number for equality.
-bool Person::operator==(Person& personObj)
+bool Person::operator==(const Person& personObj) const
 {
     if (name == personObj.name && age == personObj.age && nationalID == personObj.nationalID && phoneNumber == personObj.phoneNumber)
         return true; // Returns true if all attributes match.
@@ -7,15 +7,16 @@
 #define PERSON_H
 
 #include <string>
+#include <string_view>
 using namespace std;
 
 class Person
 {
 private:
-	string name;              // Stores the person's full name
+	string_view name;         // Stores the person's full name, held in the person text arena
 	int age;                  // Stores the person's age
 	long long int nationalID; // Stores the national ID number (unique identifier)
-	string phoneNumber;       // Stores the person's phone number
+	string_view phoneNumber;  // Stores the person's phone number, held in the person text arena
 
 public:
 	// Default constructor
@@ -28,10 +29,10 @@ public:
 		- national ID
 		- phone number
 	*/
-	Person(string, int, long long int, string);
+	Person(string_view, int, long long int, string_view);
 
-	// Sets the person's name
-	void setName(string);
+	// Sets the person's name, copying it into the person text arena
+	void setName(string_view);
 
 	// Sets the person's age with validation
 	void setAge(int);
@@ -39,30 +40,30 @@ public:
 	// Sets the national ID with validation
 	void setNationalID(long long int);
 
-	// Sets the phone number
-	void setPhoneNumber(string);
+	// Sets the phone number, copying it into the person text arena
+	void setPhoneNumber(string_view);
 
 	/*
 		Overloaded less-than operator.
 		Used to compare two Person objects based on national ID,
 		mainly for sorting and binary search purposes.
 	*/
-	bool operator<(Person&);
+	bool operator<(const Person&) const;
 
 	/*
 		Overloaded equality operator.
 		Checks if two Person objects are identical in all fields.
 	*/
-	bool operator==(Person&);
+	bool operator==(const Person&) const;
 
-	// Inline getter for the name
-	string getName() const
+	// Inline getter for the name; the view stays valid until the program data is reloaded
+	string_view getName() const
 	{
 		return name;
 	}
 
-	// Inline getter for the phone number
-	string getPhoneNumber() const
+	// Inline getter for the phone number; the view stays valid until the program data is reloaded
+	string_view getPhoneNumber() const
 	{
 		return phoneNumber;
 	}
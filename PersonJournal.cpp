@@ -0,0 +1,180 @@
+#include <cstring>
+#include <cstddef>
+#include <algorithm>
+#include <fstream>
+#include <filesystem>
+#include "PersonJournal.h"
+#include "Checksum-Functions.h"
+#include "Conversion-Functions.h"
+#include "Numeric-Functions.h"
+#include "Exceptions.h"
+#include "Constants.h"
+
+using namespace std;
+
+// The record types of the journal.
+static const uint8_t PERSON_SAVED_RECORD = 1;
+static const uint8_t PERSON_DELETED_RECORD = 2;
+
+// Records longer than this are treated as garbage; a person line is far shorter.
+static const uint32_t MAX_JOURNAL_PAYLOAD_LENGTH = 1 << 16;
+
+// Holds the header written before the payload of every record.
+struct JournalRecordHeader
+{
+    uint32_t payloadLength; // Number of payload bytes after the header
+    uint32_t checksum;      // CRC32C of the header bytes after this field and of the payload
+    uint64_t sequence;      // Sequence number, increasing by one from record to record
+    uint8_t recordType;     // PERSON_SAVED_RECORD or PERSON_DELETED_RECORD
+    uint8_t reserved[7];    // Unused, always zero
+};
+
+// The header size is part of the file format, so it must not change with the compiler.
+static_assert(sizeof(JournalRecordHeader) == 24, "The journal record header must be 24 bytes");
+
+// Computes the checksum of a record from its header and payload.
+static uint32_t computeRecordChecksum(const JournalRecordHeader& header, const char* payload)
+{
+    size_t checkedStart = offsetof(JournalRecordHeader, sequence); // The checksum covers the header from the sequence number on.
+    uint32_t checksum = computeCRC32C(reinterpret_cast<const char*>(&header) + checkedStart, sizeof(header) - checkedStart); // Checksums the header.
+    checksum = computeCRC32C(&header.payloadLength, sizeof(header.payloadLength), checksum); // Adds the length, so a damaged length is caught too.
+    return computeCRC32C(payload, header.payloadLength, checksum); // Adds the payload.
+}
+
+// Default constructor, the journal starts closed.
+PersonJournal::PersonJournal() : journalWriter(JOURNAL_IO_BUFFER_COUNT, JOURNAL_IO_BUFFER_SIZE), lastSequence(0), recordCount(0)
+{
+}
+
+// Opens the journal file for appending.
+void PersonJournal::open(const string& path)
+{
+    filePath = path; // Remembers the path.
+    journalWriter.open(filePath, false); // Opens the file, creating it if it does not exist.
+}
+
+// Closes the journal file.
+void PersonJournal::close()
+{
+    journalWriter.close(); // Writes the buffered records and closes the file.
+}
+
+// Replays the valid records into the persons vector and cuts off the damaged end of the file.
+size_t PersonJournal::applyTo(vector<Person>& personList)
+{
+    ifstream replayFile(filePath, ios::in | ios::binary); // Opens the journal for reading.
+    if (!replayFile)
+        return 0; // Returns if there is nothing to replay.
+    string content((istreambuf_iterator<char>(replayFile)), istreambuf_iterator<char>()); // Reads the whole journal.
+    replayFile.close(); // Closes the file.
+
+    size_t position = 0; // Stores where the next record starts.
+    size_t replayedCount = 0; // Counts the records replayed.
+    uint64_t replayedSequence = 0; // Stores the sequence number of the last replayed record, checked against the file's own records only.
+    while (content.size() - position >= sizeof(JournalRecordHeader))
+    {
+        JournalRecordHeader header; // Stores a copy of the header.
+        memcpy(&header, content.data() + position, sizeof(header)); // Copies the header out of the file content.
+        const char* payload = content.data() + position + sizeof(header); // Points to the payload.
+        if (header.payloadLength > MAX_JOURNAL_PAYLOAD_LENGTH || header.payloadLength > content.size() - position - sizeof(header))
+            break; // Stops at a record cut short by a crash.
+        if (header.checksum != computeRecordChecksum(header, payload) || (replayedSequence != 0 && header.sequence <= replayedSequence))
+            break; // Stops at a damaged record or at one out of sequence.
+
+        string payloadText(payload, header.payloadLength); // Copies the payload.
+        long long nationalID; // Stores the national ID of the person the record changes.
+        Person savedPerson; // Stores the saved person, for a saved person record.
+        try
+        {
+            if (header.recordType == PERSON_SAVED_RECORD)
+            {
+                savedPerson = convertCSVPersonStringToPersonObject(payloadText); // Decodes the person.
+                nationalID = savedPerson.getNationalID(); // Gets the national ID.
+            }
+            else if (header.recordType == PERSON_DELETED_RECORD)
+                nationalID = parseLongLong(payloadText); // Decodes the national ID.
+            else
+                break; // Stops at a record of an unknown type.
+        }
+        catch (...)
+        {
+            break; // Stops at a record whose checksum matches but whose payload cannot be decoded.
+        }
+
+        auto location = lower_bound(personList.begin(), personList.end(), nationalID, [](const Person& person, long long id) { return person.getNationalID() < id; }); // Finds the person or where it belongs.
+        bool found = location != personList.end() && location->getNationalID() == nationalID; // Checks if the person is already in the vector.
+        if (header.recordType == PERSON_SAVED_RECORD)
+        {
+            if (found)
+                *location = savedPerson; // Replaces the person's details.
+            else
+                personList.insert(location, savedPerson); // Adds the person, keeping the vector sorted.
+        }
+        else if (found)
+            personList.erase(location); // Removes the person.
+
+        replayedSequence = header.sequence; // Expects the next record to follow it.
+        position += sizeof(header) + header.payloadLength; // Moves to the next record.
+        replayedCount++; // Counts the record.
+    }
+
+    if (position < content.size())
+    {
+        bool wasOpen = journalWriter.isOpen(); // Stores whether the file must be reopened after cutting it.
+        close(); // Closes the file so it can be cut.
+        error_code resizeError; // Stores the result of the resize.
+        filesystem::resize_file(filePath, position, resizeError); // Cuts off the torn or damaged records.
+        if (resizeError)
+            throw InvalidFileException(); // Throws an exception if the damaged end cannot be removed.
+        if (wasOpen)
+            open(filePath); // Reopens the file for appending after the last valid record.
+    }
+    lastSequence = max(lastSequence, replayedSequence); // Continues the sequence after the replayed records, and after the ones this process appended.
+    recordCount = replayedCount; // Counts the records kept in the journal.
+    return replayedCount;
+}
+
+// Appends a record to the write buffers; flush or sync writes it.
+void PersonJournal::appendRecord(uint8_t recordType, const string& payload)
+{
+    JournalRecordHeader header = {}; // Stores the header (zero-initialized).
+    header.payloadLength = static_cast<uint32_t>(payload.size()); // Stores the payload length.
+    header.sequence = ++lastSequence; // Gives the record the next sequence number.
+    header.recordType = recordType; // Stores the record type.
+    header.checksum = computeRecordChecksum(header, payload.data()); // Checksums the record.
+    journalWriter.append(reinterpret_cast<const char*>(&header), sizeof(header)); // Appends the header.
+    journalWriter.append(payload.data(), payload.size()); // Appends the payload.
+    recordCount++; // Counts the record.
+}
+
+// Appends a record holding the new details of a person.
+void PersonJournal::appendSavedPerson(const Person& person)
+{
+    appendRecord(PERSON_SAVED_RECORD, convertPersonObjectToCSVString(person));
+}
+
+// Appends a record removing the person with the given national ID.
+void PersonJournal::appendDeletedPerson(long long nationalID)
+{
+    appendRecord(PERSON_DELETED_RECORD, formatInteger(nationalID));
+}
+
+// Writes the appended records.
+void PersonJournal::flush()
+{
+    journalWriter.flush(false); // Writes the buffered records in one batch.
+}
+
+// Writes the appended records and forces them to the disk.
+void PersonJournal::sync()
+{
+    journalWriter.flush(true); // Writes the buffered records with the fdatasync linked behind them.
+}
+
+// Empties the journal after a checkpoint.
+void PersonJournal::clear()
+{
+    close(); // Closes the file so it can be emptied.
+    journalWriter.open(filePath, true); // Empties the file and keeps it open for appending.
+    recordCount = 0; // Starts counting again.
+}
@@ -0,0 +1,98 @@
+// This is the specification file for the PersonJournal class,
+// an append-only log of the changes made to persons.
+// Adding, updating or deleting a person appends one small record instead of rewriting Persons.csv;
+// the journal is folded into Persons.csv at a checkpoint and replayed after a crash.
+
+/*
+	Journal file layout (all numbers in the native byte order):
+	- Records, one after another, each made of a 24-byte header (payload length, CRC32C,
+	  sequence number, record type) followed by the payload:
+	  the person as a CSV line for a saved person, or the national ID for a deleted person
+	- The CRC32C covers the rest of the header and the payload, so a record cut short by a crash
+	  or overwritten with garbage is detected, and everything from it to the end of the file is cut off
+*/
+
+// These are the include guards
+#pragma once
+#ifndef PERSONJOURNAL_H
+#define PERSONJOURNAL_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "Person.h"
+#include "BatchFileWriter.h"
+using namespace std;
+
+class PersonJournal
+{
+private:
+	string filePath;      // Holds the path of the journal file
+	BatchFileWriter journalWriter; // Holds the journal file opened for appending, with the records not yet written
+	uint64_t lastSequence; // Holds the sequence number of the newest record
+	size_t recordCount;   // Holds the number of records in the journal
+
+	// Appends a record of the given type and payload to the write buffers
+	void appendRecord(uint8_t, const string&);
+
+public:
+	// Default constructor, the journal starts closed
+	PersonJournal();
+
+	// The journal owns an open file, so it can be neither copied nor assigned
+	PersonJournal(const PersonJournal&) = delete;
+	PersonJournal& operator=(const PersonJournal&) = delete;
+
+	/*
+		Opens the journal file, creating it if it does not exist.
+		Throws an InvalidFileException if the file cannot be opened.
+	*/
+	void open(const string&);
+
+	// Closes the journal file
+	void close();
+
+	// Returns true if the journal is open
+	bool isOpen() const
+	{
+		return journalWriter.isOpen();
+	}
+
+	// Returns the number of records written since the journal was last cleared
+	size_t getRecordCount() const
+	{
+		return recordCount;
+	}
+
+	/*
+		Replays every valid record into the persons vector, in the order they were written,
+		keeping it sorted by national ID. A record replaces or removes the person with its national ID,
+		so replaying records already reflected in the vector leaves it unchanged.
+		Stops at the first torn or damaged record and cuts the file there.
+		Returns the number of records replayed.
+	*/
+	size_t applyTo(vector<Person>&);
+
+	// Appends a record holding the new details of a person
+	void appendSavedPerson(const Person&);
+
+	// Appends a record removing the person with the given national ID
+	void appendDeletedPerson(long long);
+
+	/*
+		Writes the records appended so far, so they survive the program crashing.
+		Throws an InvalidFileException if the journal cannot be written.
+	*/
+	void flush();
+
+	/*
+		Writes the records appended so far and forces them to the disk.
+		Throws an InvalidFileException if the journal cannot be synchronized.
+	*/
+	void sync();
+
+	// Empties the journal once its changes are saved in Persons.csv; the sequence numbers keep increasing
+	void clear();
+};
+
+#endif
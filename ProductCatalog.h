@@ -0,0 +1,378 @@
+// This is the specification and implementation file for the certificate product catalog,
+// the fixed list of certificate products a customer can open, with their terms, minimum deposits and rate tiers.
+// The catalog is built at compile time, and each product has its own policy type,
+// so the checks and interest formula of a product are compiled with its terms as constants.
+// The growth factor of every tier after every accrual period is also computed at compile time,
+// so the returns of a fixed-term certificate are a table lookup and a multiply, with no pow or loop.
+
+// These are the include guards
+#pragma once
+#ifndef PRODUCTCATALOG_H
+#define PRODUCTCATALOG_H
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <ctime>
+#include <limits>
+#include "Constants.h"
+#include "Exceptions.h"
+#include "Numeric-Functions.h"
+using namespace std;
+
+/*
+	Identifies a certificate product. The value is stored with every certificate account,
+	in the account vector, the CSV file, the snapshot and the account stores.
+	Classic is 0, so the certificates written before products existed read back as Classic.
+*/
+enum class CertificateProductID : uint8_t
+{
+	Classic = 0,
+	OneYear = 1,
+	ThreeYear = 2,
+	FiveYear = 3,
+	ThreeYearCompounding = 4,
+	FiveYearMonthly = 5
+};
+
+// The number of certificate products in the catalog
+const int CERTIFICATE_PRODUCT_COUNT = 6;
+
+// The largest number of rate tiers a product can have
+const int MAX_RATE_TIERS = 3;
+
+/*
+	How the returns of a certificate grow:
+	- Simple: the deposit earns the rate once per year
+	- Annual: the returns earned each year earn interest in the following years
+	- Monthly: a twelfth of the rate is earned each month and added to the amount earning interest
+*/
+enum class InterestCompounding : uint8_t
+{
+	Simple,
+	Annual,
+	Monthly
+};
+
+// Holds the interest rate given to deposits of at least the tier's minimum balance
+struct RateTier
+{
+	double minimumBalance;
+	double ratePercent;
+};
+
+// Holds the terms of one certificate product
+struct CertificateProduct
+{
+	CertificateProductID id;
+	const char* name;
+	int termYears;                 // Number of years the certificate earns interest, 0 when it earns for as long as it is open
+	InterestCompounding compounding;
+	double minimumDeposit;         // Smallest initial deposit accepted
+	RateTier tiers[MAX_RATE_TIERS]; // Rate tiers sorted by minimum balance; the first one starts at the minimum deposit
+	int tierCount;
+};
+
+/*
+	The certificate products, indexed by their ID.
+	The rate of a new certificate is the rate of the highest tier its deposit reaches,
+	and is kept for the life of the account.
+*/
+inline constexpr CertificateProduct CERTIFICATE_PRODUCTS[CERTIFICATE_PRODUCT_COUNT] =
+{
+	{ CertificateProductID::Classic, "Classic Certificate", 0, InterestCompounding::Simple, MIN_BALANCE, { { MIN_BALANCE, INTEREST_RATE_PERCENT } }, 1 },
+	{ CertificateProductID::OneYear, "1-Year Certificate", 1, InterestCompounding::Simple, 5000, { { 5000, 18 }, { 50000, 19 }, { 250000, 20 } }, 3 },
+	{ CertificateProductID::ThreeYear, "3-Year Certificate", 3, InterestCompounding::Simple, 10000, { { 10000, 22 }, { 100000, 23.5 }, { 500000, 25 } }, 3 },
+	{ CertificateProductID::FiveYear, "5-Year Certificate", 5, InterestCompounding::Simple, 25000, { { 25000, 27 }, { 250000, 28.5 }, { 1000000, 30 } }, 3 },
+	{ CertificateProductID::ThreeYearCompounding, "3-Year Compounding Certificate", 3, InterestCompounding::Annual, 10000, { { 10000, 20 }, { 100000, 21.5 }, { 500000, 23 } }, 3 },
+	{ CertificateProductID::FiveYearMonthly, "5-Year Monthly Certificate", 5, InterestCompounding::Monthly, 25000, { { 25000, 24 }, { 250000, 25.5 }, { 1000000, 27 } }, 3 }
+};
+
+// Returns the number of accrual periods in a year: 12 for monthly compounding, 1 otherwise
+constexpr int getPeriodsPerYear(InterestCompounding compounding)
+{
+	return compounding == InterestCompounding::Monthly ? 12 : 1;
+}
+
+// The largest number of accrual periods in a product's term, which sizes the growth factor tables
+const int MAX_TERM_PERIODS = 60;
+
+// Returns true if the catalog is indexed by product ID and every product's tiers are sorted and start at its minimum deposit
+constexpr bool isValidCertificateCatalog()
+{
+	for (int i = 0; i < CERTIFICATE_PRODUCT_COUNT; i++)
+	{
+		const CertificateProduct& product = CERTIFICATE_PRODUCTS[i];
+		if (static_cast<int>(product.id) != i || product.tierCount < 1 || product.tierCount > MAX_RATE_TIERS || product.termYears < 0)
+			return false;
+		if (product.tiers[0].minimumBalance != product.minimumDeposit || product.minimumDeposit < MIN_BALANCE)
+			return false;
+		if (product.termYears * getPeriodsPerYear(product.compounding) > MAX_TERM_PERIODS)
+			return false;
+		if (product.termYears == 0 && product.compounding != InterestCompounding::Simple)
+			return false;
+		for (int tier = 1; tier < product.tierCount; tier++)
+		{
+			if (product.tiers[tier].minimumBalance <= product.tiers[tier - 1].minimumBalance)
+				return false;
+		}
+	}
+	return true;
+}
+static_assert(isValidCertificateCatalog(), "The certificate catalog must be indexed by ID with sorted tiers starting at the minimum deposit, and only fixed-term products may compound");
+
+/*
+	Returns the growth factor of an amount after the given number of accrual periods,
+	computed directly from the rate by squaring; used for rates outside the catalog.
+	The rate per period is the yearly rate divided by the number of periods in a year, as a fraction.
+*/
+constexpr double computeGrowthFactor(InterestCompounding compounding, double ratePerPeriod, int periods)
+{
+	if (compounding == InterestCompounding::Simple)
+		return 1 + periods * ratePerPeriod;
+	double factor = 1;
+	double base = 1 + ratePerPeriod;
+	for (int remaining = periods; remaining > 0; remaining /= 2)
+	{
+		if (remaining % 2 == 1)
+			factor *= base;
+		base *= base;
+	}
+	return factor;
+}
+
+/*
+	Holds the growth factor of every tier of one product after 0 to MAX_TERM_PERIODS accrual periods.
+	Entries past the product's term are not used.
+*/
+struct GrowthFactorTable
+{
+	double factors[MAX_RATE_TIERS][MAX_TERM_PERIODS + 1];
+};
+
+// Holds the growth factor table of every product, indexed by product ID
+struct GrowthFactorCatalog
+{
+	GrowthFactorTable tables[CERTIFICATE_PRODUCT_COUNT];
+};
+
+// Builds the growth factor tables, each entry from the previous one with a single multiply or add
+constexpr GrowthFactorCatalog buildGrowthFactorCatalog()
+{
+	GrowthFactorCatalog catalog = {};
+	for (int i = 0; i < CERTIFICATE_PRODUCT_COUNT; i++)
+	{
+		const CertificateProduct& product = CERTIFICATE_PRODUCTS[i];
+		int termPeriods = product.termYears * getPeriodsPerYear(product.compounding);
+		for (int tier = 0; tier < product.tierCount; tier++)
+		{
+			double ratePerPeriod = product.tiers[tier].ratePercent / 100 / getPeriodsPerYear(product.compounding);
+			double* factors = catalog.tables[i].factors[tier];
+			factors[0] = 1;
+			for (int period = 1; period <= termPeriods; period++)
+			{
+				if (product.compounding == InterestCompounding::Simple)
+					factors[period] = factors[period - 1] + ratePerPeriod;
+				else
+					factors[period] = factors[period - 1] * (1 + ratePerPeriod);
+			}
+		}
+	}
+	return catalog;
+}
+
+// The growth factor tables of the catalog, computed by the compiler
+inline constexpr GrowthFactorCatalog GROWTH_FACTOR_TABLES = buildGrowthFactorCatalog();
+
+/*
+	Holds what a certificate needs to compute its returns as of any date with a lookup and a multiply,
+	prepared once per account from its product, rate and creation date-time,
+	and the last returns computed with the accrual window they stay valid in.
+	Returns only change at accrual boundaries, so the cached value is reused until the next boundary passes.
+*/
+struct CertificateAccrualState
+{
+	time_t creationTime;          // Time the account was created
+	int periodSeconds;            // Length of one accrual period
+	int termPeriods;              // Number of periods that earn interest, 0 when they all do
+	double ratePerPeriod;         // Rate earned per period, as a fraction
+	InterestCompounding compounding;
+	const double* growthFactors;  // The product table's row for the account's tier, or null if the rate is not one of the product's tiers
+	double accruedReturns;        // Returns computed for the accrual window below
+	time_t accruedFrom;           // Start of the window the cached returns are valid in
+	time_t accruedUntil;          // End of the window (the next accrual boundary), or the largest time once the term is over; equal to its start when nothing is cached
+};
+
+// Returns the number of whole accrual periods between the creation and the as-of time, capped at the term.
+inline int getAccruedPeriods(const CertificateAccrualState& state, time_t asOf)
+{
+	long long elapsedSeconds = static_cast<long long>(difftime(asOf, state.creationTime)); // Computes the age of the account.
+	if (elapsedSeconds < 0)
+		return 0; // An account earns nothing before it is created.
+	long long periods = elapsedSeconds / state.periodSeconds; // Counts the whole periods.
+	if (state.termPeriods > 0 && periods > state.termPeriods)
+		periods = state.termPeriods; // Stops earning at the end of the term.
+	return static_cast<int>(periods);
+}
+
+// Returns the returns earned by the deposit as of the given time: a table lookup and a multiply for the catalog rates.
+inline double computeTotalReturns(const CertificateAccrualState& state, double deposit, time_t asOf)
+{
+	int periods = getAccruedPeriods(state, asOf); // Counts the periods that earned interest.
+	if (state.termPeriods == 0)
+		return deposit * periods * state.ratePerPeriod; // Open-ended certificates earn simple interest without a term to tabulate.
+	if (state.growthFactors != nullptr)
+		return deposit * (state.growthFactors[periods] - 1); // Looks the growth factor up.
+	return deposit * (computeGrowthFactor(state.compounding, state.ratePerPeriod, periods) - 1); // Computes it for a rate outside the catalog.
+}
+
+/*
+	Returns the returns earned by the deposit as of the given time, reusing the cached value while the time is in its accrual window.
+	Otherwise computes them and caches them with the window that ends at the next accrual boundary.
+*/
+inline double getAccruedReturns(CertificateAccrualState& state, double deposit, time_t asOf)
+{
+	if (asOf >= state.accruedFrom && asOf < state.accruedUntil)
+		return state.accruedReturns; // No boundary has passed since the returns were computed.
+	int periods = getAccruedPeriods(state, asOf); // Counts the periods that earned interest.
+	state.accruedReturns = computeTotalReturns(state, deposit, asOf); // Computes the returns once for the whole window.
+	state.accruedFrom = periods == 0 ? numeric_limits<time_t>::min() : state.creationTime + static_cast<time_t>(periods) * state.periodSeconds; // Starts the window at the last boundary.
+	if (state.termPeriods > 0 && periods == state.termPeriods)
+		state.accruedUntil = numeric_limits<time_t>::max(); // Nothing accrues after the term.
+	else
+		state.accruedUntil = state.creationTime + static_cast<time_t>(periods + 1) * state.periodSeconds; // Ends the window at the next boundary.
+	return state.accruedReturns; // Returns the new value.
+}
+
+/*
+	Holds the validation, rate selection and accrual setup of one product, with the product's terms as compile-time constants.
+	Fixed-term products earn interest for their term only.
+*/
+template <CertificateProductID Product>
+struct CertificateProductPolicy
+{
+	static constexpr CertificateProduct product = CERTIFICATE_PRODUCTS[static_cast<int>(Product)];
+	static constexpr int periodsPerYear = getPeriodsPerYear(product.compounding);
+	static constexpr int termPeriods = product.termYears * periodsPerYear;
+
+	// Returns true if the deposit is enough to open the product
+	static constexpr bool isValidDeposit(double deposit)
+	{
+		return deposit >= product.minimumDeposit;
+	}
+
+	// Returns the rate of the highest tier the deposit reaches
+	static constexpr double getRatePercent(double deposit)
+	{
+		double ratePercent = product.tiers[0].ratePercent;
+		for (int tier = 1; tier < product.tierCount; tier++)
+		{
+			if (deposit >= product.tiers[tier].minimumBalance)
+				ratePercent = product.tiers[tier].ratePercent;
+		}
+		return ratePercent;
+	}
+
+	// Returns the index of the tier with the given rate, or -1 if no tier has it
+	static constexpr int findTier(double ratePercent)
+	{
+		for (int tier = 0; tier < product.tierCount; tier++)
+		{
+			if (product.tiers[tier].ratePercent == ratePercent)
+				return tier;
+		}
+		return -1;
+	}
+
+	// Returns the accrual state of an account of this product with the given rate, created at the given time
+	static CertificateAccrualState getAccrualState(double ratePercent, time_t creationTime)
+	{
+		int tier = findTier(ratePercent);
+		return CertificateAccrualState{ creationTime, SECONDS_IN_A_YEAR / periodsPerYear, termPeriods, ratePercent / 100 / periodsPerYear, product.compounding,
+			tier >= 0 ? GROWTH_FACTOR_TABLES.tables[static_cast<int>(Product)].factors[tier] : nullptr, 0, 0, 0 };
+	}
+};
+
+/*
+	The Classic certificate keeps the rules certificates had before the catalog:
+	the bank-wide minimum balance and rate, and simple interest for as long as the account is open.
+*/
+template <>
+struct CertificateProductPolicy<CertificateProductID::Classic>
+{
+	static constexpr CertificateProduct product = CERTIFICATE_PRODUCTS[static_cast<int>(CertificateProductID::Classic)];
+
+	static constexpr bool isValidDeposit(double deposit)
+	{
+		return deposit >= MIN_BALANCE;
+	}
+
+	static constexpr double getRatePercent(double)
+	{
+		return INTEREST_RATE_PERCENT;
+	}
+
+	static CertificateAccrualState getAccrualState(double ratePercent, time_t creationTime)
+	{
+		return CertificateAccrualState{ creationTime, SECONDS_IN_A_YEAR, 0, ratePercent / 100, InterestCompounding::Simple, nullptr, 0, 0, 0 };
+	}
+};
+
+// The policies are constant expressions, so their results can be checked at compile time.
+static_assert(CertificateProductPolicy<CertificateProductID::ThreeYear>::getRatePercent(100000) == 23.5, "A deposit at a tier's minimum gets the tier's rate");
+static_assert(CertificateProductPolicy<CertificateProductID::FiveYearMonthly>::termPeriods == 60, "A 5-year monthly certificate accrues for 60 months");
+static_assert(GROWTH_FACTOR_TABLES.tables[static_cast<int>(CertificateProductID::OneYear)].factors[0][1] == 1.18, "A 1-year certificate grows by its rate once");
+
+/*
+	Calls the function with the policy of the given product, so the code inside it is compiled once per product.
+	Throws an InvalidProductException if the ID is not in the catalog.
+*/
+template <class Function>
+auto visitCertificateProduct(CertificateProductID productID, Function&& function)
+{
+	static_assert(CERTIFICATE_PRODUCT_COUNT == 6, "Every product needs a case below");
+	switch (productID)
+	{
+	case CertificateProductID::Classic:
+		return function(CertificateProductPolicy<CertificateProductID::Classic>());
+	case CertificateProductID::OneYear:
+		return function(CertificateProductPolicy<CertificateProductID::OneYear>());
+	case CertificateProductID::ThreeYear:
+		return function(CertificateProductPolicy<CertificateProductID::ThreeYear>());
+	case CertificateProductID::FiveYear:
+		return function(CertificateProductPolicy<CertificateProductID::FiveYear>());
+	case CertificateProductID::ThreeYearCompounding:
+		return function(CertificateProductPolicy<CertificateProductID::ThreeYearCompounding>());
+	case CertificateProductID::FiveYearMonthly:
+		return function(CertificateProductPolicy<CertificateProductID::FiveYearMonthly>());
+	}
+	throw InvalidProductException();
+}
+
+/*
+	Returns the terms of the given product.
+	Throws an InvalidProductException if the ID is not in the catalog.
+*/
+inline const CertificateProduct& getCertificateProduct(CertificateProductID productID)
+{
+	if (static_cast<int>(productID) >= CERTIFICATE_PRODUCT_COUNT)
+		throw InvalidProductException();
+	return CERTIFICATE_PRODUCTS[static_cast<int>(productID)];
+}
+
+/*
+	Parses the product field of a certificate account vector.
+	An empty or missing field is a Classic certificate written before products existed.
+	Throws an InvalidProductException if the field names a product that is not in the catalog.
+*/
+inline CertificateProductID parseCertificateProductID(string_view field)
+{
+	if (field.empty())
+		return CertificateProductID::Classic;
+	int productNumber = parseInt(field);
+	if (productNumber < 0 || productNumber >= CERTIFICATE_PRODUCT_COUNT)
+		throw InvalidProductException();
+	return static_cast<CertificateProductID>(productNumber);
+}
+
+#endif
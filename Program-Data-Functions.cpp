@@ -1,76 +1,205 @@
 #include <string>
 #include <fstream>
 #include <limits>
+#include <memory>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <filesystem>
 #include "Program-Data-Functions.h"
 #include "Exceptions.h"
+#include "Numeric-Functions.h"
 #include "Display-Functions.h"
 #include <iostream>
 #include "Person-Functions.h"
 #include "Account-Functions.h"
+#include "Report-Functions.h"
+#include "EndOfDay-Functions.h"
+#include "Transaction-Functions.h"
+#include "Snapshot-Functions.h"
+#include "MappedAccountTable.h"
+#include "PagedAccountStore.h"
+#include "LsmAccountStore.h"
+#include "PersonJournal.h"
+#include "File-Functions.h"
+#include "PersistenceWorker.h"
+#include "Constants.h"
+#include "Clock.h"
 using namespace std;
 
 // Defines a global vector to store all Person objects, shared across translation units.
 vector<Person> persons;
+// Defines the global arena holding the names and phone numbers of the Person objects.
+StringArena personTextArena(PERSON_TEXT_ARENA_CHUNK_SIZE);
 // Defines a global vector to store all account data as vectors of strings, shared across translation units.
 vector<vector<string>> accounts;
+// Defines the global cache of the certificates' accrual states.
+AccrualCache accrualCache;
+// Defines the global table of the published account versions.
+AccountVersionTable accountVersions;
 
-// Writes all Person objects in the persons vector to the Persons.csv file for persistent storage.
-void writeAllSavedPersonsToTheCSVFile()
+// Holds the account store selected by ACCOUNT_STORE_BACKEND, which receives every account change.
+static unique_ptr<AccountStore> accountStore;
+
+// Creates the account store selected by ACCOUNT_STORE_BACKEND on first use and opens it if it is closed.
+static AccountStore& getAccountStore()
 {
-    ofstream csvPersonsFile("./CSVs/Persons.csv", ios::out); // Opens the Persons.csv file in write mode.
-    if (csvPersonsFile) // Checks if the file was opened successfully.
+    if (!accountStore)
     {
-        for (Person& person : persons) // Iterates through each Person object in the persons vector.
-        {
-            string csvPerson = convertPersonObjectToCSVString(person); // Converts the Person object to a CSV string.
-            csvPersonsFile << csvPerson << endl; // Writes the CSV string to the file.
-        }
-        csvPersonsFile.close(); // Closes the file.
+        if (ACCOUNT_STORE_BACKEND == AccountStoreBackend::PagedBTree)
+            accountStore.reset(new PagedAccountStore(BUFFER_POOL_FRAME_COUNT)); // Creates the paged B+tree store.
+        else if (ACCOUNT_STORE_BACKEND == AccountStoreBackend::LogStructured)
+            accountStore.reset(new LsmAccountStore()); // Creates the LSM tree store.
+        else
+            accountStore.reset(new MappedAccountTable()); // Creates the memory-mapped table.
     }
-    else
+    if (!accountStore->isOpen())
+    {
+        if (ACCOUNT_STORE_BACKEND == AccountStoreBackend::PagedBTree)
+            accountStore->open(ACCOUNT_PAGES_FILE_PATH); // Opens the page file, creating it if it does not exist.
+        else if (ACCOUNT_STORE_BACKEND == AccountStoreBackend::LogStructured)
+            accountStore->open(ACCOUNT_LSM_DIRECTORY_PATH); // Opens the store directory, creating it if it does not exist.
+        else
+            accountStore->open(ACCOUNT_TABLE_FILE_PATH); // Opens the table file, creating it if it does not exist.
+    }
+    return *accountStore;
+}
+
+// Holds the journal receiving every person change between two checkpoints of Persons.csv.
+static PersonJournal personJournal;
+
+// Opens the person journal on first use.
+static PersonJournal& getPersonJournal()
+{
+    if (!personJournal.isOpen())
+        personJournal.open(PERSON_JOURNAL_FILE_PATH); // Opens the journal, creating it if it does not exist.
+    return personJournal;
+}
+
+// Holds the persistence thread writing the changes to the journal and the store, started by the first change.
+static unique_ptr<PersistenceWorker> persistenceWorker;
+
+// Holds the number of account records the store will hold once the queued changes are written.
+static size_t storedAccountCount = 0;
+
+/*
+	Holds the version of the account at each position of the accounts vector, changed by every committed or persisted change.
+	A deque never moves its elements as accounts are added, so the atomics stay in place.
+*/
+static deque<atomic<unsigned long long>> accountVersionNumbers;
+
+// Holds the last version given to any account, so a version is never given twice, even after the accounts are renumbered.
+static atomic<unsigned long long> lastAccountVersion(0);
+
+// Serializes the commits, so the account written, queued and published is always the one whose version was claimed.
+static mutex accountCommitMutex;
+
+// Counts the person changes in the journal, including the queued ones, since Persons.csv was last written.
+static size_t journaledPersonCount = 0;
+
+// Waits until the persistence thread has written every queued change, before the store or journal is used directly.
+static void waitForPersistence()
+{
+    if (persistenceWorker)
+        persistenceWorker->waitUntilIdle(); // Drains the queue; rethrows a failure to write a change.
+}
+
+// Hands a change to the persistence thread, starting the thread on the first change.
+static void submitChange(PersistenceRecord& record)
+{
+    if (!persistenceWorker)
+        persistenceWorker.reset(new PersistenceWorker(getAccountStore(), getPersonJournal(), PERSISTENCE_QUEUE_CAPACITY, PERSISTENCE_DURABILITY_POLICY)); // Starts the thread on the first change.
+    persistenceWorker->submit(record); // Queues the change, waiting for it as the durability policy requires.
+}
+
+// Set while the checkpoint of an interrupted end-of-day batch may be waiting to be resumed.
+static bool endOfDayCheckpointPending = false;
+
+// Removes the checkpoint of an interrupted end-of-day batch, since resuming it would overwrite the account changed since.
+static void discardEndOfDayCheckpoint()
+{
+    if (!endOfDayCheckpointPending)
+        return; // Returns if there is no checkpoint to remove.
+    error_code removeError; // Stores the result of the removal.
+    filesystem::remove(END_OF_DAY_CHECKPOINT_FILE_PATH, removeError); // Removes the checkpoint; the next batch starts over.
+    endOfDayCheckpointPending = false; // Removes it only once.
+}
+
+// Counts the changes saved since the last background snapshot was started.
+static int changesSinceSnapshot = 0;
+
+// Counts a saved change and starts a background snapshot every BACKGROUND_SNAPSHOT_CHANGE_INTERVAL changes.
+static void recordSavedChange()
+{
+    changesSinceSnapshot++; // Counts the change.
+    if (changesSinceSnapshot >= BACKGROUND_SNAPSHOT_CHANGE_INTERVAL && startBackgroundSnapshot(SNAPSHOT_FILE_PATH))
+        changesSinceSnapshot = 0; // Restarts the count once the snapshot is under way; otherwise tries again at the next change.
+}
+
+// Writes all Person objects in the persons vector to the Persons.csv file for persistent storage,
+// then empties the person journal, whose changes the file now holds.
+void writeAllSavedPersonsToTheCSVFile()
+{
+    waitForPersistence(); // Lets the queued person changes reach the journal before it is emptied.
+    string csvContent; // Stores the whole file content, so it replaces the old file in one step.
+    for (const Person& person : persons) // Iterates through each Person object in the persons vector.
     {
-        throw InvalidFileException(); // Throws an exception if the file failed to open, causing program termination.
+        csvContent.append(convertPersonObjectToCSVString(person)); // Converts the Person object to a CSV string.
+        csvContent.push_back('\n'); // Ends the line.
     }
+    writeFileAtomically(PERSONS_CSV_FILE_PATH, csvContent); // Replaces the file; throws an InvalidFileException on failure.
+    getPersonJournal().clear(); // Empties the journal; if the program stops before this, replaying it again changes nothing.
+    journaledPersonCount = 0; // Restarts the count of journaled changes.
 }
 
 // Reads all person data from the Persons.csv file into the persons vector.
+// Reads the file in one call and tokenizes it as a whole, instead of reading and splitting line by line.
 void readAllSavedPersonsToThePersonsVector()
 {
-    ifstream csvPersonsFile("./CSVs/Persons.csv", ios::in); // Opens the Persons.csv file in read mode.
+    ifstream csvPersonsFile(PERSONS_CSV_FILE_PATH, ios::in | ios::binary); // Opens the Persons.csv file in read mode.
     if (csvPersonsFile) // Checks if the file was opened successfully.
     {
-        string csvStringPerson; // Stores each person's CSV string.
-        while (getline(csvPersonsFile, csvStringPerson)) // Reads each line from the file.
+        string fileContent = readWholeFile(csvPersonsFile); // Reads the whole file.
+        vector<CSVField> fields; // Stores the position of every field in the file.
+        vector<size_t> recordEnds; // Stores where each line's fields end.
+        tokenizeCSV(fileContent, fields, recordEnds); // Splits the file into fields and lines.
+        persons.reserve(persons.size() + recordEnds.size()); // Allocates the persons vector once.
+        personTextArena.reserve(fileContent.size()); // Allocates the space for every name and phone number once; the text is shorter than the file.
+        size_t firstField = 0; // Stores the index of the first field of the current line.
+        for (size_t recordEnd : recordEnds) // Iterates through each line of the file.
         {
-            Person person = convertCSVPersonStringToPersonObject(csvStringPerson); // Converts the CSV string to a Person object.
+            Person person = convertCSVFieldsToPersonObject(fileContent, &fields[firstField], recordEnd - firstField); // Converts the line to a Person object.
             persons.push_back(person); // Adds the Person object to the persons vector.
+            firstField = recordEnd; // Moves to the next line.
         }
         csvPersonsFile.close(); // Closes the file.
+        sort(persons.begin(), persons.end()); // Sorts the persons vector by national ID once, so searches never need to modify it.
     }
     else
     {
-        ofstream newCSVPersonsFile("./CSVs/Persons.csv", ios::out); // Creates the Persons.csv file if it does not exist.
+        ofstream newCSVPersonsFile(PERSONS_CSV_FILE_PATH, ios::out); // Creates the Persons.csv file if it does not exist.
         newCSVPersonsFile.close(); // Closes the newly created file.
     }
 }
 
 // Checks if a Person object is a default-constructed object (indicating it was not found or initialized).
-bool isDefaultPerson(Person& person)
+// Compares each field with its default value directly, so no default Person or string is created.
+bool isDefaultPerson(const Person& person)
 {
-    Person defaultPerson = Person(); // Creates a default Person object for comparison.
-    if (defaultPerson.getName() != person.getName() && defaultPerson.getAge() != person.getAge() &&
-        defaultPerson.getNationalID() != person.getNationalID() && defaultPerson.getPhoneNumber() != person.getPhoneNumber())
-        return false; // Returns false if any attribute differs from the default.
+    if (!person.getName().empty() && person.getAge() != 0 && person.getNationalID() != 0 && !person.getPhoneNumber().empty())
+        return false; // Returns false if every attribute differs from the default.
     else
         return true; // Returns true if the person matches the default.
 }
 
 // Searches for a person in the persons vector by national ID using a binary search algorithm.
+// The persons vector is kept sorted by national ID, so the search only reads it and is safe to run from several threads.
 // Returns the matching Person object or a default Person if not found.
 Person searchPerson(long long int nationalID)
 {
     Person person; // Initializes a default Person object to return if not found.
-    sort(persons.begin(), persons.end()); // Sorts the persons vector by national ID for binary search.
     int left = 0, right = persons.size() - 1; // Sets the search boundaries.
     while (left <= right && left >= 0 && right <= persons.size() - 1)
     {
@@ -89,7 +218,6 @@ Person searchPerson(long long int nationalID)
 // Returns the index of the person in the vector or -1 if not found.
 int searchPersonIndex(long long int nationalID)
 {
-    sort(persons.begin(), persons.end()); // Sorts the persons vector by national ID for binary search.
     int left = 0, right = persons.size() - 1; // Sets the search boundaries.
     while (left <= right)
     {
@@ -117,44 +245,399 @@ int lengthOfNumber(long long number)
 }
 
 // Writes all account vectors in the accounts vector to the Accounts.csv file for persistent storage.
+// The file is replaced in one step, so a crash while writing it never loses the previous account book.
 void writeAllSavedAccountToCSVFile()
 {
-    ofstream csvAccountsFile("./CSVs/Accounts.csv", ios::out); // Opens the Accounts.csv file in write mode.
+    string csvContent; // Stores the whole file content.
+    for (int id = 0; id < accounts.size(); id++) // Iterates through each account in the accounts vector.
+    {
+        accounts[id][0] = formatInteger(id + 1); // Updates the account ID based on its position.
+        csvContent.append(convertVectorToCSVString(accounts[id])); // Converts the account vector to a CSV string.
+        csvContent.push_back('\n'); // Ends the line.
+    }
+    writeFileAtomically(ACCOUNTS_CSV_FILE_PATH, csvContent); // Replaces the file; throws an InvalidFileException on failure.
+}
+
+// Reads all account data from the Accounts.csv file into the accounts vector.
+// Reads the file in one call and tokenizes it as a whole, instead of reading and splitting line by line.
+void readAllSavedAccountsToTheAccountsVector()
+{
+    ifstream csvAccountsFile(ACCOUNTS_CSV_FILE_PATH, ios::in | ios::binary); // Opens the Accounts.csv file in read mode.
     if (csvAccountsFile) // Checks if the file was opened successfully.
     {
-        for (int id = 0; id < accounts.size(); id++) // Iterates through each account in the accounts vector.
+        string fileContent = readWholeFile(csvAccountsFile); // Reads the whole file.
+        vector<CSVField> fields; // Stores the position of every field in the file.
+        vector<size_t> recordEnds; // Stores where each line's fields end.
+        tokenizeCSV(fileContent, fields, recordEnds); // Splits the file into fields and lines.
+        accounts.reserve(accounts.size() + recordEnds.size()); // Allocates the accounts vector once.
+        size_t firstField = 0; // Stores the index of the first field of the current line.
+        for (size_t recordEnd : recordEnds) // Iterates through each line of the file.
         {
-            accounts[id][0] = to_string(id + 1); // Updates the account ID based on its position.
-            string accountCSVString = convertVectorToCSVString(accounts[id]); // Converts the account vector to a CSV string.
-            csvAccountsFile << accountCSVString << endl; // Writes the CSV string to the file.
+            accounts.push_back(convertCSVFieldsToVector(fileContent, &fields[firstField], recordEnd - firstField)); // Converts the line to an account vector.
+            if (accounts.back().size() < ACCOUNT_FIELD_COUNT)
+                accounts.back().resize(ACCOUNT_FIELD_COUNT); // Adds the empty product field of a line written before products existed.
+            firstField = recordEnd; // Moves to the next line.
         }
         csvAccountsFile.close(); // Closes the file.
     }
     else
     {
-        throw InvalidFileException(); // Throws an exception if the file failed to open.
+        ofstream newCSVAccountsFile(ACCOUNTS_CSV_FILE_PATH, ios::out); // Creates the Accounts.csv file if it does not exist.
+        newCSVAccountsFile.close(); // Closes the newly created file.
     }
 }
 
-// Reads all account data from the Accounts.csv file into the accounts vector.
-void readAllSavedAccountsToTheAccountsVector()
+// Gives every account a new version, for when the accounts are loaded or renumbered and a version read before no longer names the same account.
+static void renumberAccountVersions()
 {
-    ifstream csvAccountsFile("./CSVs/Accounts.csv", ios::in); // Opens the Accounts.csv file in read mode.
-    if (csvAccountsFile) // Checks if the file was opened successfully.
+    unsigned long long version = ++lastAccountVersion; // Takes a version newer than any read before.
+    accountVersionNumbers.clear(); // Drops the versions of the old positions.
+    for (size_t accountIndex = 0; accountIndex < accounts.size(); accountIndex++)
+        accountVersionNumbers.emplace_back(version); // Sets the version of the account.
+}
+
+// Converts the account at the given position to the version published for it, with the accrual state cached for a certificate.
+static AccountVariant convertAccountToVersion(size_t accountIndex)
+{
+    AccountVariant account = convertAccountVectorToAccountVariant(accounts[accountIndex]); // Builds the account.
+    if (CertificateAccount* certificateAccountObject = get_if<CertificateAccount>(&account))
+        accrualCache.restore(accountIndex, *certificateAccountObject); // Keeps the parsed creation time and returns, if they are prepared.
+    return account;
+}
+
+// Publishes every account to the version table, on the first snapshot after a load or a renumbering.
+void prepareAccountVersions()
+{
+    if (accountVersions.isBuilt())
+        return; // Returns if the changes are already published as they are made.
+    vector<AccountVariant> publishedAccounts; // Stores the first version of every account.
+    publishedAccounts.reserve(accounts.size()); // Allocates the versions once.
+    for (size_t accountIndex = 0; accountIndex < accounts.size(); accountIndex++)
+        publishedAccounts.push_back(convertAccountToVersion(accountIndex)); // Converts the account.
+    accountVersions.publishAll(move(publishedAccounts)); // Publishes them at one epoch.
+}
+
+// Publishes new versions of the given accounts at one epoch, once the version table is built.
+static void publishAccountVersions(const vector<size_t>& accountIndexes)
+{
+    if (!accountVersions.isBuilt())
+        return; // The first snapshot publishes every account as it is then.
+    vector<pair<size_t, AccountVariant>> changes; // Stores the new versions.
+    changes.reserve(accountIndexes.size()); // Allocates the versions once.
+    for (size_t accountIndex : accountIndexes)
+        changes.emplace_back(accountIndex, convertAccountToVersion(accountIndex)); // Converts the changed account.
+    accountVersions.publishChanges(move(changes)); // Publishes them together.
+}
+
+// Queues the new record of an account the store already holds for the persistence thread.
+static void submitAccountUpdate(size_t accountIndex)
+{
+    PersistenceRecord record; // Stores the change.
+    record.type = PersistenceRecordType::UpdatedAccount; // Rewrites an account's record in place.
+    record.accountIndex = accountIndex; // Stores the position of the account.
+    discardEndOfDayCheckpoint(); // Keeps an interrupted batch from overwriting the change.
+    accrualCache.invalidate(accountIndex); // Prepares the account's accrual state again at the next sweep.
+    record.account = accounts[accountIndex]; // Copies the account, which may change again before the record is written.
+    submitChange(record); // Queues the change.
+    recordSavedChange(); // Counts the change towards the next background snapshot.
+}
+
+// Queues the new record of one account for the persistence thread.
+static void queueAccountUpdate(int accountIndex)
+{
+    if (accountIndex < 0)
+        return; // Ignores a position that holds no account.
+    if (static_cast<size_t>(accountIndex) >= storedAccountCount)
+    {
+        persistAllAccounts(); // Rebuilds everything if the store does not hold this account yet.
+        return;
+    }
+    submitAccountUpdate(accountIndex); // Queues the record.
+}
+
+// Reads the account's version.
+unsigned long long readAccountVersion(int accountIndex)
+{
+    return accountVersionNumbers[accountIndex].load(); // Reads the version without locking.
+}
+
+// Claims the account's next version with a compare-and-swap, then replaces and persists the account, one commit at a time.
+void commitAccountUpdate(int accountIndex, unsigned long long expectedVersion, vector<string> accountVector)
+{
+    lock_guard<mutex> lock(accountCommitMutex); // Keeps another commit from writing the account between this one's claim and its write.
+    if (accountIndex < 0 || static_cast<size_t>(accountIndex) >= accounts.size() || static_cast<size_t>(accountIndex) >= storedAccountCount)
+        throw AccountVersionConflictException(); // The account was removed by a renumbering, or is not persisted yet, since it was read.
+    if (!accountVersionNumbers[accountIndex].compare_exchange_strong(expectedVersion, ++lastAccountVersion))
+        throw AccountVersionConflictException(); // Another change was committed since the account was read; nothing is written.
+    accounts[accountIndex] = move(accountVector); // Replaces the account.
+    submitAccountUpdate(accountIndex); // Queues the record, without ever rebuilding the store.
+    publishAccountVersions({ static_cast<size_t>(accountIndex) }); // Publishes the version.
+}
+
+// Queues the new records of the accounts and publishes their new versions at one epoch.
+void persistAccountUpdates(const vector<size_t>& accountIndexes)
+{
+    for (size_t accountIndex : accountIndexes)
+    {
+        accountVersionNumbers[accountIndex] = ++lastAccountVersion; // Makes an update committed with an older version fail.
+        queueAccountUpdate(static_cast<int>(accountIndex)); // Queues the record.
+    }
+    publishAccountVersions(accountIndexes); // Publishes the versions together.
+}
+
+// Queues the record of the last account of the accounts vector for the persistence thread.
+void persistNewAccount()
+{
+    if (storedAccountCount + 1 != accounts.size())
     {
-        string csvAccount; // Stores each account's CSV string.
-        while (getline(csvAccountsFile, csvAccount)) // Reads each line from the file.
+        persistAllAccounts(); // Rebuilds everything if the store is not one account behind.
+        return;
+    }
+    PersistenceRecord record; // Stores the change.
+    record.type = PersistenceRecordType::NewAccount; // Adds the new account's record.
+    record.account = accounts.back(); // Copies the account.
+    discardEndOfDayCheckpoint(); // Keeps an interrupted batch from resuming over a different set of accounts.
+    accrualCache.invalidate(accounts.size() - 1); // Prepares the new account's accrual state at the next sweep.
+    submitChange(record); // Queues the change.
+    storedAccountCount++; // Counts the queued record.
+    accountVersionNumbers.emplace_back(++lastAccountVersion); // Gives the new account its first version.
+    recordSavedChange(); // Counts the change towards the next background snapshot.
+    if (accountVersions.isBuilt())
+        accountVersions.publishAppended(convertAccountToVersion(accounts.size() - 1)); // Publishes the new account.
+}
+
+// Rewrites the records of the given accounts in the account store and forces it to the disk once, after the queued changes are written.
+void persistAccountBatch(const vector<size_t>& accountIndexes)
+{
+    endOfDayCheckpointPending = false; // The running batch owns the checkpoint and removes it when it completes.
+    if (storedAccountCount != accounts.size())
+    {
+        persistAllAccounts(); // Rebuilds everything if the store does not hold every account yet.
+        return;
+    }
+    waitForPersistence(); // Keeps the persistence thread away from the store while the batch is written.
+    AccountStore& store = getAccountStore(); // Gets the store.
+    for (size_t accountIndex : accountIndexes)
+    {
+        accountVersionNumbers[accountIndex] = ++lastAccountVersion; // Makes an update committed with an older version fail.
+        store.updateRecord(accountIndex, accounts[accountIndex]); // Rewrites the account's record.
+        accrualCache.invalidate(accountIndex); // Prepares the account's accrual state again at the next sweep.
+    }
+    store.sync(); // Forces the whole batch to the disk with one sync.
+    publishAccountVersions(accountIndexes); // Publishes the changed accounts at one epoch.
+    recordSavedChange(); // Counts the batch towards the next background snapshot.
+}
+
+// Writes the Accounts.csv file and rebuilds the account store from the accounts vector, once the queued changes are written.
+void persistAllAccounts()
+{
+    waitForPersistence(); // Keeps the persistence thread away from the store while it is rebuilt.
+    discardEndOfDayCheckpoint(); // Keeps an interrupted batch from resuming over renumbered accounts.
+    writeAllSavedAccountToCSVFile(); // Renumbers the accounts and saves them to the Accounts.csv file.
+    accrualCache.clear(); // Drops the accrual states, whose positions may have moved.
+    accountVersions.clear(); // Drops the published versions, whose positions may have moved; the next snapshot publishes them again.
+    renumberAccountVersions(); // Makes the updates of accounts read before the renumbering fail.
+    getAccountStore().rebuild(accounts); // Replaces the store content with the renumbered accounts.
+    storedAccountCount = accounts.size(); // The store now holds every account.
+    recordSavedChange(); // Counts the change towards the next background snapshot.
+}
+
+// Writes the Accounts.csv file and removes the accounts' records from the account store, renumbering the others in place.
+void persistAccountRemovals(const vector<size_t>& removedIndexes)
+{
+    if (storedAccountCount != accounts.size() + removedIndexes.size())
+    {
+        persistAllAccounts(); // Rebuilds everything if the store did not hold every account.
+        return;
+    }
+    waitForPersistence(); // Keeps the persistence thread away from the store while records are removed.
+    discardEndOfDayCheckpoint(); // Keeps an interrupted batch from resuming over renumbered accounts.
+    writeAllSavedAccountToCSVFile(); // Renumbers the accounts and saves them, so a reload after a crash never sees the removed accounts.
+    accrualCache.clear(); // Drops the accrual states, whose positions moved.
+    accountVersions.clear(); // Drops the published versions, whose positions moved; the next snapshot publishes them again.
+    renumberAccountVersions(); // Makes the updates of accounts read before the renumbering fail.
+    getAccountStore().removeRecords(removedIndexes, accounts); // Removes and renumbers the records in place.
+    storedAccountCount = accounts.size(); // The store holds every remaining account.
+    recordSavedChange(); // Counts the change towards the next background snapshot.
+}
+
+// Queues the new details of a person for the person journal.
+void persistSavedPerson(const Person& person)
+{
+    PersistenceRecord record; // Stores the change.
+    record.type = PersistenceRecordType::SavedPerson; // Records the person's details.
+    record.person = person; // Copies the person.
+    submitChange(record); // Queues the change.
+    recordSavedChange(); // Counts the change towards the next background snapshot.
+    if (++journaledPersonCount >= PERSON_JOURNAL_CHECKPOINT_RECORD_COUNT)
+        writeAllSavedPersonsToTheCSVFile(); // Folds the journal into Persons.csv once it is long.
+}
+
+// Queues the removal of a person for the person journal.
+void persistDeletedPerson(long long nationalID)
+{
+    PersistenceRecord record; // Stores the change.
+    record.type = PersistenceRecordType::DeletedPerson; // Records the removal.
+    record.nationalID = nationalID; // Stores the national ID of the removed person.
+    submitChange(record); // Queues the change.
+    recordSavedChange(); // Counts the change towards the next background snapshot.
+    if (++journaledPersonCount >= PERSON_JOURNAL_CHECKPOINT_RECORD_COUNT)
+        writeAllSavedPersonsToTheCSVFile(); // Folds the journal into Persons.csv once it is long.
+}
+
+// Returns the counters of the account store, once the queued changes are written.
+StorageStatistics getAccountStoreStatistics()
+{
+    waitForPersistence(); // Keeps the persistence thread away from the store while its counters are read.
+    return getAccountStore().getStatistics();
+}
+
+// Returns true if the account store holds every account once the queued changes are written, so a lookup can be served from it.
+static bool canReadFromAccountStore()
+{
+    if (storedAccountCount != accounts.size())
+        return false; // Returns false while the store misses accounts, such as before the first load.
+    waitForPersistence(); // Lets the queued changes reach the store first.
+    return getAccountStore().getRecordCount() == accounts.size();
+}
+
+// Reads the accounts of the person from the account store, or scans the accounts vector if the store cannot serve them.
+vector<vector<string>> findAccountsOfPerson(long long nationalID)
+{
+    vector<vector<string>> personAccounts; // Stores the person's accounts.
+    if (canReadFromAccountStore())
+    {
+        vector<AccountRecord> records; // Stores the person's records.
+        try
         {
-            vector<string> accountVector = convertCSVStringToVector(csvAccount); // Converts the CSV string to a vector.
-            accounts.push_back(accountVector); // Adds the account vector to the accounts vector.
+            getAccountStore().findRecordsOfPerson(nationalID, records); // Reads them through the store.
+            personAccounts.reserve(records.size()); // Allocates the accounts once.
+            for (const AccountRecord& record : records)
+                personAccounts.push_back(convertAccountRecordToVector(record)); // Converts each record.
+            return personAccounts;
+        }
+        catch (InvalidPageException)
+        {
+            personAccounts.clear(); // Falls back to the accounts vector if a page of the store is damaged.
         }
-        csvAccountsFile.close(); // Closes the file.
     }
-    else
+    for (const vector<string>& account : accounts)
+        if (parseLongLong(account[1]) == nationalID)
+            personAccounts.push_back(account); // Adds the person's account.
+    return personAccounts;
+}
+
+// Reads the account from the account store, or from the accounts vector if the store cannot serve it, and checks its owner.
+bool readAccountOfPerson(int accountID, long long nationalID, vector<string>& account)
+{
+    if (accountID < 1 || static_cast<size_t>(accountID) > accounts.size())
+        return false; // Returns false if there is no account with this ID.
+    if (canReadFromAccountStore())
     {
-        ofstream newCSVAccountsFile("./CSVs/Accounts.csv", ios::out); // Creates the Accounts.csv file if it does not exist.
-        newCSVAccountsFile.close(); // Closes the newly created file.
+        AccountRecord record; // Stores the account's record.
+        try
+        {
+            if (getAccountStore().findRecord(nationalID, accountID, record))
+            {
+                account = convertAccountRecordToVector(record); // Converts the record.
+                return true;
+            }
+        }
+        catch (InvalidPageException)
+        {
+            // Falls back to the accounts vector below if a page of the store is damaged.
+        }
     }
+    const vector<string>& storedAccount = accounts[accountID - 1]; // Gets the working copy, for an account the store does not hold or whose record is damaged.
+    if (parseLongLong(storedAccount[1]) != nationalID)
+        return false; // Returns false if the account belongs to someone else.
+    account = storedAccount; // Copies the account.
+    return true;
+}
+
+// Loads the persons and accounts from the latest snapshot, falling back to the previous snapshot
+// and then to importing the CSV files, replays the person journal,
+// then applies the account store, which holds the balances changed since the last save.
+// Data loaded before is dropped first, and the person text arena is released in one step.
+void loadProgramData()
+{
+    waitForBackgroundSnapshot(); // Lets a background snapshot finish reading the old data.
+    waitForPersistence(); // Writes the queued changes, which may refer to the old person text.
+    persons.clear(); // Drops the persons loaded before.
+    accounts.clear(); // Drops the accounts loaded before.
+    accrualCache.clear(); // Drops the accrual states of the accounts loaded before.
+    accountVersions.clear(); // Drops the versions of the accounts loaded before; open snapshots keep theirs.
+    personTextArena.release(); // Frees the old names and phone numbers at once.
+
+    bool snapshotLoaded = false; // Stores whether a snapshot was loaded.
+    try
+    {
+        snapshotLoaded = readBankSnapshot(SNAPSHOT_FILE_PATH); // Loads the snapshot if it exists and is up to date.
+    }
+    catch (InvalidSnapshotException)
+    {
+        cout << "Warning: The snapshot file is damaged. Trying the previous snapshot." << endl; // Informs the user of the fallback.
+    }
+    if (!snapshotLoaded)
+    {
+        try
+        {
+            snapshotLoaded = readBankSnapshot(getPreviousSnapshotPath(SNAPSHOT_FILE_PATH)); // Loads the previous snapshot if it is still up to date.
+        }
+        catch (InvalidSnapshotException)
+        {
+            cout << "Warning: The previous snapshot file is damaged. Loading the data from the CSV files instead." << endl; // Informs the user of the fallback.
+        }
+    }
+    if (!snapshotLoaded)
+    {
+        readAllSavedPersonsToThePersonsVector(); // Imports all persons from the Persons.csv file.
+        readAllSavedAccountsToTheAccountsVector(); // Imports all accounts from the Accounts.csv file.
+    }
+
+    chrono::steady_clock::time_point replayStart = chrono::steady_clock::now(); // Starts timing the replay.
+    size_t replayedCount = getPersonJournal().applyTo(persons); // Replays the person changes made since Persons.csv was last written.
+    if (replayedCount > 0)
+    {
+        double replaySeconds = chrono::duration<double>(chrono::steady_clock::now() - replayStart).count(); // Measures the replay.
+        cout << "Recovered " << replayedCount << " person changes from the journal in " << replaySeconds * 1000.0 << " ms ("
+             << static_cast<long long>(replayedCount / max(replaySeconds, 1e-9)) << " records per second)." << endl; // Reports the recovery speed.
+    }
+
+    AccountStore& store = getAccountStore(); // Opens the account store, creating it if it does not exist.
+    long long appliedCount; // Stores the number of records applied, or -1 if the store must be rebuilt.
+    try
+    {
+        appliedCount = store.applyTo(accounts); // Applies the latest balances if the store matches the loaded accounts.
+    }
+    catch (InvalidPageException)
+    {
+        cout << "Warning: The account store is damaged. Rebuilding it from the loaded accounts." << endl; // Informs the user of the rebuild.
+        appliedCount = -1; // Rebuilds the store below.
+    }
+    if (appliedCount < 0)
+        store.rebuild(accounts); // Rebuilds the store from the loaded accounts otherwise.
+    storedAccountCount = store.getRecordCount(); // Stores the number of records, tracked from now on as changes are queued.
+    journaledPersonCount = replayedCount; // Counts the journal records left from before the crash.
+    endOfDayCheckpointPending = filesystem::exists(END_OF_DAY_CHECKPOINT_FILE_PATH); // Keeps an interrupted end-of-day batch resumable until an account changes.
+    renumberAccountVersions(); // Gives the loaded accounts versions newer than any read before the reload.
+}
+
+// Advances the cached returns of the certificates if an accrual boundary has passed or an account changed.
+void advanceAccruals()
+{
+    accrualCache.sweep(accounts, getOperationTime()); // Returns at once if nothing is due.
+}
+
+// Stops the persistence thread once the queued changes are written, exports the persons and accounts to the CSV files,
+// then writes the snapshot once any background snapshot has finished.
+void saveProgramData()
+{
+    waitForPersistence(); // Writes the queued changes.
+    persistenceWorker.reset(); // Stops the persistence thread.
+    writeAllSavedAccountToCSVFile(); // Saves all accounts to the Accounts.csv file.
+    writeAllSavedPersonsToTheCSVFile(); // Saves all persons to the Persons.csv file.
+    writeBankSnapshot(SNAPSHOT_FILE_PATH); // Writes the snapshot after the CSV files, so it is the newest file.
 }
 
 // Clears the input buffer to ensure it is valid and ready for the next input.
@@ -169,7 +652,7 @@ void startMenu()
 {
     displayOptionsList(); // Displays the list of program options.
     int choice; // Stores the user's menu choice.
-    cout << "Please enter your choice (1-9): "; // Prompts the user to select a menu option.
+    cout << "Please enter your choice (1-12): "; // Prompts the user to select a menu option.
     clearInputBufferFunc(); // Ensures the input buffer is valid and empty for the next input.
     cin >> choice; // Reads the user's choice.
     if (cin.fail())
@@ -178,7 +661,7 @@ void startMenu()
         clearInputBufferFunc(); // Ensures the input buffer is valid and empty for the next input.
         exit(1);
     }
-    while (choice < 1 || choice > 9) // Validates that the choice is between 1 and 9.
+    while (choice < 1 || choice > 12) // Validates that the choice is between 1 and 12.
     {
         if (cin.fail())
         {
@@ -186,12 +669,15 @@ void startMenu()
             clearInputBufferFunc(); // Ensures the input buffer is valid and empty for the next input.
             exit(1);
         }
-        cout << "Error: Invalid choice. Please select a number between 1 and 9." << endl; // Prompts for a valid choice.
-        cout << "Please enter your choice (1-9): ";
+        cout << "Error: Invalid choice. Please select a number between 1 and 12." << endl; // Prompts for a valid choice.
+        cout << "Please enter your choice (1-12): ";
         clearInputBufferFunc(); // Ensures the input buffer is valid and empty for the next input.
         cin >> choice; // Reads the re-entered choice.
     }
 
+    captureOperationTime(); // Reads the clock once; the whole operation is evaluated as of this instant.
+    advanceAccruals(); // Brings the cached certificate returns up to date before the operation reads them.
+
     switch (choice) // Executes the appropriate function based on the user's choice.
     {
     case 1:
@@ -285,5 +771,20 @@ void startMenu()
         deleteAccount(); // Deletes a specific account.
         break;
     }
+    case 10:
+    {
+        displayBankReport(); // Displays the bank-wide totals and age distribution.
+        break;
+    }
+    case 11:
+    {
+        displayEndOfDayBatch(); // Runs the end-of-day batch jobs over every account.
+        break;
+    }
+    case 12:
+    {
+        displayTransactionFile(); // Applies the deposits, withdrawals and transfers of a transaction file.
+        break;
+    }
     }
-}
\ No newline at end of file
+}
\ No newline at end of file
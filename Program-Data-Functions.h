@@ -10,16 +10,29 @@
 #include <algorithm>
 #include "Conversion-Functions.h"
 #include "Person.h"
+#include "StringArena.h"
+#include "AccountStore.h"
+#include "AccrualCache.h"
+#include "AccountVersionTable.h"
 using namespace std;
 
 /*
 	Global vector that holds all Person objects in the program.
+	- Kept sorted by national ID at all times, so lookups can binary search it without modifying it
 	- Loaded from a CSV file at the start of the program
 	- Written back to the CSV file at the end
 	- Declared as 'extern' so it is defined only once and shared across all files
 */
 extern vector<Person> persons;
 
+/*
+	Global arena that holds the names and phone numbers of every Person object.
+	- Person objects only hold views of their text, so copying one never allocates
+	- Filled in one allocation when the persons are loaded
+	- Released in one step when the program data is reloaded
+*/
+extern StringArena personTextArena;
+
 /*
 	Global vector that holds all account data as vectors of strings.
 	- Loaded from a CSV file at the start of the program
@@ -29,8 +42,31 @@ extern vector<Person> persons;
 extern vector<vector<string>> accounts;
 
 /*
-	Writes all Person objects in the 'persons' vector to the CSV file.
-	This function is typically called at the end of the program to save changes.
+	Global cache of the accrual state of every certificate in the 'accounts' vector, indexed by position.
+	- Dropped for an account whenever it is persisted as added or changed, and entirely when the accounts are renumbered or reloaded
+	- Advanced in bulk by advanceAccruals before each menu operation, once an accrual boundary has passed
+	- Read by the account tables, the withdrawal path and the bank-wide report
+*/
+extern AccrualCache accrualCache;
+
+/*
+	Global table of the published versions of every account in the 'accounts' vector, read by the bank-wide report and the account tables.
+	- Built by prepareAccountVersions before the first snapshot is taken, then given new versions whenever accounts are persisted
+	- Readers take an AccountVersionTable::Snapshot and see the accounts as of one epoch, without locking out the writers
+	- Dropped when the program data is reloaded
+*/
+extern AccountVersionTable accountVersions;
+
+/*
+	Publishes every account of the 'accounts' vector to the account version table if it is not built yet.
+	Called on the thread that changes the 'accounts' vector, before a snapshot is taken.
+*/
+void prepareAccountVersions();
+
+/*
+	Writes all Person objects in the 'persons' vector to the CSV file, replacing it in one step,
+	then empties the person journal whose changes the file now holds.
+	Called at the end of the program and whenever the journal grows past PERSON_JOURNAL_CHECKPOINT_RECORD_COUNT records.
 */
 void writeAllSavedPersonsToTheCSVFile();
 
@@ -47,16 +83,126 @@ void readAllSavedAccountsToTheAccountsVector();
 void readAllSavedPersonsToThePersonsVector();
 
 /*
-	Writes all account records from the 'accounts' vector into a CSV file.
+	Writes all account records from the 'accounts' vector into a CSV file, replacing it in one step.
 	Used to persist changes made during the program execution.
 */
 void writeAllSavedAccountToCSVFile();
 
+/*
+	Returns the version of the account at the given index of the 'accounts' vector.
+	Every change committed or persisted to an account gives it a new version, and versions are never reused,
+	even after the accounts are renumbered or reloaded.
+*/
+unsigned long long readAccountVersion(int);
+
+/*
+	Replaces the account at the given index of the 'accounts' vector with the given account vector, if the account
+	still has the given version, read by readAccountVersion before the change was prepared.
+	The version is claimed with a compare-and-swap, then the account is replaced, and only its record is queued for the
+	persistence thread, which rewrites it in the account store selected by ACCOUNT_STORE_BACKEND, and its new version
+	is published to the account version table. Commits from several threads are serialized, claim and write together,
+	so the account written is always the one whose version was claimed; the other persist functions are called
+	from the menu thread only, and never while a commit can run.
+	Throws an AccountVersionConflictException, leaving the account unchanged, if another change was committed
+	since the version was read, or the account was removed or is not in the store yet; the update can be retried from a new read.
+*/
+void commitAccountUpdate(int, unsigned long long, vector<string>);
+
+/*
+	Persists the changes made to the accounts at the given indexes of the 'accounts' vector together,
+	such as the accounts changed by a transaction file: the account version table publishes them at one epoch,
+	so a snapshot sees either every change or none. Each record is queued for the persistence thread as by commitAccountUpdate,
+	or the store is rebuilt if it does not hold the account yet.
+*/
+void persistAccountUpdates(const vector<size_t>&);
+
+/*
+	Persists the account just added at the end of the 'accounts' vector.
+	Queues only its record for the account store, since the IDs of the other accounts do not change.
+*/
+void persistNewAccount();
+
+/*
+	Persists the changes made to the accounts at the given indexes of the 'accounts' vector in one call,
+	such as the certificates renewed by the end-of-day batch.
+	Waits for the queued changes, rewrites the records in the account store and forces it to the disk once.
+*/
+void persistAccountBatch(const vector<size_t>&);
+
+/*
+	Persists the whole 'accounts' vector, such as after accounts are reordered.
+	Waits for the queued changes, renumbers the account IDs, writes the Accounts.csv file, and rebuilds the account store.
+*/
+void persistAllAccounts();
+
+/*
+	Persists the removal of the accounts that were at the given positions, sorted in increasing order,
+	once they are removed from the 'accounts' vector.
+	Waits for the queued changes, renumbers the account IDs and writes the Accounts.csv file,
+	then removes the records from the account store and renumbers the ones after them in place instead of rebuilding it.
+*/
+void persistAccountRemovals(const vector<size_t>&);
+
+/*
+	Persists a person who was added or whose details changed.
+	Queues one record for the person journal instead of rewriting the Persons.csv file.
+*/
+void persistSavedPerson(const Person&);
+
+/*
+	Persists the removal of the person with the given national ID.
+	Queues one record for the person journal instead of rewriting the Persons.csv file.
+*/
+void persistDeletedPerson(long long);
+
+/*
+	Runs the scheduled accrual sweep: if an accrual boundary has passed or an account changed since the last sweep,
+	advances the cached returns of the certificates concerned as of the time of the current operation.
+	Called before each menu operation.
+*/
+void advanceAccruals();
+
+/*
+	Returns the counters of the account store, such as the buffer pool hit and eviction counts.
+	Displayed by the bank-wide report.
+*/
+StorageStatistics getAccountStoreStatistics();
+
+/*
+	Returns the accounts owned by the person with the given national ID, in account ID order.
+	Reads them from the account store once the queued changes are written: the paged B+tree keeps a person's accounts
+	next to each other, so only one root-to-leaf path of pages goes through its buffer pool instead of a scan of every account.
+	Scans the 'accounts' vector instead while the store does not hold every account or a page of it is damaged.
+*/
+vector<vector<string>> findAccountsOfPerson(long long);
+
+/*
+	Reads the account with the given ID into the given vector if it is owned by the person with the given national ID.
+	Reads its record from the account store like findAccountsOfPerson, falling back to the 'accounts' vector.
+	Returns false if there is no such account or it belongs to someone else.
+*/
+bool readAccountOfPerson(int, long long, vector<string>&);
+
+/*
+	Loads the 'persons' and 'accounts' vectors at the start of the program.
+	Uses the binary snapshot when it is valid and taken against the current CSV files, then the previous snapshot,
+	otherwise imports the CSV files. Then replays the person journal, reporting its speed in records per second,
+	and applies the newer accounts and balances kept in the account store.
+	Can be called again to reload: the data loaded before is dropped and its person text freed at once.
+*/
+void loadProgramData();
+
+/*
+	Saves the 'persons' and 'accounts' vectors at the end of the program.
+	Exports both CSV files, then writes the binary snapshot used by the next start.
+*/
+void saveProgramData();
+
 /*
 	Checks whether a given Person object is uninitialized or contains default data.
 	Used in search logic to determine if a search result is valid.
 */
-bool isDefaultPerson(Person&);
+bool isDefaultPerson(const Person&);
 
 /*
 	Performs a binary search on the 'persons' vector using the national ID.
@@ -88,4 +234,4 @@ void startMenu();
 */
 void clearInputBufferFunc();
 
-#endif
\ No newline at end of file
+#endif
\ No newline at end of file
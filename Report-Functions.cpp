@@ -0,0 +1,172 @@
+#include <chrono>
+#include <vector>
+#include <string>
+#include <iostream>
+#include "Report-Functions.h"
+#include "WorkStealingPool.h"
+#include "Program-Data-Functions.h"
+#include "Conversion-Functions.h"
+#include "Numeric-Functions.h"
+#include "Display-Functions.h"
+#include "AccountVariant.h"
+#include "Clock.h"
+using namespace std;
+
+/*
+	Holds the partial totals accumulated by a single worker thread.
+	Aligned to a cache line so that workers never write to the same line.
+*/
+struct alignas(64) ReportPartial
+{
+	BankReport totals;
+};
+
+// Returns the index of the age band that contains the given age.
+static int getAgeBandIndex(int);
+
+// Adds the totals of the snapshot's accounts in [first, last), evaluated as of the given time, to the given partial result.
+static void accumulateAccounts(const AccountVersionTable::Snapshot&, size_t, size_t, time_t, BankReport&);
+
+// Adds the age distribution of the persons in [first, last) to the given partial result.
+static void accumulatePersons(size_t, size_t, BankReport&);
+
+// Builds the bank-wide report on a work-stealing pool from one snapshot of the accounts, and merges the per-thread results.
+BankReport generateBankReport(time_t asOf, int threadCount)
+{
+    auto startTime = chrono::steady_clock::now(); // Records when the report started.
+    prepareAccountVersions(); // Publishes the accounts if no snapshot was taken since they were loaded or renumbered.
+    AccountVersionTable::Snapshot snapshot(accountVersions); // Pins the accounts as they are now, for every partition.
+    WorkStealingPool pool(threadCount); // Starts the worker threads.
+    vector<ReportPartial> partials(pool.getThreadCount()); // Stores one partial result per worker.
+
+    // Submits one task per partition of the snapshot's accounts.
+    for (size_t first = 0; first < snapshot.size(); first += REPORT_PARTITION_SIZE)
+    {
+        size_t last = min(snapshot.size(), first + REPORT_PARTITION_SIZE); // Stores the end of the partition.
+        pool.submit([&snapshot, first, last, asOf, &partials](int workerIndex) { accumulateAccounts(snapshot, first, last, asOf, partials[workerIndex].totals); });
+    }
+
+    // Submits one task per partition of the persons vector.
+    for (size_t first = 0; first < persons.size(); first += REPORT_PARTITION_SIZE)
+    {
+        size_t last = min(persons.size(), first + REPORT_PARTITION_SIZE); // Stores the end of the partition.
+        pool.submit([first, last, &partials](int workerIndex) { accumulatePersons(first, last, partials[workerIndex].totals); });
+    }
+
+    pool.waitAll(); // Waits for every partition to be processed.
+
+    // Merges the per-thread partial results into the final report.
+    BankReport report; // Stores the merged report.
+    for (ReportPartial& partial : partials)
+    {
+        report.personCount += partial.totals.personCount;
+        report.savingAccountCount += partial.totals.savingAccountCount;
+        report.certificateAccountCount += partial.totals.certificateAccountCount;
+        report.totalDeposits += partial.totals.totalDeposits;
+        report.totalCertificatePrincipal += partial.totals.totalCertificatePrincipal;
+        report.outstandingInterestLiability += partial.totals.outstandingInterestLiability;
+        for (int band = 0; band < AGE_BAND_COUNT; band++)
+            report.ageBandCounts[band] += partial.totals.ageBandCounts[band];
+    }
+    report.asOf = asOf; // Records the instant the report describes.
+    report.snapshotEpoch = snapshot.getEpoch(); // Records the epoch of the accounts it read.
+    report.threadCount = pool.getThreadCount(); // Records how many threads were used.
+    report.elapsedMilliseconds = chrono::duration<double, milli>(chrono::steady_clock::now() - startTime).count(); // Records the elapsed time.
+    return report; // Returns the merged report.
+}
+
+// Adds the totals of the snapshot's accounts in [first, last), evaluated as of the given time, to the given partial result.
+void accumulateAccounts(const AccountVersionTable::Snapshot& snapshot, size_t first, size_t last, time_t asOf, BankReport& partial)
+{
+    AccountVisitor accumulate{
+        [&partial](const SavingAccount& savingAccountObject)
+        {
+            partial.savingAccountCount++; // Counts the saving account.
+            partial.totalDeposits += savingAccountObject.getBalance(); // Adds the balance to the total deposits.
+        },
+        [&partial, asOf](const CertificateAccount& certificateAccountObject)
+        {
+            partial.certificateAccountCount++; // Counts the certificate account.
+            partial.totalCertificatePrincipal += certificateAccountObject.getBalance(); // Adds the base balance to the principal.
+            partial.outstandingInterestLiability += certificateAccountObject.getSavingBalanceAsOf(asOf); // Adds the returns not withdrawn yet.
+        } }; // Handles each account type; a type without a case does not compile.
+    for (size_t i = first; i < last; i++)
+    {
+        AccountVariant account = snapshot.getAccount(i); // Copies the account as of the snapshot; a certificate carries the returns prepared when it was published.
+        visit(accumulate, account); // Dispatches on the account type without a virtual call.
+    }
+}
+
+// Adds the age distribution of the persons in [first, last) to the given partial result.
+void accumulatePersons(size_t first, size_t last, BankReport& partial)
+{
+    for (size_t i = first; i < last; i++)
+    {
+        partial.personCount++; // Counts the person.
+        partial.ageBandCounts[getAgeBandIndex(persons[i].getAge())]++; // Counts the person in their age band.
+    }
+}
+
+// Returns the index of the last band whose lower bound does not exceed the given age.
+int getAgeBandIndex(int age)
+{
+    int band = 0; // Stores the band index, starting at the first band.
+    while (band + 1 < AGE_BAND_COUNT && age >= AGE_BAND_LOWER_BOUNDS[band + 1])
+        band++; // Moves to the next band while the age reaches its lower bound.
+    return band; // Returns the band index.
+}
+
+// Builds the bank-wide report and displays its totals and age distribution in two tables.
+void displayBankReport()
+{
+    BankReport report = generateBankReport(getOperationTime()); // Builds the report as of the time of the operation, using all hardware threads.
+
+    vector<vector<string>> totalsTable = { {"Total", "Value"},
+        {"Persons", formatInteger(report.personCount)},
+        {"Saving Accounts", formatInteger(report.savingAccountCount)},
+        {"Certificate Accounts", formatInteger(report.certificateAccountCount)},
+        {"Total Deposits", formatDouble(report.totalDeposits)},
+        {"Total Certificate Principal", formatDouble(report.totalCertificatePrincipal)},
+        {"Outstanding Interest Liability", formatDouble(report.outstandingInterestLiability)} }; // Creates the totals table.
+
+    vector<vector<string>> ageTable = { {"Age Band", "Persons"} }; // Initializes the age distribution table with headers.
+    for (int band = 0; band < AGE_BAND_COUNT; band++)
+    {
+        int upperBound = (band + 1 < AGE_BAND_COUNT) ? AGE_BAND_LOWER_BOUNDS[band + 1] - 1 : MAX_AGE; // Calculates the last age in the band.
+        ageTable.push_back({ formatInteger(AGE_BAND_LOWER_BOUNDS[band]) + "-" + formatInteger(upperBound), formatInteger(report.ageBandCounts[band]) }); // Adds the band row.
+    }
+
+    cout << "Bank Totals:" << endl; // Displays a header for the totals.
+    printTable(totalsTable); // Prints the totals table.
+    cout << "Age Distribution:" << endl; // Displays a header for the age distribution.
+    printTable(ageTable); // Prints the age distribution table.
+    cout << "Report computed in " << report.elapsedMilliseconds << " ms using " << report.threadCount << " threads, from the accounts as of epoch "
+        << report.snapshotEpoch << "." << endl; // Displays the timing and the snapshot read.
+    cout << "Account versions: " << accountVersions.getRetiredVersionCount() << " kept for open snapshots, "
+        << accountVersions.getReclaimedVersionCount() << " reclaimed." << endl; // Displays the version counters.
+
+    StorageStatistics storage = getAccountStoreStatistics(); // Gets the counters of the account store.
+    cout << "Account store: " << storage.backendName << endl; // Displays which store is used.
+    long long pageRequests = storage.pageHits + storage.pageMisses; // Counts the page requests.
+    if (pageRequests > 0)
+    {
+        vector<vector<string>> storageTable = { {"Buffer Pool", "Value"},
+            {"Hit Rate (%)", formatDouble(100.0 * storage.pageHits / pageRequests)},
+            {"Page Hits", formatInteger(storage.pageHits)},
+            {"Page Misses", formatInteger(storage.pageMisses)},
+            {"Page Evictions", formatInteger(storage.pageEvictions)},
+            {"Page Writes", formatInteger(storage.pageWrites)},
+            {"Resident Pages", formatInteger(storage.residentPages)} }; // Creates the buffer pool table.
+        printTable(storageTable); // Prints the buffer pool table.
+    }
+    if (storage.sortedRuns + storage.memtableRecords > 0)
+    {
+        vector<vector<string>> lsmTable = { {"LSM Tree", "Value"},
+            {"Sorted Runs", formatInteger(storage.sortedRuns)},
+            {"Memtable Records", formatInteger(storage.memtableRecords)},
+            {"Compactions", formatInteger(storage.compactions)},
+            {"Point Reads", formatInteger(storage.pointReads)},
+            {"Bloom Filter Skips", formatInteger(storage.bloomFilterSkips)} }; // Creates the LSM tree table.
+        printTable(lsmTable); // Prints the LSM tree table.
+    }
+}
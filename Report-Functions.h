@@ -0,0 +1,51 @@
+// This file contains the declarations of the bank-wide reporting functions.
+// The report aggregates the persons vector and a snapshot of the account version table in parallel
+// using a work-stealing thread pool, so the accounts can change while it runs.
+
+// These are the include guards
+#pragma once
+#ifndef REPORTFUNCTIONS_H
+#define REPORTFUNCTIONS_H
+
+#include <ctime>
+#include "Constants.h"
+
+/*
+	Holds the bank-wide totals produced by generateBankReport.
+	- totalDeposits: sum of the balances of all saving accounts
+	- totalCertificatePrincipal: sum of the base balances of all certificate accounts
+	- outstandingInterestLiability: sum of the saving balances (earned but not withdrawn returns) of all certificate accounts
+	- ageBandCounts: number of persons in each band of AGE_BAND_LOWER_BOUNDS
+*/
+struct BankReport
+{
+	long long personCount = 0;
+	long long savingAccountCount = 0;
+	long long certificateAccountCount = 0;
+	double totalDeposits = 0;
+	double totalCertificatePrincipal = 0;
+	double outstandingInterestLiability = 0;
+	long long ageBandCounts[AGE_BAND_COUNT] = {};
+	time_t asOf = 0;                  // Instant the saving balances were evaluated as of
+	unsigned long long snapshotEpoch = 0; // Epoch of the account versions the report read
+	int threadCount = 0;              // Number of worker threads used to build the report
+	double elapsedMilliseconds = 0;   // Wall-clock time taken to build the report
+};
+
+/*
+	Builds the bank-wide report as of the given time.
+	Reads the accounts from one snapshot of the account version table, so every partition sees the same accounts
+	and no change waits for the report. Splits the persons vector and the snapshot into partitions of REPORT_PARTITION_SIZE records,
+	runs them on a work-stealing pool with the given number of threads (0 means one per hardware thread),
+	and merges the per-thread partial results once all partitions are done.
+	Every partition evaluates the certificates as of the same instant, so the same time gives the same report.
+*/
+BankReport generateBankReport(time_t, int = 0);
+
+/*
+	Builds the bank-wide report as of the time of the current operation and displays it in a tabular format.
+	Used by the main menu.
+*/
+void displayBankReport();
+
+#endif
@@ -12,7 +12,6 @@ SavingAccount::SavingAccount(const Person& personArgument, double balanceArgumen
 
 // Withdraws the specified amount from the saving account with validation.
 // Ensures the amount is non-negative and the remaining balance meets the minimum requirement.
-// Overrides the pure virtual withdraw function from the BankAccount base class.
 void SavingAccount::withdraw(double amount)
 {
     double accountBalance = getBalance(); // Retrieves the current account balance.
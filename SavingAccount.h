@@ -28,12 +28,12 @@ public:
 	SavingAccount(const Person&, double);
 
 	/*
-		Overrides the pure virtual withdraw function from BankAccount.
+		Withdraws from the balance; called directly or through AccountVariant, never virtually.
 		Performs validation on the withdrawal amount and ensures that:
 		- the amount is not negative
 		- the balance remains above the minimum allowed after withdrawal
 	*/
-	void withdraw(double) override;
+	void withdraw(double);
 
 	/*
 		Deposits a specified amount into the account.
@@ -47,7 +47,7 @@ public:
 		- setTimeDate
 		This is used when converting a vector of account data into a SavingAccount object.
 	*/
-	friend SavingAccount convertAccountVectorToSavingAccountObject(vector<string>&);
+	friend SavingAccount convertAccountVectorToSavingAccountObject(const vector<string>&);
 };
 
 #endif
@@ -0,0 +1,377 @@
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <fstream>
+#include <algorithm>
+#include <filesystem>
+#include <memory>
+#include <chrono>
+#include <future>
+#include <functional>
+#include "Snapshot-Functions.h"
+#include "Checksum-Functions.h"
+#include "File-Functions.h"
+#include "BatchFileWriter.h"
+#include "AccountVariant.h"
+#include "Numeric-Functions.h"
+#include "Conversion-Functions.h"
+#include "Program-Data-Functions.h"
+#include "AccountVersionTable.h"
+#include "Exceptions.h"
+#include "Constants.h"
+using namespace std;
+
+// Identifies a snapshot file.
+static const char SNAPSHOT_MAGIC[8] = { 'B', 'A', 'N', 'K', 'S', 'N', 'A', 'P' };
+
+// The format version written by this program; files with any other version are rejected.
+// Version 2 replaced the modification time comparison with the CSV stamp stored in the header.
+static const uint32_t SNAPSHOT_VERSION = 2;
+
+// The values stored in the accountType field of an account record.
+static const uint8_t SNAPSHOT_SAVING_ACCOUNT = 0;
+static const uint8_t SNAPSHOT_CERTIFICATE_ACCOUNT = 1;
+
+// Holds the fixed-size header at the start of the snapshot file.
+struct SnapshotHeader
+{
+    char magic[8];             // Always SNAPSHOT_MAGIC
+    uint32_t version;          // Format version of the file
+    uint32_t blockSize;        // Number of payload bytes covered by each checksum
+    uint64_t personCount;      // Number of person records
+    uint64_t accountCount;     // Number of account records
+    uint64_t stringHeapSize;   // Number of bytes in the string heap
+    uint64_t blockCount;       // Number of entries in the checksum table
+    uint64_t csvStamp;         // Stamp of the CSV files the snapshot was taken against
+    uint8_t reserved[4];       // Unused, always zero
+    uint32_t headerChecksum;   // CRC32C of all the header bytes before this field
+};
+
+// Holds one person; the name and phone number are stored in the string heap.
+struct SnapshotPersonRecord
+{
+    int64_t nationalID;
+    uint64_t nameOffset;       // Offset of the name in the string heap
+    uint64_t phoneOffset;      // Offset of the phone number in the string heap
+    uint32_t nameLength;
+    uint32_t phoneLength;
+    int32_t age;
+    uint32_t reserved;         // Unused, always zero
+};
+
+// Holds one account; certificate fields are zero for saving accounts.
+struct SnapshotAccountRecord
+{
+    int64_t nationalID;
+    double balance;
+    double interestRatePercent;
+    double withdrawnAmount;
+    int32_t accountID;
+    int16_t creationDateTime[6]; // Year since 1900, month from 0, day, hour, minute, second
+    uint8_t accountType;         // SNAPSHOT_SAVING_ACCOUNT or SNAPSHOT_CERTIFICATE_ACCOUNT
+    uint8_t productID;           // CertificateProductID of a certificate; zero (Classic) in snapshots written before products existed
+    uint8_t reserved[6];         // Unused, always zero
+};
+
+// The record sizes are part of the file format, so they must not change with the compiler.
+static_assert(sizeof(SnapshotHeader) == 64, "The snapshot header must be 64 bytes");
+static_assert(sizeof(SnapshotPersonRecord) == 40, "The snapshot person record must be 40 bytes");
+static_assert(sizeof(SnapshotAccountRecord) == 56, "The snapshot account record must be 56 bytes");
+
+// Returns the path the snapshot is moved to when a newer snapshot replaces it.
+string getPreviousSnapshotPath(const string& snapshotPath)
+{
+    return snapshotPath + ".prev";
+}
+
+// Holds the result of the snapshot being written by a background thread, if any.
+static future<bool> backgroundSnapshot;
+
+// Stores whether the last background snapshot was written successfully.
+static bool lastBackgroundSnapshotSucceeded = true;
+
+// Combines the modification time and size of both CSV files into one number that changes whenever either file is written.
+static uint64_t computeCSVStamp()
+{
+    uint64_t stamp = 0; // Stores the combined stamp.
+    for (const char* csvPath : { PERSONS_CSV_FILE_PATH, ACCOUNTS_CSV_FILE_PATH })
+    {
+        error_code fileError; // Stores the result of each file system query.
+        uint64_t modificationTime = static_cast<uint64_t>(filesystem::last_write_time(csvPath, fileError).time_since_epoch().count()); // Reads the modification time.
+        if (fileError)
+            modificationTime = 0; // Uses zero for a missing file.
+        uint64_t fileSize = filesystem::file_size(csvPath, fileError); // Reads the file size.
+        if (fileError)
+            fileSize = 0; // Uses zero for a missing file.
+        stamp = (stamp ^ modificationTime) * 0x9E3779B97F4A7C15ULL; // Mixes in the modification time.
+        stamp = (stamp ^ fileSize) * 0x9E3779B97F4A7C15ULL; // Mixes in the size.
+    }
+    return stamp;
+}
+
+// Fills the record of an account from its account vector.
+static void fillSnapshotAccountRecord(SnapshotAccountRecord& record, const vector<string>& account)
+{
+    record.accountID = parseInt(account[0]); // Stores the account ID.
+    record.nationalID = parseLongLong(account[1]); // Stores the owner's national ID.
+    record.balance = parseDouble(account[2]); // Stores the balance.
+    vector<string> dateTimeVector = convertDateTimeStringToDateTimeVector(account[3]); // Splits the creation date-time.
+    for (int part = 0; part < 6; part++)
+        record.creationDateTime[part] = static_cast<int16_t>(parseInt(dateTimeVector[part])); // Stores each date-time component.
+    if (isSavingAccountVector(account)) // Determines if the account is a Saving Account.
+    {
+        record.accountType = SNAPSHOT_SAVING_ACCOUNT; // Marks the record as a saving account.
+    }
+    else
+    {
+        record.accountType = SNAPSHOT_CERTIFICATE_ACCOUNT; // Marks the record as a certificate account.
+        record.interestRatePercent = parseDouble(account[4]); // Stores the interest rate.
+        record.withdrawnAmount = parseDouble(account[5]); // Stores the withdrawn amount.
+        record.productID = static_cast<uint8_t>(parseCertificateProductID(account[6])); // Stores the product.
+    }
+}
+
+// Writes the given persons and the given number of accounts, each filled by the given function from its position,
+// to a temporary file, forces it to the disk, then renames it over the snapshot, keeping the snapshot it replaces as the previous snapshot.
+static void writeSnapshotFile(const string& snapshotPath, const vector<Person>& snapshotPersons, size_t accountCount,
+    const function<void(size_t, SnapshotAccountRecord&)>& fillAccountRecord, uint64_t csvStamp)
+{
+    // Builds the person records and the string heap.
+    string stringHeap; // Stores all names and phone numbers back to back.
+    vector<SnapshotPersonRecord> personRecords(snapshotPersons.size()); // Stores the fixed-width person records.
+    for (size_t i = 0; i < snapshotPersons.size(); i++)
+    {
+        SnapshotPersonRecord& record = personRecords[i]; // Gets the record to fill (zero-initialized).
+        record.nationalID = snapshotPersons[i].getNationalID(); // Stores the national ID.
+        record.age = snapshotPersons[i].getAge(); // Stores the age.
+        record.nameOffset = stringHeap.size(); // Stores where the name starts in the heap.
+        record.nameLength = static_cast<uint32_t>(snapshotPersons[i].getName().size()); // Stores the name length.
+        stringHeap.append(snapshotPersons[i].getName()); // Adds the name to the heap.
+        record.phoneOffset = stringHeap.size(); // Stores where the phone number starts in the heap.
+        record.phoneLength = static_cast<uint32_t>(snapshotPersons[i].getPhoneNumber().size()); // Stores the phone number length.
+        stringHeap.append(snapshotPersons[i].getPhoneNumber()); // Adds the phone number to the heap.
+    }
+
+    // Builds the account records.
+    vector<SnapshotAccountRecord> accountRecords(accountCount); // Stores the fixed-width account records (zero-initialized).
+    for (size_t i = 0; i < accountCount; i++)
+        fillAccountRecord(i, accountRecords[i]); // Fills the record of each account.
+
+    // Lays out the payload as person records, account records, then the string heap.
+    size_t personBytes = personRecords.size() * sizeof(SnapshotPersonRecord); // Stores the size of the person section.
+    size_t accountBytes = accountRecords.size() * sizeof(SnapshotAccountRecord); // Stores the size of the account section.
+    vector<char> payload(personBytes + accountBytes + stringHeap.size()); // Allocates the whole payload once.
+    if (personBytes > 0)
+        memcpy(payload.data(), personRecords.data(), personBytes); // Copies the person records.
+    if (accountBytes > 0)
+        memcpy(payload.data() + personBytes, accountRecords.data(), accountBytes); // Copies the account records.
+    if (!stringHeap.empty())
+        memcpy(payload.data() + personBytes + accountBytes, stringHeap.data(), stringHeap.size()); // Copies the string heap.
+
+    // Checksums the payload one block at a time.
+    size_t blockCount = (payload.size() + SNAPSHOT_BLOCK_SIZE - 1) / SNAPSHOT_BLOCK_SIZE; // Calculates the number of blocks.
+    vector<uint32_t> blockChecksums(blockCount); // Stores one checksum per block.
+    for (size_t block = 0; block < blockCount; block++)
+    {
+        size_t blockStart = block * SNAPSHOT_BLOCK_SIZE; // Calculates where the block starts.
+        size_t blockLength = min(static_cast<size_t>(SNAPSHOT_BLOCK_SIZE), payload.size() - blockStart); // The last block may be shorter.
+        blockChecksums[block] = computeCRC32C(payload.data() + blockStart, blockLength); // Checksums the block.
+    }
+
+    // Fills the header and checksums it.
+    SnapshotHeader header = {}; // Stores the header (zero-initialized).
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)); // Stores the magic bytes.
+    header.version = SNAPSHOT_VERSION; // Stores the format version.
+    header.blockSize = SNAPSHOT_BLOCK_SIZE; // Stores the block size.
+    header.personCount = personRecords.size(); // Stores the number of persons.
+    header.accountCount = accountRecords.size(); // Stores the number of accounts.
+    header.stringHeapSize = stringHeap.size(); // Stores the size of the string heap.
+    header.blockCount = blockCount; // Stores the number of checksums.
+    header.csvStamp = csvStamp; // Stores the stamp of the CSV files the data matches.
+    header.headerChecksum = computeCRC32C(&header, offsetof(SnapshotHeader, headerChecksum)); // Checksums the header.
+
+    // Writes the snapshot to a temporary file so that the previous snapshot stays intact until the new one is complete.
+    string temporaryPath = snapshotPath + ".tmp"; // Stores the path of the temporary file.
+    BatchFileWriter snapshotWriter(SNAPSHOT_IO_BUFFER_COUNT, SNAPSHOT_IO_BUFFER_SIZE); // Writes the file in large batches.
+    snapshotWriter.open(temporaryPath, true); // Opens the temporary file, emptying it.
+    snapshotWriter.append(reinterpret_cast<const char*>(&header), sizeof(header)); // Writes the header.
+    snapshotWriter.append(reinterpret_cast<const char*>(blockChecksums.data()), blockChecksums.size() * sizeof(uint32_t)); // Writes the checksum table.
+    snapshotWriter.append(payload.data(), payload.size()); // Writes the payload.
+    snapshotWriter.flush(true); // Writes the last batch and forces the file to the disk; throws an exception if either failed.
+    snapshotWriter.close(); // Closes the file.
+
+    error_code renameError; // Stores the result of each rename.
+    filesystem::rename(snapshotPath, getPreviousSnapshotPath(snapshotPath), renameError); // Keeps the previous snapshot in case the new one is damaged later; fails harmlessly if there is none.
+    filesystem::rename(temporaryPath, snapshotPath, renameError); // Puts the new snapshot in place in one step.
+    if (renameError)
+        throw InvalidFileException(); // Throws an exception if the snapshot could not be replaced.
+#ifndef _WIN32
+    syncFileToDisk(filesystem::path(snapshotPath).parent_path().string()); // Makes the rename itself durable.
+#endif
+}
+
+// Writes the persons and accounts vectors to the snapshot, after any background snapshot has finished.
+void writeBankSnapshot(const string& snapshotPath)
+{
+    waitForBackgroundSnapshot(); // Keeps two writers away from the temporary file.
+    writeSnapshotFile(snapshotPath, persons, accounts.size(),
+        [](size_t accountIndex, SnapshotAccountRecord& record) { fillSnapshotAccountRecord(record, accounts[accountIndex]); }, computeCSVStamp()); // Writes the snapshot of the current data.
+}
+
+// Starts writing a snapshot of the current data in the background.
+bool startBackgroundSnapshot(const string& snapshotPath)
+{
+    if (isBackgroundSnapshotRunning())
+        return false; // Returns false if the previous snapshot is still being written.
+    uint64_t csvStamp = computeCSVStamp(); // Reads the stamp now, while the CSV files match the vectors.
+
+    // The accounts are read from a snapshot of the account version table, which pins them as they are now without copying them,
+    // while later changes publish new versions beside the pinned ones; the persons hold only views of the arena text, so they are copied.
+    prepareAccountVersions(); // Publishes the accounts if no snapshot was taken since they were loaded or renumbered.
+    shared_ptr<AccountVersionTable::Snapshot> accountSnapshot = make_shared<AccountVersionTable::Snapshot>(accountVersions); // Pins the accounts.
+    shared_ptr<vector<Person>> personsCopy = make_shared<vector<Person>>(persons); // Copies the persons.
+    backgroundSnapshot = async(launch::async, [snapshotPath, personsCopy, accountSnapshot, csvStamp]()
+        {
+            try
+            {
+                writeSnapshotFile(snapshotPath, *personsCopy, accountSnapshot->size(), [&accountSnapshot](size_t accountIndex, SnapshotAccountRecord& record)
+                    {
+                        fillSnapshotAccountRecord(record, convertAccountVariantToAccountVector(accountSnapshot->getAccount(accountIndex))); // Reads the pinned version.
+                    }, csvStamp); // Writes the pinned data.
+                return true;
+            }
+            catch (...)
+            {
+                return false; // Reports any failure to waitForBackgroundSnapshot.
+            }
+        });
+    return true;
+}
+
+// Returns true while a background snapshot is being written, collecting the result of a finished one.
+bool isBackgroundSnapshotRunning()
+{
+    if (!backgroundSnapshot.valid())
+        return false; // Returns false if no snapshot was started.
+    if (backgroundSnapshot.wait_for(chrono::seconds(0)) != future_status::ready)
+        return true; // Returns true if the thread is still writing.
+    lastBackgroundSnapshotSucceeded = backgroundSnapshot.get(); // Collects the result.
+    return false;
+}
+
+// Waits for the background snapshot to finish and returns whether it was written.
+bool waitForBackgroundSnapshot()
+{
+    if (backgroundSnapshot.valid())
+        lastBackgroundSnapshotSucceeded = backgroundSnapshot.get(); // Waits for the thread and collects the result.
+    return lastBackgroundSnapshotSucceeded;
+}
+
+// Reads and verifies the whole snapshot file, then rebuilds the persons and accounts vectors from it.
+bool readBankSnapshot(const string& snapshotPath)
+{
+    ifstream snapshotFile(snapshotPath, ios::in | ios::binary); // Opens the snapshot file.
+    if (!snapshotFile)
+        return false; // Returns false if the file cannot be opened.
+    vector<char> content(static_cast<size_t>(filesystem::file_size(snapshotPath))); // Allocates the whole file once.
+    snapshotFile.read(content.data(), content.size()); // Reads the whole file in one call.
+    if (!snapshotFile)
+        throw InvalidSnapshotException(); // Throws if the file could not be read completely.
+
+    // Verifies the header.
+    SnapshotHeader header; // Stores a copy of the header.
+    if (content.size() < sizeof(header))
+        throw InvalidSnapshotException(); // Throws if the file is too short to hold a header.
+    memcpy(&header, content.data(), sizeof(header)); // Copies the header out of the file content.
+    if (memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0)
+        throw InvalidSnapshotException(); // Throws if the file is not a snapshot.
+    if (header.version < SNAPSHOT_VERSION)
+        return false; // Returns false so a snapshot of an older format is replaced by importing the CSV files.
+    if (header.version != SNAPSHOT_VERSION)
+        throw InvalidSnapshotException(); // Throws if the file was written by a newer program.
+    if (header.headerChecksum != computeCRC32C(&header, offsetof(SnapshotHeader, headerChecksum)) || header.blockSize == 0)
+        throw InvalidSnapshotException(); // Throws if the header is corrupted.
+    if (header.csvStamp != computeCSVStamp())
+        return false; // Returns false so the CSV files are imported if either was written after the snapshot was taken.
+
+    // Verifies that the file holds exactly the sections described by the header.
+    uint64_t personBytes = header.personCount * sizeof(SnapshotPersonRecord); // Calculates the size of the person section.
+    uint64_t accountBytes = header.accountCount * sizeof(SnapshotAccountRecord); // Calculates the size of the account section.
+    uint64_t payloadSize = personBytes + accountBytes + header.stringHeapSize; // Calculates the size of the payload.
+    uint64_t checksumTableSize = header.blockCount * sizeof(uint32_t); // Calculates the size of the checksum table.
+    if (header.blockCount != (payloadSize + header.blockSize - 1) / header.blockSize ||
+        content.size() != sizeof(header) + checksumTableSize + payloadSize)
+        throw InvalidSnapshotException(); // Throws if the file is truncated or has extra bytes.
+
+    // Verifies every payload block against its checksum.
+    const char* checksumTable = content.data() + sizeof(header); // Points to the checksum table.
+    const char* payload = checksumTable + checksumTableSize; // Points to the payload.
+    for (uint64_t block = 0; block < header.blockCount; block++)
+    {
+        uint32_t expectedChecksum; // Stores the checksum recorded for the block.
+        memcpy(&expectedChecksum, checksumTable + block * sizeof(uint32_t), sizeof(uint32_t)); // Reads the recorded checksum.
+        uint64_t blockStart = block * header.blockSize; // Calculates where the block starts.
+        uint64_t blockLength = min<uint64_t>(header.blockSize, payloadSize - blockStart); // The last block may be shorter.
+        if (computeCRC32C(payload + blockStart, static_cast<size_t>(blockLength)) != expectedChecksum)
+            throw InvalidSnapshotException(); // Throws if the block is corrupted.
+    }
+
+    // Rebuilds the persons vector from the person records and the string heap.
+    const char* stringHeap = payload + personBytes + accountBytes; // Points to the string heap.
+    vector<Person> loadedPersons; // Stores the loaded persons until the whole snapshot has been decoded.
+    loadedPersons.reserve(static_cast<size_t>(header.personCount)); // Allocates the vector once.
+    personTextArena.reserve(static_cast<size_t>(header.stringHeapSize)); // Allocates the space for every name and phone number once.
+    for (uint64_t i = 0; i < header.personCount; i++)
+    {
+        SnapshotPersonRecord record; // Stores a copy of the record.
+        memcpy(&record, payload + i * sizeof(SnapshotPersonRecord), sizeof(record)); // Copies the record out of the payload.
+        if (record.nameOffset + record.nameLength > header.stringHeapSize || record.phoneOffset + record.phoneLength > header.stringHeapSize)
+            throw InvalidSnapshotException(); // Throws if a string points outside the heap.
+        Person person; // Creates a new Person object.
+        person.setNationalID(record.nationalID); // Sets the national ID.
+        person.setName(string_view(stringHeap + record.nameOffset, record.nameLength)); // Sets the name.
+        person.setAge(record.age); // Sets the age.
+        person.setPhoneNumber(string_view(stringHeap + record.phoneOffset, record.phoneLength)); // Sets the phone number.
+        loadedPersons.push_back(person); // Adds the person.
+    }
+
+    // Rebuilds the accounts vector from the account records.
+    vector<vector<string>> loadedAccounts; // Stores the loaded accounts until the whole snapshot has been decoded.
+    loadedAccounts.reserve(static_cast<size_t>(header.accountCount)); // Allocates the vector once.
+    for (uint64_t i = 0; i < header.accountCount; i++)
+    {
+        SnapshotAccountRecord record; // Stores a copy of the record.
+        memcpy(&record, payload + personBytes + i * sizeof(SnapshotAccountRecord), sizeof(record)); // Copies the record out of the payload.
+        string dateTime; // Stores the creation date-time in its "Year-Month-Day-Hour-Minute-Second" form.
+        for (int part = 0; part < 6; part++)
+        {
+            if (part > 0)
+                dateTime.push_back('-'); // Adds a separator.
+            appendInteger(dateTime, record.creationDateTime[part]); // Appends the component.
+        }
+        loadedAccounts.emplace_back(); // Adds the account in place.
+        vector<string>& accountVector = loadedAccounts.back(); // Gets its fields, built in place so no string is copied.
+        accountVector.reserve(ACCOUNT_FIELD_COUNT); // Allocates the fields once.
+        accountVector.push_back(formatInteger(record.accountID)); // Adds the account ID.
+        accountVector.push_back(formatInteger(record.nationalID)); // Adds the owner's national ID.
+        accountVector.push_back(formatDouble(record.balance)); // Adds the balance.
+        accountVector.push_back(move(dateTime)); // Adds the creation date-time.
+        if (record.accountType == SNAPSHOT_CERTIFICATE_ACCOUNT)
+        {
+            accountVector.push_back(formatDouble(record.interestRatePercent)); // Adds the interest rate.
+            accountVector.push_back(formatDouble(record.withdrawnAmount)); // Adds the withdrawn amount.
+            accountVector.push_back(formatInteger(record.productID)); // Adds the product.
+        }
+        else
+        {
+            accountVector.resize(ACCOUNT_FIELD_COUNT); // Leaves the certificate fields of a saving account empty.
+        }
+    }
+
+    if (!is_sorted(loadedPersons.begin(), loadedPersons.end()))
+        sort(loadedPersons.begin(), loadedPersons.end()); // Restores the national ID order required by the searches.
+    persons = move(loadedPersons); // Replaces the persons vector.
+    accounts = move(loadedAccounts); // Replaces the accounts vector.
+    return true; // Reports that the snapshot was loaded.
+}
@@ -0,0 +1,61 @@
+// This file contains the declarations of the binary snapshot functions.
+// A snapshot stores the persons and accounts vectors in a versioned binary file
+// so the program can start with one read and a checksum pass instead of parsing the CSV files.
+// The CSV files remain the import/export format.
+// While the program runs, snapshots are also taken in the background so a restart after a crash stays fast.
+
+/*
+	Snapshot file layout (all numbers in the native byte order, little-endian on every supported platform):
+	- Header (64 bytes): magic "BANKSNAP", format version, block size, record counts, string heap size,
+	  block count, the stamp of the CSV files the snapshot matches, and a CRC32C of the header itself
+	- Checksum table: one CRC32C per block of the payload
+	- Payload: fixed-width person records, then fixed-width account records, then the string heap
+	  holding the names and phone numbers referenced by the person records
+*/
+
+// These are the include guards
+#pragma once
+#ifndef SNAPSHOTFUNCTIONS_H
+#define SNAPSHOTFUNCTIONS_H
+
+#include <string>
+using namespace std;
+
+/*
+	Writes the persons and accounts vectors to the snapshot file, waiting first for a background snapshot.
+	The snapshot is written to a temporary file, forced to the disk, and then renamed into place,
+	so a failure part-way never damages the last good snapshot.
+	The snapshot it replaces is kept at the previous snapshot path.
+	Throws an InvalidFileException if the file cannot be written.
+*/
+void writeBankSnapshot(const string&);
+
+/*
+	Starts writing a snapshot of the persons and accounts vectors as they are now, and returns at once.
+	A thread writes the accounts from a snapshot of the account version table pinned before returning,
+	so later changes do not reach the file and no account is copied; only the persons vector is copied.
+	Returns false if the previous background snapshot is still being written or could not be started.
+*/
+bool startBackgroundSnapshot(const string&);
+
+// Returns true while a background snapshot is being written
+bool isBackgroundSnapshotRunning();
+
+// Waits for the background snapshot, if any, and returns false if the last one failed
+bool waitForBackgroundSnapshot();
+
+/*
+	Loads the persons and accounts vectors from the snapshot file, replacing their content.
+	Returns false (leaving the vectors untouched) if the snapshot does not exist, has an older format,
+	or was taken before one of the CSV files was last written, which means the CSV files should be imported instead.
+	Throws an InvalidSnapshotException if the file is truncated, has an unknown version, or fails a checksum.
+*/
+bool readBankSnapshot(const string&);
+
+/*
+	Returns the path where the snapshot replaced by the latest one is kept.
+	It is loaded instead of the latest snapshot when the latest one is damaged or missing.
+*/
+string getPreviousSnapshotPath(const string&);
+
+#endif
@@ -0,0 +1,55 @@
+#include <cstring>
+#include <algorithm>
+#include "StringArena.h"
+
+using namespace std;
+
+// Constructor that creates an empty arena; no memory is allocated until the first string is stored.
+StringArena::StringArena(size_t size)
+    : chunkSize(max<size_t>(size, 1)), currentChunk(nullptr), currentUsed(0), currentCapacity(0), usedBytes(0), reservedBytes(0)
+{
+}
+
+// Allocates a chunk and makes it the current chunk; the rest of the previous chunk is left unused.
+void StringArena::addChunk(size_t minimumSize)
+{
+    size_t size = max(chunkSize, minimumSize); // Gives a long string a chunk of its own size.
+    chunks.emplace_back(new char[size]); // Allocates the chunk.
+    currentChunk = chunks.back().get(); // Copies the next strings into it.
+    currentUsed = 0; // Starts it empty.
+    currentCapacity = size; // Remembers its size.
+    reservedBytes += size; // Counts it.
+}
+
+// Copies the string into the current chunk, starting a new chunk if it does not fit.
+string_view StringArena::store(string_view text)
+{
+    if (text.empty())
+        return string_view(); // Stores nothing for an empty string.
+    if (currentCapacity - currentUsed < text.size())
+        addChunk(text.size()); // Starts a new chunk if the string does not fit.
+    char* copy = currentChunk + currentUsed; // Points to the free space.
+    memcpy(copy, text.data(), text.size()); // Copies the string.
+    currentUsed += text.size(); // Uses the space.
+    usedBytes += text.size(); // Counts the bytes.
+    return string_view(copy, text.size()); // Returns a view of the copy.
+}
+
+// Starts a chunk large enough for the given number of bytes if the current one is too small.
+void StringArena::reserve(size_t size)
+{
+    if (currentCapacity - currentUsed < size)
+        addChunk(size); // Allocates the whole space at once.
+}
+
+// Frees every chunk.
+void StringArena::release()
+{
+    chunks.clear(); // Frees the memory.
+    chunks.shrink_to_fit(); // Frees the chunk list as well, so nothing is left from the released data.
+    currentChunk = nullptr; // Forgets the current chunk.
+    currentUsed = 0;
+    currentCapacity = 0;
+    usedBytes = 0;
+    reservedBytes = 0;
+}
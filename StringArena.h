@@ -0,0 +1,73 @@
+// This is the specification file for the StringArena class,
+// a monotonic allocator that copies strings into large shared chunks.
+// Strings are never freed one by one: the whole arena is released at once,
+// so loading millions of names and phone numbers costs a handful of allocations instead of one per string.
+
+// These are the include guards
+#pragma once
+#ifndef STRINGARENA_H
+#define STRINGARENA_H
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <memory>
+#include <cstddef>
+using namespace std;
+
+class StringArena
+{
+private:
+	vector<unique_ptr<char[]>> chunks; // Holds the chunks, which never move once allocated
+	size_t chunkSize;                  // Holds the size of a regular chunk
+	char* currentChunk;                // Holds the chunk strings are copied into, or nullptr before the first one
+	size_t currentUsed;                // Holds the number of bytes used in the current chunk
+	size_t currentCapacity;            // Holds the size of the current chunk
+	size_t usedBytes;                  // Holds the number of string bytes stored since the arena was last released
+	size_t reservedBytes;              // Holds the total size of the chunks
+
+	// Allocates a chunk of at least the given size and makes it the current chunk
+	void addChunk(size_t);
+
+public:
+	// Constructor that creates an empty arena allocating chunks of the given size
+	explicit StringArena(size_t);
+
+	// The arena owns the memory every stored view points to, so it can be neither copied nor assigned
+	StringArena(const StringArena&) = delete;
+	StringArena& operator=(const StringArena&) = delete;
+
+	/*
+		Copies the string into the arena and returns a view of the copy.
+		The view stays valid until the arena is released.
+		Not thread-safe: strings are stored from the main thread only,
+		but views may be read from any thread since stored bytes never change or move.
+	*/
+	string_view store(string_view);
+
+	// Makes sure the given number of bytes can be stored with at most one more allocation, so a known load fills a single chunk
+	void reserve(size_t);
+
+	// Frees every chunk at once, which invalidates every view the arena returned
+	void release();
+
+	// Returns the number of chunks allocated, which is the number of allocations made for the stored strings
+	size_t getChunkCount() const
+	{
+		return chunks.size();
+	}
+
+	// Returns the number of string bytes stored
+	size_t getUsedBytes() const
+	{
+		return usedBytes;
+	}
+
+	// Returns the total size of the chunks
+	size_t getReservedBytes() const
+	{
+		return reservedBytes;
+	}
+};
+
+#endif
@@ -0,0 +1,92 @@
+// This benchmark measures the person lookups of the menu (findAccountsOfPerson, behind "display person")
+// served from the paged B+tree through its buffer pool of BUFFER_POOL_FRAME_COUNT pages,
+// against the scan of the accounts vector they replace, with the persons drawn from a Zipf distribution
+// (a few customers are looked up far more often than the others) and from a uniform one.
+// Usage: AccountStore-Benchmark [accountCount] [lookupCount], 1,000,000 accounts and 100,000 lookups by default;
+// the bank has one person per four accounts.
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include "Test-Support.h"
+using namespace std;
+
+// Draws person positions from a Zipf distribution with exponent 1 over the given number of persons.
+class ZipfDistribution
+{
+private:
+    vector<double> cumulativeWeights; // Holds the cumulative probability of every position.
+
+public:
+    explicit ZipfDistribution(size_t personCount) : cumulativeWeights(personCount)
+    {
+        double total = 0;
+        for (size_t i = 0; i < personCount; i++)
+            cumulativeWeights[i] = total += 1.0 / (i + 1);
+        for (double& weight : cumulativeWeights)
+            weight /= total;
+    }
+
+    size_t operator()(mt19937_64& random) const
+    {
+        double draw = uniform_real_distribution<double>(0, 1)(random);
+        return min(static_cast<size_t>(lower_bound(cumulativeWeights.begin(), cumulativeWeights.end(), draw) - cumulativeWeights.begin()),
+            cumulativeWeights.size() - 1);
+    }
+};
+
+// Looks up the given persons through the store and prints the time per lookup and the buffer pool counters.
+static void runLookups(const string& name, const vector<long long>& nationalIDs)
+{
+    StorageStatistics before = getAccountStoreStatistics();
+    size_t foundCount = 0;
+    Stopwatch stopwatch;
+    for (long long nationalID : nationalIDs)
+        foundCount += findAccountsOfPerson(nationalID).size();
+    double microseconds = stopwatch.getElapsedMilliseconds() * 1000 / nationalIDs.size();
+    StorageStatistics after = getAccountStoreStatistics();
+    long long hits = after.pageHits - before.pageHits, misses = after.pageMisses - before.pageMisses;
+    cout << left << setw(22) << name << setw(14) << fixed << setprecision(2) << microseconds << setw(12) << setprecision(1)
+        << 100.0 * hits / max(hits + misses, 1LL) << setw(12) << after.pageEvictions - before.pageEvictions
+        << setw(14) << setprecision(2) << static_cast<double>(hits + misses) / nationalIDs.size() << foundCount << endl;
+}
+
+int main(int argc, char* argv[])
+{
+    size_t accountCount = getBenchmarkSize(argc, argv, 1000000); // Stores the number of accounts.
+    size_t lookupCount = argc > 2 ? static_cast<size_t>(atoll(argv[2])) : 100000; // Stores the number of lookups of each distribution.
+    size_t personCount = accountCount / 4 + 1; // Gives every person about four accounts.
+    generatePersons(personCount);
+    generateAccounts(accountCount, personCount);
+    persistAllAccounts(); // Builds the paged store, so the lookups can be served from it.
+
+    mt19937_64 random(31);
+    ZipfDistribution zipf(personCount);
+    vector<long long> zipfIDs(lookupCount), uniformIDs(lookupCount);
+    for (size_t i = 0; i < lookupCount; i++)
+    {
+        zipfIDs[i] = getGeneratedNationalID(zipf(random));
+        uniformIDs[i] = getGeneratedNationalID(random() % personCount);
+    }
+
+    cout << accountCount << " accounts, " << personCount << " persons, " << lookupCount << " lookups, "
+        << BUFFER_POOL_FRAME_COUNT << " buffer pool frames" << endl;
+    cout << left << setw(22) << "Lookup" << setw(14) << "us/lookup" << setw(12) << "Hit rate %" << setw(12) << "Evictions"
+        << setw(14) << "Pages/lookup" << "Accounts" << endl;
+    runLookups("Store, Zipf", zipfIDs);
+    runLookups("Store, uniform", uniformIDs);
+
+    // Scans the accounts vector for a sample of the persons, as "display person" did before.
+    size_t scanCount = min<size_t>(lookupCount, 200);
+    size_t foundCount = 0;
+    Stopwatch stopwatch;
+    for (size_t i = 0; i < scanCount; i++)
+    {
+        string nationalID = formatInteger(zipfIDs[i]);
+        for (const vector<string>& account : accounts)
+            foundCount += account[1] == nationalID; // Compares the text, as the scan did.
+    }
+    cout << left << setw(22) << "Vector scan" << setw(14) << setprecision(2) << stopwatch.getElapsedMilliseconds() * 1000 / scanCount
+        << setw(12) << "-" << setw(12) << "-" << setw(14) << "-" << foundCount << " (" << scanCount << " lookups)" << endl;
+    return 0;
+}
@@ -0,0 +1,141 @@
+// This test checks the lookups of every account store against the accounts vector they were written from:
+// each person's accounts come back in account ID order, a single account is found only under its owner's national ID,
+// and both see the records rewritten, appended and removed after the store was built.
+// The paged B+tree runs with a buffer pool of a few pages, so its lookups also go through page evictions.
+// Finally, the lookups of the menu operations are checked to read the store once it holds every account.
+
+#include <random>
+#include "Test-Support.h"
+#include "PagedAccountStore.h"
+#include "MappedAccountTable.h"
+#include "LsmAccountStore.h"
+using namespace std;
+
+// Returns the accounts of the person with the given national ID, scanned from the accounts vector.
+static vector<vector<string>> scanAccountsOfPerson(long long nationalID)
+{
+    vector<vector<string>> personAccounts;
+    for (const vector<string>& account : accounts)
+        if (parseLongLong(account[1]) == nationalID)
+            personAccounts.push_back(account);
+    return personAccounts;
+}
+
+// Checks the lookups of an open store holding the accounts vector.
+static void checkLookups(AccountStore& store, size_t personCount)
+{
+    for (size_t personIndex = 0; personIndex < personCount + 1; personIndex++) // Includes a person without accounts.
+    {
+        long long nationalID = getGeneratedNationalID(personIndex);
+        vector<AccountRecord> records;
+        store.findRecordsOfPerson(nationalID, records);
+        vector<vector<string>> found;
+        for (const AccountRecord& record : records)
+            found.push_back(convertAccountRecordToVector(record));
+        CHECK(found == scanAccountsOfPerson(nationalID));
+    }
+    mt19937_64 random(31);
+    for (int i = 0; i < 2000; i++)
+    {
+        size_t accountIndex = random() % accounts.size();
+        long long nationalID = parseLongLong(accounts[accountIndex][1]);
+        AccountRecord record;
+        CHECK(store.findRecord(nationalID, static_cast<int32_t>(accountIndex + 1), record));
+        CHECK(convertAccountRecordToVector(record) == accounts[accountIndex]);
+        CHECK(!store.findRecord(nationalID + 1, static_cast<int32_t>(accountIndex + 1), record));
+    }
+    AccountRecord record;
+    CHECK(!store.findRecord(getGeneratedNationalID(0), static_cast<int32_t>(accounts.size() + 1), record));
+}
+
+// Removes the accounts at the given positions, sorted in increasing order, from the accounts vector, and renumbers the others.
+static void removeAccounts(const vector<size_t>& removedIndexes)
+{
+    vector<vector<string>> remainingAccounts;
+    for (size_t accountIndex = 0; accountIndex < accounts.size(); accountIndex++)
+        if (!binary_search(removedIndexes.begin(), removedIndexes.end(), accountIndex))
+            remainingAccounts.push_back(accounts[accountIndex]);
+    accounts = move(remainingAccounts);
+    for (size_t accountIndex = 0; accountIndex < accounts.size(); accountIndex++)
+        accounts[accountIndex][0] = formatInteger(static_cast<long long>(accountIndex + 1));
+}
+
+// Builds the store from the accounts, changes, adds and removes accounts through it, then checks its lookups.
+static void checkStore(AccountStore& store, const string& path, size_t personCount)
+{
+    store.open(path);
+    store.rebuild(accounts);
+    checkLookups(store, personCount);
+    for (size_t accountIndex = 0; accountIndex < accounts.size(); accountIndex += 7)
+    {
+        accounts[accountIndex][2] = formatDouble(parseDouble(accounts[accountIndex][2]) + 1); // Changes the balance.
+        store.updateRecord(accountIndex, accounts[accountIndex]);
+    }
+    accounts.push_back({ formatInteger(static_cast<long long>(accounts.size() + 1)), formatInteger(getGeneratedNationalID(3)),
+        formatDouble(MIN_BALANCE), "124-0-1-12-0-0", "", "", "" });
+    store.appendRecord(accounts.back());
+    checkLookups(store, personCount);
+    vector<size_t> removedIndexes = { 0 }; // Removes the first account, every 97th account, a run of accounts and the appended one.
+    for (size_t accountIndex = 50; accountIndex < accounts.size() - 1; accountIndex += 97)
+        removedIndexes.push_back(accountIndex);
+    for (size_t accountIndex = 5000; accountIndex < 5400; accountIndex++)
+        if (accountIndex % 97 != 50)
+            removedIndexes.push_back(accountIndex);
+    removedIndexes.push_back(accounts.size() - 1);
+    sort(removedIndexes.begin(), removedIndexes.end());
+    for (size_t accountIndex = 1; accountIndex < accounts.size(); accountIndex += 5)
+        accounts[accountIndex][2] = formatDouble(parseDouble(accounts[accountIndex][2]) + 2); // Changes balances the store has not seen, which the removal must keep.
+    removeAccounts(removedIndexes);
+    store.removeRecords(removedIndexes, accounts);
+    checkLookups(store, personCount);
+    store.close();
+    store.open(path);
+    checkLookups(store, personCount); // Reopens the store, so the removals were written.
+    store.close();
+}
+
+int main()
+{
+    const size_t personCount = 300;
+    generatePersons(personCount);
+    generateAccounts(20000, personCount);
+    vector<vector<string>> generatedAccounts = accounts;
+
+    PagedAccountStore pagedStore(8); // Holds far fewer pages than the tree, so lookups evict pages.
+    checkStore(pagedStore, "Accounts.pages", personCount);
+    StorageStatistics statistics = pagedStore.getStatistics();
+    CHECK(statistics.pageEvictions > 0);
+    CHECK(statistics.residentPages == 0); // Closing the store empties its pool.
+    cout << "Paged B+tree: " << statistics.pageHits << " hits, " << statistics.pageMisses << " misses, "
+        << statistics.pageEvictions << " evictions with 8 frames" << endl;
+
+    accounts = generatedAccounts;
+    MappedAccountTable mappedTable;
+    checkStore(mappedTable, "Accounts.table", personCount);
+    cout << "Memory-mapped table: lookups checked" << endl;
+
+    accounts = generatedAccounts;
+    LsmAccountStore lsmStore;
+    checkStore(lsmStore, "Accounts.lsm", personCount);
+    cout << "LSM tree: lookups checked" << endl;
+
+    // Once the store holds every account, the menu lookups read it and see the same accounts as the vector,
+    // also after accounts are removed from it in place.
+    accounts = generatedAccounts;
+    persistAllAccounts();
+    vector<size_t> removedIndexes = { 2, 3, 700, 19999 };
+    removeAccounts(removedIndexes);
+    persistAccountRemovals(removedIndexes);
+    for (size_t personIndex = 0; personIndex < personCount; personIndex += 13)
+    {
+        long long nationalID = getGeneratedNationalID(personIndex);
+        CHECK(findAccountsOfPerson(nationalID) == scanAccountsOfPerson(nationalID));
+    }
+    long long pageRequestsBefore = getAccountStoreStatistics().pageMisses + getAccountStoreStatistics().pageHits;
+    vector<string> account;
+    CHECK(readAccountOfPerson(5, parseLongLong(accounts[4][1]), account) && account == accounts[4]);
+    CHECK(!readAccountOfPerson(5, parseLongLong(accounts[4][1]) + 1, account));
+    CHECK(!readAccountOfPerson(static_cast<int>(accounts.size() + 1), parseLongLong(accounts[4][1]), account));
+    CHECK(getAccountStoreStatistics().pageMisses + getAccountStoreStatistics().pageHits > pageRequestsBefore); // The reads went through the buffer pool.
+    return reportTestResult();
+}
@@ -0,0 +1,107 @@
+// This test checks the optimistic commits of account updates: a commit made with the version read before the change
+// replaces the account, and a second commit made with the same version is rejected and leaves the account as the first one wrote it.
+// Then several threads race to commit every account with the same version read beforehand: exactly one commit of each account wins,
+// the account and its record in the store hold the winner's change, and the versions keep moving on afterwards.
+
+#include <thread>
+#include <atomic>
+#include "Test-Support.h"
+#include "Exceptions.h"
+using namespace std;
+
+const size_t ACCOUNT_COUNT = 2000;
+const int THREAD_COUNT = 4;
+
+// Returns the account at the given position with its balance replaced.
+static vector<string> withBalance(size_t accountIndex, double balance)
+{
+    vector<string> account = accounts[accountIndex];
+    account[2] = formatDouble(balance);
+    return account;
+}
+
+// Commits the account and returns true, or returns false if the commit was rejected.
+static bool tryCommit(size_t accountIndex, unsigned long long version, vector<string> account)
+{
+    try
+    {
+        commitAccountUpdate(static_cast<int>(accountIndex), version, move(account));
+        return true;
+    }
+    catch (AccountVersionConflictException)
+    {
+        return false;
+    }
+}
+
+int main()
+{
+    generatePersons(ACCOUNT_COUNT / 4 + 1);
+    generateAccounts(ACCOUNT_COUNT, ACCOUNT_COUNT / 4 + 1);
+    persistAllAccounts();
+
+    // Two commits from the same read: the first wins, the second is rejected and writes nothing.
+    unsigned long long version = readAccountVersion(0);
+    vector<string> first = withBalance(0, 1000), second = withBalance(0, 2000);
+    CHECK(tryCommit(0, version, first));
+    CHECK(!tryCommit(0, version, second));
+    CHECK(accounts[0] == first);
+    CHECK(readAccountVersion(0) != version);
+    CHECK(tryCommit(0, readAccountVersion(0), second)); // Succeeds again from a new read.
+    CHECK(!tryCommit(ACCOUNT_COUNT, 0, second)); // Rejects a position past the last account.
+    CHECK(!tryCommit(static_cast<size_t>(-1), 0, second));
+
+    // A change persisted another way also makes a commit from an older read fail.
+    version = readAccountVersion(1);
+    persistAccountUpdates({ 1 });
+    CHECK(!tryCommit(1, version, withBalance(1, 3000)));
+
+    // Every thread commits every account with the version read before any of them started.
+    vector<unsigned long long> versions(ACCOUNT_COUNT);
+    vector<vector<vector<string>>> changes(THREAD_COUNT);
+    for (size_t i = 0; i < ACCOUNT_COUNT; i++)
+        versions[i] = readAccountVersion(static_cast<int>(i));
+    for (int t = 0; t < THREAD_COUNT; t++)
+        for (size_t i = 0; i < ACCOUNT_COUNT; i++)
+            changes[t].push_back(withBalance(i, 10000.0 * (t + 1) + static_cast<double>(i)));
+    vector<vector<char>> won(THREAD_COUNT, vector<char>(ACCOUNT_COUNT, 0));
+    atomic<bool> start(false);
+    vector<thread> threads;
+    for (int t = 0; t < THREAD_COUNT; t++)
+    {
+        threads.emplace_back([&, t]()
+            {
+                while (!start)
+                    this_thread::yield();
+                for (size_t step = 0; step < ACCOUNT_COUNT; step++)
+                {
+                    size_t i = (step + t * ACCOUNT_COUNT / THREAD_COUNT) % ACCOUNT_COUNT; // Starts each thread at a different account, then overlaps.
+                    won[t][i] = tryCommit(i, versions[i], changes[t][i]);
+                }
+            });
+    }
+    start = true;
+    for (thread& commitThread : threads)
+        commitThread.join();
+
+    for (size_t i = 0; i < ACCOUNT_COUNT; i++)
+    {
+        int winnerCount = 0, winner = -1;
+        for (int t = 0; t < THREAD_COUNT; t++)
+        {
+            if (won[t][i])
+            {
+                winnerCount++;
+                winner = t;
+            }
+        }
+        CHECK(winnerCount == 1);
+        if (winnerCount != 1)
+            continue;
+        CHECK(accounts[i] == changes[winner][i]);
+        vector<string> storedAccount;
+        CHECK(readAccountOfPerson(static_cast<int>(i + 1), parseLongLong(accounts[i][1]), storedAccount) && storedAccount == changes[winner][i]);
+    }
+    cout << THREAD_COUNT << " threads committed " << ACCOUNT_COUNT << " accounts from the same versions, one commit of each won" << endl;
+    return reportTestResult();
+}
@@ -0,0 +1,90 @@
+// This benchmark compares the date-time functions with the mktime, localtime and ctime path they replaced,
+// conversion by conversion: the time to convert one date-time of each kind used by the account tables and the certificates.
+// Both sides parse the stored date-time the same way, so the difference is the calendar and timezone work.
+// Run it with TZ set to a zone with daylight saving time, such as TZ=America/New_York, to include the changes.
+// Usage: DateTime-Benchmark [dateTimeCount], 1,000,000 date-times of each kind by default.
+
+#include <iomanip>
+#include <functional>
+#include "Test-Support.h"
+#include "DateTime-Functions.h"
+using namespace std;
+
+// Runs the given function over every date-time and returns the time per date-time in nanoseconds, best of three runs.
+static double timePerDateTime(size_t dateTimeCount, const function<double(size_t)>& convertDateTime)
+{
+    double bestNanoseconds = 0;
+    for (int run = 0; run < 3; run++)
+    {
+        volatile double sink = 0; // Keeps the results alive, so the conversions are not optimized away.
+        Stopwatch stopwatch;
+        for (size_t i = 0; i < dateTimeCount; i++)
+            sink = sink + convertDateTime(i);
+        double nanoseconds = stopwatch.getElapsedMilliseconds() * 1e6 / dateTimeCount;
+        if (run == 0 || nanoseconds < bestNanoseconds)
+            bestNanoseconds = nanoseconds;
+    }
+    return bestNanoseconds;
+}
+
+// Prints one row of the results.
+static void printRow(const string& conversion, double beforeNanoseconds, double afterNanoseconds)
+{
+    cout << left << setw(32) << conversion << setw(16) << fixed << setprecision(1) << beforeNanoseconds << setw(16) << afterNanoseconds
+        << setprecision(2) << beforeNanoseconds / afterNanoseconds << "x" << endl;
+}
+
+// Converts a stored date-time to a timestamp the way the accounts did before: through a tm structure and mktime.
+static time_t convertWithMktime(const string& storedDateTime)
+{
+    LocalDateTime local = parseStoredDateTime(storedDateTime);
+    tm datetime = {};
+    datetime.tm_year = local.year;
+    datetime.tm_mon = local.month;
+    datetime.tm_mday = local.day;
+    datetime.tm_hour = local.hour;
+    datetime.tm_min = local.minute;
+    datetime.tm_sec = local.second;
+    datetime.tm_isdst = -1;
+    return mktime(&datetime);
+}
+
+int main(int argc, char* argv[])
+{
+    tzset(); // Reads TZ once, outside the timed runs.
+    size_t dateTimeCount = getBenchmarkSize(argc, argv, 1000000); // Stores the number of date-times of each kind.
+    generatePersons(1000);
+    generateAccounts(dateTimeCount, 1000);
+    vector<time_t> timestamps(dateTimeCount); // Stores times to convert, such as the creation time of new accounts.
+    for (size_t i = 0; i < dateTimeCount; i++)
+        timestamps[i] = convertWithMktime(accounts[i][3]) + static_cast<time_t>(i % 86400);
+
+    const char* timezone = getenv("TZ");
+    cout << dateTimeCount << " date-times of each kind, TZ=" << (timezone != nullptr ? timezone : "(unset)") << endl;
+    cout << left << setw(32) << "Conversion" << setw(16) << "libc (ns)" << setw(16) << "DateTime (ns)" << "Speedup" << endl;
+    printRow("stored to display (ctime)", timePerDateTime(dateTimeCount, [](size_t i)
+        {
+            time_t timestamp = convertWithMktime(accounts[i][3]);
+            return static_cast<double>(string(ctime(&timestamp)).size());
+        }),
+        timePerDateTime(dateTimeCount, [](size_t i) { return static_cast<double>(formatStoredDateTimeForDisplay(accounts[i][3]).size()); }));
+    printRow("stored to timestamp (mktime)", timePerDateTime(dateTimeCount, [](size_t i) { return static_cast<double>(convertWithMktime(accounts[i][3])); }),
+        timePerDateTime(dateTimeCount, [](size_t i) { return static_cast<double>(convertLocalDateTimeToTime(parseStoredDateTime(accounts[i][3]))); }));
+    printRow("timestamp to stored (localtime)", timePerDateTime(dateTimeCount, [&timestamps](size_t i)
+        {
+            tm datetime;
+            localtime_r(&timestamps[i], &datetime);
+            string field;
+            appendStoredDateTime(field, { datetime.tm_year, datetime.tm_mon, datetime.tm_mday, datetime.tm_hour, datetime.tm_min, datetime.tm_sec });
+            return static_cast<double>(field.size());
+        }),
+        timePerDateTime(dateTimeCount, [&timestamps](size_t i)
+        {
+            string field;
+            appendStoredDateTime(field, convertTimeToLocalDateTime(timestamps[i]));
+            return static_cast<double>(field.size());
+        }));
+    printRow("timestamp to display (ctime)", timePerDateTime(dateTimeCount, [&timestamps](size_t i) { return static_cast<double>(string(ctime(&timestamps[i])).size()); }),
+        timePerDateTime(dateTimeCount, [&timestamps](size_t i) { return static_cast<double>(formatTimeForDisplay(timestamps[i]).size()); }));
+    return 0;
+}
@@ -0,0 +1,38 @@
+// This benchmark measures the end-of-day batch over a generated bank, from the first job to the last sync of the account store.
+// Half of the certificates are 1-year certificates opened between 2000 and 2024, so as of 2025 every one of them is renewed:
+// the rollover job changes and persists an eighth of the accounts, which is the heaviest day the batch can have.
+// Usage: EndOfDay-Benchmark [accountCount], 1,000,000 accounts by default; the bank has one person per four accounts.
+
+#include <iomanip>
+#include <filesystem>
+#include "Test-Support.h"
+#include "EndOfDay-Functions.h"
+using namespace std;
+
+int main(int argc, char* argv[])
+{
+    size_t accountCount = getBenchmarkSize(argc, argv, 1000000); // Stores the number of accounts to run the batch over.
+    size_t personCount = accountCount / 4 + 1; // Gives every person about four accounts.
+    generatePersons(personCount);
+    generateAccounts(accountCount, personCount);
+    for (size_t i = 3; i < accountCount; i += 8)
+    {
+        accounts[i][4] = formatDouble(18); // Gives the certificate the rate of the first 1-year tier.
+        accounts[i][6] = formatInteger(static_cast<int>(CertificateProductID::OneYear)); // Makes it a 1-year certificate.
+    }
+    persistAllAccounts(); // Writes the store the renewed certificates are persisted to.
+
+    time_t businessDate = 1735732800; // Runs the batch for 2025-01-01 12:00.
+    Stopwatch stopwatch;
+    BatchRunSummary summary = runEndOfDayBatch(businessDate);
+    double milliseconds = stopwatch.getElapsedMilliseconds();
+
+    cout << accountCount << " accounts, " << summary.threadCount << " worker thread(s)" << endl;
+    cout << left << setw(22) << "Job" << setw(14) << "Accounts" << setw(14) << "Affected" << "Time (ms)" << endl;
+    for (const BatchJobSummary& job : summary.jobs)
+        cout << left << setw(22) << job.jobName << setw(14) << job.processedCount << setw(14) << job.affectedCount
+            << fixed << setprecision(1) << job.elapsedMilliseconds << endl;
+    cout << "Whole batch: " << fixed << setprecision(1) << milliseconds << " ms, " << setprecision(0)
+        << accountCount / milliseconds * 1000 << " accounts/s" << endl;
+    return filesystem::exists(END_OF_DAY_CHECKPOINT_FILE_PATH) ? 1 : 0; // A completed batch removes its checkpoint.
+}
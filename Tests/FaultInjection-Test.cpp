@@ -0,0 +1,253 @@
+// This test crashes the program at random points of its writes and checks that it always recovers a consistent bank.
+// It runs itself as a child process with BANK_FAULT_INJECTION_OFFSET set to a random offset: the child loads a bank,
+// deposits into random accounts and changes the age of random persons through the persistence thread
+// (which writes the account store and the person journal), starts background snapshots as it goes, then saves.
+// The child stops part-way through whichever write crosses the offset. Another child then reloads the bank and checks that
+// every account and person is found, that the balances are exactly those after some prefix of the deposits
+// (save for the one account record the crash may tear, which keeps its loaded balance),
+// and that the ages are exactly those after some prefix of the person changes.
+// Usage: FaultInjection-Test [trialCount], 30 crashes by default.
+
+#include <fstream>
+#include <filesystem>
+#include <sys/wait.h>
+#include "Test-Support.h"
+using namespace std;
+
+const size_t PERSON_COUNT = 500;
+const size_t ACCOUNT_COUNT = 2000;
+const size_t STEP_COUNT = 2500; // Every step deposits 1 into an account; one step in ten also changes a person's age.
+
+// Holds one step of the workload.
+struct WorkloadStep
+{
+    size_t accountIndex;
+    size_t personIndex; // Equal to PERSON_COUNT when the step changes no person
+    int age;
+};
+
+// Returns the steps of the workload, the same in every process.
+static vector<WorkloadStep> getWorkloadSteps()
+{
+    vector<WorkloadStep> steps(STEP_COUNT);
+    mt19937_64 random(34);
+    for (size_t step = 0; step < STEP_COUNT; step++)
+    {
+        steps[step].accountIndex = random() % ACCOUNT_COUNT;
+        steps[step].personIndex = step % 10 == 0 ? random() % PERSON_COUNT : PERSON_COUNT;
+        steps[step].age = MIN_AGE + static_cast<int>(step % (MAX_AGE - MIN_AGE));
+    }
+    return steps;
+}
+
+// Writes the starting bank to the CSV files, the snapshot and the account store.
+static int setUpBank()
+{
+    generatePersons(PERSON_COUNT);
+    generateAccounts(ACCOUNT_COUNT, PERSON_COUNT);
+    writeAllSavedPersonsToTheCSVFile();
+    persistAllAccounts();
+    saveProgramData();
+    return 0;
+}
+
+// Loads the bank, runs the workload and saves the bank, as a session of the program would.
+static int runWorkload()
+{
+    loadProgramData();
+    for (const WorkloadStep& step : getWorkloadSteps())
+    {
+        vector<string>& account = accounts[step.accountIndex];
+        account[2] = formatDouble(parseDouble(account[2]) + 1);
+        persistAccountUpdates({ step.accountIndex });
+        if (step.personIndex < PERSON_COUNT)
+        {
+            persons[step.personIndex].setAge(step.age);
+            persistSavedPerson(persons[step.personIndex]);
+        }
+    }
+    saveProgramData();
+    return 0;
+}
+
+// Reloads the bank and checks that it holds the starting bank changed by a prefix of the deposits and of the person changes.
+static int checkRecoveredBank(bool complete)
+{
+    generatePersons(PERSON_COUNT);
+    generateAccounts(ACCOUNT_COUNT, PERSON_COUNT);
+    vector<long long> initialNationalIDs;
+    vector<string> initialNames; // Copies the names, since reloading frees the text the persons view.
+    vector<int> ages;
+    for (const Person& person : persons)
+    {
+        initialNationalIDs.push_back(person.getNationalID());
+        initialNames.emplace_back(person.getName());
+        ages.push_back(person.getAge());
+    }
+    vector<vector<string>> initialAccounts = accounts;
+    try
+    {
+        loadProgramData();
+    }
+    catch (...)
+    {
+        cout << "The bank could not be reloaded" << endl;
+        return 1;
+    }
+    CHECK(persons.size() == PERSON_COUNT);
+    CHECK(accounts.size() == ACCOUNT_COUNT);
+    if (persons.size() != PERSON_COUNT || accounts.size() != ACCOUNT_COUNT)
+        return reportTestResult();
+    vector<WorkloadStep> steps = getWorkloadSteps();
+
+    // The deposits reached the accounts in order, so the balances are those after some number of deposits,
+    // except that the record torn by the crash fails its checksum and keeps the balance loaded from the CSV file.
+    vector<long long> depositCounts(ACCOUNT_COUNT);
+    for (size_t i = 0; i < ACCOUNT_COUNT; i++)
+    {
+        CHECK(parseInt(accounts[i][0]) == static_cast<int>(i + 1));
+        CHECK(!isDefaultPerson(searchPerson(parseLongLong(accounts[i][1]))));
+        double deposited = parseDouble(accounts[i][2]) - parseDouble(initialAccounts[i][2]);
+        depositCounts[i] = static_cast<long long>(deposited);
+        CHECK(deposited == static_cast<double>(depositCounts[i]) && depositCounts[i] >= 0);
+    }
+    vector<long long> expectedCounts(ACCOUNT_COUNT);
+    size_t mismatchCount = 0; // Counts the accounts whose balance differs from the one after the deposits so far.
+    for (size_t i = 0; i < ACCOUNT_COUNT; i++)
+        mismatchCount += depositCounts[i] != 0;
+    long long recoveredDeposits = -1, tornAccounts = 0;
+    for (long long step = 0; step <= static_cast<long long>(STEP_COUNT); step++)
+    {
+        if (step > 0)
+        {
+            size_t accountIndex = steps[step - 1].accountIndex;
+            mismatchCount -= depositCounts[accountIndex] != expectedCounts[accountIndex];
+            expectedCounts[accountIndex]++;
+            mismatchCount += depositCounts[accountIndex] != expectedCounts[accountIndex];
+        }
+        if (mismatchCount == 0)
+        {
+            recoveredDeposits = step;
+            tornAccounts = 0;
+        }
+        else if (mismatchCount == 1 && recoveredDeposits < 0)
+        {
+            size_t i = 0;
+            while (depositCounts[i] == expectedCounts[i])
+                i++;
+            if (depositCounts[i] == 0)
+            {
+                recoveredDeposits = step; // Matches once the torn account is allowed its loaded balance.
+                tornAccounts = 1;
+            }
+        }
+    }
+    CHECK(recoveredDeposits >= 0);
+
+    // The person changes reached the journal in order, so the ages match those after some number of changes.
+    vector<int> recoveredAges(PERSON_COUNT);
+    for (size_t i = 0; i < PERSON_COUNT; i++)
+    {
+        recoveredAges[i] = persons[i].getAge();
+        CHECK(persons[i].getNationalID() == initialNationalIDs[i] && persons[i].getName() == initialNames[i]);
+    }
+    long long recoveredPersonChanges = ages == recoveredAges ? 0 : -1, personChanges = 0;
+    for (const WorkloadStep& step : steps)
+    {
+        if (step.personIndex == PERSON_COUNT)
+            continue;
+        ages[step.personIndex] = step.age;
+        personChanges++;
+        if (ages == recoveredAges)
+            recoveredPersonChanges = personChanges;
+    }
+    CHECK(recoveredPersonChanges >= 0);
+    if (complete)
+        CHECK(recoveredDeposits == static_cast<long long>(STEP_COUNT) && tornAccounts == 0 && recoveredPersonChanges == personChanges);
+    cout << "Recovered " << recoveredDeposits << " of " << STEP_COUNT << " deposits" << (tornAccounts > 0 ? " with one torn account record" : "")
+        << " and " << recoveredPersonChanges << " of " << personChanges << " person changes" << endl;
+    return reportTestResult();
+}
+
+// Runs this program in the given folder with the given mode, and returns its exit code, or -1 if it did not exit normally.
+static int runChild(const string& program, const filesystem::path& folder, const string& mode, long long faultOffset)
+{
+    string command = "cd '" + folder.string() + "' && ";
+    if (faultOffset >= 0)
+        command += "BANK_FAULT_INJECTION_OFFSET=" + formatInteger(faultOffset) + " ";
+    command += "'" + program + "' " + mode + " >> output.txt 2>&1";
+    int status = system(command.c_str());
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+// Copies the starting bank to a fresh folder, runs the workload with the given fault offset, then checks the recovered bank.
+// Returns the exit code of the workload.
+static int runTrial(const string& program, long long faultOffset, bool& recovered)
+{
+    filesystem::path trialFolder = filesystem::current_path() / "trial";
+    filesystem::remove_all(trialFolder);
+    filesystem::create_directories(trialFolder);
+    filesystem::copy(filesystem::current_path() / "start" / "CSVs", trialFolder / "CSVs", filesystem::copy_options::recursive);
+    int workloadResult = runChild(program, trialFolder, "--workload", faultOffset);
+    recovered = runChild(program, trialFolder, workloadResult == 0 ? "--check-complete" : "--check", -1) == 0;
+    if (!recovered)
+    {
+        ifstream output(trialFolder / "output.txt");
+        cout << "Offset " << faultOffset << ":" << endl << output.rdbuf() << endl;
+    }
+    return workloadResult;
+}
+
+int main(int argc, char* argv[])
+{
+    string mode = argc > 1 ? argv[1] : "";
+    if (mode == "--setup")
+        return setUpBank();
+    if (mode == "--workload")
+        return runWorkload();
+    if (mode == "--check" || mode == "--check-complete")
+        return checkRecoveredBank(mode == "--check-complete");
+
+    size_t trialCount = getBenchmarkSize(argc, argv, 30);
+    string program = filesystem::absolute(argv[0]).string();
+    filesystem::path startFolder = filesystem::current_path() / "start";
+    filesystem::create_directories(startFolder / "CSVs");
+    if (runChild(program, startFolder, "--setup", -1) != 0)
+    {
+        cout << "The starting bank could not be written" << endl;
+        return 1;
+    }
+
+    // Finds how many bytes the workload writes: doubles the offset until the workload completes before reaching it,
+    // then halves the range between the last offset that stopped it and the first that did not.
+    bool recovered = false;
+    long long byteCount = 1 << 16;
+    while (runTrial(program, byteCount, recovered) != 0)
+    {
+        CHECK(recovered);
+        byteCount *= 2;
+    }
+    CHECK(recovered);
+    long long stoppedOffset = byteCount / 2;
+    while (byteCount - stoppedOffset > 4096)
+    {
+        long long middle = stoppedOffset + (byteCount - stoppedOffset) / 2;
+        if (runTrial(program, middle, recovered) != 0)
+            stoppedOffset = middle;
+        else
+            byteCount = middle;
+        CHECK(recovered);
+    }
+    cout << "The workload writes about " << byteCount << " bytes" << endl;
+
+    mt19937_64 random(34);
+    size_t crashCount = 0;
+    for (size_t trial = 0; trial < trialCount; trial++)
+    {
+        long long faultOffset = static_cast<long long>(random() % static_cast<unsigned long long>(byteCount));
+        crashCount += runTrial(program, faultOffset, recovered) != 0;
+        CHECK(recovered);
+    }
+    cout << crashCount << " of " << trialCount << " runs crashed at a random offset" << endl;
+    return reportTestResult();
+}
@@ -0,0 +1,89 @@
+// This test checks that the LSM tree store reads back the newest version of every account
+// after its memtables are flushed to sorted runs and the runs are compacted, and after it is reopened.
+// Each round rewrites the accounts of one parity of ID with a new balance, so memtables fill and become runs
+// holding every other account; a lookup of an account of the other parity is ruled out by the run's bloom filter.
+
+#include <chrono>
+#include <thread>
+#include "Test-Support.h"
+#include "LsmAccountStore.h"
+using namespace std;
+
+// Waits until the background thread has merged the runs at least once and brought them back under the limit.
+static bool waitForCompaction(LsmAccountStore& store)
+{
+    for (int attempt = 0; attempt < 1200; attempt++)
+    {
+        StorageStatistics statistics = store.getStatistics();
+        if (statistics.compactions > 0 && statistics.sortedRuns <= LSM_MAX_RUN_COUNT)
+            return true;
+        this_thread::sleep_for(chrono::milliseconds(50));
+    }
+    return false;
+}
+
+// Checks that every account is found with its newest version, and only under its owner's national ID.
+static void checkEveryAccount(LsmAccountStore& store)
+{
+    int mismatchCount = 0;
+    for (size_t accountIndex = 0; accountIndex < accounts.size(); accountIndex++)
+    {
+        long long nationalID = parseLongLong(accounts[accountIndex][1]);
+        AccountRecord record;
+        if (!store.findRecord(nationalID, static_cast<int32_t>(accountIndex + 1), record) || convertAccountRecordToVector(record) != accounts[accountIndex])
+            mismatchCount++;
+    }
+    CHECK(mismatchCount == 0);
+    AccountRecord record;
+    CHECK(!store.findRecord(parseLongLong(accounts[0][1]) + 1, 1, record));
+    for (size_t personIndex = 0; personIndex < 50; personIndex++)
+    {
+        long long nationalID = getGeneratedNationalID(personIndex);
+        vector<AccountRecord> records;
+        store.findRecordsOfPerson(nationalID, records);
+        vector<vector<string>> found, expected;
+        for (const AccountRecord& personRecord : records)
+            found.push_back(convertAccountRecordToVector(personRecord));
+        for (const vector<string>& account : accounts)
+            if (parseLongLong(account[1]) == nationalID)
+                expected.push_back(account);
+        CHECK(found == expected);
+    }
+}
+
+int main()
+{
+    const size_t accountCount = 2 * LSM_MEMTABLE_RECORD_LIMIT + 5000; // Gives each parity more accounts than a memtable holds.
+    generatePersons(accountCount / 4);
+    generateAccounts(accountCount, accountCount / 4);
+    vector<vector<string>> loadedAccounts = accounts; // Keeps the accounts as they were saved, for the reopened store to update.
+
+    LsmAccountStore store;
+    store.open("Accounts.lsm");
+    store.rebuild(accounts); // Writes the accounts as a single run.
+    for (int round = 1; round <= 2 * (LSM_MAX_RUN_COUNT + 1); round++)
+    {
+        for (size_t accountIndex = round % 2; accountIndex < accounts.size(); accountIndex += 2)
+        {
+            accounts[accountIndex][2] = formatDouble(parseDouble(accounts[accountIndex][2]) + round); // Changes the balance.
+            store.updateRecord(accountIndex, accounts[accountIndex]);
+        }
+    }
+    CHECK(waitForCompaction(store));
+    StorageStatistics statistics = store.getStatistics();
+    cout << "After the updates: " << statistics.sortedRuns << " run(s), " << statistics.memtableRecords << " memtable records, "
+        << statistics.compactions << " compaction(s)" << endl;
+    checkEveryAccount(store);
+    statistics = store.getStatistics();
+    CHECK(statistics.bloomFilterSkips > 0);
+    cout << statistics.pointReads << " point reads, " << statistics.bloomFilterSkips << " runs skipped by their bloom filter" << endl;
+
+    // The reopened store finds the same versions, and brings the accounts as saved up to date.
+    store.close();
+    store.open("Accounts.lsm");
+    checkEveryAccount(store);
+    CHECK(store.applyTo(loadedAccounts) == static_cast<long long>(accountCount));
+    CHECK(loadedAccounts == accounts);
+    store.close();
+    return reportTestResult();
+}
@@ -0,0 +1,65 @@
+// This benchmark compares the numeric codec with the standard library functions it replaced,
+// field by field: the time to parse or format one field of each kind stored in the CSV files and account vectors.
+// Usage: Numeric-Benchmark [fieldCount], 1,000,000 fields of each kind by default.
+
+#include <iomanip>
+#include <functional>
+#include "Test-Support.h"
+#include "Numeric-Functions.h"
+using namespace std;
+
+// Runs the given function over every field and returns the time per field in nanoseconds, best of three runs.
+static double timePerField(size_t fieldCount, const function<double(size_t)>& convertField)
+{
+    double bestNanoseconds = 0;
+    for (int run = 0; run < 3; run++)
+    {
+        volatile double sink = 0; // Keeps the results alive, so the conversions are not optimized away.
+        Stopwatch stopwatch;
+        for (size_t i = 0; i < fieldCount; i++)
+            sink = sink + convertField(i);
+        double nanoseconds = stopwatch.getElapsedMilliseconds() * 1e6 / fieldCount;
+        if (run == 0 || nanoseconds < bestNanoseconds)
+            bestNanoseconds = nanoseconds;
+    }
+    return bestNanoseconds;
+}
+
+// Prints one row of the results.
+static void printRow(const string& field, double beforeNanoseconds, double afterNanoseconds)
+{
+    cout << left << setw(28) << field << setw(16) << fixed << setprecision(1) << beforeNanoseconds << setw(16) << afterNanoseconds
+        << setprecision(2) << beforeNanoseconds / afterNanoseconds << "x" << endl;
+}
+
+int main(int argc, char* argv[])
+{
+    size_t fieldCount = getBenchmarkSize(argc, argv, 1000000); // Stores the number of fields of each kind.
+    generatePersons(1000);
+    generateAccounts(fieldCount, 1000);
+    vector<string> ages(fieldCount); // Stores age fields, as in Persons.csv.
+    vector<long long> integers(fieldCount); // Stores account IDs to format.
+    vector<double> balances(fieldCount); // Stores balances to format.
+    for (size_t i = 0; i < fieldCount; i++)
+    {
+        ages[i] = to_string(MIN_AGE + i % (MAX_AGE - MIN_AGE));
+        integers[i] = static_cast<long long>(i + 1);
+        balances[i] = stod(accounts[i][2]);
+    }
+
+    cout << fieldCount << " fields of each kind" << endl;
+    cout << left << setw(28) << "Field" << setw(16) << "stdlib (ns)" << setw(16) << "codec (ns)" << "Speedup" << endl;
+    printRow("account ID (stoi)", timePerField(fieldCount, [](size_t i) { return stoi(accounts[i][0]); }),
+        timePerField(fieldCount, [](size_t i) { return parseInt(accounts[i][0]); }));
+    printRow("national ID (stoll)", timePerField(fieldCount, [](size_t i) { return static_cast<double>(stoll(accounts[i][1])); }),
+        timePerField(fieldCount, [](size_t i) { return static_cast<double>(parseLongLong(accounts[i][1])); }));
+    printRow("balance (stod)", timePerField(fieldCount, [](size_t i) { return stod(accounts[i][2]); }),
+        timePerField(fieldCount, [](size_t i) { return parseDouble(accounts[i][2]); }));
+    printRow("age (stoi)", timePerField(fieldCount, [&ages](size_t i) { return stoi(ages[i]); }),
+        timePerField(fieldCount, [&ages](size_t i) { return parseInt(ages[i]); }));
+    printRow("account ID (to_string)", timePerField(fieldCount, [&integers](size_t i) { return to_string(integers[i]).size(); }),
+        timePerField(fieldCount, [&integers](size_t i) { return formatInteger(integers[i]).size(); }));
+    printRow("balance (to_string)", timePerField(fieldCount, [&balances](size_t i) { return to_string(balances[i]).size(); }),
+        timePerField(fieldCount, [&balances](size_t i) { return formatDouble(balances[i]).size(); }));
+    return 0;
+}
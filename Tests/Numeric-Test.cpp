@@ -0,0 +1,65 @@
+// This test checks the numeric codec against the standard library functions it replaced:
+// the same values parse from the same fields, including the last field of a CRLF line, and format to the same text.
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include "Test-Support.h"
+#include "Numeric-Functions.h"
+#include "Exceptions.h"
+using namespace std;
+
+// Returns true if parsing the field as a double throws an InvalidNumberException.
+static bool rejectsDouble(const string& field)
+{
+    try
+    {
+        parseDouble(field);
+    }
+    catch (InvalidNumberException)
+    {
+        return true;
+    }
+    return false;
+}
+
+int main()
+{
+    // The fields of the CSV files parse with or without the carriage return of a CRLF line.
+    CHECK(parseDouble("30000.000000\r") == 30000.0);
+    CHECK(parseDouble(" 25.500000 ") == 25.5);
+    CHECK(parseLongLong("12345678912345\r\n") == 12345678912345LL);
+    CHECK(parseInt("\t42") == 42);
+
+    // A field that is empty or has other characters left over is still rejected.
+    CHECK(rejectsDouble(""));
+    CHECK(rejectsDouble("\r"));
+    CHECK(rejectsDouble("12.5x"));
+    CHECK(rejectsDouble("12 5"));
+
+    // Values halfway between two millionths, near the limit of the fast formatting path, negative or not finite format like to_string.
+    const double edgeValues[] = { 0.0, -0.0, -1e-9, 0.0000005, 0.0000015, 2.5e-7, 1.0000005, 123456.7890125, -42.4999995,
+        999999999.9999995, 1e9, -1e9, 1e12 + 0.5, 1e300, numeric_limits<double>::infinity(), numeric_limits<double>::quiet_NaN() };
+    for (double value : edgeValues)
+        CHECK(formatDouble(value) == to_string(value));
+
+    // Random values format like to_string and parse back like stoll and stod.
+    mt19937_64 random(27);
+    uniform_real_distribution<double> balances(0, 1e9);
+    for (int i = 0; i < 100000; i++)
+    {
+        long long integer = static_cast<long long>(random()) >> (random() % 64);
+        double balance = balances(random);
+        CHECK(formatInteger(integer) == to_string(integer));
+        CHECK(formatDouble(balance) == to_string(balance));
+        CHECK(parseLongLong(to_string(integer)) == stoll(to_string(integer)));
+        CHECK(parseDouble(to_string(balance)) == stod(to_string(balance)));
+
+        // Any magnitude, with the digits past the sixth decimal chosen at random, formats like to_string.
+        double value = ldexp(static_cast<double>(random() >> 11), static_cast<int>(random() % 80) - 70) * (random() % 2 ? 1 : -1);
+        CHECK(formatDouble(value) == to_string(value));
+        double nearHalf = (static_cast<double>(random() % 1000000000) + 0.5) / 1e6; // Lands on or near a halfway point.
+        CHECK(formatDouble(nearHalf) == to_string(nearHalf));
+    }
+    return reportTestResult();
+}
@@ -0,0 +1,98 @@
+// This test checks the certificate returns against reference values computed independently of the growth factor tables:
+// every table entry against std::pow, a few entries against their exact values worked out by hand,
+// and the returns of accounts of every product, as of dates before, inside and past their term, against the same references.
+// The returns are also read going back in time and past the term, so the cached accrual window is exercised.
+
+#include <cmath>
+#include "Test-Support.h"
+#include "CertificateAccount.h"
+#include "ProductCatalog.h"
+using namespace std;
+
+// The largest relative error accepted between a growth factor and its reference value.
+const double RELATIVE_TOLERANCE = 1e-12;
+
+// Returns true if the value is within the relative tolerance of the reference value.
+static bool isClose(double value, double reference)
+{
+    return fabs(value - reference) <= fabs(reference) * RELATIVE_TOLERANCE;
+}
+
+// Returns the growth factor of a product's rate after the given number of periods, computed with pow.
+static double getReferenceGrowthFactor(const CertificateProduct& product, double ratePercent, int periods)
+{
+    int periodsPerYear = product.compounding == InterestCompounding::Monthly ? 12 : 1;
+    if (product.compounding == InterestCompounding::Simple)
+        return 1 + periods * ratePercent / 100;
+    return pow(1 + ratePercent / 100 / periodsPerYear, periods);
+}
+
+// Returns a certificate of the given product and rate with the given deposit, created on the 1st of January 2024.
+static CertificateAccount makeCertificate(CertificateProductID productID, double deposit, double ratePercent)
+{
+    return convertAccountVectorToCertificateAccountObject({ "1", formatInteger(getGeneratedNationalID(0)), formatDouble(deposit),
+        "124-0-1-12-0-0", formatDouble(ratePercent), "0", formatInteger(static_cast<int>(productID)) });
+}
+
+// Checks the returns of a certificate as of every period boundary of its term and beyond, reading the dates forwards then backwards.
+static void checkAccountReturns(const CertificateProduct& product, double deposit, double ratePercent)
+{
+    CertificateAccount account = makeCertificate(product.id, deposit, ratePercent);
+    const CertificateAccrualState& state = account.getAccrualState();
+    int termPeriods = product.termYears * (product.compounding == InterestCompounding::Monthly ? 12 : 1);
+    int lastPeriod = termPeriods > 0 ? termPeriods + 3 : 10; // Goes past the term, where the returns stop growing.
+    for (int pass = 0; pass < 2; pass++)
+    {
+        for (int step = 0; step <= lastPeriod; step++)
+        {
+            int period = pass == 0 ? step : lastPeriod - step;
+            time_t asOf = state.creationTime + static_cast<time_t>(period) * state.periodSeconds + state.periodSeconds / 2; // Falls inside the period.
+            int earningPeriods = termPeriods > 0 && period > termPeriods ? termPeriods : period;
+            double expected = deposit * (getReferenceGrowthFactor(product, ratePercent, earningPeriods) - 1);
+            CHECK(fabs(account.getTotalReturnsAsOf(asOf) - expected) <= deposit * RELATIVE_TOLERANCE);
+            CHECK(fabs(account.getTotalReturnsAsOf(asOf) - expected) <= deposit * RELATIVE_TOLERANCE); // Reads the cached value.
+        }
+    }
+    CHECK(account.getTotalReturnsAsOf(state.creationTime - 1) == 0); // Nothing accrues before the account is created.
+}
+
+int main()
+{
+    // Every table entry within a product's term matches pow.
+    int checkedEntries = 0;
+    for (const CertificateProduct& product : CERTIFICATE_PRODUCTS)
+    {
+        int termPeriods = product.termYears * (product.compounding == InterestCompounding::Monthly ? 12 : 1);
+        for (int tier = 0; tier < product.tierCount; tier++)
+        {
+            for (int period = 0; period <= termPeriods; period++)
+            {
+                double factor = GROWTH_FACTOR_TABLES.tables[static_cast<int>(product.id)].factors[tier][period];
+                CHECK(isClose(factor, getReferenceGrowthFactor(product, product.tiers[tier].ratePercent, period)));
+                checkedEntries++;
+            }
+        }
+    }
+
+    // The last entry of each compounding tier matches its exact value, rounded to a double.
+    const GrowthFactorTable& annual = GROWTH_FACTOR_TABLES.tables[static_cast<int>(CertificateProductID::ThreeYearCompounding)];
+    CHECK(isClose(annual.factors[0][3], 1.728)); // 1.2 to the 3rd
+    CHECK(isClose(annual.factors[2][3], 1.860867)); // 1.23 to the 3rd
+    CHECK(isClose(annual.factors[1][2], 1.476225)); // 1.215 to the 2nd
+    const GrowthFactorTable& monthly = GROWTH_FACTOR_TABLES.tables[static_cast<int>(CertificateProductID::FiveYearMonthly)];
+    CHECK(isClose(monthly.factors[0][60], 3.2810307883654111)); // 1.02 to the 60th
+    CHECK(isClose(monthly.factors[1][60], 3.5312150959270996)); // 1.02125 to the 60th
+    CHECK(isClose(monthly.factors[2][60], 3.8001347859463839)); // 1.0225 to the 60th
+    const GrowthFactorTable& fiveYear = GROWTH_FACTOR_TABLES.tables[static_cast<int>(CertificateProductID::FiveYear)];
+    CHECK(isClose(fiveYear.factors[1][5], 2.425)); // 1 + 5 * 0.285
+
+    // The returns of accounts of every tier, and of a rate outside the catalog, match the references as of any date.
+    for (const CertificateProduct& product : CERTIFICATE_PRODUCTS)
+    {
+        for (int tier = 0; tier < product.tierCount; tier++)
+            checkAccountReturns(product, product.tiers[tier].minimumBalance, product.tiers[tier].ratePercent);
+        checkAccountReturns(product, product.minimumDeposit, product.tiers[0].ratePercent + 0.75); // Computed without the table.
+    }
+    cout << checkedEntries << " table entries and the returns of " << CERTIFICATE_PRODUCT_COUNT << " products match pow" << endl;
+    return reportTestResult();
+}
@@ -0,0 +1,43 @@
+// This benchmark measures how the bank-wide report scales with the number of worker threads.
+// It builds a synthetic bank, then times generateBankReport with 1, 2, 4, ... threads up to the largest thread count,
+// and prints the speedup of each run over the single-threaded one.
+// Usage: Report-Benchmark [accountCount] [maxThreadCount], 10,000,000 accounts and one thread per hardware thread by default.
+
+#include <thread>
+#include <iomanip>
+#include "Test-Support.h"
+#include "Report-Functions.h"
+using namespace std;
+
+int main(int argc, char* argv[])
+{
+    size_t accountCount = getBenchmarkSize(argc, argv, 10000000); // Stores the number of accounts to report on.
+    size_t personCount = accountCount / 4 + 1; // Gives every person about four accounts.
+    generatePersons(personCount);
+    generateAccounts(accountCount, personCount);
+    time_t asOf = 1735689600; // Evaluates every run as of 2025-01-01, so they all compute the same totals.
+    generateBankReport(asOf, 1); // Publishes the account versions once, outside the timed runs.
+
+    int hardwareThreadCount = max(1, static_cast<int>(thread::hardware_concurrency())); // Stores the number of hardware threads.
+    int maxThreadCount = argc > 2 ? max(1, atoi(argv[2])) : hardwareThreadCount; // Stores the largest number of threads to run with.
+    cout << accountCount << " accounts, " << personCount << " persons, " << hardwareThreadCount << " hardware thread(s)" << endl;
+    cout << left << setw(10) << "Threads" << setw(14) << "Time (ms)" << "Speedup" << endl;
+    double singleThreadMilliseconds = 0; // Stores the time of the single-threaded run.
+    for (int threadCount = 1; ; threadCount = min(threadCount * 2, maxThreadCount))
+    {
+        double bestMilliseconds = 0; // Stores the best of three runs, to leave out the runs slowed by other processes.
+        for (int run = 0; run < 3; run++)
+        {
+            BankReport report = generateBankReport(asOf, threadCount);
+            if (run == 0 || report.elapsedMilliseconds < bestMilliseconds)
+                bestMilliseconds = report.elapsedMilliseconds;
+        }
+        if (threadCount == 1)
+            singleThreadMilliseconds = bestMilliseconds;
+        cout << left << setw(10) << threadCount << setw(14) << fixed << setprecision(1) << bestMilliseconds
+            << setprecision(2) << singleThreadMilliseconds / bestMilliseconds << "x" << endl;
+        if (threadCount == maxThreadCount)
+            break;
+    }
+    return 0;
+}
@@ -0,0 +1,64 @@
+// This benchmark measures the cold-start load of a generated bank from the binary snapshot and from the CSV files.
+// It writes both formats once, then times readBankSnapshot and the CSV import that the snapshot replaces at startup.
+// Usage: Snapshot-Benchmark [accountCount], 1,000,000 accounts by default; the bank has one person per four accounts.
+
+#include <iomanip>
+#include "Test-Support.h"
+#include "Snapshot-Functions.h"
+using namespace std;
+
+int main(int argc, char* argv[])
+{
+    size_t accountCount = getBenchmarkSize(argc, argv, 1000000); // Stores the number of accounts to load.
+    size_t personCount = accountCount / 4 + 1; // Gives every person about four accounts.
+    generatePersons(personCount);
+    generateAccounts(accountCount, personCount);
+    writeAllSavedPersonsToTheCSVFile(); // Writes the CSV files first, so the snapshot is stamped against them.
+    writeAllSavedAccountToCSVFile();
+    writeBankSnapshot(SNAPSHOT_FILE_PATH);
+    vector<vector<string>> expectedAccounts = accounts; // Keeps the accounts, to check that both loads return them.
+
+    cout << accountCount << " accounts, " << personCount << " persons" << endl;
+    cout << left << setw(22) << "Load" << setw(14) << "Time (ms)" << "Accounts/s" << endl;
+    double bestSnapshotMilliseconds = 0, bestCSVMilliseconds = 0;
+    for (int run = 0; run < 3; run++)
+    {
+        persons.clear();
+        accounts.clear();
+        personTextArena.release();
+        Stopwatch stopwatch;
+        if (!readBankSnapshot(SNAPSHOT_FILE_PATH))
+        {
+            cout << "The snapshot was not loaded" << endl;
+            return 1;
+        }
+        double milliseconds = stopwatch.getElapsedMilliseconds();
+        if (run == 0 || milliseconds < bestSnapshotMilliseconds)
+            bestSnapshotMilliseconds = milliseconds;
+        if (accounts != expectedAccounts || persons.size() != personCount)
+        {
+            cout << "The snapshot did not load the accounts it was written from" << endl;
+            return 1;
+        }
+
+        persons.clear();
+        accounts.clear();
+        personTextArena.release();
+        stopwatch.restart();
+        readAllSavedPersonsToThePersonsVector();
+        readAllSavedAccountsToTheAccountsVector();
+        milliseconds = stopwatch.getElapsedMilliseconds();
+        if (run == 0 || milliseconds < bestCSVMilliseconds)
+            bestCSVMilliseconds = milliseconds;
+        if (accounts != expectedAccounts || persons.size() != personCount)
+        {
+            cout << "The CSV files did not load the accounts they were written from" << endl;
+            return 1;
+        }
+    }
+    cout << left << setw(22) << "Binary snapshot" << setw(14) << fixed << setprecision(1) << bestSnapshotMilliseconds
+        << setprecision(0) << accountCount / bestSnapshotMilliseconds * 1000 << endl;
+    cout << left << setw(22) << "CSV import" << setw(14) << setprecision(1) << bestCSVMilliseconds
+        << setprecision(0) << accountCount / bestCSVMilliseconds * 1000 << endl;
+    return 0;
+}
@@ -0,0 +1,73 @@
+// This benchmark measures how long the foreground is held up by the background snapshots:
+// the time startBackgroundSnapshot takes to pin the accounts and copy the persons before it returns,
+// and the latency of single account updates, which start a snapshot every BACKGROUND_SNAPSHOT_CHANGE_INTERVAL changes,
+// split by whether a snapshot was being written meanwhile.
+// Usage: Snapshot-Pause-Benchmark [accountCount] [updateCount], 1,000,000 accounts and 20,000 updates by default;
+// the bank has one person per four accounts.
+
+#include <algorithm>
+#include <iomanip>
+#include "Test-Support.h"
+#include "Snapshot-Functions.h"
+using namespace std;
+
+// Prints the count, median, 99th percentile and maximum of the given times in milliseconds.
+static void printPercentiles(const string& name, vector<double> milliseconds)
+{
+    cout << left << setw(38) << name << setw(10) << milliseconds.size();
+    if (milliseconds.empty())
+    {
+        cout << endl;
+        return;
+    }
+    sort(milliseconds.begin(), milliseconds.end());
+    auto percentile = [&milliseconds](double fraction) { return milliseconds[min(milliseconds.size() - 1, static_cast<size_t>(fraction * milliseconds.size()))]; };
+    cout << fixed << setprecision(3) << setw(12) << percentile(0.5) << setw(12) << percentile(0.99) << milliseconds.back() << endl;
+}
+
+int main(int argc, char* argv[])
+{
+    size_t accountCount = getBenchmarkSize(argc, argv, 1000000); // Stores the number of accounts.
+    size_t updateCount = argc > 2 ? static_cast<size_t>(atoll(argv[2])) : 20000; // Stores the number of account updates.
+    size_t personCount = accountCount / 4 + 1; // Gives every person about four accounts.
+    generatePersons(personCount);
+    generateAccounts(accountCount, personCount);
+    writeAllSavedPersonsToTheCSVFile();
+    persistAllAccounts(); // Builds the account store, so updates write a single record.
+    prepareAccountVersions(); // Publishes the accounts once, as the first report or snapshot after a load does.
+
+    // Times the start of snapshots, each written completely before the next one starts.
+    vector<double> startTimes;
+    double writeMilliseconds = 0;
+    for (int i = 0; i < 10; i++)
+    {
+        Stopwatch stopwatch;
+        startBackgroundSnapshot(SNAPSHOT_FILE_PATH);
+        startTimes.push_back(stopwatch.getElapsedMilliseconds());
+        waitForBackgroundSnapshot();
+        writeMilliseconds = max(writeMilliseconds, stopwatch.getElapsedMilliseconds());
+    }
+
+    // Times single account updates, some of which start a snapshot or run while one is written.
+    vector<double> idleTimes, duringSnapshotTimes;
+    mt19937_64 random(33);
+    for (size_t i = 0; i < updateCount; i++)
+    {
+        size_t accountIndex = random() % accounts.size();
+        bool snapshotRunning = isBackgroundSnapshotRunning();
+        Stopwatch stopwatch;
+        accounts[accountIndex][2] = formatDouble(parseDouble(accounts[accountIndex][2]) + 1);
+        persistAccountUpdates({ accountIndex });
+        double milliseconds = stopwatch.getElapsedMilliseconds();
+        (snapshotRunning || isBackgroundSnapshotRunning() ? duringSnapshotTimes : idleTimes).push_back(milliseconds);
+    }
+    waitForBackgroundSnapshot();
+
+    cout << accountCount << " accounts, " << personCount << " persons; a background snapshot takes up to "
+        << fixed << setprecision(0) << writeMilliseconds << " ms to write" << endl;
+    cout << left << setw(38) << "Foreground pause (ms)" << setw(10) << "Count" << setw(12) << "p50" << setw(12) << "p99" << "Max" << endl;
+    printPercentiles("startBackgroundSnapshot", startTimes);
+    printPercentiles("Update, no snapshot running", idleTimes);
+    printPercentiles("Update, snapshot started or running", duringSnapshotTimes);
+    return 0;
+}
@@ -0,0 +1,119 @@
+// This file contains the helpers shared by the tests and benchmarks:
+// a check that counts failures instead of stopping at the first one, a stopwatch,
+// and generators that fill the 'persons' and 'accounts' vectors with a synthetic bank of any size.
+
+// These are the include guards
+#pragma once
+#ifndef TESTSUPPORT_H
+#define TESTSUPPORT_H
+
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <iostream>
+#include "Program-Data-Functions.h"
+#include "Conversion-Functions.h"
+#include "Numeric-Functions.h"
+#include "Constants.h"
+using namespace std;
+
+// Counts the checks that failed in the running test
+inline int& getFailedCheckCount()
+{
+	static int failedCheckCount = 0;
+	return failedCheckCount;
+}
+
+// Reports a failed check with its location, and lets the test go on
+#define CHECK(condition) \
+	do { if (!(condition)) { cerr << __FILE__ << ":" << __LINE__ << ": check failed: " #condition << endl; getFailedCheckCount()++; } } while (false)
+
+// Prints the result of the test and returns the exit code of its main function
+inline int reportTestResult()
+{
+	if (getFailedCheckCount() == 0)
+	{
+		cout << "All checks passed" << endl;
+		return 0;
+	}
+	cout << getFailedCheckCount() << " check(s) failed" << endl;
+	return 1;
+}
+
+// Returns the size given as the first argument of a benchmark, or the default size
+inline size_t getBenchmarkSize(int argc, char* argv[], size_t defaultSize)
+{
+	return argc > 1 ? static_cast<size_t>(atoll(argv[1])) : defaultSize;
+}
+
+// Measures the wall-clock time since it was created or restarted
+class Stopwatch
+{
+private:
+	chrono::steady_clock::time_point startTime;
+
+public:
+	Stopwatch() : startTime(chrono::steady_clock::now())
+	{
+	}
+
+	void restart()
+	{
+		startTime = chrono::steady_clock::now();
+	}
+
+	double getElapsedMilliseconds() const
+	{
+		return chrono::duration<double, milli>(chrono::steady_clock::now() - startTime).count();
+	}
+};
+
+// Returns the national ID of the generated person at the given position; the IDs are sorted like the 'persons' vector
+inline long long getGeneratedNationalID(size_t personIndex)
+{
+	return 10000000000000LL + static_cast<long long>(personIndex);
+}
+
+/*
+	Replaces the 'persons' vector with the given number of generated persons, sorted by national ID.
+	Their names and phone numbers are stored in the person text arena.
+*/
+inline void generatePersons(size_t personCount)
+{
+	persons.clear();
+	personTextArena.release();
+	persons.reserve(personCount);
+	mt19937_64 random(personCount);
+	for (size_t i = 0; i < personCount; i++)
+		persons.emplace_back("Person " + formatInteger(static_cast<long long>(i)), MIN_AGE + static_cast<int>(random() % (MAX_AGE - MIN_AGE + 1)),
+			getGeneratedNationalID(i), "+1415555" + formatInteger(static_cast<long long>(1000 + i % 9000)));
+}
+
+/*
+	Replaces the 'accounts' vector with the given number of generated accounts, owned in turn by the given number of persons.
+	One account in four is a Classic certificate, the others are saving accounts; the balances are random.
+	Drops the accrual states and versions of the accounts held before.
+*/
+inline void generateAccounts(size_t accountCount, size_t personCount)
+{
+	accounts.clear();
+	accounts.reserve(accountCount);
+	mt19937_64 random(accountCount);
+	for (size_t i = 0; i < accountCount; i++)
+	{
+		string balance = formatDouble(static_cast<double>(MIN_BALANCE + random() % 1000000)); // Stores a balance above the minimum.
+		string dateTime = formatInteger(100 + static_cast<long long>(random() % 25)) + "-" + formatInteger(static_cast<long long>(random() % 12)) + "-"
+			+ formatInteger(1 + static_cast<long long>(random() % 28)) + "-12-0-0"; // Stores a creation time between 2000 and 2024.
+		if (i % 4 == 3)
+			accounts.push_back({ formatInteger(static_cast<long long>(i + 1)), formatInteger(getGeneratedNationalID(i % personCount)), balance, dateTime,
+				formatDouble(INTEREST_RATE_PERCENT), formatDouble(0), "0" });
+		else
+			accounts.push_back({ formatInteger(static_cast<long long>(i + 1)), formatInteger(getGeneratedNationalID(i % personCount)), balance, dateTime, "", "", "" });
+	}
+	accrualCache.clear();
+	accountVersions.clear();
+}
+
+#endif
@@ -0,0 +1,76 @@
+// This benchmark measures the throughput of the CSV tokenizer with each delimiter scanner the CPU supports,
+// and of the find/substr splitting it replaced, on the text of a generated Accounts.csv file with CRLF line endings.
+// Usage: Tokenizer-Benchmark [accountCount], 2,000,000 accounts (about 130 MB) by default.
+
+#include <iomanip>
+#include <sstream>
+#include "Test-Support.h"
+#include "Tokenizer-Functions.h"
+using namespace std;
+
+// Returns the best throughput of three runs of the given function over the text, in GB/s.
+template <class Function>
+static double measureGigabytesPerSecond(const string& text, Function tokenize)
+{
+    double bestMilliseconds = 0;
+    for (int run = 0; run < 3; run++)
+    {
+        Stopwatch stopwatch;
+        tokenize();
+        double milliseconds = stopwatch.getElapsedMilliseconds();
+        if (run == 0 || milliseconds < bestMilliseconds)
+            bestMilliseconds = milliseconds;
+    }
+    return text.size() / (bestMilliseconds * 1e6);
+}
+
+int main(int argc, char* argv[])
+{
+    size_t accountCount = getBenchmarkSize(argc, argv, 2000000); // Stores the number of lines of the generated file.
+    generateAccounts(accountCount, accountCount / 4 + 1);
+    string text; // Stores the text of the generated file.
+    for (const vector<string>& account : accounts)
+        text += convertVectorToCSVString(account) + "\r\n";
+    accounts.clear();
+    cout << accountCount << " lines, " << fixed << setprecision(1) << text.size() / 1e6 << " MB" << endl;
+    cout << left << setw(28) << "Tokenizer" << "GB/s" << endl;
+
+    // Splits every line with find and substr, as the loader did before the tokenizer.
+    size_t referenceFieldCount = 0;
+    double referenceRate = measureGigabytesPerSecond(text, [&text, &referenceFieldCount]()
+        {
+            istringstream input(text);
+            string line;
+            referenceFieldCount = 0;
+            while (getline(input, line))
+            {
+                vector<string> fields;
+                size_t start = 0, comma;
+                while ((comma = line.find(',', start)) != string::npos)
+                {
+                    fields.push_back(line.substr(start, comma - start));
+                    start = comma + 1;
+                }
+                fields.push_back(line.substr(start));
+                referenceFieldCount += fields.size();
+            }
+        });
+    cout << left << setw(28) << "find/substr per line" << setprecision(2) << referenceRate << endl;
+
+    const char* scannerNames[] = { "Scalar", "SSE2", "AVX2" };
+    vector<CSVField> fields;
+    vector<size_t> recordEnds;
+    for (const char* scannerName : scannerNames)
+    {
+        if (!selectCSVScanner(scannerName))
+            continue;
+        double rate = measureGigabytesPerSecond(text, [&text, &fields, &recordEnds]() { tokenizeCSV(text, fields, recordEnds); });
+        if (fields.size() != referenceFieldCount)
+        {
+            cout << scannerName << " found " << fields.size() << " fields instead of " << referenceFieldCount << endl;
+            return 1;
+        }
+        cout << left << setw(28) << (string("tokenizeCSV, ") + scannerName) << setprecision(2) << rate << endl;
+    }
+    return 0;
+}
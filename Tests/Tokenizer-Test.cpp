@@ -0,0 +1,137 @@
+// This test compares every delimiter scanner the CPU supports with a plain reference splitter on random CSV text.
+// The text mixes quotes, commas inside quotes, CRLF and LF line endings, stray carriage returns and empty lines,
+// at random lengths and alignments, so the block loops, their tails and the unaligned loads are all exercised.
+// The CSV files have no quoting, so a quote is an ordinary character and a comma always separates two fields;
+// every scanner must split quoted text exactly like the reference does.
+
+#include <random>
+#include <string>
+#include <vector>
+#include "Test-Support.h"
+#include "Tokenizer-Functions.h"
+using namespace std;
+
+// Splits the text like the line-by-line loader did: lines end at '\n', lose one trailing '\r', empty lines are skipped,
+// and fields are separated by ','.
+static vector<vector<string>> splitReference(const string& text)
+{
+    vector<vector<string>> records;
+    size_t lineStart = 0;
+    while (lineStart <= text.size())
+    {
+        size_t lineEnd = text.find('\n', lineStart);
+        if (lineEnd == string::npos)
+            lineEnd = text.size();
+        string line = text.substr(lineStart, lineEnd - lineStart);
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        if (!line.empty())
+        {
+            vector<string> fields;
+            size_t fieldStart = 0, comma;
+            while ((comma = line.find(',', fieldStart)) != string::npos)
+            {
+                fields.push_back(line.substr(fieldStart, comma - fieldStart));
+                fieldStart = comma + 1;
+            }
+            fields.push_back(line.substr(fieldStart));
+            records.push_back(fields);
+        }
+        lineStart = lineEnd + 1;
+    }
+    return records;
+}
+
+// Returns the records found by tokenizeCSV, as strings.
+static vector<vector<string>> splitTokenized(string_view text)
+{
+    vector<CSVField> fields;
+    vector<size_t> recordEnds;
+    tokenizeCSV(text, fields, recordEnds);
+    vector<vector<string>> records;
+    size_t firstField = 0;
+    for (size_t recordEnd : recordEnds)
+    {
+        vector<string> record;
+        for (size_t i = firstField; i < recordEnd; i++)
+            record.emplace_back(text.substr(fields[i].offset, fields[i].length));
+        records.push_back(record);
+        firstField = recordEnd;
+    }
+    return records;
+}
+
+// Returns random CSV text of the given length, built from fields that may be quoted and may hold commas.
+static string generateCSVText(mt19937_64& random, size_t length)
+{
+    static const string plainCharacters = "abcXYZ019 .+-_\"";
+    string text;
+    while (text.size() < length)
+    {
+        switch (random() % 10)
+        {
+        case 0:
+            text += "\r\n"; // Ends a line the Windows way.
+            break;
+        case 1:
+            text += '\n'; // Ends a line the Unix way, or adds an empty line after another line ending.
+            break;
+        case 2:
+            text += ','; // Separates two fields, possibly empty.
+            break;
+        case 3:
+            text += "\"a,b\""; // Adds a quoted field holding a comma.
+            break;
+        case 4:
+            text += '\r'; // Adds a stray carriage return in the middle of a line.
+            break;
+        default:
+            for (size_t run = random() % 40; run > 0; run--)
+                text += plainCharacters[random() % plainCharacters.size()]; // Adds a run of ordinary characters, so some blocks hold no delimiter.
+        }
+    }
+    text.resize(length);
+    return text;
+}
+
+int main()
+{
+    const char* scannerNames[] = { "Scalar", "SSE2", "AVX2" };
+    mt19937_64 random(28);
+    for (const char* scannerName : scannerNames)
+    {
+        if (!selectCSVScanner(scannerName))
+        {
+            cout << scannerName << " is not supported here, skipped" << endl;
+            continue;
+        }
+        int comparedTexts = 0;
+        for (int round = 0; round < 20000; round++)
+        {
+            size_t length = round < 2000 ? round % 100 : random() % 2000; // Covers every short length, then longer texts.
+            string buffer = generateCSVText(random, length + 64);
+            size_t offset = random() % 64; // Starts the text at any alignment.
+            string_view text(buffer.data() + offset, length);
+            string copy(text);
+            vector<vector<string>> expected = splitReference(copy);
+            vector<vector<string>> actual = splitTokenized(text);
+            CHECK(actual == expected);
+
+            // A single line splits like the reference does, once its newlines are removed.
+            string line = copy;
+            for (char& character : line)
+                if (character == '\n')
+                    character = ' ';
+            vector<CSVField> lineFields;
+            splitCSVLine(line, lineFields);
+            vector<string> lineActual;
+            for (const CSVField& field : lineFields)
+                lineActual.push_back(line.substr(field.offset, field.length));
+            vector<vector<string>> lineExpected = splitReference(line);
+            CHECK(lineActual == (lineExpected.empty() ? vector<string>{ "" } : lineExpected[0]));
+            comparedTexts++;
+        }
+        cout << scannerName << ": " << comparedTexts << " random texts match the reference" << endl;
+    }
+    return reportTestResult();
+}
@@ -0,0 +1,69 @@
+// This benchmark applies the same generated transaction file with 1, 2, 4 ... shards, up to the given count,
+// to show how the throughput and latency of the thread-per-core engine scale with the number of shards.
+// The file mixes deposits, withdrawals and transfers between random accounts, so about half of the transfers cross shards;
+// it has no closures, so every run starts from the same bank. The time covers the submissions and the last completion,
+// not the persistence of the changed accounts that follows.
+// Shards are pinned to their own core only when there are no more of them than hardware threads,
+// so the counts past the number of cores show the cost of oversubscribing them instead.
+// Usage: Transaction-Benchmark [transactionCount] [maxShardCount], 1,000,000 transactions over 100,000 accounts and up to 8 shards by default.
+
+#include <iomanip>
+#include <fstream>
+#include <thread>
+#include "Test-Support.h"
+#include "Transaction-Functions.h"
+using namespace std;
+
+const size_t ACCOUNT_COUNT = 100000;
+
+// Writes a file of random deposits, withdrawals and transfers between the generated accounts.
+static void writeTransactionFile(const string& filePath, size_t transactionCount)
+{
+    ofstream transactionFile(filePath, ios::out | ios::binary);
+    mt19937_64 random(48);
+    for (size_t i = 0; i < transactionCount; i++)
+    {
+        size_t accountID = random() % ACCOUNT_COUNT + 1;
+        int amount = static_cast<int>(random() % 100) + 1;
+        switch (random() % 4)
+        {
+        case 0:
+            transactionFile << "deposit," << accountID << "," << amount << "\n";
+            break;
+        case 1:
+            transactionFile << "withdrawal," << accountID << "," << amount << "\n";
+            break;
+        default:
+            transactionFile << "transfer," << accountID << "," << random() % ACCOUNT_COUNT + 1 << "," << amount << "\n";
+            break;
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    size_t transactionCount = getBenchmarkSize(argc, argv, 1000000); // Stores the number of transactions in the file.
+    int maxShardCount = argc > 2 ? atoi(argv[2]) : 8; // Stores the largest number of shards to run.
+    generatePersons(ACCOUNT_COUNT / 4 + 1);
+    generateAccounts(ACCOUNT_COUNT, ACCOUNT_COUNT / 4 + 1);
+    persistAllAccounts(); // Writes the store the changed accounts are persisted to after each run.
+    vector<vector<string>> initialAccounts = accounts; // Keeps the bank, to start every run from it.
+    writeTransactionFile("Transactions.csv", transactionCount);
+    vector<TransactionRequest> requests = readTransactionFile("Transactions.csv");
+
+    cout << transactionCount << " transactions over " << ACCOUNT_COUNT << " accounts, " << thread::hardware_concurrency() << " hardware thread(s)" << endl;
+    cout << left << setw(10) << "Shards" << setw(14) << "Time (ms)" << setw(18) << "Transactions/s" << setw(12) << "p50 (us)"
+        << setw(12) << "p99 (us)" << "p99.9 (us)" << endl;
+    for (int shardCount = 1; shardCount <= maxShardCount; shardCount *= 2)
+    {
+        accounts = initialAccounts;
+        persistAllAccounts();
+        TransactionRunSummary summary = processTransactions(requests, shardCount);
+        CHECK(summary.shardCount == shardCount);
+        CHECK(summary.statusCounts[static_cast<int>(TransactionStatus::Applied)] > 0);
+        cout << left << setw(10) << shardCount << fixed << setprecision(1) << setw(14) << summary.elapsedMilliseconds << setprecision(0)
+            << setw(18) << summary.transactionsPerSecond << setprecision(1) << setw(12) << summary.p50LatencyMicroseconds
+            << setw(12) << summary.p99LatencyMicroseconds << summary.p999LatencyMicroseconds << endl;
+    }
+    return reportTestResult();
+}
@@ -0,0 +1,93 @@
+// This test applies a run of transactions that changes balances and closes a person in the same run,
+// then checks that the account store holds the changed balances of the remaining accounts:
+// the menu lookups read the store, and a reload applies the store over the accounts read from the CSV file.
+// Closing the person removes their records from the store in place, so the run's changes must reach the records kept.
+// The run uses the store selected by ACCOUNT_STORE_BACKEND; AccountStore-Test checks the removals of every store directly.
+
+#include "Test-Support.h"
+#include "Transaction-Functions.h"
+using namespace std;
+
+const size_t PERSON_COUNT = 200;
+const size_t ACCOUNT_COUNT = 1000;
+
+// Returns the accounts of the person with the given national ID, scanned from the accounts vector.
+static vector<vector<string>> scanAccountsOfPerson(long long nationalID)
+{
+    vector<vector<string>> personAccounts;
+    for (const vector<string>& account : accounts)
+        if (parseLongLong(account[1]) == nationalID)
+            personAccounts.push_back(account);
+    return personAccounts;
+}
+
+// Checks that the menu lookups, which read the account store, see the same accounts as the accounts vector.
+static void checkStoreLookups()
+{
+    for (size_t personIndex = 0; personIndex < PERSON_COUNT; personIndex++)
+    {
+        long long nationalID = getGeneratedNationalID(personIndex);
+        CHECK(findAccountsOfPerson(nationalID) == scanAccountsOfPerson(nationalID));
+    }
+    for (size_t accountIndex = 0; accountIndex < accounts.size(); accountIndex++)
+    {
+        vector<string> account;
+        CHECK(readAccountOfPerson(static_cast<int>(accountIndex + 1), parseLongLong(accounts[accountIndex][1]), account) && account == accounts[accountIndex]);
+    }
+}
+
+int main()
+{
+    generatePersons(PERSON_COUNT);
+    generateAccounts(ACCOUNT_COUNT, PERSON_COUNT);
+    writeAllSavedPersonsToTheCSVFile();
+    persistAllAccounts();
+    saveProgramData();
+
+    long long closedNationalID = getGeneratedNationalID(7); // Closes a person whose accounts lie between the changed ones.
+    vector<TransactionRequest> requests;
+    for (size_t accountIndex = 0; accountIndex < accounts.size(); accountIndex += 3)
+    {
+        TransactionRequest request;
+        request.type = isSavingAccountVector(accounts[accountIndex]) ? TransactionType::Deposit : TransactionType::Withdrawal;
+        request.accountIndex = accountIndex;
+        request.amount = 1;
+        requests.push_back(request);
+    }
+    TransactionRequest transfer;
+    transfer.type = TransactionType::Transfer;
+    transfer.accountIndex = accounts.size() - 1;
+    transfer.targetAccountIndex = 0;
+    transfer.amount = 1;
+    if (isSavingAccountVector(accounts[0]))
+        requests.push_back(transfer);
+    TransactionRequest closure;
+    closure.type = TransactionType::Closure;
+    closure.nationalID = closedNationalID;
+    requests.push_back(closure);
+    vector<vector<string>> initialAccounts = accounts;
+
+    TransactionRunSummary summary = processTransactions(requests, 2);
+    CHECK(summary.statusCounts[static_cast<int>(TransactionStatus::Applied)] > 1);
+    CHECK(searchPersonIndex(closedNationalID) == -1);
+    CHECK(scanAccountsOfPerson(closedNationalID).empty());
+    CHECK(accounts.size() < initialAccounts.size());
+    size_t changedCount = 0; // Counts the remaining accounts whose balance the run changed.
+    for (size_t accountIndex = 0, initialIndex = 0; accountIndex < accounts.size(); accountIndex++, initialIndex++)
+    {
+        while (parseLongLong(initialAccounts[initialIndex][1]) == closedNationalID)
+            initialIndex++; // Skips the closed accounts.
+        changedCount += accounts[accountIndex][2] != initialAccounts[initialIndex][2];
+    }
+    CHECK(changedCount > 0);
+    checkStoreLookups();
+
+    // A reload reads the Accounts.csv file written by the run, then applies the store's records over it.
+    vector<vector<string>> expectedAccounts = accounts;
+    loadProgramData();
+    CHECK(accounts == expectedAccounts);
+    CHECK(searchPersonIndex(closedNationalID) == -1);
+    checkStoreLookups();
+    cout << changedCount << " changed balances kept in the store after closing a person" << endl;
+    return reportTestResult();
+}
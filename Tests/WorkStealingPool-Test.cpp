@@ -0,0 +1,53 @@
+// This test checks that the work-stealing pool runs every submitted task once, rethrows the first task error,
+// and that its idle workers block instead of polling, so an idle pool uses no CPU time.
+
+#include <ctime>
+#include <atomic>
+#include <thread>
+#include <stdexcept>
+#include "Test-Support.h"
+#include "WorkStealingPool.h"
+using namespace std;
+
+int main()
+{
+    WorkStealingPool pool(4); // Starts four workers, whatever the number of hardware threads.
+
+    // Every task runs exactly once, including tasks submitted by other tasks.
+    atomic<long long> sum(0);
+    for (int i = 1; i <= 10000; i++)
+        pool.submit([&sum, &pool, i](int) { sum += i; if (i % 100 == 0) pool.submit([&sum](int) { sum += 1; }); });
+    pool.waitAll();
+    CHECK(sum.load() == 10000LL * 10001 / 2 + 100);
+
+    // The first error is rethrown by waitAll, and the pool can be used again afterwards.
+    pool.submit([](int) { throw runtime_error("task failed"); });
+    bool rethrown = false;
+    try
+    {
+        pool.waitAll();
+    }
+    catch (const runtime_error&)
+    {
+        rethrown = true;
+    }
+    CHECK(rethrown);
+    atomic<int> laterTasks(0);
+    pool.submit([&laterTasks](int) { laterTasks++; });
+    pool.waitAll();
+    CHECK(laterTasks.load() == 1);
+
+    // Idle workers sleep: half a second of idleness costs far less CPU time than four workers polling every millisecond.
+    clock_t cpuStart = clock();
+    this_thread::sleep_for(chrono::milliseconds(500));
+    double idleCpuMilliseconds = 1000.0 * (clock() - cpuStart) / CLOCKS_PER_SEC;
+    cout << "CPU time of an idle pool over 500 ms: " << idleCpuMilliseconds << " ms" << endl;
+    CHECK(idleCpuMilliseconds < 5);
+
+    // A task submitted after a long idle period still wakes a worker.
+    atomic<bool> ran(false);
+    pool.submit([&ran](int) { ran = true; });
+    pool.waitAll();
+    CHECK(ran.load());
+    return reportTestResult();
+}
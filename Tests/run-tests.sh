@@ -0,0 +1,62 @@
+#!/bin/sh
+# Builds and runs the tests and benchmarks of the bank system.
+# Each test or benchmark is a program of its own, linked with every source file of the program except Main.cpp,
+# and run in an empty working directory with its own CSVs folder, so it never touches the real data files.
+#
+# Usage, from any directory:
+#   Tests/run-tests.sh                  runs every test (Tests/*-Test.cpp)
+#   Tests/run-tests.sh --benchmarks     runs every benchmark (Tests/*-Benchmark.cpp)
+#   Tests/run-tests.sh <name> [args]    runs one test or benchmark, such as Report-Benchmark 10000000
+# The compiler and its flags can be changed through the CXX and CXXFLAGS environment variables.
+
+set -e
+testsDirectory=$(cd "$(dirname "$0")" && pwd)
+sourceDirectory=$(dirname "$testsDirectory")
+buildDirectory="$testsDirectory/build"
+CXX=${CXX:-g++}
+CXXFLAGS=${CXXFLAGS:--std=c++17 -O2 -pthread}
+mkdir -p "$buildDirectory/objects"
+
+# Compiles the program's source files, skipping the ones that did not change since the last run.
+objects=""
+for source in "$sourceDirectory"/*.cpp; do
+    name=$(basename "$source" .cpp)
+    [ "$name" = "Main" ] && continue
+    object="$buildDirectory/objects/$name.o"
+    if [ ! -f "$object" ] || [ -n "$(find "$sourceDirectory" -maxdepth 1 \( -name '*.h' -o -name "$name.cpp" \) -newer "$object")" ]; then
+        $CXX $CXXFLAGS -c "$source" -o "$object"
+    fi
+    objects="$objects $object"
+done
+
+# Builds one test or benchmark and runs it with the given arguments in a fresh working directory.
+run()
+{
+    name=$1
+    shift
+    $CXX $CXXFLAGS -I"$sourceDirectory" "$testsDirectory/$name.cpp" $objects -o "$buildDirectory/$name" || return 1
+    workingDirectory="$buildDirectory/$name.run"
+    rm -rf "$workingDirectory"
+    mkdir -p "$workingDirectory/CSVs" || return 1
+    echo "== $name"
+    (cd "$workingDirectory" && "$buildDirectory/$name" "$@")
+}
+
+if [ "$1" = "--benchmarks" ]; then
+    pattern="*-Benchmark.cpp"
+elif [ -n "$1" ]; then
+    run "$@"
+    exit 0
+else
+    pattern="*-Test.cpp"
+fi
+
+failures=0
+for program in "$testsDirectory"/$pattern; do
+    [ -f "$program" ] || continue
+    run "$(basename "$program" .cpp)" || failures=$((failures + 1))
+done
+if [ "$failures" -ne 0 ]; then
+    echo "$failures program(s) failed"
+    exit 1
+fi
@@ -0,0 +1,248 @@
+#include "Tokenizer-Functions.h"
+
+// Enables the vectorized scanners only on x86 processors, where SSE2 and AVX2 exist.
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define CSV_TOKENIZER_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// SSE2 is part of every x86-64 processor; 32-bit builds only use it when the compiler targets it.
+#if defined(CSV_TOKENIZER_X86) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define CSV_TOKENIZER_SSE2
+#endif
+
+// GCC and Clang need the AVX2 function marked so it can use AVX2 without compiling the whole file for AVX2.
+#if defined(__GNUC__) || defined(__clang__)
+#define CSV_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define CSV_TARGET_AVX2
+#endif
+
+using namespace std;
+
+// Signature shared by the scanners: appends the index of every ',' and '\n' in the block to the buffer.
+typedef void (*DelimiterScanner)(const char*, size_t, vector<size_t>&);
+
+// Appends the index of every ',' and '\n' in the block one byte at a time.
+static void scanDelimitersScalar(const char*, size_t, vector<size_t>&);
+
+#ifdef CSV_TOKENIZER_X86
+// Returns the index of the lowest set bit of a non-zero mask.
+static inline int countTrailingZeros(unsigned int mask)
+{
+#ifdef _MSC_VER
+    unsigned long index; // Stores the index of the lowest set bit.
+    _BitScanForward(&index, mask); // Finds the lowest set bit.
+    return static_cast<int>(index);
+#else
+    return __builtin_ctz(mask); // Finds the lowest set bit.
+#endif
+}
+
+// Appends the index of every set bit in the mask, offset by the start of the block it came from.
+static inline void appendMaskPositions(unsigned int mask, size_t blockStart, vector<size_t>& positions)
+{
+    while (mask != 0)
+    {
+        positions.push_back(blockStart + countTrailingZeros(mask)); // Records the delimiter position.
+        mask &= mask - 1; // Clears the lowest set bit.
+    }
+}
+
+// Returns true if the processor and the operating system both support AVX2.
+static bool cpuSupportsAVX2()
+{
+#ifdef _MSC_VER
+    int info[4]; // Stores the EAX, EBX, ECX and EDX registers returned by CPUID.
+    __cpuid(info, 0); // Reads the highest supported CPUID leaf.
+    if (info[0] < 7)
+        return false; // Returns false if the extended feature leaf does not exist.
+    __cpuid(info, 1); // Reads the basic feature flags.
+    bool osSavesYmm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6; // Checks that the OS saves the AVX registers.
+    __cpuidex(info, 7, 0); // Reads the extended feature flags.
+    return osSavesYmm && (info[1] & (1 << 5)) != 0; // Checks the AVX2 bit.
+#else
+    return __builtin_cpu_supports("avx2"); // Asks the compiler runtime, which also checks operating system support.
+#endif
+}
+#endif
+
+#ifdef CSV_TOKENIZER_SSE2
+// Appends the index of every ',' and '\n' in the block, comparing 16 bytes at a time.
+static void scanDelimitersSSE2(const char* data, size_t size, vector<size_t>& positions)
+{
+    const __m128i commas = _mm_set1_epi8(','); // Holds a comma in every byte.
+    const __m128i newlines = _mm_set1_epi8('\n'); // Holds a newline in every byte.
+    size_t i = 0; // Stores the start of the current block.
+    for (; i + 16 <= size; i += 16)
+    {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)); // Loads 16 bytes.
+        __m128i matches = _mm_or_si128(_mm_cmpeq_epi8(block, commas), _mm_cmpeq_epi8(block, newlines)); // Marks commas and newlines.
+        appendMaskPositions(static_cast<unsigned int>(_mm_movemask_epi8(matches)), i, positions); // Records the marked bytes.
+    }
+    size_t tailStart = positions.size(); // Stores where the positions of the tail begin.
+    scanDelimitersScalar(data + i, size - i, positions); // Scans the bytes that do not fill a whole block.
+    for (size_t p = tailStart; p < positions.size(); p++)
+        positions[p] += i; // Makes the tail positions relative to the whole text.
+}
+#endif
+
+#ifdef CSV_TOKENIZER_X86
+// Appends the index of every ',' and '\n' in the block, comparing 32 bytes at a time.
+CSV_TARGET_AVX2 static void scanDelimitersAVX2(const char* data, size_t size, vector<size_t>& positions)
+{
+    const __m256i commas = _mm256_set1_epi8(','); // Holds a comma in every byte.
+    const __m256i newlines = _mm256_set1_epi8('\n'); // Holds a newline in every byte.
+    size_t i = 0; // Stores the start of the current block.
+    for (; i + 32 <= size; i += 32)
+    {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)); // Loads 32 bytes.
+        __m256i matches = _mm256_or_si256(_mm256_cmpeq_epi8(block, commas), _mm256_cmpeq_epi8(block, newlines)); // Marks commas and newlines.
+        appendMaskPositions(static_cast<unsigned int>(_mm256_movemask_epi8(matches)), i, positions); // Records the marked bytes.
+    }
+    size_t tailStart = positions.size(); // Stores where the positions of the tail begin.
+    scanDelimitersScalar(data + i, size - i, positions); // Scans the bytes that do not fill a whole block.
+    for (size_t p = tailStart; p < positions.size(); p++)
+        positions[p] += i; // Makes the tail positions relative to the whole text.
+}
+#endif
+
+// Appends the index of every ',' and '\n' in the block one byte at a time.
+void scanDelimitersScalar(const char* data, size_t size, vector<size_t>& positions)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        if (data[i] == ',' || data[i] == '\n')
+            positions.push_back(i); // Records the delimiter position.
+    }
+}
+
+// Picks the widest scanner the processor supports.
+static DelimiterScanner selectScanner(const char*& name)
+{
+#ifdef CSV_TOKENIZER_X86
+    if (cpuSupportsAVX2())
+    {
+        name = "AVX2";
+        return scanDelimitersAVX2;
+    }
+#endif
+#ifdef CSV_TOKENIZER_SSE2
+    name = "SSE2";
+    return scanDelimitersSSE2;
+#else
+    name = "Scalar";
+    return scanDelimitersScalar;
+#endif
+}
+
+// Holds the name of the scanner chosen at startup.
+static const char* scannerName = "Scalar";
+// Holds the scanner chosen at startup, replaced only by selectCSVScanner.
+static DelimiterScanner scanDelimiters = selectScanner(scannerName);
+
+// Returns the delimiter positions buffer of the calling thread, reused between calls.
+static vector<size_t>& getPositionsBuffer()
+{
+    thread_local vector<size_t> positions; // Stores the positions of the last scan on this thread.
+    positions.clear(); // Empties the buffer while keeping its capacity.
+    return positions;
+}
+
+// Splits CSV text into fields and records, dropping the '\r' of Windows line endings and skipping empty lines.
+void tokenizeCSV(string_view text, vector<CSVField>& fields, vector<size_t>& recordEnds)
+{
+    fields.clear(); // Empties the field buffer while keeping its capacity.
+    recordEnds.clear(); // Empties the record buffer while keeping its capacity.
+    vector<size_t>& positions = getPositionsBuffer(); // Gets the reusable positions buffer.
+    scanDelimiters(text.data(), text.size(), positions); // Finds all commas and newlines.
+
+    size_t fieldStart = 0; // Stores the start of the current field.
+    size_t recordFirstField = 0; // Stores the index of the first field of the current record.
+    for (size_t position : positions)
+    {
+        if (text[position] == ',')
+        {
+            fields.push_back({ fieldStart, position - fieldStart }); // Ends the current field at the comma.
+        }
+        else
+        {
+            size_t fieldEnd = position; // Stores the end of the last field of the line.
+            if (fieldEnd > fieldStart && text[fieldEnd - 1] == '\r')
+                fieldEnd--; // Drops the carriage return of a Windows line ending.
+            if (fields.size() > recordFirstField || fieldEnd > fieldStart)
+            {
+                fields.push_back({ fieldStart, fieldEnd - fieldStart }); // Ends the last field of the record.
+                recordEnds.push_back(fields.size()); // Ends the record.
+            }
+            recordFirstField = fields.size(); // Starts a new record.
+        }
+        fieldStart = position + 1; // Starts the next field after the delimiter.
+    }
+
+    // Ends the last record if the text does not finish with a newline.
+    size_t fieldEnd = text.size(); // Stores the end of the last field.
+    if (fieldEnd > fieldStart && text[fieldEnd - 1] == '\r')
+        fieldEnd--; // Drops a trailing carriage return.
+    if (fields.size() > recordFirstField || fieldEnd > fieldStart)
+    {
+        fields.push_back({ fieldStart, fieldEnd - fieldStart }); // Ends the last field.
+        recordEnds.push_back(fields.size()); // Ends the last record.
+    }
+}
+
+// Splits a single CSV line into fields, dropping a trailing '\r'.
+void splitCSVLine(string_view line, vector<CSVField>& fields)
+{
+    if (!line.empty() && line.back() == '\r')
+        line.remove_suffix(1); // Drops the carriage return left by reading a Windows file line by line.
+    fields.clear(); // Empties the field buffer while keeping its capacity.
+    vector<size_t>& positions = getPositionsBuffer(); // Gets the reusable positions buffer.
+    scanDelimiters(line.data(), line.size(), positions); // Finds all commas.
+
+    size_t fieldStart = 0; // Stores the start of the current field.
+    for (size_t position : positions)
+    {
+        fields.push_back({ fieldStart, position - fieldStart }); // Ends the current field at the delimiter.
+        fieldStart = position + 1; // Starts the next field after the delimiter.
+    }
+    fields.push_back({ fieldStart, line.size() - fieldStart }); // Adds the final field, which may be empty.
+}
+
+// Returns the name of the scanner in use.
+const char* getCSVScannerName()
+{
+    return scannerName;
+}
+
+// Switches to the named scanner if it is compiled in and the processor supports it.
+bool selectCSVScanner(const char* name)
+{
+    string_view requested(name); // Stores the requested name.
+    if (requested == "Scalar")
+    {
+        scannerName = "Scalar";
+        scanDelimiters = scanDelimitersScalar;
+        return true;
+    }
+#ifdef CSV_TOKENIZER_SSE2
+    if (requested == "SSE2")
+    {
+        scannerName = "SSE2";
+        scanDelimiters = scanDelimitersSSE2;
+        return true;
+    }
+#endif
+#ifdef CSV_TOKENIZER_X86
+    if (requested == "AVX2" && cpuSupportsAVX2())
+    {
+        scannerName = "AVX2";
+        scanDelimiters = scanDelimitersAVX2;
+        return true;
+    }
+#endif
+    return false; // Keeps the current scanner.
+}
@@ -0,0 +1,53 @@
+// This file contains the declarations of the CSV tokenizer functions.
+// The tokenizer finds commas and newlines a whole block at a time (AVX2 or SSE2 when the CPU supports them,
+// a scalar loop otherwise) and emits field offsets into buffers the caller can reuse between calls.
+
+// These are the include guards
+#pragma once
+#ifndef TOKENIZERFUNCTIONS_H
+#define TOKENIZERFUNCTIONS_H
+
+#include <vector>
+#include <string_view>
+using namespace std;
+
+/*
+	Describes one field of the tokenized text by its position,
+	so no string is allocated until the caller needs one.
+*/
+struct CSVField
+{
+	size_t offset; // Index of the first character of the field in the tokenized text
+	size_t length; // Number of characters in the field
+};
+
+/*
+	Splits CSV text into fields.
+	- Fields are separated by ',' and records end at '\n'; a '\r' right before '\n' is dropped (Windows line endings)
+	- Appends every field to the first buffer
+	- Appends, for each record, the index one past its last field in the first buffer to the second buffer
+	- Both buffers are cleared first, so keeping them between calls avoids reallocating them
+	Empty lines produce no record.
+*/
+void tokenizeCSV(string_view, vector<CSVField>&, vector<size_t>&);
+
+/*
+	Splits a single CSV line (without its newline) into fields.
+	The buffer is cleared first, so keeping it between calls avoids reallocating it.
+*/
+void splitCSVLine(string_view, vector<CSVField>&);
+
+/*
+	Returns the name of the delimiter scanner selected for this CPU at startup:
+	"AVX2", "SSE2" or "Scalar".
+*/
+const char* getCSVScannerName();
+
+/*
+	Switches to the delimiter scanner of the given name ("AVX2", "SSE2" or "Scalar").
+	Returns false, keeping the current scanner, if this build or CPU does not have it.
+	Used by the tests and benchmarks to compare the scanners; must not be called while text is being tokenized.
+*/
+bool selectCSVScanner(const char*);
+
+#endif
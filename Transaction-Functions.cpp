@@ -0,0 +1,194 @@
+#include <cmath>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include "Transaction-Functions.h"
+#include "Program-Data-Functions.h"
+#include "Tokenizer-Functions.h"
+#include "Numeric-Functions.h"
+#include "Display-Functions.h"
+#include "File-Functions.h"
+#include "Exceptions.h"
+using namespace std;
+
+// The names displayed for each outcome, indexed by TransactionStatus.
+static const char* const TRANSACTION_STATUS_NAMES[TRANSACTION_STATUS_COUNT] = { "Applied", "Invalid Account", "Invalid Amount", "Insufficient Balance", "Not Allowed", "Account Closed" };
+
+// Converts an account ID of the account tables to a position in the accounts vector; an ID below 1 gives a position past the end.
+static size_t convertAccountIDToIndex(string_view accountID)
+{
+    long long id = parseLongLong(accountID); // Parses the account ID.
+    if (id < 1)
+        return accounts.size(); // Lets the processor reject the account.
+    return static_cast<size_t>(id - 1);
+}
+
+// Returns the latency under which the given fraction of the sorted latencies fall, in microseconds.
+static double getLatencyPercentile(const vector<long long>& sortedLatencies, double fraction)
+{
+    if (sortedLatencies.empty())
+        return 0;
+    size_t rank = static_cast<size_t>(ceil(fraction * sortedLatencies.size())); // Finds the nearest rank.
+    return sortedLatencies[max<size_t>(rank, 1) - 1] / 1000.0; // Converts nanoseconds to microseconds.
+}
+
+// Reads the whole transaction file and tokenizes it in one pass.
+vector<TransactionRequest> readTransactionFile(const string& filePath)
+{
+    ifstream transactionFile(filePath, ios::in | ios::binary); // Opens the transaction file in read mode.
+    if (!transactionFile)
+        throw InvalidFileException(); // Throws an exception if the file cannot be opened.
+    string fileContent = readWholeFile(transactionFile); // Reads the whole file.
+    vector<CSVField> fields; // Stores the position of every field in the file.
+    vector<size_t> recordEnds; // Stores where each line's fields end.
+    tokenizeCSV(fileContent, fields, recordEnds); // Splits the file into fields and lines.
+
+    vector<TransactionRequest> requests; // Stores the transactions.
+    requests.reserve(recordEnds.size()); // Allocates the transactions once.
+    size_t firstField = 0; // Stores the index of the first field of the current line.
+    for (size_t recordEnd : recordEnds)
+    {
+        size_t fieldCount = recordEnd - firstField; // Counts the fields of the line.
+        auto field = [&](size_t i) { return string_view(fileContent).substr(fields[firstField + i].offset, fields[firstField + i].length); }; // Gets a field without copying it.
+        TransactionRequest request; // Stores the transaction.
+        string_view type = field(0); // Gets the kind of transaction.
+        if ((type == "deposit" || type == "withdrawal") && fieldCount == 3)
+        {
+            request.type = type == "deposit" ? TransactionType::Deposit : TransactionType::Withdrawal; // Sets the kind.
+            request.accountIndex = convertAccountIDToIndex(field(1)); // Sets the account.
+            request.amount = parseDouble(field(2)); // Sets the amount.
+        }
+        else if (type == "transfer" && fieldCount == 4)
+        {
+            request.type = TransactionType::Transfer; // Sets the kind.
+            request.accountIndex = convertAccountIDToIndex(field(1)); // Sets the debited account.
+            request.targetAccountIndex = convertAccountIDToIndex(field(2)); // Sets the credited account.
+            request.amount = parseDouble(field(3)); // Sets the amount.
+        }
+        else if (type == "close" && fieldCount == 2)
+        {
+            request.type = TransactionType::Closure; // Sets the kind.
+            request.nationalID = parseLongLong(field(1)); // Sets the person.
+        }
+        else
+            throw InvalidFileException(); // Throws an exception if the line is not a transaction.
+        requests.push_back(request); // Adds the transaction.
+        firstField = recordEnd; // Moves to the next line.
+    }
+    return requests;
+}
+
+// Removes the persons closed by the run and their accounts in one pass over each vector, then persists the removals.
+static void deleteClosedPersons(const vector<long long>& closedNationalIDs)
+{
+    vector<long long> sortedNationalIDs = closedNationalIDs; // Stores the closed persons, sorted for searching.
+    sort(sortedNationalIDs.begin(), sortedNationalIDs.end());
+    sortedNationalIDs.erase(unique(sortedNationalIDs.begin(), sortedNationalIDs.end()), sortedNationalIDs.end()); // Removes a person once even if closed twice.
+    auto isClosed = [&sortedNationalIDs](long long nationalID) { return binary_search(sortedNationalIDs.begin(), sortedNationalIDs.end(), nationalID); };
+    persons.erase(remove_if(persons.begin(), persons.end(), [&isClosed](const Person& person) { return isClosed(person.getNationalID()); }), persons.end()); // Removes the persons, keeping the others sorted.
+
+    vector<size_t> removedIndexes; // Stores the positions of the removed accounts, in increasing order.
+    size_t keptCount = 0; // Counts the accounts kept so far.
+    for (size_t accountIndex = 0; accountIndex < accounts.size(); accountIndex++)
+    {
+        if (isClosed(parseLongLong(accounts[accountIndex][1])))
+        {
+            removedIndexes.push_back(accountIndex); // Removes the account of a closed person.
+            continue;
+        }
+        if (keptCount != accountIndex)
+            accounts[keptCount] = move(accounts[accountIndex]); // Moves the kept account over the removed ones, keeping the order.
+        keptCount++;
+    }
+    accounts.resize(keptCount); // Drops the moved-from accounts at the end.
+    persistAccountRemovals(removedIndexes); // Saves the accounts to the CSV file and removes their records from the account store.
+    for (long long nationalID : sortedNationalIDs)
+        persistDeletedPerson(nationalID); // Records the removal in the person journal.
+}
+
+// Applies the transactions on the processor, measuring the latency of each one, then persists the changed accounts and closures.
+TransactionRunSummary processTransactions(const vector<TransactionRequest>& requests, int shardCount)
+{
+    TransactionRunSummary summary; // Stores the results.
+    vector<TransactionResult> results(requests.size()); // Stores the outcome of each transaction, each written by one callback only.
+    vector<size_t> changedAccounts; // Stores the positions of the changed accounts.
+    auto startTime = chrono::steady_clock::now(); // Records when the first transaction is submitted.
+    {
+        TransactionProcessor processor(shardCount); // Starts the shards.
+        summary.shardCount = processor.getShardCount(); // Keeps the number of shards.
+        for (size_t i = 0; i < requests.size(); i++)
+            processor.submit(requests[i], [&results, i](const TransactionResult& result) { results[i] = result; }); // Queues the transaction.
+        processor.waitUntilIdle(); // Waits for every transaction to complete.
+        changedAccounts = processor.publishChanges(); // Writes the changed accounts back.
+    }
+    summary.elapsedMilliseconds = chrono::duration<double, milli>(chrono::steady_clock::now() - startTime).count(); // Measures the run.
+
+    vector<long long> closedNationalIDs; // Stores the persons closed by the run.
+    for (size_t i = 0; i < requests.size(); i++)
+    {
+        if (requests[i].type == TransactionType::Closure && results[i].status == TransactionStatus::Applied)
+            closedNationalIDs.push_back(requests[i].nationalID); // Keeps the closed person.
+    }
+    if (!closedNationalIDs.empty())
+        deleteClosedPersons(closedNationalIDs); // Renumbers the account store, as the positions of the accounts move.
+    else
+        persistAccountUpdates(changedAccounts); // Queues the new records and publishes them at one epoch, so no snapshot sees half of a transfer.
+
+    vector<long long> latencies(results.size()); // Stores the latencies, to be sorted.
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        int status = static_cast<int>(results[i].status); // Gets the outcome.
+        summary.statusCounts[status]++; // Counts the transaction.
+        summary.statusAmounts[status] += requests[i].type == TransactionType::Closure ? results[i].balance : requests[i].amount; // Adds its amount, or the balance a closure closed.
+        latencies[i] = results[i].latencyNanoseconds; // Keeps its latency.
+    }
+    sort(latencies.begin(), latencies.end()); // Orders the latencies for the percentiles.
+    summary.p50LatencyMicroseconds = getLatencyPercentile(latencies, 0.50);
+    summary.p99LatencyMicroseconds = getLatencyPercentile(latencies, 0.99);
+    summary.p999LatencyMicroseconds = getLatencyPercentile(latencies, 0.999);
+    if (summary.elapsedMilliseconds > 0)
+        summary.transactionsPerSecond = requests.size() * 1000.0 / summary.elapsedMilliseconds; // Computes the throughput.
+    return summary;
+}
+
+// Prompts for a transaction file, applies it and displays the totals, throughput and latency.
+void displayTransactionFile()
+{
+    string filePath; // Stores the path of the transaction file.
+    cout << "Enter the path of the transaction file: "; // Prompts the user to enter the path.
+    clearInputBufferFunc(); // Ensures the input buffer is valid and empty for the next input.
+    getline(cin, filePath); // Reads the full path, including spaces.
+    cin.putback('\n'); // Inserts a newline into the input buffer to prevent issues with empty buffer checks.
+
+    vector<TransactionRequest> requests; // Stores the transactions of the file.
+    try
+    {
+        requests = readTransactionFile(filePath); // Reads the file.
+    }
+    catch (InvalidFileException)
+    {
+        cout << "Error: The transaction file could not be read, or one of its lines is not a transaction." << endl;
+        return;
+    }
+    catch (InvalidNumberException)
+    {
+        cout << "Error: An account ID, a national ID or an amount in the transaction file is not a valid number." << endl;
+        return;
+    }
+
+    TransactionRunSummary summary = processTransactions(requests); // Applies the transactions using one shard per hardware thread.
+
+    vector<vector<string>> resultsTable = { {"Outcome", "Transactions", "Amount"} }; // Initializes the results table with headers.
+    for (int status = 0; status < TRANSACTION_STATUS_COUNT; status++)
+        resultsTable.push_back({ TRANSACTION_STATUS_NAMES[status], formatInteger(summary.statusCounts[status]), formatDouble(summary.statusAmounts[status]) }); // Adds the outcome's row.
+
+    cout << "Transactions:" << endl; // Displays a header for the results.
+    printTable(resultsTable); // Prints the results table.
+    cout << "Processed " << requests.size() << " transactions in " << summary.elapsedMilliseconds << " ms using " << summary.shardCount
+        << " shards (" << summary.transactionsPerSecond << " transactions per second)." << endl; // Displays the throughput.
+    cout << "Latency: p50 " << summary.p50LatencyMicroseconds << " us, p99 " << summary.p99LatencyMicroseconds
+        << " us, p99.9 " << summary.p999LatencyMicroseconds << " us." << endl; // Displays the latency percentiles.
+}
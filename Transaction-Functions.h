@@ -0,0 +1,61 @@
+// This file contains the declarations of the transaction file functions.
+// A transaction file lists deposits, withdrawals, transfers and closures, one per line, which are applied together
+// on the TransactionProcessor instead of one at a time through the account update and person deletion prompts.
+
+/*
+	Transaction file format, one transaction per line, with account IDs as displayed in the account tables:
+	- deposit,<accountID>,<amount>
+	- withdrawal,<accountID>,<amount>
+	- transfer,<accountID>,<targetAccountID>,<amount>
+	- close,<nationalID>
+	A closure closes every account of the person, and the person and their accounts are deleted once the file is applied.
+*/
+
+// These are the include guards
+#pragma once
+#ifndef TRANSACTIONFUNCTIONS_H
+#define TRANSACTIONFUNCTIONS_H
+
+#include <vector>
+#include <string>
+#include "TransactionProcessor.h"
+using namespace std;
+
+// The number of outcomes a transaction can have, one per TransactionStatus value
+const int TRANSACTION_STATUS_COUNT = 6;
+
+// Holds the results of applying a list of transactions
+struct TransactionRunSummary
+{
+	long long statusCounts[TRANSACTION_STATUS_COUNT] = {}; // Number of transactions of each outcome, indexed by TransactionStatus
+	double statusAmounts[TRANSACTION_STATUS_COUNT] = {};   // Total amount of the transactions of each outcome
+	int shardCount = 0;                                    // Number of shards used
+	double elapsedMilliseconds = 0;                        // Wall-clock time from the first submission to the last completion
+	double transactionsPerSecond = 0;                      // Transactions completed per second of that time
+	double p50LatencyMicroseconds = 0;                     // Latency under which half of the transactions completed
+	double p99LatencyMicroseconds = 0;                     // Latency under which 99% of the transactions completed
+	double p999LatencyMicroseconds = 0;                    // Latency under which 99.9% of the transactions completed
+};
+
+/*
+	Reads the transactions of a transaction file, converting the account IDs to positions in the 'accounts' vector.
+	Throws an InvalidFileException if the file cannot be opened or a line is not a transaction,
+	and an InvalidNumberException if an account ID, a national ID or an amount is not a number.
+*/
+vector<TransactionRequest> readTransactionFile(const string&);
+
+/*
+	Applies the transactions on a TransactionProcessor with the given number of shards (one per hardware thread by default),
+	then persists every changed account, and deletes the persons closed by a closure with their accounts.
+	Returns the totals and the throughput and latency of the run.
+*/
+TransactionRunSummary processTransactions(const vector<TransactionRequest>&, int = 0);
+
+/*
+	Prompts the user for the path of a transaction file, applies its transactions,
+	and displays the totals of each outcome in a tabular format with the throughput and latency.
+	Used by the main menu.
+*/
+void displayTransactionFile();
+
+#endif
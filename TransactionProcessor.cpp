@@ -0,0 +1,392 @@
+#include <algorithm>
+#include "TransactionProcessor.h"
+#include "Program-Data-Functions.h"
+#include "Conversion-Functions.h"
+#include "Constants.h"
+#include "Exceptions.h"
+#include "Clock.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+using namespace std;
+
+// Pins the calling thread to one core, so the accounts of its shard stay in the caches of that core.
+static void pinCurrentThreadToCore(size_t core)
+{
+#ifdef _WIN32
+    if (core < 64)
+        SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(1) << core); // Runs the thread on the core only.
+#elif defined(__linux__)
+    cpu_set_t cpuSet; // Stores the set of allowed cores.
+    CPU_ZERO(&cpuSet); // Clears the set.
+    CPU_SET(core, &cpuSet); // Allows only the core.
+    pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet); // Runs the thread on the core only; a refusal leaves it unpinned.
+#else
+    (void)core; // Leaves the thread to the scheduler where pinning is not available.
+#endif
+}
+
+// Reads the type of every account, starts the shards and waits until each has loaded its accounts.
+TransactionProcessor::TransactionProcessor(int shardCount) : asOf(getOperationTime()), pinShards(false), loadedShardCount(0),
+    stopping(false), submittedCount(0), completedCount(0)
+{
+    int hardwareThreadCount = static_cast<int>(thread::hardware_concurrency()); // Gets the number of hardware threads, or 0 if unknown.
+    if (shardCount < 1)
+        shardCount = hardwareThreadCount; // Uses all hardware threads by default.
+    if (shardCount < 1)
+        shardCount = 1; // Falls back to a single shard if the hardware thread count is unknown.
+    pinShards = shardCount <= hardwareThreadCount; // Pins the shards only if each can have a core of its own.
+
+    savingAccounts.resize(accounts.size()); // Allocates the account types once.
+    for (size_t i = 0; i < accounts.size(); i++)
+        savingAccounts[i] = isSavingAccountVector(accounts[i]); // Reads the account's type.
+
+    for (int i = 0; i < shardCount; i++)
+        shards.push_back(make_unique<Shard>(TRANSACTION_QUEUE_CAPACITY)); // Creates every queue before a shard can pass a message to it.
+    for (size_t i = 0; i < shards.size(); i++)
+        shards[i]->shardThread = thread(&TransactionProcessor::shardLoop, this, i); // Starts the thread that owns shard i.
+
+    unique_lock<mutex> lock(stateMutex); // Locks to wait for the shards.
+    progressMade.wait(lock, [this]() { return loadedShardCount == shards.size(); }); // Waits until every shard holds its accounts.
+}
+
+// Lets the shards apply the queued transactions, then joins their threads.
+TransactionProcessor::~TransactionProcessor()
+{
+    waitUntilIdle(); // Lets every transfer and closure finish, so no shard stops while a message can still be passed to it.
+    {
+        lock_guard<mutex> lock(stateMutex); // Locks so a shard cannot miss the stop signal.
+        stopping = true; // Asks the shards to finish.
+    }
+    for (unique_ptr<Shard>& shard : shards)
+        shard->workAvailable.notify_one(); // Wakes the shard's thread if it is waiting.
+    for (unique_ptr<Shard>& shard : shards)
+    {
+        if (shard->shardThread.joinable())
+            shard->shardThread.join(); // Waits for the thread to finish.
+    }
+}
+
+// Checks the accounts, types and persons a transaction names, before it is queued.
+TransactionStatus TransactionProcessor::validateRequest(const TransactionRequest& request) const
+{
+    if (request.type == TransactionType::Closure)
+        return searchPersonIndex(request.nationalID) == -1 ? TransactionStatus::InvalidAccount : TransactionStatus::Applied; // Rejects a person who is not a client.
+    if (request.accountIndex >= savingAccounts.size())
+        return TransactionStatus::InvalidAccount; // Rejects an account that does not exist.
+    if (request.type == TransactionType::Deposit && !savingAccounts[request.accountIndex])
+        return TransactionStatus::NotAllowed; // Certificates only allow withdrawals.
+    if (request.type == TransactionType::Transfer)
+    {
+        if (request.targetAccountIndex >= savingAccounts.size() || request.targetAccountIndex == request.accountIndex)
+            return TransactionStatus::InvalidAccount; // Rejects a credited account that does not exist or is the debited one.
+        if (!savingAccounts[request.targetAccountIndex])
+            return TransactionStatus::NotAllowed; // Certificates only allow withdrawals.
+    }
+    return TransactionStatus::Applied;
+}
+
+// Submits a transaction and returns the future of its outcome.
+future<TransactionResult> TransactionProcessor::submit(const TransactionRequest& request)
+{
+    Transaction transaction; // Stores the transaction.
+    transaction.request = request; // Copies the request.
+    future<TransactionResult> result = transaction.completion.get_future(); // Gets the future before the promise moves to the queue.
+    submitTransaction(transaction); // Queues or rejects the transaction.
+    return result;
+}
+
+// Submits a transaction whose outcome is passed to the callback.
+void TransactionProcessor::submit(const TransactionRequest& request, TransactionCallback callback)
+{
+    Transaction transaction; // Stores the transaction.
+    transaction.request = request; // Copies the request.
+    transaction.callback = move(callback); // Takes the callback.
+    submitTransaction(transaction); // Queues or rejects the transaction.
+}
+
+// Queues a transaction for the shard of its account, or completes it at once if it names the wrong accounts.
+void TransactionProcessor::submitTransaction(Transaction& transaction)
+{
+    transaction.submitTime = chrono::steady_clock::now(); // Starts measuring the latency.
+    TransactionStatus status = validateRequest(transaction.request); // Checks the accounts.
+    if (status != TransactionStatus::Applied)
+    {
+        TransactionResult result; // Stores the rejection.
+        result.status = status;
+        completeTransaction(transaction, result); // Completes the transaction on the calling thread.
+        return;
+    }
+    if (transaction.request.type == TransactionType::Closure)
+    {
+        // A closure is a barrier: every transfer queued before it lands first, and none queued after it starts before it ends,
+        // so no transfer is refunded to an account the closure already closed.
+        waitUntilIdle(); // Lets the transactions queued before the closure complete.
+        submittedCount++; // Counts the closure before a shard can complete it.
+        transaction.stage = TransactionStage::Closing; // Starts the visit of the shards.
+        enqueue(0, transaction); // Starts from the first shard.
+        waitUntilIdle(); // Waits for the closure to visit every shard.
+        return;
+    }
+    submittedCount++; // Counts the transaction before a shard can complete it.
+    enqueue(getShardIndex(transaction.request.accountIndex), transaction); // Queues it for the owner of its account.
+}
+
+// Queues a transaction, applying backpressure while the shard's queue is full.
+void TransactionProcessor::enqueue(size_t shardIndex, Transaction& transaction)
+{
+    shards[shardIndex]->queue.push(transaction); // Waits while the queue is full until the shard takes a transaction.
+    wakeShard(shardIndex); // Wakes the shard if it is waiting.
+}
+
+// Wakes a shard's thread if it announced that it is going to sleep.
+void TransactionProcessor::wakeShard(size_t shardIndex)
+{
+    Shard& shard = *shards[shardIndex]; // Gets the shard.
+    atomic_thread_fence(memory_order_seq_cst); // Orders the queued transaction before the check, matching the fence in shardLoop.
+    if (shard.sleeping.exchange(false))
+    {
+        lock_guard<mutex> lock(stateMutex); // Locks so the wake-up cannot arrive between the thread's check and its wait.
+        shard.workAvailable.notify_one(); // Wakes the thread.
+    }
+}
+
+// Waits until the shards have completed every queued transaction.
+void TransactionProcessor::waitUntilIdle()
+{
+    unique_lock<mutex> lock(stateMutex); // Locks to wait for progress.
+    progressMade.wait(lock, [this]() { return completedCount.load() >= submittedCount.load(); }); // Waits for the queues to drain.
+}
+
+// Writes the changed accounts of every shard back to the accounts vector.
+vector<size_t> TransactionProcessor::publishChanges()
+{
+    vector<size_t> changedAccounts; // Stores the positions of the changed accounts.
+    for (size_t accountIndex = 0; accountIndex < savingAccounts.size(); accountIndex++)
+    {
+        Shard& shard = *shards[getShardIndex(accountIndex)]; // Gets the owner of the account.
+        size_t localIndex = accountIndex / shards.size(); // Gets the account's place in the shard.
+        if (!shard.changed[localIndex])
+            continue; // Skips the unchanged account.
+        accounts[accountIndex] = convertAccountVariantToAccountVector(shard.accounts[localIndex]); // Writes the account back.
+        shard.changed[localIndex] = false; // Publishes it only once.
+        changedAccounts.push_back(accountIndex); // Records its position.
+    }
+    return changedAccounts;
+}
+
+// Loads the accounts of one shard as typed objects, on the shard's own thread so they are allocated near its core.
+void TransactionProcessor::loadShard(size_t shardIndex)
+{
+    Shard& shard = *shards[shardIndex]; // Gets the shard.
+    size_t shardCount = shards.size(); // Stores the number of shards.
+    size_t accountCount = savingAccounts.size() > shardIndex ? (savingAccounts.size() - shardIndex + shardCount - 1) / shardCount : 0; // Counts the shard's accounts.
+    shard.accounts.reserve(accountCount); // Allocates the accounts once.
+    for (size_t accountIndex = shardIndex; accountIndex < savingAccounts.size(); accountIndex += shardCount)
+    {
+        shard.accounts.push_back(convertAccountVectorToAccountVariant(accounts[accountIndex])); // Builds the account.
+        if (holds_alternative<CertificateAccount>(shard.accounts.back()))
+            accrualCache.restore(accountIndex, get<CertificateAccount>(shard.accounts.back())); // Reuses the cached returns of the certificate.
+    }
+    shard.changed.assign(accountCount, false); // No account has changed yet.
+    shard.closed.assign(accountCount, false); // No account is closed yet.
+}
+
+// Deposits into a saving account owned by the calling shard.
+double TransactionProcessor::creditAccount(size_t accountIndex, double amount)
+{
+    SavingAccount& savingAccountObject = get<SavingAccount>(getShardAccount(accountIndex)); // Gets the account; only saving accounts take deposits.
+    savingAccountObject.deposit(amount); // Deposits, rejecting a negative amount.
+    shards[getShardIndex(accountIndex)]->changed[accountIndex / shards.size()] = true; // Marks it for publishing.
+    return savingAccountObject.getBalance();
+}
+
+// Withdraws from an account owned by the calling shard, using the rules of its type.
+double TransactionProcessor::debitAccount(size_t accountIndex, double amount)
+{
+    AccountVariant& accountObject = getShardAccount(accountIndex); // Gets the account.
+    withdrawFromAccount(accountObject, amount, asOf); // Withdraws, rejecting a negative amount or an insufficient balance.
+    shards[getShardIndex(accountIndex)]->changed[accountIndex / shards.size()] = true; // Marks it for publishing.
+    return getAccountBalance(accountObject);
+}
+
+// Closes the shard's accounts of the closure's person and adds their balances to the closure.
+void TransactionProcessor::closeShardAccounts(size_t shardIndex, Transaction& transaction)
+{
+    Shard& shard = *shards[shardIndex]; // Gets the shard.
+    for (size_t localIndex = 0; localIndex < shard.accounts.size(); localIndex++)
+    {
+        const AccountVariant& accountObject = shard.accounts[localIndex]; // Gets the account.
+        if (shard.closed[localIndex] || visit([](const auto& typedAccount) { return typedAccount.getOwnerNationalID(); }, accountObject) != transaction.request.nationalID)
+            continue; // Skips the accounts of other persons.
+        shard.closed[localIndex] = true; // Closes the account.
+        transaction.carriedBalance += getAccountBalance(accountObject); // Adds its balance.
+    }
+}
+
+// Applies a transaction, or its step that belongs to this shard, passing it on to the shard of its next step.
+bool TransactionProcessor::applyTransaction(size_t shardIndex, Transaction& transaction)
+{
+    const TransactionRequest& request = transaction.request; // Gets the request.
+    TransactionResult result; // Stores the outcome.
+    switch (transaction.stage)
+    {
+    case TransactionStage::Closing:
+    {
+        closeShardAccounts(shardIndex, transaction); // Closes the person's accounts in this shard.
+        transaction.visitedShardCount++; // Counts the shard.
+        if (transaction.visitedShardCount < shards.size())
+        {
+            forwardTransaction(shardIndex, (shardIndex + 1) % shards.size(), transaction); // Visits the next shard.
+            return false;
+        }
+        result.balance = transaction.carriedBalance; // Reports the closed balance.
+        break;
+    }
+    case TransactionStage::CreditPending:
+    {
+        if (isAccountClosed(request.targetAccountIndex))
+        {
+            transaction.stage = TransactionStage::RefundPending; // Sends the amount back to the debited account.
+            forwardTransaction(shardIndex, getShardIndex(request.accountIndex), transaction);
+            return false;
+        }
+        creditAccount(request.targetAccountIndex, request.amount); // Credits the transfer; the debit already checked the amount.
+        result.balance = transaction.carriedBalance; // Reports the balance of the debited account.
+        break;
+    }
+    case TransactionStage::RefundPending:
+    {
+        result.status = TransactionStatus::AccountClosed; // Rejects the transfer to the closed account.
+        result.balance = creditAccount(request.accountIndex, request.amount); // Refunds the debited account, even if it was closed meanwhile.
+        break;
+    }
+    case TransactionStage::Submitted:
+    {
+        if (isAccountClosed(request.accountIndex))
+        {
+            result.status = TransactionStatus::AccountClosed; // Rejects a transaction from a closed account.
+            break;
+        }
+        try
+        {
+            if (request.type == TransactionType::Deposit)
+                result.balance = creditAccount(request.accountIndex, request.amount); // Deposits.
+            else
+                result.balance = debitAccount(request.accountIndex, request.amount); // Withdraws, or debits the transfer.
+        }
+        catch (InvalidAmountException&)
+        {
+            result.status = TransactionStatus::InvalidAmount;
+        }
+        catch (InsufficientBalanceException&)
+        {
+            result.status = TransactionStatus::InsufficientBalance;
+        }
+        if (request.type != TransactionType::Transfer || result.status != TransactionStatus::Applied)
+            break;
+
+        transaction.stage = TransactionStage::CreditPending; // Leaves only the credit.
+        transaction.carriedBalance = result.balance; // Keeps the balance to report.
+        size_t targetShardIndex = getShardIndex(request.targetAccountIndex); // Finds the owner of the credited account.
+        if (targetShardIndex != shardIndex)
+        {
+            forwardTransaction(shardIndex, targetShardIndex, transaction); // Lets the owner credit the account.
+            return false;
+        }
+        return applyTransaction(shardIndex, transaction); // Credits the account, which this shard also owns.
+    }
+    }
+    completeTransaction(transaction, result); // Completes the transaction.
+    return true;
+}
+
+// Passes a transaction on to another shard without waiting, so two shards passing messages to each other never wait for each other.
+void TransactionProcessor::forwardTransaction(size_t shardIndex, size_t targetShardIndex, Transaction& transaction)
+{
+    if (shards[targetShardIndex]->queue.tryPush(transaction))
+        wakeShard(targetShardIndex); // Wakes the shard if it is waiting.
+    else
+        shards[shardIndex]->pendingMessages.emplace_back(targetShardIndex, move(transaction)); // Keeps the message and tries again later.
+}
+
+// Completes a transaction with its latency, through its callback or its future.
+void TransactionProcessor::completeTransaction(Transaction& transaction, TransactionResult result)
+{
+    result.latencyNanoseconds = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - transaction.submitTime).count(); // Measures the latency.
+    if (transaction.callback)
+        transaction.callback(result); // Passes the outcome to the callback.
+    else
+        transaction.completion.set_value(result); // Completes the future.
+}
+
+// Loads the shard, then applies the queued transactions and passes on the waiting messages, sleeping until more arrive.
+void TransactionProcessor::shardLoop(size_t shardIndex)
+{
+    Shard& shard = *shards[shardIndex]; // Gets the shard.
+    if (pinShards)
+        pinCurrentThreadToCore(shardIndex); // Keeps the thread on its own core before it touches its accounts.
+    loadShard(shardIndex); // Loads the shard's accounts.
+    {
+        lock_guard<mutex> lock(stateMutex); // Locks so the constructor cannot miss the progress.
+        loadedShardCount++; // Counts the loaded shard.
+    }
+    progressMade.notify_all(); // Wakes the constructor.
+
+    Transaction transaction; // Stores the transaction being applied.
+    while (true)
+    {
+        long long batchSize = 0; // Counts the transactions taken from the queue.
+        long long completedInBatch = 0; // Counts those completed here, the others being passed on to another shard.
+        while (shard.queue.tryPop(transaction))
+        {
+            if (applyTransaction(shardIndex, transaction))
+                completedInBatch++; // Counts the completed transaction.
+            batchSize++; // Counts the transaction.
+        }
+
+        size_t pendingCount = shard.pendingMessages.size(); // Stores the number of messages waiting to be passed on.
+        for (size_t i = 0; i < pendingCount; i++)
+        {
+            pair<size_t, Transaction> message = move(shard.pendingMessages.front()); // Takes the oldest message.
+            shard.pendingMessages.pop_front();
+            forwardTransaction(shardIndex, message.first, message.second); // Tries to pass it on again.
+        }
+
+        if (batchSize > 0)
+        {
+            {
+                lock_guard<mutex> lock(stateMutex); // Locks so a waiting caller cannot miss the progress.
+                completedCount += completedInBatch; // Counts the completed transactions.
+            }
+            progressMade.notify_all(); // Wakes the callers waiting for an empty queue.
+            continue;
+        }
+
+        if (!shard.pendingMessages.empty())
+        {
+            this_thread::yield(); // Lets the other shards make room for the messages.
+            continue;
+        }
+
+        if (stopping)
+            return; // Finishes once the processor is being destroyed, which waits for every transaction first.
+
+        // Announces the sleep, then looks at the queue once more, so a transaction queued meanwhile is not missed.
+        shard.sleeping = true; // Asks the next producer to wake this thread.
+        atomic_thread_fence(memory_order_seq_cst); // Orders the announcement before the check, matching the fence in wakeShard.
+        if (!shard.queue.isEmpty())
+        {
+            shard.sleeping = false; // Cancels the sleep to apply the transaction that arrived meanwhile.
+            continue;
+        }
+        unique_lock<mutex> lock(stateMutex); // Locks to wait.
+        shard.workAvailable.wait(lock, [&shard, this]() { return !shard.sleeping || stopping; }); // Waits for a transaction or the stop signal.
+        shard.sleeping = false; // Marks the thread awake.
+    }
+}
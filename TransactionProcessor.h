@@ -0,0 +1,231 @@
+// This is the specification file for the TransactionProcessor class,
+// a thread-per-core engine that applies deposits, withdrawals, transfers and account closures.
+// The accounts are split into shards by their position in the 'accounts' vector. Each shard is owned by one thread,
+// pinned to its own core, which loads the shard's accounts as typed objects and is the only thread to touch them,
+// so nothing inside a shard is locked or shared. Requests reach the shard of their account through its bounded
+// lock-free queue, and each one completes through a future or a callback once it has been applied or rejected.
+// Operations spanning shards are messages passed from shard to shard: the credit of a transfer travels to the shard
+// of the credited account, and a closure visits every shard in turn to close the accounts of a person.
+// The changed accounts are written back to the 'accounts' vector when the caller publishes them.
+
+// These are the include guards
+#pragma once
+#ifndef TRANSACTIONPROCESSOR_H
+#define TRANSACTIONPROCESSOR_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <future>
+#include <chrono>
+#include <ctime>
+#include <utility>
+#include <functional>
+#include <condition_variable>
+#include "BoundedMpmcQueue.h"
+#include "AccountVariant.h"
+using namespace std;
+
+// The kinds of transaction the processor applies
+enum class TransactionType { Deposit, Withdrawal, Transfer, Closure };
+
+// The outcomes of a transaction
+enum class TransactionStatus
+{
+	Applied,             // The transaction changed the accounts
+	InvalidAccount,      // An account position is out of range, a transfer names the same account twice, or a closure names no client
+	InvalidAmount,       // The amount is negative
+	InsufficientBalance, // The withdrawal would leave less than the account allows
+	NotAllowed,          // The account does not take deposits, as certificates only allow withdrawals
+	AccountClosed        // An account of the transaction was closed by an earlier closure
+};
+
+// Holds one transaction, naming the accounts by their position in the 'accounts' vector
+struct TransactionRequest
+{
+	TransactionType type = TransactionType::Deposit;
+	size_t accountIndex = 0;       // The account credited by a deposit, or debited by a withdrawal or a transfer
+	size_t targetAccountIndex = 0; // The account credited by a transfer
+	double amount = 0;
+	long long nationalID = 0;      // The person whose accounts a closure closes
+};
+
+// Holds the outcome of one transaction
+struct TransactionResult
+{
+	TransactionStatus status = TransactionStatus::Applied;
+	double balance = 0;               // The balance of the account named by accountIndex after the transaction, or the total balance a closure closed
+	long long latencyNanoseconds = 0; // The time from the submission to the completion of the transaction
+};
+
+// Receives the outcome of a transaction, on the shard thread that completed it
+using TransactionCallback = function<void(const TransactionResult&)>;
+
+class TransactionProcessor
+{
+private:
+	// The steps of a transaction that passes from shard to shard
+	enum class TransactionStage
+	{
+		Submitted,     // Not applied yet; runs on the shard of accountIndex, or on the first shard for a closure
+		CreditPending, // A transfer debited its source; the credit runs on the shard of targetAccountIndex
+		RefundPending, // A transfer found its credited account closed; the refund runs on the shard of accountIndex
+		Closing        // A closure visiting the shards in turn
+	};
+
+	// Holds a transaction on its way through the shards
+	struct Transaction
+	{
+		TransactionRequest request;
+		TransactionStage stage = TransactionStage::Submitted;
+		size_t visitedShardCount = 0;                 // The number of shards a closure has visited
+		double carriedBalance = 0;                    // The balance of the debited account of a transfer, or the balance closed so far by a closure
+		chrono::steady_clock::time_point submitTime;  // When the transaction was submitted
+		promise<TransactionResult> completion;        // Completes the future, if the transaction has no callback
+		TransactionCallback callback;                 // Receives the outcome, if the caller gave one
+	};
+
+	// Holds the queue, thread and accounts of one shard, on cache lines of its own
+	struct alignas(64) Shard
+	{
+		BoundedMpmcQueue<Transaction> queue;             // Holds the transactions and messages for the shard
+		thread shardThread;                              // Holds the thread that owns the shard
+		atomic<bool> sleeping;                           // Set while the thread waits for transactions
+		condition_variable workAvailable;                // Signaled when a transaction is queued or the processor stops
+		deque<pair<size_t, Transaction>> pendingMessages; // Holds the messages the shard could not pass on yet, with their destination shard
+		vector<AccountVariant> accounts;                 // Holds the accounts of the shard, by position divided by the shard count
+		vector<bool> changed;                            // Set for the accounts changed since they were last published
+		vector<bool> closed;                             // Set for the accounts closed by a closure
+
+		// Constructor that creates the shard's queue with the given capacity
+		explicit Shard(size_t capacity) : queue(capacity), sleeping(false)
+		{
+		}
+	};
+
+	vector<unique_ptr<Shard>> shards; // Holds the shards
+	vector<bool> savingAccounts;      // Set for the saving accounts, read once, since the type of an account never changes
+	time_t asOf;                      // The time certificate withdrawals are evaluated at
+	bool pinShards;                   // Set if each shard thread is pinned to its own core
+	size_t loadedShardCount;          // Counts the shards whose accounts are loaded, guarded by stateMutex
+	atomic<bool> stopping;            // Set when the processor is being destroyed
+	atomic<long long> submittedCount; // Counts the transactions queued
+	atomic<long long> completedCount; // Counts the queued transactions completed
+	mutex stateMutex;                 // Guards sleeping and waking
+	condition_variable progressMade;  // Signaled when a shard finishes loading or a batch of transactions
+
+	// Returns the index of the shard that owns the account at the given position
+	size_t getShardIndex(size_t accountIndex) const
+	{
+		return accountIndex % shards.size();
+	}
+
+	// Returns the account at the given position, from the shard that owns it; only that shard's thread may call it
+	AccountVariant& getShardAccount(size_t accountIndex)
+	{
+		return shards[getShardIndex(accountIndex)]->accounts[accountIndex / shards.size()];
+	}
+
+	// Returns the outcome of the checks made before a transaction is queued: Applied if it can be queued
+	TransactionStatus validateRequest(const TransactionRequest&) const;
+
+	// Queues a transaction for the shard of the given index, waiting while its queue is full
+	void enqueue(size_t, Transaction&);
+
+	// Queues a transaction for the shard of its account, or completes it at once if it is rejected
+	void submitTransaction(Transaction&);
+
+	// Wakes the thread of the shard of the given index if it is waiting for transactions
+	void wakeShard(size_t);
+
+	// Deposits into the account at the given position and returns its new balance
+	double creditAccount(size_t, double);
+
+	// Withdraws from the account at the given position and returns its new balance
+	double debitAccount(size_t, double);
+
+	// Returns true if the account at the given position was closed
+	bool isAccountClosed(size_t accountIndex) const
+	{
+		return shards[getShardIndex(accountIndex)]->closed[accountIndex / shards.size()];
+	}
+
+	/*
+		Applies one transaction, or one step of it, on the shard of the given index.
+		Returns false if the transaction was passed on to another shard, which completes it.
+	*/
+	bool applyTransaction(size_t, Transaction&);
+
+	// Closes the accounts of the closure's person held by the shard of the given index, adding up their balances
+	void closeShardAccounts(size_t, Transaction&);
+
+	/*
+		Passes a transaction on from the first shard to the second without waiting, keeping it on the first shard
+		if the queue is full, so two shards passing messages to each other never wait for each other.
+	*/
+	void forwardTransaction(size_t, size_t, Transaction&);
+
+	// Reports the outcome of a transaction to its future or callback
+	void completeTransaction(Transaction&, TransactionResult);
+
+	// Loads the accounts of the shard of the given index from the 'accounts' vector
+	void loadShard(size_t);
+
+	// The loop run by the thread of every shard
+	void shardLoop(size_t);
+
+public:
+	/*
+		Constructor that starts the given number of shards over the 'accounts' vector,
+		each with a queue of TRANSACTION_QUEUE_CAPACITY transactions.
+		A count lower than 1 starts one shard per hardware thread. If there are no more shards than hardware threads,
+		the thread of each shard is pinned to its own core.
+		Certificate withdrawals are evaluated as of the time of the current operation.
+		The 'accounts' and 'persons' vectors must not be changed by anything else until the processor is destroyed.
+	*/
+	explicit TransactionProcessor(int = 0);
+
+	// Destructor that applies the queued transactions and joins the shard threads
+	~TransactionProcessor();
+
+	// The processor owns running threads, so it can be neither copied nor moved
+	TransactionProcessor(const TransactionProcessor&) = delete;
+	TransactionProcessor& operator=(const TransactionProcessor&) = delete;
+
+	/*
+		Submits a transaction and returns the future of its outcome.
+		Can be called from several threads at once; waits while the queue of the account's shard is full.
+		A closure waits for the transactions queued before it, then for itself to complete, so it must not be submitted
+		from a callback. It rejects the later transactions starting from the person's accounts and refunds the later
+		transfers to them; a refund reaching an account closed meanwhile, by a closure submitted from another thread,
+		is still applied to it.
+	*/
+	future<TransactionResult> submit(const TransactionRequest&);
+
+	/*
+		Submits a transaction whose outcome is passed to the callback, on the shard thread that completes it,
+		or on the calling thread if the transaction is rejected before being queued.
+	*/
+	void submit(const TransactionRequest&, TransactionCallback);
+
+	// Waits until every queued transaction has completed
+	void waitUntilIdle();
+
+	/*
+		Writes the accounts changed since the last call back to the 'accounts' vector,
+		and returns their positions in increasing order, so the caller can persist them.
+		Called after waitUntilIdle, while no transaction is submitted.
+	*/
+	vector<size_t> publishChanges();
+
+	// Inline getter for the number of shards
+	int getShardCount() const
+	{
+		return static_cast<int>(shards.size());
+	}
+};
+
+#endif
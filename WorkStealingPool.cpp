@@ -0,0 +1,124 @@
+#include "WorkStealingPool.h"
+
+// Starts the requested number of workers, or one per hardware thread when the count is not positive.
+WorkStealingPool::WorkStealingPool(int threadCount) : pendingTasks(0), queuedTasks(0), nextQueue(0), stopping(false)
+{
+    if (threadCount < 1)
+        threadCount = static_cast<int>(thread::hardware_concurrency()); // Uses all hardware threads by default.
+    if (threadCount < 1)
+        threadCount = 1; // Falls back to a single worker if the hardware thread count is unknown.
+
+    for (int i = 0; i < threadCount; i++)
+        queues.push_back(make_unique<WorkerQueue>()); // Creates all queues before any worker can try to steal from them.
+    for (int i = 0; i < threadCount; i++)
+        workers.emplace_back(&WorkStealingPool::workerLoop, this, i); // Starts the worker that owns queue i.
+}
+
+// Signals all workers to stop and waits for them to exit.
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        lock_guard<mutex> lock(stateMutex); // Prevents a worker from missing the stop signal while going to sleep.
+        stopping = true; // Tells the workers to exit once they run out of tasks.
+    }
+    workAvailable.notify_all(); // Wakes every sleeping worker.
+    for (thread& worker : workers)
+        worker.join(); // Waits for each worker to exit.
+}
+
+// Pushes a task onto one of the worker queues in round-robin order and wakes a sleeping worker.
+void WorkStealingPool::submit(function<void(int)> task)
+{
+    pendingTasks++; // Counts the task before it becomes visible to the workers.
+    int queueIndex = static_cast<int>(nextQueue++ % queues.size()); // Picks the next queue in turn.
+    {
+        lock_guard<mutex> lock(queues[queueIndex]->queueMutex); // Locks only the chosen queue.
+        queues[queueIndex]->tasks.push_back(move(task)); // Adds the task to the back of the queue.
+        queuedTasks++; // Counts it while the queue is locked, so no worker can take it first.
+    }
+    {
+        lock_guard<mutex> lock(stateMutex); // Orders the push with a worker checking for work before sleeping.
+    }
+    workAvailable.notify_one(); // Wakes one worker to run or steal the task.
+}
+
+// Waits until the pending task count reaches zero, then rethrows the first task error if any.
+void WorkStealingPool::waitAll()
+{
+    unique_lock<mutex> lock(stateMutex); // Locks the state used by the completion condition.
+    allTasksDone.wait(lock, [this]() { return pendingTasks.load() == 0; }); // Sleeps until all tasks finished.
+    if (firstError)
+    {
+        exception_ptr error = firstError; // Takes the stored error so the pool can be reused.
+        firstError = nullptr; // Clears the stored error.
+        rethrow_exception(error); // Reports the failure to the caller.
+    }
+}
+
+// Takes the most recently pushed task from the worker's own queue.
+bool WorkStealingPool::popLocalTask(int workerIndex, function<void(int)>& task)
+{
+    WorkerQueue& queue = *queues[workerIndex]; // Gets the worker's own queue.
+    lock_guard<mutex> lock(queue.queueMutex); // Locks the queue.
+    if (queue.tasks.empty())
+        return false; // Returns false if the worker has nothing left locally.
+    task = move(queue.tasks.back()); // Takes the newest task, which is the most likely to be cache-warm.
+    queue.tasks.pop_back(); // Removes it from the queue.
+    queuedTasks--; // Stops counting it as queued.
+    return true;
+}
+
+// Takes the oldest task from the first other worker that still has work queued.
+bool WorkStealingPool::stealTask(int workerIndex, function<void(int)>& task)
+{
+    int queueCount = static_cast<int>(queues.size()); // Stores the number of queues.
+    for (int offset = 1; offset < queueCount; offset++)
+    {
+        WorkerQueue& victim = *queues[(workerIndex + offset) % queueCount]; // Visits the other queues starting from the neighbor.
+        unique_lock<mutex> lock(victim.queueMutex, try_to_lock); // Skips queues that are busy rather than waiting on them.
+        if (lock.owns_lock() && !victim.tasks.empty())
+        {
+            task = move(victim.tasks.front()); // Takes the oldest task, leaving the owner its newest ones.
+            victim.tasks.pop_front(); // Removes it from the victim's queue.
+            queuedTasks--; // Stops counting it as queued.
+            return true;
+        }
+    }
+    return false; // Returns false if no other worker had a task available.
+}
+
+// Runs tasks from the worker's own queue, steals when it is empty, and sleeps until a task is submitted when there is no work anywhere.
+void WorkStealingPool::workerLoop(int workerIndex)
+{
+    function<void(int)> task; // Stores the task currently being run.
+    while (true)
+    {
+        if (popLocalTask(workerIndex, task) || stealTask(workerIndex, task))
+        {
+            try
+            {
+                task(workerIndex); // Runs the task with the index of this worker.
+            }
+            catch (...)
+            {
+                lock_guard<mutex> lock(stateMutex); // Guards the stored error.
+                if (!firstError)
+                    firstError = current_exception(); // Keeps only the first error.
+            }
+            task = nullptr; // Releases anything captured by the task before the next one runs.
+            if (--pendingTasks == 0)
+            {
+                lock_guard<mutex> lock(stateMutex); // Orders the count change with a waiter checking it.
+                allTasksDone.notify_all(); // Wakes the callers blocked in waitAll.
+            }
+            continue;
+        }
+
+        unique_lock<mutex> lock(stateMutex); // Locks the state before deciding to sleep.
+        // Sleeps until a task is queued; a submitter counts its task before taking this lock to wake a worker, so no wakeup is missed.
+        // A task skipped by the try_lock of stealTask is still counted, so the worker scans the queues again instead of sleeping.
+        workAvailable.wait(lock, [this]() { return stopping || queuedTasks.load() > 0; });
+        if (stopping && queuedTasks.load() == 0)
+            return; // Exits once the pool is stopping and no task is left.
+    }
+}
@@ -0,0 +1,85 @@
+// This is the specification file for the WorkStealingPool class,
+// a fixed-size thread pool where every worker owns a task queue
+// and idle workers steal tasks from the queues of busy workers.
+
+// These are the include guards
+#pragma once
+#ifndef WORKSTEALINGPOOL_H
+#define WORKSTEALINGPOOL_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <exception>
+#include <functional>
+#include <condition_variable>
+using namespace std;
+
+class WorkStealingPool
+{
+private:
+	// Holds the tasks owned by one worker, protected by its own mutex
+	struct WorkerQueue
+	{
+		mutex queueMutex;                 // Guards the task deque of this worker
+		deque<function<void(int)>> tasks; // Tasks waiting to run, each receives the index of the worker running it
+	};
+
+	vector<unique_ptr<WorkerQueue>> queues; // Holds one task queue per worker
+	vector<thread> workers;                 // Holds the worker threads
+	atomic<int> pendingTasks;               // Counts submitted tasks that have not finished yet
+	atomic<int> queuedTasks;                // Counts submitted tasks still in a queue, changed under the lock of that queue
+	atomic<unsigned int> nextQueue;         // Round-robin cursor used to spread submitted tasks
+	atomic<bool> stopping;                  // Set when the pool is being destroyed
+	mutex stateMutex;                       // Guards sleeping and waking of workers and waiters
+	condition_variable workAvailable;       // Signaled when a new task is submitted or the pool stops; idle workers block on it
+	condition_variable allTasksDone;        // Signaled when the pending task count drops to zero
+	exception_ptr firstError;               // Holds the first exception thrown by a task, rethrown by waitAll
+
+	// Pops a task from the back of the worker's own queue (most recently pushed first)
+	bool popLocalTask(int, function<void(int)>&);
+
+	// Steals a task from the front of another worker's queue (oldest first)
+	bool stealTask(int, function<void(int)>&);
+
+	// The loop run by every worker thread
+	void workerLoop(int);
+
+public:
+	/*
+		Constructor that starts the given number of worker threads.
+		A count lower than 1 starts one worker per hardware thread.
+	*/
+	explicit WorkStealingPool(int = 0);
+
+	// Destructor that stops and joins all worker threads
+	~WorkStealingPool();
+
+	// The pool owns running threads, so it can be neither copied nor moved
+	WorkStealingPool(const WorkStealingPool&) = delete;
+	WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+	/*
+		Submits a task to the pool.
+		The task receives the index of the worker that runs it,
+		so callers can keep per-worker partial results without locking.
+	*/
+	void submit(function<void(int)>);
+
+	/*
+		Blocks the caller until every submitted task has finished.
+		If any task threw an exception, the first one is rethrown here.
+	*/
+	void waitAll();
+
+	// Inline getter for the number of worker threads
+	int getThreadCount() const
+	{
+		return static_cast<int>(workers.size());
+	}
+};
+
+#endif